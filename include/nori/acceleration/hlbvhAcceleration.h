@@ -4,6 +4,7 @@
 
 #pragma once
 #include <nori/core/accel.h>
+#include <nori/core/numa.h>
 NORI_NAMESPACE_BEGIN
 
 struct mortonShape;
@@ -21,6 +22,8 @@ public:
 
     virtual bool rayIntersect(const Ray3f & ray, Intersection & its, bool bShadowRay) const;
 
+    virtual void replicateForNode(int node) override;
+
     virtual std::string toString() const override;
 
 private:
@@ -49,7 +52,9 @@ private:
     uint32_t m_nNodes = 0;
     uint32_t m_nLeafs = 0;
     MemoryArena m_memoryArena;/// Use it's own memory manager
-    LinearBVHNode * m_pNodes;
+    LinearBVHNode * m_pNodes = nullptr;
+    LinearBVHNode * m_pNodeReplicas[NORI_MAX_NUMA_NODES] = {}; /// Node-local copies of m_pNodes
+    std::vector<PrimitiveShape*> m_shapeReplicas[NORI_MAX_NUMA_NODES]; /// Node-local copies of m_pShapes
 };
 
 NORI_NAMESPACE_END
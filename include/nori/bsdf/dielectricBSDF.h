@@ -22,6 +22,19 @@ public:
 
     virtual Color3f sample(BSDFQueryRecord &bRec, const Point2f &sample) const override;
 
+    virtual void propagateDifferentials(const BSDFQueryRecord &bRec, const Ray3f &incident, Ray3f &scattered) const override;
+
+    /// Batch version of \ref eval()
+    virtual void evalBatch(const BSDFQueryBatch &batch, Color3fBatch &result) const override;
+
+    /// Batch version of \ref pdf()
+    virtual void pdfBatch(const BSDFQueryBatch &batch, FloatBatch &result) const override;
+
+    /// Batch version of \ref sample()
+    virtual void sampleBatch(BSDFQueryBatch &batch, const Point2fBatch &sample, Color3fBatch &result) const override;
+
+    virtual bool usesRayDifferentials() const override;
+
     virtual std::string toString() const override;
 
     virtual void addChild(NoriObject * pChildObj, const std::string & name) override;
@@ -29,6 +42,16 @@ public:
     virtual void activate() override;
 
 private:
+    /// Gather a texture value for every lane of a batch
+    static Color3fBatch evalTextureBatch(const Texture * pTexture, const BSDFQueryBatch & batch);
+
+    /**
+     * \brief Fresnel reflectance of every lane, and the masks of the lanes whose
+     * outgoing direction is the specular reflection / refraction of the incident one
+     */
+    void getSpecularLanes(const BSDFQueryBatch & batch, FloatBatch & fresnel, FloatBatch & cosThetaT,
+                          MaskBatch & reflected, MaskBatch & refracted) const;
+
     float m_intIOR, m_extIOR;
     std::unique_ptr<Texture> m_pKsReflect;
     std::unique_ptr<Texture> m_pKsRefract;
@@ -26,8 +26,24 @@ public:
     /// Draw a a sample from the BRDF model
     virtual Color3f sample(BSDFQueryRecord &bRec, const Point2f &sample) const override;
 
+    /// Batch version of \ref eval()
+    virtual void evalBatch(const BSDFQueryBatch &batch, Color3fBatch &result) const override;
+
+    /// Batch version of \ref pdf()
+    virtual void pdfBatch(const BSDFQueryBatch &batch, FloatBatch &result) const override;
+
+    /// Batch version of \ref sample()
+    virtual void sampleBatch(BSDFQueryBatch &batch, const Point2fBatch &sample, Color3fBatch &result) const override;
+
+    /// Evaluate the albedo at the intersection
+    virtual void prepare(Intersection &its, MemoryArena &arena) const override;
+
     virtual bool isDiffuse() const override;
 
+    virtual Color3f getAlbedo(const Intersection &its) const override;
+
+    virtual bool usesRayDifferentials() const override;
+
     /// Return a human-readable summary
     virtual std::string toString() const override;
 
@@ -36,6 +52,11 @@ public:
     virtual void activate() override;
 
 private:
+    Color3f getAlbedoParameter(const Intersection &its) const;
+
+    /// Gather the albedo of every lane of a batch
+    Color3fBatch getAlbedoBatch(const BSDFQueryBatch &batch) const;
+
     std::unique_ptr<Texture> m_pAlbedo;
 };
 
@@ -21,11 +21,27 @@ public:
     /// Evaluate the sampling density of \ref sample() wrt. solid angles
     virtual float pdf(const BSDFQueryRecord &bRec) const override;
 
+    /// Evaluate the roughness and the diffuse albedo at the intersection
+    virtual void prepare(Intersection &its, MemoryArena &arena) const override;
+
     /// Sample the BRDF
     virtual Color3f sample(BSDFQueryRecord &bRec, const Point2f &_sample) const override;
 
+    /// Batch version of \ref eval()
+    virtual void evalBatch(const BSDFQueryBatch &batch, Color3fBatch &result) const override;
+
+    /// Batch version of \ref pdf()
+    virtual void pdfBatch(const BSDFQueryBatch &batch, FloatBatch &result) const override;
+
+    /// Batch version of \ref sample()
+    virtual void sampleBatch(BSDFQueryBatch &batch, const Point2fBatch &sample, Color3fBatch &result) const override;
+
     virtual bool isDiffuse() const override;
 
+    virtual Color3f getAlbedo(const Intersection &its) const override;
+
+    virtual bool usesRayDifferentials() const override;
+
     virtual std::string toString() const override;
 
     virtual void addChild(NoriObject *pChildObj, const std::string &name) override;
@@ -33,14 +49,63 @@ public:
     virtual void activate() override;
 
 private:
+    /// Microfacet normal distribution
+    enum class EDistribution
+    {
+        EBeckmann,
+        EGGX
+    };
+
+    /// Texture values at an intersection, see \ref prepare()
+    struct Parameters
+    {
+        float alpha;
+        Color3f kd;
+    };
+
+    Parameters getParameters(const Intersection & its) const;
+
+    float distribution(const Normal3f & M, float alpha) const;
+    float smithG1(const Vector3f & V, const Normal3f & M, float alpha) const;
+
+    /// Sample a microfacet normal for the incident direction \c wi
+    Normal3f sampleNormal(const Vector3f & wi, const Point2f & sample, float alpha) const;
+
+    /// Density of \ref sampleNormal() wrt. solid angles
+    float pdfNormal(const Vector3f & wi, const Normal3f & M, float alpha) const;
+
     static float beckmannD(const Normal3f & M, float alpha);
     static float smithBeckmannG1(const Vector3f & V, const Normal3f & M, float alpha);
+    static float ggxD(const Normal3f & M, float alpha);
+    static float smithGGXG1(const Vector3f & V, const Normal3f & M, float alpha);
+
+    /// Gather the texture values of every lane of a batch
+    void getParameterBatch(const BSDFQueryBatch & batch, FloatBatch & alpha, Color3fBatch & kd) const;
+
+    /// BRDF of every lane, without the checks of the measure and the hemispheres
+    Color3fBatch evalKernel(const Vector3fBatch & wi, const Vector3fBatch & wo, const FloatBatch & alpha,
+                            const Color3fBatch & kd, const FloatBatch & ks) const;
+
+    /// Sampling density of every lane, without the checks of the measure and the hemispheres
+    FloatBatch pdfKernel(const Vector3fBatch & wi, const Vector3fBatch & wo, const FloatBatch & alpha, const FloatBatch & ks) const;
+
+    FloatBatch distributionBatch(const Vector3fBatch & M, const FloatBatch & alpha) const;
+    FloatBatch smithG1Batch(const Vector3fBatch & V, const Vector3fBatch & M, const FloatBatch & alpha) const;
+    Vector3fBatch sampleNormalBatch(const Vector3fBatch & wi, const Point2fBatch & sample, const FloatBatch & alpha) const;
+    FloatBatch pdfNormalBatch(const Vector3fBatch & wi, const Vector3fBatch & M, const FloatBatch & alpha) const;
+
+    static FloatBatch beckmannDBatch(const Vector3fBatch & M, const FloatBatch & alpha);
+    static FloatBatch smithBeckmannG1Batch(const Vector3fBatch & V, const Vector3fBatch & M, const FloatBatch & alpha);
+    static FloatBatch ggxDBatch(const Vector3fBatch & M, const FloatBatch & alpha);
+    static FloatBatch smithGGXG1Batch(const Vector3fBatch & V, const Vector3fBatch & M, const FloatBatch & alpha);
 
 private:
     std::unique_ptr<Texture> m_pAlpha;
     float m_intIOR, m_extIOR;
     std::unique_ptr<Texture> m_pKd;
     float m_eta, m_invEta;
+    EDistribution m_distribution;
+    bool m_bSampleVisible;
 };
 
 
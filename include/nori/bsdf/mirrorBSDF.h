@@ -21,6 +21,8 @@ public:
 
     virtual Color3f sample(BSDFQueryRecord &bRec, const Point2f &) const override;
 
+    virtual void propagateDifferentials(const BSDFQueryRecord &bRec, const Ray3f &incident, Ray3f &scattered) const override;
+
     virtual std::string toString() const override;
 
     virtual void activate() override;
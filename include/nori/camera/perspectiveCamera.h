@@ -21,10 +21,19 @@ public:
     PerspectiveCamera(const PropertyList &propList);
     virtual void activate() override;
 
+    virtual void applyOverrides(const PropertyList &propList) override;
+
     virtual Color3f sampleRay(Ray3f &ray,
                       const Point2f &samplePosition,
                       const Point2f &apertureSample) const override;
 
+    virtual Color3f evalImportance(const Ray3f &ray, Point2f &pixel) const override;
+
+    virtual void pdfImportance(const Ray3f &ray, float &pdfPosition, float &pdfDirection) const override;
+
+    virtual Color3f sampleImportance(const Point3f &ref, const Point2f &apertureSample,
+                      Point3f &p, Normal3f &n, Point2f &pixel, float &pdf) const override;
+
     virtual void addChild(NoriObject *obj, const std::string & name) override;
 
     /// Return a human-readable summary
@@ -32,6 +41,8 @@ public:
 private:
     Vector2f m_invOutputSize;
     Transform m_sampleToCamera;
+    Transform m_cameraToSample;
+    float m_imageArea; ///< Area of the visible region of the plane at z=1 in camera space
     Transform m_cameraToWorld;
     float m_fov;
     float m_nearClip;
@@ -59,6 +59,24 @@ public:
      */
     virtual bool rayIntersect(const Ray3f &ray, Intersection &its, bool shadowRay) const;
 
+    /**
+     * \brief Determine for a batch of shadow rays whether each one is blocked
+     *
+     * Writes \c true to <tt>pOccluded[i]</tt> if <tt>pRays[i]</tt> intersects the
+     * scene. The default implementation issues one occlusion-only query per ray;
+     * accelerations with packet traversal can process the batch at once.
+     */
+    virtual void rayOccluded(const Ray3f *pRays, size_t count, bool *pOccluded) const;
+
+    /**
+     * \brief Copy the data read during traversal into memory local to a NUMA node
+     *
+     * Must be called after \ref build() from a thread pinned to \c node
+     * (see \ref NumaTopology). Afterwards, queries issued by threads of that
+     * node traverse the copy. The default implementation keeps a single copy.
+     */
+    virtual void replicateForNode(int node) { }
+
     /**
      * \brief Return the type of object (i.e. Mesh/BSDF/etc.)
      * provided by this instance
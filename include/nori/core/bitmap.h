@@ -35,6 +35,14 @@ public:
     /// Save the bitmap as an EXR file with the specified filename
     void saveEXR(const std::string &filename);
 
+    /**
+     * \brief Save the bitmap as a part of a larger image in the EXR format
+     *
+     * The file stores the bitmap as its data window at \c offset within a
+     * display window of size \c displaySize.
+     */
+    void saveEXR(const std::string &filename, const Point2i &offset, const Vector2i &displaySize);
+
     /// Save the bitmap as a PNG file (with sRGB tonemapping) with the specified filename
     void savePNG(const std::string &filename);
 };
@@ -70,15 +70,46 @@ public:
      */
     Bitmap *toBitmap() const;
 
+    /// Like \ref toBitmap(), but only convert the given window of the block
+    Bitmap *toBitmap(const Point2i &offset, const Vector2i &size) const;
+
     /// Convert a bitmap into an image block
     void fromBitmap(const Bitmap &bitmap);
 
+    /**
+     * \brief Save the unnormalized contents using the OpenEXR format
+     *
+     * Stores the weighted color sums (R, G, B channels) along with the
+     * accumulated filter weights (W channel) and discards the border region.
+     * Partial renderings of the same image can then be combined exactly
+     * using \ref addWeightedEXR(). The extension ".exr" is appended to the
+     * filename, as in \ref Bitmap::saveEXR(). The crop window of the
+     * rendering is recorded in the header, so that the merged image can
+     * be cropped the same way.
+     */
+    void saveWeightedEXR(const std::string &filename, const Point2i &cropOffset, const Vector2i &cropSize) const;
+
+    /// Add the contents of a file written by \ref saveWeightedEXR() to this block
+    void addWeightedEXR(const std::string &filename);
+
+    /// Read the crop window recorded by \ref saveWeightedEXR() (the whole image when there is none)
+    static void loadWeightedEXRCropWindow(const std::string &filename, Point2i &cropOffset, Vector2i &cropSize);
+
     /// Clear all contents
     void clear() { setConstant(Color4f()); }
 
     /// Record a sample with the given position and radiance value
     void put(const Point2f &pos, const Color3f &value);
 
+    /**
+     * \brief Add radiance to the sample at the given position without
+     * accounting for its weight again
+     *
+     * Used for contributions which are resolved after the sample was recorded
+     * with \ref put() (e.g. deferred shadow rays).
+     */
+    void splat(const Point2f &pos, const Color3f &value);
+
     /**
      * \brief Merge another image block into this one
      *
@@ -96,6 +127,9 @@ public:
     /// Return a human-readable string summary
     std::string toString() const;
 protected:
+    /// Add \c value to the pixels around \c pos, weighted by the reconstruction filter
+    void accumulate(const Point2f &pos, const Color4f &value);
+
     Point2i m_offset;
     Vector2i m_size;
     int m_borderSize = 0;
@@ -125,6 +159,27 @@ public:
      *      Maximum size of the individual blocks
      */
     BlockGenerator(const Vector2i &size, int blockSize);
+
+    /**
+     * \brief Create a block generator which only produces the blocks
+     * intersecting a crop window
+     *
+     * The blocks keep their positions within the grid of the entire image
+     * (and are not clipped to the window). The samples of the pixels within
+     * \c margin of the window still reach it through the reconstruction
+     * filter, so the blocks covering this margin are generated as well and
+     * the pixels of the window match those of a full render.
+     *
+     * \param cropOffset
+     *      Offset of the crop window in pixels
+     * \param cropSize
+     *      Size of the crop window in pixels
+     * \param margin
+     *      Width of the region around the window that also has to be
+     *      rendered, usually the border size of the \ref ImageBlock
+     */
+    BlockGenerator(const Vector2i &size, int blockSize,
+                   const Point2i &cropOffset, const Vector2i &cropSize, int margin = 0);
     
     /**
      * \brief Return the next block to be rendered
@@ -137,10 +192,22 @@ public:
 
     /// Return the total number of blocks
     int getBlockCount() const { return m_blocksLeft; }
+
+    /**
+     * \brief Return the row-major index of a block within the grid of blocks
+     *
+     * Unlike the spiral order, this index only depends on the offset of the block
+     */
+    int getBlockIndex(const ImageBlock &block) const {
+        Point2i index = block.getOffset() / m_blockSize;
+        return index.y() * m_numBlocks.x() + index.x();
+    }
 protected:
     enum EDirection { ERight = 0, EDown, ELeft, EUp };
 
     Point2i m_block;
+    Point2i m_blockMin;
+    Point2i m_blockMax;
     Vector2i m_numBlocks;
     Vector2i m_size;
     int m_blockSize;
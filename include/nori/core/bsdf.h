@@ -59,6 +59,45 @@ public:
 
     virtual float pdf(const BSDFQueryRecord &bRec) const = 0;
 
+    /**
+     * \brief Batch version of \ref sample(): sample an outgoing direction for
+     * every lane of \c batch with the corresponding row of \c sample
+     *
+     * Writes the outgoing directions, the relative refractive indices and the
+     * measure into \c batch and the importance weights into \c result. The
+     * built-in BSDFs implement the batch entry points with SIMD kernels, the
+     * default implementations loop over the scalar versions.
+     */
+    virtual void sampleBatch(BSDFQueryBatch &batch, const Point2fBatch &sample, Color3fBatch &result) const;
+
+    /// Batch version of \ref eval()
+    virtual void evalBatch(const BSDFQueryBatch &batch, Color3fBatch &result) const;
+
+    /// Batch version of \ref pdf()
+    virtual void pdfBatch(const BSDFQueryBatch &batch, FloatBatch &result) const;
+
+    /**
+     * \brief Evaluate the textures of the BSDF at \c its once, before the
+     * BSDF is queried there
+     *
+     * The parameters are allocated from \c arena (which must outlive all
+     * queries at \c its) and stored in <tt>its.pBSDFParams</tt>, which
+     * \ref eval(), \ref pdf() and \ref sample() then read instead of looking
+     * up the same textures again. Queries at intersections which were not
+     * prepared still evaluate the textures. The default does nothing.
+     */
+    virtual void prepare(Intersection &its, MemoryArena &arena) const;
+
+    /**
+     * \brief Compute the differentials of the ray \c scattered, which
+     * continues the path along the direction sampled in \c bRec, from
+     * those of the \c incident ray
+     *
+     * The differentials are only tracked through specular chains, the
+     * default drops them.
+     */
+    virtual void propagateDifferentials(const BSDFQueryRecord &bRec, const Ray3f &incident, Ray3f &scattered) const;
+
     /**
      * \brief Return the type of object (i.e. Mesh/BSDF/etc.)
      * provided by this instance
@@ -71,11 +110,20 @@ public:
      * or not to store photons on a surface
      */
     virtual bool isDiffuse() const;
+
+    /**
+     * \brief Return the hemispherical reflectance at \c its (e.g. the diffuse
+     * albedo), used as a feature by the denoiser
+     */
+    virtual Color3f getAlbedo(const Intersection &its) const;
     /**
 	* \brief Return whether or not this BRDF is anisotropic.
 	*/
     virtual bool isAnisotropic() const;
 
+    /// Return whether the textures of this BSDF are filtered with the ray differentials
+    virtual bool usesRayDifferentials() const;
+
     /// Add a new component of the BSDFType (Could be a combined type or a single type)
     void addBsdfType(uint32_t Type);
 
@@ -85,6 +133,13 @@ public:
     /// Get the combined bitwise BSDF type
     uint32_t getBsdfTypes() const;
 
+protected:
+    /// Differentials of a ray reflected specularly about the shading normal (PBRT 10.1.3)
+    static void reflectDifferentials(const BSDFQueryRecord &bRec, const Ray3f &incident, Ray3f &scattered);
+
+    /// Differentials of a ray refracted specularly through the shading normal (PBRT 10.1.3)
+    static void refractDifferentials(const BSDFQueryRecord &bRec, const Ray3f &incident, Ray3f &scattered);
+
 private:
     uint32_t m_combinedType = 0;
 };
@@ -0,0 +1,44 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#pragma once
+#include <nori/core/common.h>
+#include <nori/core/object.h>
+
+NORI_NAMESPACE_BEGIN
+
+/**
+ * \brief Validation of the batch (SIMD) entry points of the BSDFs against the scalar ones
+ *
+ * Random incident directions on the entire sphere are sampled with
+ * \ref BSDF::sampleBatch() and with \ref BSDF::sample(), and the directions,
+ * relative refractive indices and weights of every lane must agree. The
+ * sampled directions and random ones are then evaluated with
+ * \ref BSDF::evalBatch() and \ref BSDF::pdfBatch(), lane by lane against
+ * \ref BSDF::eval() and \ref BSDF::pdf().
+ */
+class BSDFBatchTest : public NoriObject
+{
+public:
+    BSDFBatchTest(const PropertyList & propList);
+
+    virtual ~BSDFBatchTest();
+
+    /// Register the BSDFs to be tested
+    virtual void addChild(NoriObject * pChildObj, const std::string & name) override;
+
+    /// Execute the tests
+    virtual void activate() override;
+
+    virtual std::string toString() const override;
+
+    virtual EClassType getClassType() const override;
+
+private:
+    std::vector<BSDF *> m_bsdfs;
+    int m_sampleCount;
+    int m_batchSize;
+};
+
+NORI_NAMESPACE_END
@@ -0,0 +1,64 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+#pragma once
+#include <nori/core/common.h>
+#include <nori/core/bsdfQueryRecord.h>
+#include <vector>
+
+NORI_NAMESPACE_BEGIN
+
+/**
+ * \brief Query records of a batch of queries to the same BSDF, in
+ * structure-of-arrays form (every row is one lane)
+ *
+ * Used by the batch (SIMD) entry points of \ref BSDF, e.g. for wavefront
+ * shading. The measure and the transport mode are shared by the batch.
+ */
+struct BSDFQueryBatch
+{
+    /// Incident directions (in the local frames)
+    Vector3fBatch wi;
+
+    /// Outgoing directions (in the local frames)
+    Vector3fBatch wo;
+
+    /// Relative refractive indices in the sampled directions
+    FloatBatch eta;
+
+    /// Measure associated with the samples
+    EMeasure measure = ESolidAngle;
+
+    /// The transport mode when sampling or evaluating a scattering function
+    ETransportMode mode = ETransportMode::ERadiance;
+
+    /// Surface interaction of every lane (may be left empty for queries without textures)
+    std::vector<const Intersection *> pIts;
+
+    /// Create a batch of \c size lanes (at most NORI_MAX_BATCH_SIZE)
+    BSDFQueryBatch(size_t size = 0);
+
+    /// Change the number of lanes (at most NORI_MAX_BATCH_SIZE), the content is undefined afterwards
+    void resize(size_t size);
+
+    /// Return the number of lanes
+    size_t size() const { return size_t(wi.rows()); }
+
+    /// Return the surface interaction of a lane (a default one if none was given)
+    const Intersection & getIntersection(size_t lane) const;
+
+    /// Return the scalar record of a lane
+    BSDFQueryRecord getRecord(size_t lane) const;
+};
+
+/// Set the lanes of \c values outside of \c mask to zero (also when they are NaN)
+template <typename Derived>
+inline void maskLanes(Eigen::ArrayBase<Derived> & values, const MaskBatch & mask)
+{
+    for (Eigen::Index i = 0; i < values.cols(); i++)
+    {
+        values.col(i) = mask.select(values.col(i), 0.0f);
+    }
+}
+
+NORI_NAMESPACE_END
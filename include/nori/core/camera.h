@@ -45,12 +45,94 @@ public:
         const Point2f &samplePosition,
         const Point2f &apertureSample) const = 0;
 
+    /**
+     * \brief Evaluate the importance emitted by the camera along a ray
+     *
+     * \param ray
+     *    A ray leaving the camera
+     *
+     * \param pixel
+     *    Set to the position where the ray crosses the film,
+     *    expressed in fractional pixel coordinates
+     *
+     * \return
+     *    The importance, zero if the ray does not reach the film
+     */
+    virtual Color3f evalImportance(const Ray3f &ray, Point2f &pixel) const {
+        throw NoriException("%s does not support importance evaluation!", classTypeName(getClassType()));
+    }
+
+    /**
+     * \brief Compute the densities of sampling \c ray with \ref sampleRay()
+     *
+     * The density of the position is expressed with respect to the area of
+     * the aperture, the density of the direction with respect to solid angles.
+     */
+    virtual void pdfImportance(const Ray3f &ray, float &pdfPosition, float &pdfDirection) const {
+        throw NoriException("%s does not support importance evaluation!", classTypeName(getClassType()));
+    }
+
+    /**
+     * \brief Sample a position on the aperture which sees the point \c ref
+     *
+     * \param ref
+     *    The reference point
+     *
+     * \param apertureSample
+     *    A uniformly distributed 2D vector that is used to sample
+     *    a position on the aperture if necessary
+     *
+     * \param p
+     *    Set to the sampled position on the aperture
+     *
+     * \param n
+     *    Set to the viewing direction of the camera at \c p
+     *
+     * \param pixel
+     *    Set to the position of \c ref on the film, expressed in
+     *    fractional pixel coordinates
+     *
+     * \param pdf
+     *    Set to the density of \c p with respect to solid angles at \c ref
+     *
+     * \return
+     *    The importance divided by \c pdf, zero if \c ref is not visible on the film
+     */
+    virtual Color3f sampleImportance(const Point3f &ref, const Point2f &apertureSample,
+        Point3f &p, Normal3f &n, Point2f &pixel, float &pdf) const {
+        throw NoriException("%s does not support importance evaluation!", classTypeName(getClassType()));
+    }
+
+    /**
+     * \brief Change parameters of an already activated camera
+     *
+     * The properties use the same names as in the scene description,
+     * parameters that are not specified keep their current values. This
+     * allows re-rendering a resident scene from a different view without
+     * parsing it again.
+     */
+    virtual void applyOverrides(const PropertyList &propList) {
+        throw NoriException("%s does not support parameter overrides!", classTypeName(getClassType()));
+    }
+
     /// Return the size of the output image in pixels
     const Vector2i &getOutputSize() const { return m_outputSize; }
 
+    /// Return the offset of the crop window in pixels
+    const Point2i &getCropOffset() const { return m_cropOffset; }
+
+    /// Return the size of the crop window in pixels (the output size when no crop window is set)
+    Vector2i getCropSize() const { return m_cropSize.prod() > 0 ? m_cropSize : m_outputSize; }
+
+    /// Return whether only a part of the image should be rendered
+    bool hasCropWindow() const { return getCropSize() != m_outputSize; }
+
     /// Return the camera's reconstruction filter in image space
     const ReconstructionFilter *getReconstructionFilter() const { return m_rfilter; }
 
+    /// Specify whether \ref sampleRay() also generates ray differentials (set up by the scene)
+    void setRayDifferentials(bool bRayDifferentials) { m_bRayDifferentials = bRayDifferentials; }
+
     /**
      * \brief Return the type of object (i.e. Mesh/Camera/etc.) 
      * provided by this instance
@@ -59,7 +141,10 @@ public:
 
 protected:
     Vector2i m_outputSize;
+    Point2i m_cropOffset = Point2i(0, 0);
+    Vector2i m_cropSize = Vector2i(0, 0);
     ReconstructionFilter *m_rfilter;
+    bool m_bRayDifferentials = true; ///< Only needed for filtered texture lookups
 };
 
 NORI_NAMESPACE_END
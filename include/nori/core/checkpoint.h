@@ -0,0 +1,106 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#pragma once
+#include <nori/core/common.h>
+#include <nori/core/block.h>
+#include <nori/core/timer.h>
+
+NORI_NAMESPACE_BEGIN
+
+/**
+ * \brief Periodic snapshot of a running render
+ *
+ * Records the accumulated image (colors and filter weights, including the
+ * border region), the number of samples taken in each pixel, the blocks that
+ * have been completed, the seed of the sampler and a hash of the integrator,
+ * sampler and camera configuration. Since every block is
+ * rendered with a sampler that is deterministically seeded from the block
+ * offset and this seed, a resumed render only needs to re-render the blocks
+ * that are not marked as completed to produce the same final image.
+ */
+class RenderCheckpoint
+{
+public:
+    /**
+     * \brief Create an empty checkpoint
+     * \param size
+     *     Size of the rendered image
+     * \param blockSize
+     *     Maximum size of the blocks handed out by the \ref BlockGenerator
+     * \param sampleCount
+     *     Number of samples per pixel of a completed block
+     * \param seed
+     *     Seed of the sampler which renders the blocks
+     * \param configHash
+     *     Hash of the configuration of the render, see \ref hashConfiguration()
+     */
+    RenderCheckpoint(const Vector2i & size, int blockSize, uint32_t sampleCount, uint64_t seed, uint64_t configHash);
+
+    /// Hash a description of the render configuration (e.g. the \c toString() of the integrator, sampler and camera)
+    static uint64_t hashConfiguration(const std::string & description);
+
+    /// Return whether the block at the offset of \c block has been completed
+    bool isCompleted(const ImageBlock & block) const;
+
+    /// Return the number of completed blocks
+    int getCompletedCount() const;
+
+    /**
+     * \brief Merge a finished block into the image and mark it as completed
+     *
+     * Both happen atomically with respect to \ref save(), so a snapshot never
+     * contains the data of a block without its completion flag (or vice versa).
+     * This function is thread-safe.
+     */
+    void commit(ImageBlock & result, ImageBlock & block);
+
+    /**
+     * \brief Write a snapshot of \c result and the progress to a file
+     *
+     * The data is first written to a temporary file which then replaces
+     * \c filename, so that an interrupted write never destroys the previous
+     * checkpoint. This function is thread-safe.
+     */
+    void save(const std::string & filename, const ImageBlock & result) const;
+
+    /**
+     * \brief Write a snapshot if more than \c interval seconds have passed since the last one
+     *
+     * Only one thread writes a snapshot at a time, other threads return immediately.
+     * \return \c true if a snapshot has been written
+     */
+    bool saveIfDue(const std::string & filename, const ImageBlock & result, float interval);
+
+    /**
+     * \brief Restore the image and the progress from a file
+     *
+     * Throws a \ref NoriException if the file does not exist or was written
+     * for a different image size, block size, sample count, sampler seed or
+     * configuration.
+     */
+    void load(const std::string & filename, ImageBlock & result);
+
+    /// Return the number of samples which have been taken in the given pixel
+    uint32_t getSampleCount(const Point2i & pixel) const;
+
+    std::string toString() const;
+
+private:
+    int blockIndex(const ImageBlock & block) const;
+
+    Vector2i m_size;
+    Vector2i m_numBlocks;
+    int m_blockSize;
+    uint32_t m_sampleCount;
+    uint64_t m_seed;
+    uint64_t m_configHash;
+    std::vector<uint8_t> m_completed;
+    std::vector<uint32_t> m_pixelSampleCounts;
+    Timer m_timer;
+    mutable tbb::mutex m_mutex;
+    tbb::mutex m_saveMutex;
+};
+
+NORI_NAMESPACE_END
@@ -42,9 +42,9 @@
 #define NORI_NAMESPACE_BEGIN namespace nori {
 #define NORI_NAMESPACE_END }
 
-#if defined(__NORI_APPLE__NORI_)
+#if defined(__APPLE__)
 #define PLATFORM_MACOS
-#elif defined(__NORI_linux__NORI_)
+#elif defined(__linux__)
 #define PLATFORM_LINUX
 #elif defined(WIN32)
 #define PLATFORM_WINDOWS
@@ -101,10 +101,41 @@
 #define XML_INTEGRATOR_PATH_MATS_DEPTH           "depth"
 #define XML_INTEGRATOR_PATH_MIS                  "path_mis"
 #define XML_INTEGRATOR_PATH_MIS_DEPTH            "depth"
+#define XML_INTEGRATOR_PATH_MIS_GUIDING          "guiding"
+#define XML_INTEGRATOR_PATH_MIS_GUIDING_PASSES   "guidingPasses"
+#define XML_INTEGRATOR_PATH_MIS_GUIDING_BSDF_FRACTION "guidingBsdfFraction"
+#define XML_INTEGRATOR_PATH_MIS_GUIDING_SPATIAL_THRESHOLD "guidingSpatialThreshold"
+#define XML_INTEGRATOR_PATH_MIS_GUIDING_DIRECTIONAL_THRESHOLD "guidingDirectionalThreshold"
+#define XML_INTEGRATOR_EMITTER_SAMPLING          "emitterSampling"
+#define XML_INTEGRATOR_EMITTER_SAMPLING_ALL      "all"
+#define XML_INTEGRATOR_EMITTER_SAMPLING_LIGHT_BVH "lightbvh"
+#define XML_INTEGRATOR_RUSSIAN_ROULETTE          "russianRoulette"
+#define XML_INTEGRATOR_RUSSIAN_ROULETTE_FIXED    "fixed"
+#define XML_INTEGRATOR_RUSSIAN_ROULETTE_ADRRS    "adrrs"
+#define XML_INTEGRATOR_ADRRS_SAMPLE_COUNT        "adrrsSampleCount"
+#define XML_INTEGRATOR_ADRRS_MAX_SPLIT           "adrrsMaxSplit"
+#define XML_INTEGRATOR_SPPM                      "sppm"
+#define XML_INTEGRATOR_SPPM_DEPTH                "depth"
+#define XML_INTEGRATOR_SPPM_ITERATIONS           "iterations"
+#define XML_INTEGRATOR_SPPM_PHOTON_COUNT         "photonCount"
+#define XML_INTEGRATOR_SPPM_INITIAL_RADIUS       "initialRadius"
+#define XML_INTEGRATOR_SPPM_ALPHA                "alpha"
+#define XML_INTEGRATOR_BDPT                      "bdpt"
+#define XML_INTEGRATOR_BDPT_DEPTH                "depth"
+#define XML_INTEGRATOR_BDPT_LIGHT_TRACING        "lightTracing"
+#define XML_INTEGRATOR_RESTIR                    "restir"
+#define XML_INTEGRATOR_RESTIR_DEPTH              "depth"
+#define XML_INTEGRATOR_RESTIR_CANDIDATES         "candidates"
+#define XML_INTEGRATOR_RESTIR_TEMPORAL_REUSE     "temporalReuse"
+#define XML_INTEGRATOR_RESTIR_SPATIAL_REUSE      "spatialReuse"
+#define XML_INTEGRATOR_RESTIR_SPATIAL_NEIGHBORS  "spatialNeighbors"
+#define XML_INTEGRATOR_RESTIR_SPATIAL_RADIUS     "spatialRadius"
+#define XML_INTEGRATOR_RESTIR_HISTORY_LIMIT      "historyLimit"
 
 #define XML_EMITTER                              "emitter"
 #define XML_EMITTER_AREA_LIGHT                   "area"
 #define XML_EMITTER_AREA_LIGHT_RADIANCE          "radiance"
+#define XML_EMITTER_AREA_LIGHT_SOLID_ANGLE       "solidAngleSampling"
 #define XML_EMITTER_POINT_LIGHT                  "point"
 #define XML_EMITTER_POINT_LIGHT_POSITION         "position"
 #define XML_EMITTER_POINT_LIGHT_POWER            "power"
@@ -112,6 +143,7 @@
 #define XML_EMITTER_ENVIRONMENT_LIGHT_FILENAME   "filename"
 #define XML_EMITTER_ENVIRONMENT_LIGHT_SCALE      "scale"
 #define XML_EMITTER_ENVIRONMENT_LIGHT_TO_WORLD   "toWorld"
+#define XML_EMITTER_ENVIRONMENT_LIGHT_ALIAS_TABLE "aliasTable"
 #define XML_EMITTER_DIRECTIONAL_LIGHT            "directional"
 #define XML_EMITTER_DIRECTIONAL_LIGHT_IRRADIANCE "irradiance"
 #define XML_EMITTER_DIRECTIONAL_LIGHT_DIRECTION  "direction"
@@ -197,6 +229,7 @@
 #define XML_MESH_WAVEFRONG_OBJ                   "obj"
 #define XML_MESH_WAVEFRONG_OBJ_FILENAME          "filename"
 #define XML_MESH_WAVEFRONG_OBJ_TO_WORLD          "toWorld"
+#define XML_MESH_WAVEFRONG_OBJ_ALIAS_TABLE       "aliasTable"
 
 #define XML_BSDF                                 "bsdf"
 #define XML_BSDF_GGX                             "ggx"
@@ -214,6 +247,8 @@
 #define XML_BSDF_MICROFACET_INT_IOR              "intIOR"
 #define XML_BSDF_MICROFACET_EXT_IOR              "extIOR"
 #define XML_BSDF_MICROFACET_KD                   "kd"
+#define XML_BSDF_MICROFACET_TYPE                 "type"
+#define XML_BSDF_MICROFACET_SAMPLE_VISIBLE       "sampleVisible"
 #define XML_BSDF_CONDUCTOR                       "conductor"
 #define XML_BSDF_CONDUCTOR_INT_IOR               "intIOR"
 #define XML_BSDF_CONDUCTOR_EXT_IOR               "extIOR"
@@ -291,6 +326,10 @@
 #define XML_CAMERA_PERSPECTIVE_FOV               "fov"
 #define XML_CAMERA_PERSPECTIVE_NEAR_CLIP         "nearClip"
 #define XML_CAMERA_PERSPECTIVE_FAR_CLIP          "farClip"
+#define XML_CAMERA_PERSPECTIVE_CROP_OFFSET_X     "cropOffsetX"
+#define XML_CAMERA_PERSPECTIVE_CROP_OFFSET_Y     "cropOffsetY"
+#define XML_CAMERA_PERSPECTIVE_CROP_WIDTH        "cropWidth"
+#define XML_CAMERA_PERSPECTIVE_CROP_HEIGHT       "cropHeight"
 
 #define XML_TEST                                 "test"
 #define XML_TEST_STUDENT_T                       "ttest"
@@ -304,6 +343,27 @@
 #define XML_TEST_CHI2_MIN_EXP_FREQUENCY          "minExpFrequency"
 #define XML_TEST_CHI2_SAMPLE_COUNT               "sampleCount"
 #define XML_TEST_CHI2_TEST_COUNT                 "testCount"
+#define XML_TEST_DISCRETE_PDF                    "dpdftest"
+#define XML_TEST_DISCRETE_PDF_COUNT              "count"
+#define XML_TEST_DISCRETE_PDF_WIDTH              "width"
+#define XML_TEST_DISCRETE_PDF_HEIGHT             "height"
+#define XML_TEST_DISCRETE_PDF_SAMPLE_COUNT       "sampleCount"
+#define XML_TEST_PCG32X8                         "pcgtest"
+#define XML_TEST_PCG32X8_STREAM_COUNT            "streamCount"
+#define XML_TEST_PCG32X8_SAMPLE_COUNT            "sampleCount"
+#define XML_TEST_BSDF_BATCH                      "batchtest"
+#define XML_TEST_BSDF_BATCH_SAMPLE_COUNT         "sampleCount"
+#define XML_TEST_BSDF_BATCH_BATCH_SIZE           "batchSize"
+#define XML_TEST_SPHERICAL_TRIANGLE              "sphtritest"
+#define XML_TEST_SPHERICAL_TRIANGLE_RESOLUTION   "resolution"
+#define XML_TEST_SPHERICAL_TRIANGLE_SAMPLE_COUNT "sampleCount"
+#define XML_TEST_SPHERICAL_TRIANGLE_SIGNIFICANCE_LEVEL "significanceLevel"
+#define XML_TEST_SAMPLER                         "samplertest"
+#define XML_TEST_SAMPLER_SAMPLERS                "samplers"
+#define XML_TEST_SAMPLER_SAMPLE_COUNTS           "sampleCounts"
+#define XML_TEST_SAMPLER_RESOLUTION              "resolution"
+#define XML_TEST_SAMPLER_SAMPLE_COUNT            "sampleCount"
+#define XML_TEST_SAMPLER_SIGNIFICANCE_LEVEL      "significanceLevel"
 
 #define XML_FILTER                               "rfilter"
 #define XML_FILTER_BOX                           "box"
@@ -319,6 +379,20 @@
 #define XML_SAMPLER                              "sampler"
 #define XML_SAMPLER_INDEPENDENT                  "independent"
 #define XML_SAMPLER_INDEPENDENT_SAMPLE_COUNT     "sampleCount"
+#define XML_SAMPLER_INDEPENDENT_SEED             "seed"
+#define XML_SAMPLER_SOBOL                        "sobol"
+#define XML_SAMPLER_SOBOL_SAMPLE_COUNT           "sampleCount"
+#define XML_SAMPLER_SOBOL_SEED                   "seed"
+#define XML_SAMPLER_CMJ                          "cmj"
+#define XML_SAMPLER_CMJ_SAMPLE_COUNT             "sampleCount"
+#define XML_SAMPLER_CMJ_SEED                     "seed"
+#define XML_SAMPLER_STRATIFIED                   "stratified"
+#define XML_SAMPLER_STRATIFIED_SAMPLE_COUNT      "sampleCount"
+#define XML_SAMPLER_STRATIFIED_SEED              "seed"
+#define XML_SAMPLER_STRATIFIED_JITTER            "jitter"
+#define XML_SAMPLER_ZSOBOL                       "zsobol"
+#define XML_SAMPLER_ZSOBOL_SAMPLE_COUNT          "sampleCount"
+#define XML_SAMPLER_ZSOBOL_SEED                  "seed"
 
 #define XML_SHAPE                                "shape"
 
@@ -351,6 +425,8 @@
 #define DEFAULT_BSDF_MICROFACET_INT_IOR            1.5046f
 #define DEFAULT_BSDF_MICROFACET_EXT_IOR            1.000277f /* Air */
 #define DEFAULT_BSDF_MICROFACET_ALBEDO             Color3f(0.5f)
+#define DEFAULT_BSDF_MICROFACET_TYPE               XML_BSDF_BECKMANN
+#define DEFAULT_BSDF_MICROFACET_SAMPLE_VISIBLE     true
 #define DEFAULT_BSDF_CONDUCTOR_INT_IOR             1.5046f
 #define DEFAULT_BSDF_CONDUCTOR_EXT_IOR             1.000277f /* Air */
 #define DEFAULT_BSDF_CONDUCTOR_K                   Color3f(1.0f)
@@ -414,13 +490,47 @@
 #define DEFAULT_INTEGRATOR_AO_ALPHA                1e6f
 #define DEFAULT_INTEGRATOR_AO_SAMPLE_COUNT         16
 #define DEFAULT_INTEGRATOR_WHITTED_DEPTH           -1
+#define DEFAULT_INTEGRATOR_EMITTER_SAMPLING        XML_INTEGRATOR_EMITTER_SAMPLING_ALL
+#define DEFAULT_INTEGRATOR_RUSSIAN_ROULETTE        XML_INTEGRATOR_RUSSIAN_ROULETTE_FIXED
+#define DEFAULT_INTEGRATOR_ADRRS_SAMPLE_COUNT      4
+#define DEFAULT_INTEGRATOR_ADRRS_MAX_SPLIT         8.0f
+#define DEFAULT_INTEGRATOR_PATH_MIS_GUIDING        false
+#define DEFAULT_INTEGRATOR_PATH_MIS_GUIDING_PASSES 5
+#define DEFAULT_INTEGRATOR_PATH_MIS_GUIDING_BSDF_FRACTION 0.5f
+#define DEFAULT_INTEGRATOR_PATH_MIS_GUIDING_SPATIAL_THRESHOLD 12000
+#define DEFAULT_INTEGRATOR_PATH_MIS_GUIDING_DIRECTIONAL_THRESHOLD 0.01f
+#define DEFAULT_INTEGRATOR_SPPM_ITERATIONS         64
+#define DEFAULT_INTEGRATOR_SPPM_PHOTON_COUNT       100000
+#define DEFAULT_INTEGRATOR_SPPM_INITIAL_RADIUS     0.0f
+#define DEFAULT_INTEGRATOR_SPPM_ALPHA              0.6667f
+#define DEFAULT_INTEGRATOR_BDPT_LIGHT_TRACING      true
+#define DEFAULT_INTEGRATOR_RESTIR_CANDIDATES       32
+#define DEFAULT_INTEGRATOR_RESTIR_TEMPORAL_REUSE   false
+#define DEFAULT_INTEGRATOR_RESTIR_SPATIAL_REUSE    false
+#define DEFAULT_INTEGRATOR_RESTIR_SPATIAL_NEIGHBORS 3
+#define DEFAULT_INTEGRATOR_RESTIR_SPATIAL_RADIUS   4
+#define DEFAULT_INTEGRATOR_RESTIR_HISTORY_LIMIT    20
 
 #define DEFAULT_SAMPLER_INDEPENDENT_SAMPLE_COUNT   1
+#define DEFAULT_SAMPLER_INDEPENDENT_SEED           0
+#define DEFAULT_SAMPLER_SOBOL_SAMPLE_COUNT         1
+#define DEFAULT_SAMPLER_SOBOL_SEED                 0
+#define DEFAULT_SAMPLER_CMJ_SAMPLE_COUNT           1
+#define DEFAULT_SAMPLER_CMJ_SEED                   0
+#define DEFAULT_SAMPLER_STRATIFIED_SAMPLE_COUNT    1
+#define DEFAULT_SAMPLER_STRATIFIED_SEED            0
+#define DEFAULT_SAMPLER_STRATIFIED_JITTER          true
+#define DEFAULT_SAMPLER_ZSOBOL_SAMPLE_COUNT        1
+#define DEFAULT_SAMPLER_ZSOBOL_SEED                0
 
 #define DEFAULT_MESH_BSDF                          XML_BSDF_DIFFUSE
+#define DEFAULT_MESH_ALIAS_TABLE                   false
+
+#define DEFAULT_EMITTER_AREA_LIGHT_SOLID_ANGLE     true
 
 #define DEFAULT_EMITTER_ENVIRONMENT_SCALE          1.0f
 #define DEFAULT_EMITTER_ENVIRONMENT_TO_WORLD       Transform()
+#define DEFAULT_EMITTER_ENVIRONMENT_ALIAS_TABLE    false
 
 #define DEFAULT_TEST_STUDENT_T_SIGNIFICANCE_LEVEL  0.01f
 #define DEFAULT_TEST_STUDENT_T_ANGLES              ""
@@ -433,6 +543,27 @@
 #define DEFAULT_TEST_CHI2_SAMPLE_COUNT             -1
 #define DEFAULT_TEST_CHI2_TEST_COUNT               5
 
+#define DEFAULT_TEST_DISCRETE_PDF_COUNT            100000
+#define DEFAULT_TEST_DISCRETE_PDF_WIDTH            4096
+#define DEFAULT_TEST_DISCRETE_PDF_HEIGHT           2048
+#define DEFAULT_TEST_DISCRETE_PDF_SAMPLE_COUNT     10000000
+
+#define DEFAULT_TEST_PCG32X8_STREAM_COUNT          64
+#define DEFAULT_TEST_PCG32X8_SAMPLE_COUNT          100000
+
+#define DEFAULT_TEST_BSDF_BATCH_SAMPLE_COUNT       100000
+#define DEFAULT_TEST_BSDF_BATCH_BATCH_SIZE         64
+
+#define DEFAULT_TEST_SPHERICAL_TRIANGLE_RESOLUTION 20
+#define DEFAULT_TEST_SPHERICAL_TRIANGLE_SAMPLE_COUNT 1000000
+#define DEFAULT_TEST_SPHERICAL_TRIANGLE_SIGNIFICANCE_LEVEL 0.01f
+
+#define DEFAULT_TEST_SAMPLER_SAMPLERS              "stratified, cmj"
+#define DEFAULT_TEST_SAMPLER_SAMPLE_COUNTS         "2, 3, 5, 8, 32, 128, 512"
+#define DEFAULT_TEST_SAMPLER_RESOLUTION            16
+#define DEFAULT_TEST_SAMPLER_SAMPLE_COUNT          1000000
+#define DEFAULT_TEST_SAMPLER_SIGNIFICANCE_LEVEL    0.01f
+
 #define DEFAULT_SCENE_BACKGROUND                   Color3f(0.0f)
 #define DEFAULT_SCENE_FORCE_BACKGROUND             false
 
@@ -535,6 +666,16 @@ typedef TBoundingBox<Point4i>   BoundingBox4i;
 typedef TRay<Point2f, Vector2f> Ray2f;
 typedef TRay<Point3f, Vector3f> Ray3f;
 
+/* Structure-of-arrays types of the batch (SIMD) kernels, every row is one lane. The
+   storage for NORI_MAX_BATCH_SIZE lanes is inline, so the temporaries of the kernels
+   are never allocated on the heap */
+#define NORI_MAX_BATCH_SIZE 256
+typedef Eigen::Array<float, Eigen::Dynamic, 1, Eigen::ColMajor, NORI_MAX_BATCH_SIZE, 1> FloatBatch;
+typedef Eigen::Array<float, Eigen::Dynamic, 2, Eigen::ColMajor, NORI_MAX_BATCH_SIZE, 2> Point2fBatch;
+typedef Eigen::Array<float, Eigen::Dynamic, 3, Eigen::ColMajor, NORI_MAX_BATCH_SIZE, 3> Vector3fBatch;
+typedef Eigen::Array<float, Eigen::Dynamic, 3, Eigen::ColMajor, NORI_MAX_BATCH_SIZE, 3> Color3fBatch;
+typedef Eigen::Array<bool, Eigen::Dynamic, 1, Eigen::ColMajor, NORI_MAX_BATCH_SIZE, 1> MaskBatch;
+
 /// Some more forward declarations
 class Accel;
 class BSDF;
@@ -544,6 +685,12 @@ class Camera;
 class ImageBlock;
 class Integrator;
 class KDTree;
+class LightBVH;
+class MemoryArena;
+class SDTree;
+class RadianceCache;
+struct DTreeWrapper;
+struct LightBounds;
 class Emitter;
 struct EmitterQueryRecord;
 class Mesh;
@@ -558,6 +705,7 @@ class Sampler;
 class Scene;
 class Timer;
 struct BSDFQueryRecord;
+struct BSDFQueryBatch;
 class DiscretePDF1D;
 class DiscretePDF2D;
 class Texture;
@@ -627,6 +775,9 @@ extern float gammaCorrect(float value, float invGamma);
 /// Fresnel coefficient for dielectric material. eta = intIOR / extIOR
 extern float fresnelDielectric(float cosThetaI, float eta, float invEta, float & cosThetaT);
 
+/// Batch version of \ref fresnelDielectric(), one lane per row
+extern void fresnelDielectricBatch(const FloatBatch & cosThetaI, float eta, float invEta, FloatBatch & fresnel, FloatBatch & cosThetaT);
+
 /// Fresnel coefficient for conductor material. eta = intIOR / extIOR, etaK = K / extIOR
 extern Color3f fresnelConductor(float cosThetaI, const Color3f & eta, const Color3f & etaK);
 
@@ -0,0 +1,58 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#pragma once
+#include <nori/core/common.h>
+#include <nori/core/bitmap.h>
+
+NORI_NAMESPACE_BEGIN
+
+/// First-hit feature buffers guiding the \ref Denoiser
+struct FeatureBuffers
+{
+    Bitmap albedo;  ///< Albedo of the BSDF (one for missed rays)
+    Bitmap normal;  ///< Shading normal in world space (zero for missed rays)
+    Bitmap depth;   ///< Distance to the camera (zero for missed rays), stored in all channels
+};
+
+/**
+ * \brief Edge-avoiding a-trous wavelet filter (Dammertz et al., "Edge-Avoiding
+ * A-Trous Wavelet Transform for fast Global Illumination Filtering", 2010)
+ *
+ * The image is divided by the albedo, so only the (smoother) illumination is
+ * filtered and the texture detail is restored afterwards. Every iteration
+ * applies a 5x5 B3-spline kernel whose taps are spread apart by a step doubling
+ * with each iteration, and every tap is weighted by the similarity of its
+ * color (in log space), normal, depth and albedo to the center pixel. The
+ * tolerance on the color is halved with each iteration so that the coarse
+ * levels do not blur over features which the noise hid from the fine levels.
+ */
+class Denoiser
+{
+public:
+    Denoiser(int iterations = 5, float sigmaColor = 0.35f, float sigmaNormal = 0.3f,
+             float sigmaDepth = 0.1f, float sigmaAlbedo = 0.1f);
+
+    /**
+     * \brief Render the feature buffers of the crop window of the camera
+     *
+     * Every pixel averages \c sampleCount primary rays (uniformly distributed
+     * within the pixel), rendered in parallel.
+     */
+    static void renderFeatures(const Scene * pScene, uint32_t sampleCount, FeatureBuffers & features);
+
+    /// Filter \c color, which must have the same size as the feature buffers
+    Bitmap * denoise(const Bitmap & color, const FeatureBuffers & features) const;
+
+    std::string toString() const;
+
+private:
+    int m_iterations;
+    float m_sigmaColor;
+    float m_sigmaNormal;
+    float m_sigmaDepth;
+    float m_sigmaAlbedo;
+};
+
+NORI_NAMESPACE_END
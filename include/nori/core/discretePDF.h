@@ -12,6 +12,12 @@ NORI_NAMESPACE_BEGIN
 *
 * This data structure can be used to transform uniformly distributed
 * samples to a stored discrete probability distribution.
+*
+* By default an entry is selected by inverting the CDF with a binary search,
+* which is monotonic and thus preserves the stratification of the samples.
+* Optionally, it is selected in constant time with an alias table (Walker's
+* method, built with Vose's algorithm), which produces the same densities but
+* scrambles stratified samples.
 */
 
 struct DiscretePDF1D
@@ -19,7 +25,7 @@ struct DiscretePDF1D
 public:
     friend struct DiscretePDF2D;
 
-    DiscretePDF1D(const float * pFunc, const int& count);
+    DiscretePDF1D(const float * pFunc, const int& count, bool bAliasTable = false);
 
     int count() const;
 
@@ -30,8 +36,22 @@ public:
     float pdf(const int& index) const;
 
 private:
+    /// Entry of the alias table: the bin keeps its own index with probability \c prob, otherwise it selects \c alias
+    struct AliasEntry
+    {
+        float prob;
+        int alias;
+    };
+
+    void buildAliasTable();
+
+    /// Select an entry, \c sampleRemapped receives the position of the sample within it
+    int sampleIndex(const float& sample, float& sampleRemapped) const;
+
     std::vector<float> m_cdf, m_func;
+    std::vector<AliasEntry> m_aliasTable;
     float m_funcIntegral;
+    bool m_bAliasTable;
 };
 
 
@@ -44,8 +64,8 @@ private:
 struct DiscretePDF2D
 {
 public:
-    /// Construct a 2D distribution by the array data
-    DiscretePDF2D(float * pDatas, const int& width, const int& height);
+    /// Construct a 2D distribution by the array data, see \ref DiscretePDF1D for \c bAliasTable
+    DiscretePDF2D(float * pDatas, const int& width, const int& height, bool bAliasTable = false);
 
     Point2f sampleContinuous(const Point2f& sample, float * pPdf = nullptr, Point2i * idx = nullptr) const;
 
@@ -0,0 +1,48 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#pragma once
+#include <nori/core/common.h>
+#include <nori/core/object.h>
+
+NORI_NAMESPACE_BEGIN
+
+/**
+ * \brief Validation and benchmark of the two backends of \ref DiscretePDF1D
+ * and \ref DiscretePDF2D (CDF inversion and alias table)
+ *
+ * Both backends sample the same random, heavy-tailed distributions. The
+ * average density of the samples is compared against its expected value
+ * (the sum of the squared probabilities), which fails when the samples do not
+ * follow the densities that are reported for them, and the time per sample is
+ * printed. A chi^2 test then compares the histogram of the sampled entries
+ * (or cells) with the expected frequencies. The 1D distribution is also
+ * sampled through a mesh with triangles of the same areas, which times
+ * \ref Mesh::samplePosition() with either backend (see the "aliasTable"
+ * parameter of the meshes).
+ *
+ * A float sample only takes 2^23 different values, so with much more than
+ * 10^5 entries the selection of a single entry becomes measurably quantized
+ * (with either backend) and the 1D test starts to fail.
+ */
+class DiscretePDFTest : public NoriObject
+{
+public:
+    DiscretePDFTest(const PropertyList & propList);
+
+    /// Execute the tests
+    virtual void activate() override;
+
+    virtual std::string toString() const override;
+
+    virtual EClassType getClassType() const override;
+
+private:
+    int m_count;
+    int m_width;
+    int m_height;
+    int m_sampleCount;
+};
+
+NORI_NAMESPACE_END
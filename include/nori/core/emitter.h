@@ -59,6 +59,61 @@ public:
 	*/
     virtual Color3f eval(const EmitterQueryRecord & record) const = 0;
 
+    /**
+     * \brief Return the number of primitives (e.g. the triangles of an area
+     * light) which are sampled as individual lights by the \ref LightBVH
+     */
+    virtual uint32_t getPrimitiveCount() const { return 1; }
+
+    /**
+     * \brief Return the spatial and directional bounds of the power emitted by a primitive
+     *
+     * \return \c false if the emitter is unbounded (e.g. an environment light),
+     *         such emitters are not placed in the hierarchy of the \ref LightBVH
+     */
+    virtual bool getLightBounds(uint32_t primitive, LightBounds & bounds) const { return false; }
+
+    /**
+     * \brief Sample a position on the primitive \c record.primitive only
+     *
+     * Same as \ref sample(), except that the density is conditioned on the
+     * primitive. The default implementation samples the entire emitter.
+     */
+    virtual Color3f samplePrimitive(EmitterQueryRecord & record, const Point2f & sample2D, float sample1D) const
+    {
+        return sample(record, sample2D, sample1D);
+    }
+
+    /// Compute the probability of sampling \c record.p with \ref samplePrimitive()
+    virtual float pdfPrimitive(const EmitterQueryRecord & record) const { return pdf(record); }
+
+    /**
+     * \brief Sample a ray leaving the emitter (e.g. to trace photons)
+     *
+     * \param ray               The sampled ray
+     * \param n                 Set to the surface normal at the origin of the ray
+     *                          (the direction of the ray for environment emitters)
+     * \param positionSample    A uniformly distributed sample on \f$[0,1]^2\f$
+     * \param directionSample   A uniformly distributed sample on \f$[0,1]^2\f$
+     * \param sample1D          A uniformly distributed sample on \f$[0,1]\f$
+     * \param sceneBounds       Bounds of the scene, which environment emitters
+     *                          use to place the origin of the ray
+     *
+     * \return The power carried by the ray divided by the density of the ray
+     */
+    virtual Color3f sampleRay(Ray3f & ray, Normal3f & n, const Point2f & positionSample, const Point2f & directionSample,
+                              float sample1D, const BoundingBox3f & sceneBounds) const;
+
+    /**
+     * \brief Compute the densities of sampling \c ray with \ref sampleRay()
+     *
+     * \param n                 The surface normal at the origin of the ray
+     * \param pdfPosition       Set to the density of the origin with respect to areas
+     * \param pdfDirection      Set to the density of the direction with respect to solid angles
+     */
+    virtual void pdfRay(const Ray3f & ray, const Normal3f & n, const BoundingBox3f & sceneBounds,
+                        float & pdfPosition, float & pdfDirection) const;
+
     /**
      * \brief Return the type of object (i.e. Mesh/Emitter/etc.) 
      * provided by this instance
@@ -15,6 +15,9 @@ struct EmitterQueryRecord
     /// Pointer to the sampled emitter
     const Emitter * pEmitter = nullptr;
 
+    /// Index of the primitive of the emitter (e.g. the triangle of an area light)
+    uint32_t primitive = 0;
+
     /// Origin point from which we sample the emitter
     Point3f ref;
 
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <nori/core/object.h>
+#include <functional>
 
 NORI_NAMESPACE_BEGIN
 
@@ -41,11 +42,61 @@ public:
      */
     virtual Color3f li(const Scene *pScene, Sampler *pSampler, const Ray3f &ray) const = 0;
 
+    /**
+     * \brief Perform an (optional) postprocess step once all blocks were rendered
+     *
+     * Integrators which also contribute to pixels other than the one being
+     * sampled (e.g. by splatting light tracing paths onto the film) add these
+     * contributions to \c result here.
+     */
+    virtual void postprocess(const Scene *pScene, ImageBlock &result) const { }
+
+    /**
+     * \brief Render the entire image with a custom rendering loop
+     *
+     * Integrators whose estimates are not independent per pixel (e.g. photon
+     * mapping) override this function and write the (normalized) pixel values
+     * into \c result, possibly several times to show the progress.
+     *
+     * \return \c false if the image should be rendered block by block with \ref li()
+     */
+    virtual bool render(const Scene *pScene, ImageBlock &result) const { return false; }
+
+    /**
+     * \brief Return whether every image block is rendered on its own
+     *
+     * Crop windows, checkpoints and distributed workers skip or restore
+     * individual blocks, which requires that no other part of the image
+     * depends on them. Integrators with their own rendering loop (see
+     * \ref render()) return \c false, and these modes are rejected.
+     */
+    virtual bool hasIndependentBlocks() const { return true; }
+
+    /**
+     * \brief Return whether \ref preprocess() always leads to the same state
+     *
+     * A resumed render combines blocks rendered by two processes, which is
+     * only consistent if both preprocessed the scene identically. Integrators
+     * which learn from paths traced concurrently (e.g. a guiding distribution)
+     * return \c false, and checkpoints are rejected.
+     */
+    virtual bool hasReproduciblePreprocess() const { return true; }
+
     /**
      * \brief Return the type of object (i.e. Mesh/BSDF/etc.) 
      * provided by this instance
      * */
     EClassType getClassType() const { return EIntegrator; }
+
+protected:
+    /**
+     * \brief Trace \c sampleCount camera rays through every pixel in parallel
+     *
+     * Used by training passes in \ref preprocess() (e.g. to learn a guiding
+     * distribution), \c trace is invoked concurrently with a sampler per thread.
+     */
+    void traceCameraRays(const Scene *pScene, uint32_t sampleCount, uint64_t seed,
+                         const std::function<void(Sampler *, const Ray3f &)> &trace) const;
 };
 
 NORI_NAMESPACE_END
@@ -14,36 +14,59 @@ NORI_NAMESPACE_BEGIN
  * This includes the position, traveled ray distance, uv coordinates, as well
  * as well as two local coordinate frames (one that corresponds to the true
  * geometry, and one that is used for shading computations).
+ *
+ * The traversal of the acceleration structures only keeps a compact hit (the
+ * shape, the distance and the barycentric coordinates), which the shape turns
+ * into the surface attributes above once the closest hit is known. The
+ * position, the texture coordinates and both frames are still computed
+ * eagerly: every caller that asks for an intersection record shades the hit
+ * or spawns a ray from it, which needs the frames, and shadow rays never
+ * build a record. Deferring them would only save work for hits that are
+ * discarded unshaded, at the cost of an accessor on every use. The partial
+ * derivatives are only needed by textured BSDFs and are computed on demand by
+ * \ref computePartials(). Likewise, the hit only keeps the footprint of the ray
+ * differentials (\ref dPdX, \ref dPdY), and the texture coordinate partials
+ * wrt. the screen space are left to \ref computeScreenSpacePartials().
  */
 struct Intersection {
     /// Position of the surface intersection
     Point3f p;
     /// Unoccluded distance along the ray
     float t;
-    /** \brief UV coordinates, if any
-     * (This parameter was used as barycentric coordinate in the 1st stage
-     * of ray-triangle intersection and was transformed to UV coordinate in
-     * the 2nd stage)
-     */
+    /// Barycentric coordinates of the hit on the shape (set by the traversal)
+    Point2f barycentric;
+    /// UV coordinates, if any
     Point2f uv;
 
-    bool bHasUVPartial = false;
+    /// Whether the partials were computed by \ref computePartials()
+    mutable bool bPartialsComputed = false;
+
+    /// Whether the shape provides partials (only valid once they were computed)
+    mutable bool bHasUVPartial = false;
+
+    mutable Vector3f dPdU;
+
+    mutable Vector3f dPdV;
 
-    Vector3f dPdU;
+    mutable Vector3f dNdU;
 
-    Vector3f dPdV;
+    mutable Vector3f dNdV;
 
-    Vector3f dNdU;
+    /// Offset of the position for a shift of one (scaled) pixel, see \ref setRayDifferentials()
+    Vector3f dPdX = Vector3f(0.0f);
 
-    Vector3f dNdV;
+    Vector3f dPdY = Vector3f(0.0f);
 
-    float dUdX = 0.0f;
+    /// Whether the partials below were computed by \ref computeScreenSpacePartials()
+    mutable bool bScreenSpacePartialsComputed = false;
 
-    float dUdY = 0.0f;
+    mutable float dUdX = 0.0f;
 
-    float dVdX = 0.0f;
+    mutable float dUdY = 0.0f;
 
-    float dVdY = 0.0f;
+    mutable float dVdX = 0.0f;
+
+    mutable float dVdY = 0.0f;
 
     /// Shading frame (based on the shading normal)
     Frame shFrame;
@@ -60,6 +83,9 @@ struct Intersection {
     /// Pointer to the associated BSDF
     const BSDF * pBSDF = nullptr;
 
+    /// Parameters of the BSDF evaluated at the intersection (nullptr until \ref BSDF::prepare() was called)
+    const void * pBSDFParams = nullptr;
+
     /// Create an uninitialized intersection record
     Intersection();
 
@@ -74,8 +100,14 @@ struct Intersection {
 	*/
     Ray3f generateShadowRay(const Point3f & destPoint) const;
 
-    /// Computes texture coordinate partials
-    void computeScreenSpacePartial(const Ray3f & Ray);
+    /// Compute the partial derivatives of the position and the normal wrt. the texture coordinates (if not done yet)
+    void computePartials() const;
+
+    /// Compute the position partials wrt. the screen space from the ray differentials (zero without)
+    void setRayDifferentials(const Ray3f & Ray);
+
+    /// Compute the texture coordinate partials wrt. the screen space from the position partials (if not done yet)
+    void computeScreenSpacePartials() const;
 
     /// Return a human-readable summary of the intersection record
     std::string toString() const;
@@ -0,0 +1,143 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#pragma once
+#include <nori/core/common.h>
+#include <nori/core/bbox.h>
+#include <unordered_map>
+
+NORI_NAMESPACE_BEGIN
+
+/**
+ * \brief Spatial and directional bounds of the power emitted by a light (or a group of lights)
+ *
+ * The surface normals of the emitters lie within the cone of angle
+ * \c thetaO around \c w, and light is emitted up to \c thetaE beyond
+ * the normals (pi / 2 for diffuse emitters).
+ */
+struct LightBounds
+{
+    /// Bounds of the emitting positions
+    BoundingBox3f bounds;
+
+    /// Emitted power
+    float phi = 0.0f;
+
+    /// Axis of the cone bounding the surface normals
+    Vector3f w = Vector3f(0.0f, 0.0f, 1.0f);
+
+    /// Cosine of the spread of the normals around \c w
+    float cosThetaO = 1.0f;
+
+    /// Cosine of the emission angle beyond the normals
+    float cosThetaE = 0.0f;
+
+    /// Whether light is emitted on both sides of the surfaces
+    bool bTwoSided = false;
+
+    /**
+     * \brief Conservatively estimate the contribution to the point \c p with normal \c n
+     *
+     * Bounds the distance, the angle to the normal cone and the cosine at the
+     * receiver over all positions in the bounds. A zero normal skips the
+     * receiver cosine.
+     */
+    float importance(const Point3f & p, const Normal3f & n) const;
+
+    /// Return the bounds of the union of two groups of lights
+    static LightBounds merge(const LightBounds & a, const LightBounds & b);
+};
+
+/**
+ * \brief Bounding volume hierarchy over the emitters of a scene (Conty Estevez and Kulla, 2018)
+ *
+ * Every primitive of a bounded emitter (e.g. every triangle of an area light)
+ * is a leaf of the tree. A light is selected for a shading point by descending
+ * the tree and choosing a child proportionally to its \ref LightBounds::importance(),
+ * which favours close, bright lights that face the shading point. The probability
+ * of any light can be recomputed from the path to its leaf, which is needed for
+ * multiple importance sampling. Unbounded emitters (e.g. environment lights)
+ * are selected uniformly with the same probability as the whole tree.
+ */
+class LightBVH
+{
+public:
+    /**
+     * \brief Build the hierarchy
+     *
+     * \param emitters     All emitters of the scene
+     * \param sceneRadius  Radius of the bounding sphere of the scene, used as the
+     *                     distance of environment and directional emitters
+     */
+    LightBVH(const std::vector<Emitter *> & emitters, float sceneRadius);
+
+    /**
+     * \brief Select a light for the shading point \c record.ref and sample a position on it
+     *
+     * \param record      An emitter query record with \c ref set. On success, it
+     *                    describes the sample, and \c pdf includes the selection probability
+     * \param n           Normal at the shading point (or zero)
+     * \param sampleLight A uniformly distributed sample used to select the light
+     * \param sample2D    Passed to \ref Emitter::samplePrimitive()
+     * \param sample1D    Passed to \ref Emitter::samplePrimitive()
+     *
+     * \return The emitter value divided by the probability density of the sample,
+     *         a zero value means that sampling failed
+     */
+    Color3f sample(EmitterQueryRecord & record, const Normal3f & n, float sampleLight,
+                   const Point2f & sample2D, float sample1D) const;
+
+    /**
+     * \brief Compute the density of sampling \c record.p on \c record.pEmitter
+     * (primitive \c record.primitive) from \c record.ref with \ref sample()
+     */
+    float pdf(const EmitterQueryRecord & record, const Normal3f & n) const;
+
+    /// Return the probability of selecting the given light for a shading point
+    float pmf(const Point3f & p, const Normal3f & n, const Emitter * pEmitter, uint32_t primitive) const;
+
+    /// Return the number of bounded lights in the hierarchy
+    size_t getLightCount() const { return m_lights.size(); }
+
+    std::string toString() const;
+
+private:
+    struct LightRef
+    {
+        const Emitter * pEmitter;
+        uint32_t primitive;
+    };
+
+    struct Node
+    {
+        LightBounds bounds;
+        uint32_t childOrLightIndex; ///< Second child of an interior node, light of a leaf
+        bool bLeaf;
+    };
+
+    struct BuildLight
+    {
+        uint32_t lightIndex;
+        LightBounds bounds;
+    };
+
+    /// Build the subtree over the lights [begin, end) and return the index of its root
+    uint32_t buildRecursive(std::vector<BuildLight> & buildLights, size_t begin, size_t end,
+                            uint64_t bitTrail, int depth);
+
+    /// Cost of a group of lights for the surface area orientation heuristic
+    float evaluateCost(const LightBounds & bounds, const BoundingBox3f & centroidBounds, int dim) const;
+
+    /// Probability of selecting the hierarchy instead of an unbounded emitter
+    float getTreeProbability() const;
+
+    std::vector<const Emitter *> m_infiniteEmitters;
+    std::vector<LightRef> m_lights;
+    std::vector<Node> m_nodes;
+    std::unordered_map<const Emitter *, uint32_t> m_emitterOffsets; ///< First entry of an emitter in m_bitTrails
+    std::vector<uint64_t> m_bitTrails;                              ///< Path from the root to the leaf of every light
+    float m_sceneRadius;
+};
+
+NORI_NAMESPACE_END
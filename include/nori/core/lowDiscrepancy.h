@@ -0,0 +1,198 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#pragma once
+#include <nori/core/vector.h>
+
+NORI_NAMESPACE_BEGIN
+
+/**
+ * \brief Building blocks of the low-discrepancy samplers
+ *
+ * Contains the first two dimensions of the Sobol sequence, which form a
+ * (0,2)-sequence in base 2, the hash-based Owen scrambling of
+ * Burley ("Practical Hash-based Owen Scrambling", JCGT 2020) and the
+ * hashed permutations of Kensler ("Correlated Multi-Jittered Sampling", 2013).
+ */
+class LowDiscrepancy
+{
+public:
+    /// Largest float which is strictly smaller than one
+    static constexpr float OneMinusEpsilon = 0x1.fffffep-1f;
+
+    /// Reverse the order of the bits of a 32-bit integer
+    static inline uint32_t reverseBits(uint32_t x)
+    {
+        x = (x << 16) | (x >> 16);
+        x = ((x & 0x00ff00ffu) << 8) | ((x & 0xff00ff00u) >> 8);
+        x = ((x & 0x0f0f0f0fu) << 4) | ((x & 0xf0f0f0f0u) >> 4);
+        x = ((x & 0x33333333u) << 2) | ((x & 0xccccccccu) >> 2);
+        x = ((x & 0x55555555u) << 1) | ((x & 0xaaaaaaaau) >> 1);
+        return x;
+    }
+
+    /// Finalizer of MurmurHash3, used to derive decorrelated seeds
+    static inline uint64_t mixBits(uint64_t v)
+    {
+        v ^= v >> 33;
+        v *= 0xff51afd7ed558ccdull;
+        v ^= v >> 33;
+        v *= 0xc4ceb9fe1a85ec53ull;
+        v ^= v >> 33;
+        return v;
+    }
+
+    /// Hash a pixel, a dimension and a seed into 64 bits
+    static inline uint64_t hash(const Point2i & pixel, uint32_t dimension, uint64_t seed)
+    {
+        uint64_t h = mixBits(seed ^ 0x9e3779b97f4a7c15ull);
+        h = mixBits(h ^ uint32_t(pixel.x()));
+        h = mixBits(h ^ (uint64_t(uint32_t(pixel.y())) << 32));
+        return mixBits(h ^ dimension);
+    }
+
+    /// Hash a dimension and a seed into 64 bits (identical for all pixels)
+    static inline uint64_t hash(uint32_t dimension, uint64_t seed)
+    {
+        return mixBits(mixBits(seed ^ 0x9e3779b97f4a7c15ull) ^ dimension);
+    }
+
+    /// Interleave the bits of two 32-bit coordinates into a Morton code
+    static inline uint64_t encodeMorton2(uint32_t x, uint32_t y)
+    {
+        auto spread = [](uint64_t v) {
+            v = (v | (v << 16)) & 0x0000ffff0000ffffull;
+            v = (v | (v << 8)) & 0x00ff00ff00ff00ffull;
+            v = (v | (v << 4)) & 0x0f0f0f0f0f0f0f0full;
+            v = (v | (v << 2)) & 0x3333333333333333ull;
+            v = (v | (v << 1)) & 0x5555555555555555ull;
+            return v;
+        };
+        return (spread(y) << 1) | spread(x);
+    }
+
+    /**
+     * \brief Owen scramble the bits of \c x, starting from the least significant bit
+     *
+     * A bit is only flipped depending on the seed and the less significant bits,
+     * which is the property of the Laine-Karras permutation.
+     */
+    static inline uint32_t laineKarrasPermutation(uint32_t x, uint32_t seed)
+    {
+        x += seed;
+        x ^= x * 0x6c50b47cu;
+        x ^= x * 0xb82f1e52u;
+        x ^= x * 0xc7afe638u;
+        x ^= x * 0x8d22f6e6u;
+        return x;
+    }
+
+    /// Owen scramble the bits of \c x, starting from the most significant bit
+    static inline uint32_t nestedUniformScramble(uint32_t x, uint32_t seed)
+    {
+        return reverseBits(laineKarrasPermutation(reverseBits(x), seed));
+    }
+
+    /**
+     * \brief Return the given dimension (0 or 1) of the Sobol point with the given index
+     *
+     * The result is a 32-bit fixed-point number in [0, 1). The generator
+     * matrices are truncated to 32 rows but use all 64 columns: the first
+     * dimension only depends on the lower 32 bits of the index, the second
+     * one on all of them.
+     */
+    static inline uint32_t sobol(uint64_t index, int dimension)
+    {
+        if (dimension == 0)
+        {
+            return reverseBits(uint32_t(index));
+        }
+
+        /* The generator matrix of the second dimension is the Pascal matrix modulo 2 */
+        uint32_t result = 0;
+        for (uint32_t v = 1u << 31; index != 0; index >>= 1, v ^= v >> 1)
+        {
+            if (index & 1)
+            {
+                result ^= v;
+            }
+        }
+        return result;
+    }
+
+    /// Convert a 32-bit fixed-point number into a float in [0, 1)
+    static inline float toFloat(uint32_t x)
+    {
+        return std::min(float(x) * 0x1p-32f, OneMinusEpsilon);
+    }
+
+    /**
+     * \brief Return the element \c i of a random permutation of <tt>[0, l)</tt>
+     *
+     * The permutation is selected by the pattern \c p and evaluated without
+     * any storage by cycle-walking a hash over the next power of two.
+     */
+    static inline uint32_t permutationElement(uint32_t i, uint32_t l, uint32_t p)
+    {
+        uint32_t w = l - 1;
+        w |= w >> 1;
+        w |= w >> 2;
+        w |= w >> 4;
+        w |= w >> 8;
+        w |= w >> 16;
+        do
+        {
+            i ^= p;
+            i *= 0xe170893du;
+            i ^= p >> 16;
+            i ^= (i & w) >> 4;
+            i ^= p >> 8;
+            i *= 0x0929eb3fu;
+            i ^= p >> 23;
+            i ^= (i & w) >> 1;
+            i *= 1 | p >> 27;
+            i *= 0x6935fa69u;
+            i ^= (i & w) >> 11;
+            i *= 0x74dcb303u;
+            i ^= (i & w) >> 2;
+            i *= 0x9e501cc3u;
+            i ^= (i & w) >> 2;
+            i *= 0xc860a3dfu;
+            i &= w;
+            i ^= i >> 5;
+        } while (i >= l);
+        return (i + p) % l;
+    }
+
+    /// Return a hashed random float in [0, 1) for the index \c i and the pattern \c p
+    static inline float randomFloat(uint32_t i, uint32_t p)
+    {
+        i ^= p;
+        i ^= i >> 17;
+        i ^= i >> 10;
+        i *= 0xb36534e5u;
+        i ^= i >> 12;
+        i ^= i >> 21;
+        i *= 0x93fc4795u;
+        i ^= 0xdf6e307fu;
+        i ^= i >> 17;
+        i *= 1 | p >> 18;
+        return std::min(float(i) * (1.0f / 4294967808.0f), OneMinusEpsilon);
+    }
+
+    /**
+     * \brief Return a dimension of an Owen-scrambled Sobol point
+     *
+     * The index is shuffled with \c indexSeed, which decorrelates the
+     * dimensions that are padded together, and the value is scrambled
+     * with \c scrambleSeed
+     */
+    static inline float scrambledSobol(uint32_t index, int dimension, uint32_t indexSeed, uint32_t scrambleSeed)
+    {
+        uint32_t shuffledIndex = nestedUniformScramble(index, indexSeed);
+        return toFloat(nestedUniformScramble(sobol(shuffledIndex, dimension), scrambleSeed));
+    }
+};
+
+NORI_NAMESPACE_END
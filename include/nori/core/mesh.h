@@ -8,6 +8,8 @@
 
 #include <nori/core/object.h>
 #include <nori/core/bbox.h>
+#include <nori/core/numa.h>
+#include <atomic>
 
 NORI_NAMESPACE_BEGIN
 
@@ -73,16 +75,38 @@ public:
     bool rayIntersect(uint32_t index, const Ray3f &ray, float &u, float &v, float &t) const;
 
     /// Return a pointer to the vertex positions
-    const MatrixXf &getVertexPositions() const;
+    const MatrixXf &getVertexPositions() const {
+        const NodeBuffers *pNodeBuffers = getNodeBuffers();
+        return pNodeBuffers != nullptr ? pNodeBuffers->V : m_V;
+    }
 
     /// Return a pointer to the vertex normals (or \c nullptr if there are none)
-    const MatrixXf &getVertexNormals() const;
+    const MatrixXf &getVertexNormals() const {
+        const NodeBuffers *pNodeBuffers = getNodeBuffers();
+        return pNodeBuffers != nullptr ? pNodeBuffers->N : m_N;
+    }
 
     /// Return a pointer to the texture coordinates (or \c nullptr if there are none)
-    const MatrixXf &getVertexTexCoords() const;
+    const MatrixXf &getVertexTexCoords() const {
+        const NodeBuffers *pNodeBuffers = getNodeBuffers();
+        return pNodeBuffers != nullptr ? pNodeBuffers->UV : m_UV;
+    }
 
     /// Return a pointer to the triangle vertex index list
-    const MatrixXu &getIndices() const;
+    const MatrixXu &getIndices() const {
+        const NodeBuffers *pNodeBuffers = getNodeBuffers();
+        return pNodeBuffers != nullptr ? pNodeBuffers->F : m_F;
+    }
+
+    /**
+     * \brief Copy the vertex and index buffers into memory local to a NUMA node
+     *
+     * Must be called from a thread pinned to \c node (see \ref NumaTopology)
+     * before rendering starts, since the kernel places pages on the node of the
+     * thread which first writes them. Afterwards, the accessors above return the
+     * copy of the node that the calling thread is pinned to.
+     */
+    void replicateForNode(int node);
 
     /// Is this mesh an area emitter?
     bool isEmitter() const;
@@ -120,6 +144,28 @@ public:
 	*/
     void samplePosition(float sample1D, const Point2f & sample2D, Point3f & samplePoint, Normal3f & sampleNormal) const;
 
+    /**
+     * \brief Uniformly sample a position on the given triangle with
+     * respect to surface area. Returns both position and (unit) normal
+     */
+    void sampleTriangle(uint32_t index, const Point2f & sample2D, Point3f & samplePoint, Normal3f & sampleNormal) const;
+
+    /// Select a triangle with a probability proportional to its area, like \ref samplePosition()
+    uint32_t sampleTriangleIndex(float sample1D) const;
+
+    /**
+     * \brief Sample a position on the given triangle uniformly with respect to
+     * the solid angle it subtends at \c ref. Returns both position and (unit) normal
+     *
+     * \return The density of the sample with respect to solid angles, zero if
+     *         the triangle is degenerate as seen from \c ref
+     */
+    float sampleTriangleSolidAngle(uint32_t index, const Point3f & ref, const Point2f & sample2D,
+                                   Point3f & samplePoint, Normal3f & sampleNormal) const;
+
+    /// Density of \ref sampleTriangleSolidAngle(), the same for all the positions on the triangle
+    float pdfTriangleSolidAngle(uint32_t index, const Point3f & ref) const;
+
     ///  Compute the probability of sampling point on the mesh
     float pdf() const;
 
@@ -127,6 +173,9 @@ protected:
     /// Create an empty mesh
     Mesh();
 
+    /// Position and (unit) normal at the barycentric coordinates (1 - alpha - beta, alpha, beta) of a triangle
+    void interpolate(uint32_t index, float alpha, float beta, Point3f & point, Normal3f & normal) const;
+
 protected:
     std::string m_name;                  ///< Identifying name
     MatrixXf      m_V;                   ///< Vertex positions
@@ -139,6 +188,31 @@ protected:
     std::unique_ptr<DiscretePDF1D> m_pPDF; /// < Used for sampling triangle of the mesh weighted by its area
     float m_meshArea = 0.0f;               ///< Total surface area of the mesh
     float m_invMeshArea = 0.0f;            ///< Probability of a sampling point on the mesh
+    bool m_bAliasTable = false;            ///< Select the triangles in constant time with an alias table
+
+private:
+    /// Geometry buffers replicated on a NUMA node
+    struct NodeBuffers
+    {
+        MatrixXf V, N, UV;
+        MatrixXu F;
+    };
+
+    /**
+     * \brief Return the replica of the calling thread's NUMA node (or \c nullptr)
+     *
+     * Without replicas, this is a single flag test and the thread's node is
+     * never looked up, which keeps the accessors cheap on the traversal path.
+     */
+    const NodeBuffers * getNodeBuffers() const {
+        if (!m_bReplicated.load(std::memory_order_relaxed))
+            return nullptr;
+        int node = NumaTopology::getCurrentNode();
+        return node >= 0 && node < NORI_MAX_NUMA_NODES ? m_pNodeBuffers[node].get() : nullptr;
+    }
+
+    std::unique_ptr<NodeBuffers> m_pNodeBuffers[NORI_MAX_NUMA_NODES];
+    std::atomic<bool> m_bReplicated{false}; ///< Whether any node holds a replica
 };
 
 NORI_NAMESPACE_END
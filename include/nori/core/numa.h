@@ -0,0 +1,58 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#pragma once
+#include <nori/core/common.h>
+
+/// Maximum number of NUMA nodes which can hold a replica of the scene data
+#define NORI_MAX_NUMA_NODES 8
+
+NORI_NAMESPACE_BEGIN
+
+/**
+ * \brief NUMA layout of the machine
+ *
+ * On Linux, the nodes and their CPUs are read from
+ * /sys/devices/system/node. On other platforms (or if the information
+ * is unavailable) the machine is treated as a single node containing
+ * all hardware threads.
+ */
+class NumaTopology
+{
+public:
+    /// Detect the topology of the current machine
+    NumaTopology();
+
+    /// Return the number of NUMA nodes
+    int getNodeCount() const { return int(m_nodeCpus.size()); }
+
+    /// Return the logical CPUs belonging to a node
+    const std::vector<int> & getCpus(int node) const { return m_nodeCpus[node]; }
+
+    /**
+     * \brief Restrict the calling thread to the CPUs of a node
+     *
+     * Also records \c node as the node of the calling thread, see
+     * \ref getCurrentNode(). Memory which is first touched by the thread
+     * afterwards is allocated on that node by the kernel.
+     *
+     * \return \c false if the affinity could not be changed
+     */
+    bool pinCurrentThread(int node) const;
+
+    /**
+     * \brief Return the NUMA node of the calling thread
+     *
+     * This is the node passed to the last call of \ref pinCurrentThread()
+     * on this thread, or -1 if the thread has never been pinned.
+     */
+    static int getCurrentNode();
+
+    std::string toString() const;
+
+private:
+    std::vector<std::vector<int>> m_nodeCpus;
+};
+
+NORI_NAMESPACE_END
@@ -0,0 +1,155 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#pragma once
+#include <nori/core/common.h>
+#include <pcg32.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+NORI_NAMESPACE_BEGIN
+
+/**
+ * \brief Eight interleaved lanes of a single PCG32 stream
+ *
+ * Lane \c k starts at the \c k-th next state of a scalar \ref pcg32 and every
+ * lane jumps ahead by eight steps at a time. The outputs of one call are thus
+ * exactly the next eight outputs of the scalar generator, so batched and
+ * per-sample generation produce the same numbers. The state update and the
+ * output permutation are evaluated with AVX2 when the compiler targets it
+ * (NORI_ENABLE_AVX2, 64-bit multiplications are emulated with 32-bit ones),
+ * otherwise with a plain loop.
+ */
+class PCG32x8
+{
+public:
+    /// Continue the stream of \c rng
+    explicit PCG32x8(const pcg32 & rng)
+    {
+        /* Compute the multiplier and increment of an eight step jump */
+        uint64_t mult = 1u, plus = 0u;
+        for (int i = 0; i < 8; i++)
+        {
+            plus = plus * PCG32_MULT + rng.inc;
+            mult *= PCG32_MULT;
+        }
+        m_jumpMult = mult;
+        m_jumpPlus = plus;
+
+        uint64_t state = rng.state;
+        for (int i = 0; i < 8; i++)
+        {
+            m_state[i] = state;
+            state = state * PCG32_MULT + rng.inc;
+        }
+    }
+
+    /// Generate the next eight uniformly distributed 32-bit integers
+    void nextUInt(uint32_t * pResult)
+    {
+#if defined(__AVX2__)
+        nextUIntAVX2(pResult);
+#else
+        nextUIntScalar(pResult);
+#endif
+    }
+
+    /**
+     * \brief Portable version of \ref nextUInt()
+     *
+     * Always compiled, so that the vectorized version can be validated against it
+     */
+    void nextUIntScalar(uint32_t * pResult)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            uint64_t oldState = m_state[i];
+            m_state[i] = oldState * m_jumpMult + m_jumpPlus;
+            uint32_t xorShifted = uint32_t(((oldState >> 18u) ^ oldState) >> 27u);
+            uint32_t rot = uint32_t(oldState >> 59u);
+            pResult[i] = (xorShifted >> rot) | (xorShifted << ((~rot + 1u) & 31));
+        }
+    }
+
+#if defined(__AVX2__)
+    /// AVX2 version of \ref nextUInt()
+    void nextUIntAVX2(uint32_t * pResult)
+    {
+        const __m256i mult = _mm256_set1_epi64x(int64_t(m_jumpMult));
+        const __m256i plus = _mm256_set1_epi64x(int64_t(m_jumpPlus));
+        __m256i state0 = _mm256_load_si256(reinterpret_cast<const __m256i *>(m_state));
+        __m256i state1 = _mm256_load_si256(reinterpret_cast<const __m256i *>(m_state + 4));
+
+        __m256i result0 = output(state0), result1 = output(state1);
+
+        _mm256_store_si256(reinterpret_cast<__m256i *>(m_state), _mm256_add_epi64(mul64(state0, mult), plus));
+        _mm256_store_si256(reinterpret_cast<__m256i *>(m_state + 4), _mm256_add_epi64(mul64(state1, mult), plus));
+
+        /* Gather the low 32 bits of the 64-bit lanes */
+        const __m256i even = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+        __m256i packed = _mm256_permute2x128_si256(
+                _mm256_permutevar8x32_epi32(result0, even),
+                _mm256_permutevar8x32_epi32(result1, even), 0x20);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(pResult), packed);
+    }
+#endif
+
+    /// Return whether \ref nextUInt() was compiled with AVX2 (see the CMake option NORI_ENABLE_AVX2)
+    static constexpr bool isVectorized()
+    {
+#if defined(__AVX2__)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /// Generate the next eight uniformly distributed floats in <tt>[0, 1)</tt>
+    void nextFloat(float * pResult)
+    {
+        alignas(32) uint32_t values[8];
+        nextUInt(values);
+        for (int i = 0; i < 8; i++)
+        {
+            union { uint32_t u; float f; } x;
+            x.u = (values[i] >> 9) | 0x3f800000u;
+            pResult[i] = x.f - 1.0f;
+        }
+    }
+
+    /// Return the state of the scalar generator that has produced all outputs so far
+    uint64_t getScalarState() const { return m_state[0]; }
+
+private:
+#if defined(__AVX2__)
+    /// Low 64 bits of the product of two vectors of 64-bit integers
+    static inline __m256i mul64(__m256i a, __m256i b)
+    {
+        __m256i low = _mm256_mul_epu32(a, b);
+        __m256i cross = _mm256_add_epi64(
+                _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+                _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+        return _mm256_add_epi64(low, _mm256_slli_epi64(cross, 32));
+    }
+
+    /// PCG XSH-RR output permutation, the result is in the low 32 bits of every 64-bit lane
+    static inline __m256i output(__m256i state)
+    {
+        const __m256i low32 = _mm256_set1_epi64x(0xffffffffll);
+        __m256i xorShifted = _mm256_and_si256(
+                _mm256_srli_epi64(_mm256_xor_si256(_mm256_srli_epi64(state, 18), state), 27), low32);
+        __m256i rot = _mm256_srli_epi64(state, 59);
+        __m256i negRot = _mm256_and_si256(_mm256_sub_epi32(_mm256_setzero_si256(), rot), _mm256_set1_epi64x(31));
+        return _mm256_or_si256(_mm256_srlv_epi32(xorShifted, rot), _mm256_sllv_epi32(xorShifted, negRot));
+    }
+#endif
+
+    alignas(32) uint64_t m_state[8];
+    uint64_t m_jumpMult;
+    uint64_t m_jumpPlus;
+};
+
+NORI_NAMESPACE_END
@@ -0,0 +1,37 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#pragma once
+#include <nori/core/common.h>
+#include <nori/core/object.h>
+
+NORI_NAMESPACE_BEGIN
+
+/**
+ * \brief Validation of the batched sample generation against scalar \c pcg32
+ *
+ * Every stream is generated three times: with \ref PCG32x8::nextUInt() (the
+ * AVX2 version when compiled with NORI_ENABLE_AVX2), with the portable
+ * \ref PCG32x8::nextUIntScalar() and with a scalar \c pcg32. All outputs and
+ * the final states must agree bit for bit. The batched array requests of the
+ * independent sampler are also compared against repeated \c next1D() calls.
+ */
+class PCG32x8Test : public NoriObject
+{
+public:
+    PCG32x8Test(const PropertyList & propList);
+
+    /// Execute the tests
+    virtual void activate() override;
+
+    virtual std::string toString() const override;
+
+    virtual EClassType getClassType() const override;
+
+private:
+    int m_streamCount;
+    int m_sampleCount;
+};
+
+NORI_NAMESPACE_END
@@ -49,9 +49,23 @@ public:
     */
     virtual bool rayIntersect(const Ray3f & Ray, float & U, float & V, float & T) const = 0;
 
-    /// After intersection test passed, compute the detail information of the intersection point.
+    /**
+    * \brief After intersection test passed, compute the detail information of the intersection point.
+    *
+    * Fills in the position, the texture coordinates and both frames, which
+    * every shaded hit needs. The partials are left to \ref computePartials().
+    */
     virtual void postIntersect(Intersection & Isect) const = 0;
 
+    /**
+    * \brief Compute the partial derivatives of the position and the normal wrt.
+    * the texture coordinates at an intersection filled in by \ref postIntersect()
+    *
+    * Called on demand by \ref Intersection::computePartials(). By default, the
+    * shape provides no partials.
+    */
+    virtual void computePartials(const Intersection & Isect) const;
+
     /**
     * \brief Return the pointer of the mesh that this shape attach
     * \return
@@ -0,0 +1,73 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#pragma once
+#include <nori/core/common.h>
+#include <nori/core/bbox.h>
+#include <atomic>
+
+NORI_NAMESPACE_BEGIN
+
+/// Lengths and splits of the rendered paths with ADRRS, accumulated by every thread on its own
+struct AdrrsStatistics
+{
+    uint64_t pathCount = 0;
+    uint64_t vertexCount = 0;
+    uint64_t splitCount = 0;
+};
+
+/**
+ * \brief Coarse estimate of the radiance reflected by the surfaces of a scene
+ *
+ * The bounds of the scene are divided into a uniform grid of cubic cells, and
+ * every cell averages the luminance of the radiance reflected at the path
+ * vertices falling into it. Records are accumulated atomically and can be
+ * issued concurrently by all render threads.
+ *
+ * The cache drives adjoint-driven Russian roulette and splitting (Vorba and
+ * Krivanek, "Adjoint-Driven Russian Roulette and Splitting in Light Transport
+ * Simulation", 2016): a path is continued proportionally to its expected
+ * contribution relative to the value of its pixel.
+ */
+class RadianceCache
+{
+public:
+    /// Create an empty cache whose longest axis is divided into \c resolution cells
+    RadianceCache(const BoundingBox3f & bounds, int resolution);
+
+    /// Add the luminance \c value of the radiance reflected at \c p
+    void record(const Point3f & p, float value);
+
+    /// Return the average luminance reflected around \c p, or a negative value if nothing was recorded there
+    float lookup(const Point3f & p) const;
+
+    /**
+     * \brief Return the expected number of continuations of a path with throughput
+     * \c beta which reached a surface at \c p
+     *
+     * The expected contribution of the path is compared to a window centered
+     * on \c pixelEstimate: dim paths are terminated with Russian roulette and
+     * bright ones are split into at most \c maxSplit paths. The fixed survival
+     * probability \c fallback is returned where no estimate is available.
+     */
+    float getSplittingFactor(const Point3f & p, const Color3f & beta, float pixelEstimate,
+                             float maxSplit, float fallback) const;
+
+    std::string toString() const;
+
+private:
+    struct Cell
+    {
+        std::atomic<float> sum;
+        std::atomic<uint32_t> count;
+    };
+
+    size_t getCellIndex(const Point3f & p) const;
+
+    BoundingBox3f m_bounds;
+    Vector3i m_resolution;
+    std::unique_ptr<Cell[]> m_pCells;
+};
+
+NORI_NAMESPACE_END
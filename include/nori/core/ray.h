@@ -75,6 +75,33 @@ template <typename PointType, typename _VectorType> struct TRay {
         dRcp = d.cwiseInverse();
     }
 
+    /**
+     * \brief Scale the offset of the differential rays from the main ray
+     *
+     * The camera generates differentials for a shift of one pixel, with
+     * n samples per pixel they are scaled by \ref differentialScale() to
+     * match the spacing of the samples.
+     */
+    void scaleDifferentials(Scalar scale) {
+        if (!bHasDifferentials)
+            return;
+        rxOrigin = o + (rxOrigin - o) * scale;
+        ryOrigin = o + (ryOrigin - o) * scale;
+        rxDirection = d + (rxDirection - d) * scale;
+        ryDirection = d + (ryDirection - d) * scale;
+    }
+
+    /**
+     * \brief Scale of the differentials for \c sampleCount samples per pixel
+     *
+     * This is 1 / sqrt(n), clamped to 1/8 like pbrt-v4: with more samples the
+     * footprints would only select finer texture levels that the pixel filter
+     * averages away again.
+     */
+    static Scalar differentialScale(size_t sampleCount) {
+        return std::max(Scalar(0.125f), Scalar(1) / std::sqrt(Scalar(sampleCount)));
+    }
+
     /// Return the position of a point along the ray
     PointType operator() (Scalar t) const { return o + t * d; }
 
@@ -36,7 +36,9 @@ class ImageBlock;
  * \ref advance() needs to be invoked. This repeats until all pixel samples have
  * been exhausted.  While computing a pixel sample, the rendering 
  * algorithm requests (pseudo-) random numbers using the \ref next1D() and
- * \ref next2D() functions.
+ * \ref next2D() functions. The sampler keeps track of the current pixel, the
+ * index of the sample within the pixel and the number of dimensions which
+ * have been consumed by the current sample.
  *
  * Conceptually, the right way of thinking of this goes as follows:
  * For each sample in a pixel, a sample generator produces a (hypothetical)
@@ -55,6 +57,15 @@ public:
     /// Create an exact clone of the current instance
     virtual std::unique_ptr<Sampler> clone() const = 0;
 
+    /**
+     * \brief Perform an (optional) preprocess step
+     *
+     * This function is called before rendering starts and after the
+     * sample count has been configured, e.g. to adapt the sampler
+     * to the resolution of the camera.
+     */
+    virtual void preprocess(const Scene *scene) { }
+
     /**
      * \brief Prepare to render a new image block
      * 
@@ -69,12 +80,20 @@ public:
      * \brief Prepare to generate new samples
      * 
      * This function is called initially and every time the 
-     * integrator starts rendering a new pixel.
+     * integrator starts rendering a new pixel. It resets the
+     * sample index and the dimension.
      */
-    virtual void generate() = 0;
+    virtual void generate(const Point2i &pixel) {
+        m_pixel = pixel;
+        m_sampleIndex = m_firstSample;
+        m_dimension = 0;
+    }
 
     /// Advance to the next sample
-    virtual void advance() = 0;
+    virtual void advance() {
+        m_sampleIndex++;
+        m_dimension = 0;
+    }
 
     /// Retrieve the next component value from the current sample
     virtual float next1D() = 0;
@@ -82,8 +101,74 @@ public:
     /// Retrieve the next two component values from the current sample
     virtual Point2f next2D() = 0;
 
-    /// Return the number of configured pixel samples
-    virtual size_t getSampleCount() const { return m_sampleCount; }
+    /**
+     * \brief Retrieve the next \c count component values at once
+     *
+     * Equivalent to \c count calls of \ref next1D(), but lets samplers
+     * generate the values in bulk, e.g. for packets of rays
+     */
+    virtual void next1DArray(float *values, size_t count) {
+        for (size_t i = 0; i < count; ++i)
+            values[i] = next1D();
+    }
+
+    /// Retrieve the next \c count pairs of component values at once (see \ref next1DArray())
+    virtual void next2DArray(Point2f *values, size_t count) {
+        for (size_t i = 0; i < count; ++i)
+            values[i] = next2D();
+    }
+
+    /// Return the number of pixel samples to be rendered (see \ref setSampleRange())
+    virtual size_t getSampleCount() const { return m_bSampleRange ? m_rangeSampleCount : m_sampleCount; }
+
+    /// Return the number of pixel samples of the complete render, including those outside of the sample range
+    size_t getTotalSampleCount() const { return m_sampleCount; }
+
+    /// Change the number of pixel samples, this also resets the sample range
+    virtual void setSampleCount(size_t sampleCount) {
+        m_sampleCount = sampleCount;
+        m_firstSample = 0;
+        m_bSampleRange = false;
+    }
+
+    /**
+     * \brief Only render the pixel samples <tt>[first, first + count)</tt>
+     *
+     * The samples keep their index within the full sequence of the configured
+     * sample count, so that disjoint ranges rendered separately (e.g. by
+     * distributed workers) add up to the samples of a complete render.
+     * Samplers whose values do not depend on the sample index have to
+     * decorrelate the ranges themselves.
+     */
+    virtual void setSampleRange(size_t first, size_t count) {
+        m_firstSample = (uint32_t) first;
+        m_rangeSampleCount = count;
+        m_bSampleRange = true;
+    }
+
+    /// Return the index of the first rendered pixel sample (see \ref setSampleRange())
+    uint32_t getFirstSample() const { return m_firstSample; }
+
+    /**
+     * \brief Return the seed of the sampler
+     *
+     * Together with the block passed to \ref prepare(), the seed determines
+     * the generated samples. Samplers with different seeds produce
+     * decorrelated sample streams.
+     */
+    virtual uint64_t getSeed() const { return m_seed; }
+
+    /// Set the seed of the sampler (see \ref getSeed())
+    virtual void setSeed(uint64_t seed) { m_seed = seed; }
+
+    /// Return the pixel passed to the last call of \ref generate()
+    const Point2i &getPixel() const { return m_pixel; }
+
+    /// Return the index of the current sample within the pixel
+    uint32_t getSampleIndex() const { return m_sampleIndex; }
+
+    /// Return the number of dimensions consumed by the current sample
+    uint32_t getDimension() const { return m_dimension; }
 
     /**
      * \brief Return the type of object (i.e. Mesh/Sampler/etc.) 
@@ -92,6 +177,13 @@ public:
     EClassType getClassType() const { return ESampler; }
 protected:
     size_t m_sampleCount;
+    uint64_t m_seed = 0;
+    Point2i m_pixel = Point2i(0, 0);
+    uint32_t m_sampleIndex = 0;
+    uint32_t m_dimension = 0;
+    uint32_t m_firstSample = 0;
+    size_t m_rangeSampleCount = 0;
+    bool m_bSampleRange = false;
 };
 
 NORI_NAMESPACE_END
@@ -0,0 +1,40 @@
+//
+// Created by superqqli on 2026/10/19.
+//
+
+#pragma once
+#include <nori/core/common.h>
+#include <nori/core/object.h>
+
+NORI_NAMESPACE_BEGIN
+
+/**
+ * \brief Chi^2 test of the uniformity of the stratified samplers
+ *
+ * Every sampler type is instantiated with every sample count of the list,
+ * including ones that are not a product of the stratification grid (e.g. 32
+ * samples on a 5 x 7 grid). The 1D and 2D samples of all pixels are binned
+ * and compared with the uniform distribution, which catches strata that are
+ * never visited.
+ */
+class SamplerTest : public NoriObject
+{
+public:
+    SamplerTest(const PropertyList & propList);
+
+    /// Execute the tests
+    virtual void activate() override;
+
+    virtual std::string toString() const override;
+
+    virtual EClassType getClassType() const override;
+
+private:
+    std::vector<std::string> m_samplers;
+    std::vector<int> m_sampleCounts;
+    int m_resolution;
+    int m_sampleCount;
+    float m_significanceLevel;
+};
+
+NORI_NAMESPACE_END
@@ -9,6 +9,7 @@
 #include <nori/core/object.h>
 #include <nori/core/common.h>
 #include <nori/core/bbox.h>
+#include <mutex>
 
 NORI_NAMESPACE_BEGIN
 
@@ -39,6 +40,9 @@ public:
     /// Return a pointer to the scene's camera
     const Camera *getCamera() const;
 
+    /// Return a pointer to the scene's camera
+    Camera *getCamera();
+
     /// Return a pointer to the scene's sample generator (const version)
     const Sampler *getSampler() const;
 
@@ -51,6 +55,15 @@ public:
     /// Return a reference to an array containing all emitters  (const version)
     const std::vector<Emitter*> & getEmitters() const;
 
+    /**
+     * \brief Return a pointer to the light hierarchy over all emitters of the scene
+     *
+     * The hierarchy is built by the first call, so scenes rendered by
+     * integrators which do not sample it never pay for it. This function is
+     * thread-safe.
+     */
+    const LightBVH * getLightBVH() const;
+
     /// Return a pointer to the scene's environment emitter  (const version)
     const Emitter * getEnvironmentEmitter() const;
 
@@ -99,6 +112,21 @@ public:
      */
     bool rayIntersect(const Ray3f &ray) const;
 
+    /**
+     * \brief Determine for a batch of shadow rays whether each one is blocked
+     *
+     * Equivalent to calling the occlusion-only \ref rayIntersect() for every
+     * ray, but lets the acceleration structure traverse the whole batch at once.
+     */
+    void rayOccluded(const Ray3f *pRays, size_t count, bool *pOccluded) const;
+
+    /**
+     * \brief Replicate the acceleration structure and the mesh buffers on a NUMA node
+     *
+     * Must be called from a thread pinned to \c node, see \ref Accel::replicateForNode()
+     */
+    void replicateForNode(int node);
+
     /**
      * \brief Inherited from \ref NoriObject::activate()
      *
@@ -126,6 +154,8 @@ private:
     Accel *m_pAccel = nullptr;
     std::vector<Emitter*> m_pEmitters;
     Emitter * m_pEnvironmentEmitter = nullptr;
+    mutable std::unique_ptr<LightBVH> m_pLightBVH;
+    mutable std::once_flag m_lightBVHFlag;
     BoundingBox3f m_bBox;
 };
 
@@ -0,0 +1,141 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#pragma once
+#include <nori/core/common.h>
+#include <nori/core/bbox.h>
+#include <atomic>
+
+NORI_NAMESPACE_BEGIN
+
+/**
+ * \brief Directional quadtree approximating the incident radiance at a region of space
+ *
+ * Directions are mapped to the unit square with the area-preserving cylindrical
+ * mapping <tt>((cos(theta) + 1) / 2, phi / (2 pi))</tt>, which is subdivided by a
+ * quadtree. Every node stores the energy recorded in its four quadrants, so the
+ * tree can be sampled by descending proportionally to the energy. Records are
+ * accumulated atomically and can be issued concurrently by all render threads.
+ */
+class DTree
+{
+public:
+    /// Create a tree with a single level (uniform distribution)
+    DTree();
+
+    DTree(const DTree & other);
+
+    DTree & operator=(const DTree & other);
+
+    /// Add the incident radiance \c value (divided by its sampling density) arriving from \c d
+    void record(const Vector3f & d, float value);
+
+    /// Sample a direction proportionally to the recorded energy
+    Vector3f sample(const Point2f & sample2D) const;
+
+    /// Compute the density of \ref sample() with respect to solid angles
+    float pdf(const Vector3f & d) const;
+
+    /**
+     * \brief Rebuild the topology from the energy of \c previous and reset the energy
+     *
+     * Quadrants holding more than a fraction \c threshold of the total energy are
+     * subdivided (up to \c maxDepth levels), others are collapsed.
+     */
+    void build(const DTree & previous, float threshold, int maxDepth);
+
+    /// Return the total recorded energy
+    float getEnergy() const;
+
+    /// Return the number of nodes
+    size_t getNodeCount() const { return m_nodes.size(); }
+
+private:
+    struct Node
+    {
+        Node();
+        Node(const Node & other);
+        Node & operator=(const Node & other);
+
+        float getSum() const;
+
+        std::atomic<float> sum[4];
+        uint32_t child[4]; ///< Zero for leaf quadrants
+    };
+
+    void buildRecursive(const DTree & previous, int previousIndex, const float * previousSums,
+                        uint32_t index, float total, float threshold, int depth, int maxDepth);
+
+    std::vector<Node> m_nodes;
+};
+
+/// Pair of directional trees of a spatial leaf: one is sampled while the other is being learned
+struct DTreeWrapper
+{
+    DTreeWrapper() : count(0) { }
+    DTreeWrapper(const DTreeWrapper & other) :
+            building(other.building), sampling(other.sampling), count(other.count.load()) { }
+
+    DTreeWrapper & operator=(const DTreeWrapper & other)
+    {
+        building = other.building;
+        sampling = other.sampling;
+        count = other.count.load();
+        return *this;
+    }
+
+    DTree building;
+    DTree sampling;
+    std::atomic<uint64_t> count; ///< Number of records of the current iteration
+};
+
+/**
+ * \brief Spatio-directional tree for path guiding (Mueller et al., "Practical Path
+ * Guiding for Efficient Light-Transport Simulation", 2017)
+ *
+ * A binary tree subdivides the (cubified) bounds of the scene by alternating the
+ * split axis, and every leaf owns a \ref DTreeWrapper. Rendering proceeds in
+ * training iterations: paths record into the \c building trees, and afterwards
+ * \ref refine() splits the spatial leaves that received many records and turns
+ * the learned distributions into the \c sampling trees.
+ */
+class SDTree
+{
+public:
+    explicit SDTree(const BoundingBox3f & bounds);
+
+    /// Return the directional trees of the leaf containing \c p
+    DTreeWrapper * lookup(const Point3f & p);
+
+    /// Return the directional trees of the leaf containing \c p
+    const DTreeWrapper * lookup(const Point3f & p) const;
+
+    /**
+     * \brief Finish a training iteration
+     *
+     * Leaves with more than \c spatialThreshold records are split, then all
+     * directional trees are rebuilt in parallel from the recorded energy.
+     */
+    void refine(uint64_t spatialThreshold, float directionalThreshold, int maxDirectionalDepth);
+
+    /// Return the number of spatial leaves
+    size_t getLeafCount() const;
+
+    std::string toString() const;
+
+private:
+    struct Node
+    {
+        uint32_t child[2] = { 0, 0 }; ///< Zero for leaves
+        int axis = 0;
+        DTreeWrapper dTree;
+    };
+
+    void subdivide(uint32_t index, uint64_t threshold);
+
+    BoundingBox3f m_bounds;
+    std::vector<Node> m_nodes;
+};
+
+NORI_NAMESPACE_END
@@ -0,0 +1,72 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#pragma once
+#include <nori/core/common.h>
+#include <nori/core/ray.h>
+#include <nori/core/color.h>
+#include <vector>
+
+NORI_NAMESPACE_BEGIN
+
+/**
+ * \brief Per-thread queue of the shadow rays of next-event estimation
+ *
+ * Instead of tracing a shadow ray right after sampling an emitter, integrators
+ * push the ray together with the radiance it carries if it is unoccluded. The
+ * renderer flushes the queue in batches through the occlusion-only traversal
+ * (\ref Scene::rayOccluded()) and splats the radiance of the unoccluded rays
+ * onto the pixel samples which generated them, so that the traversal runs
+ * over many similar rays in a row instead of being interleaved with shading.
+ *
+ * A queue only collects rays while it is the active queue of its thread (see
+ * \ref setActive()). Elsewhere (e.g. in training passes or statistical tests)
+ * \ref getActive() returns \c nullptr and shadow rays are traced immediately.
+ */
+class ShadowRayQueue
+{
+public:
+    /// Create a queue which asks to be flushed once \c batchSize rays are queued
+    ShadowRayQueue(size_t batchSize = 256);
+
+    /**
+     * \brief Start a new pixel sample
+     *
+     * The radiance of the rays pushed afterwards is scaled by \c weight (the
+     * importance of the camera ray) and splatted at \c pixelSample.
+     */
+    void beginSample(const Point2f & pixelSample, const Color3f & weight);
+
+    /// Queue a shadow ray, \c value is added to the current pixel sample if the ray is unoccluded
+    void push(const Ray3f & shadowRay, const Color3f & value);
+
+    /// Return whether the queue reached its batch size
+    bool isFull() const { return m_rays.size() >= m_batchSize; }
+
+    /// Trace all queued shadow rays and splat the radiance of the unoccluded ones into \c block
+    void flush(const Scene * pScene, ImageBlock & block);
+
+    /// Return the active queue of the calling thread, or \c nullptr
+    static ShadowRayQueue * getActive();
+
+    /// Make \c pQueue the active queue of the calling thread (\c nullptr deactivates it)
+    static void setActive(ShadowRayQueue * pQueue);
+
+private:
+    struct Contribution
+    {
+        Point2f pixelSample;
+        Color3f value;
+    };
+
+    size_t m_batchSize;
+    Point2f m_pixelSample;
+    Color3f m_weight;
+    std::vector<Ray3f> m_rays;
+    std::vector<Contribution> m_contributions;
+    std::unique_ptr<bool[]> m_pOccluded;
+    size_t m_occludedCapacity;
+};
+
+NORI_NAMESPACE_END
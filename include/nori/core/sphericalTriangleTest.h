@@ -0,0 +1,41 @@
+//
+// Created by superqqli on 2026/10/19.
+//
+
+#pragma once
+#include <nori/core/common.h>
+#include <nori/core/object.h>
+
+NORI_NAMESPACE_BEGIN
+
+/**
+ * \brief Chi^2 test of \ref Warp::squareToSphericalTriangle(), the solid angle
+ * sampling of the triangle area lights
+ *
+ * A set of triangles (regular, thin and ones that cover most of the
+ * hemisphere of the reference point) is sampled, and the points where the
+ * sampled directions meet the triangle are binned in the parameterization of
+ * uniform area sampling. The expected frequencies follow from a density of
+ * one over the solid angle, which is computed independently in double
+ * precision and also compared with \ref Warp::squareToSphericalTrianglePdf().
+ * Directions that miss the triangle fail the test.
+ */
+class SphericalTriangleTest : public NoriObject
+{
+public:
+    SphericalTriangleTest(const PropertyList & propList);
+
+    /// Execute the tests
+    virtual void activate() override;
+
+    virtual std::string toString() const override;
+
+    virtual EClassType getClassType() const override;
+
+private:
+    int m_resolution;
+    int m_sampleCount;
+    float m_significanceLevel;
+};
+
+NORI_NAMESPACE_END
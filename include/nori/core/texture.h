@@ -65,6 +65,9 @@ public:
     /// Return whether the texture is monochromatic / spectrally uniform
     virtual bool isMonochromatic() const;
 
+    /// Return whether a filtered \ref eval() uses the ray differentials of the intersection
+    virtual bool usesRayDifferentials() const;
+
     /// Some textures are only proxies for an actual implementation.This function returns the actual texture implementation to be used.
     virtual Texture * actualTexture();
 
@@ -109,6 +112,9 @@ public:
     /// Unfiltered texture lookup
     virtual void evalGradient(const Point2f & uv, Color3f * pGradients) const;
 
+    /// The filter footprint is derived from the ray differentials
+    virtual bool usesRayDifferentials() const override;
+
 };
 
 /* ============================================================ */
@@ -184,6 +190,8 @@ public:
 
     virtual bool isMonochromatic() const override;
 
+    virtual bool usesRayDifferentials() const override;
+
     virtual std::string toString() const override;
 
 protected:
@@ -210,6 +218,8 @@ public:
 
     virtual bool isMonochromatic() const override;
 
+    virtual bool usesRayDifferentials() const override;
+
     virtual std::string toString() const override;
 
 protected:
@@ -236,6 +246,8 @@ public:
 
     virtual bool isMonochromatic() const override;
 
+    virtual bool usesRayDifferentials() const override;
+
     virtual std::string toString() const override;
 
 protected:
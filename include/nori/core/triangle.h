@@ -54,6 +54,9 @@ public:
     /// After intersection test passed, compute the detail information of the intersection point.
     virtual void postIntersect(Intersection & Isect) const override;
 
+    /// Compute the partials at the intersection from the vertex normals and texture coordinates
+    virtual void computePartials(const Intersection & Isect) const override;
+
     /**
     * \brief Return the pointer of the mesh that this shape attach
     * \return
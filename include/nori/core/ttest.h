@@ -62,6 +62,7 @@ private:
     std::vector<float> m_references;
     float m_significanceLevel;
     int m_sampleCount;
+    int m_batchSize;
 };
 
 NORI_NAMESPACE_END
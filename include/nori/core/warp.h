@@ -54,6 +54,78 @@ public:
 
     /// Probability density of \ref squareToBeckmann()
     static float squareToBeckmannPdf(const Vector3f &m, float alpha);
+
+    /**
+     * \brief Warp a uniformly distributed square sample to the Beckmann normals visible from \c wi
+     *
+     * The density is G1(wi, m) max(0, wi . m) D(m) / cos(theta_i), normals facing away from \c wi
+     * are never produced. See Jakob, "An Improved Visible Normal Sampling Routine for the Beckmann
+     * Distribution", 2014
+     */
+    static Vector3f squareToBeckmannVisible(const Point2f &sample, const Vector3f &wi, float alpha);
+
+    /// Probability density of \ref squareToBeckmannVisible()
+    static float squareToBeckmannVisiblePdf(const Vector3f &m, const Vector3f &wi, float alpha);
+
+    /// Warp a uniformly distributed square sample to a GGX distribution * cosine for the given 'alpha' parameter
+    static Vector3f squareToGGX(const Point2f &sample, float alpha);
+
+    /// Probability density of \ref squareToGGX()
+    static float squareToGGXPdf(const Vector3f &m, float alpha);
+
+    /**
+     * \brief Warp a uniformly distributed square sample to the GGX normals visible from \c wi
+     *
+     * Same density as \ref squareToBeckmannVisible() for the GGX distribution. See Heitz,
+     * "Sampling the GGX Distribution of Visible Normals", JCGT 2018
+     */
+    static Vector3f squareToGGXVisible(const Point2f &sample, const Vector3f &wi, float alpha);
+
+    /// Probability density of \ref squareToGGXVisible()
+    static float squareToGGXVisiblePdf(const Vector3f &m, const Vector3f &wi, float alpha);
+
+    /**
+     * \brief Uniformly sample a direction within the spherical triangle with the (unit)
+     * vertices \c a, \c b and \c c with respect to solid angles
+     *
+     * See Arvo, "Stratified Sampling of Spherical Triangles", SIGGRAPH 1995
+     */
+    static Vector3f squareToSphericalTriangle(const Point2f &sample, const Vector3f &a, const Vector3f &b, const Vector3f &c);
+
+    /// Probability density of \ref squareToSphericalTriangle(), i.e. one over the solid angle of the triangle
+    static float squareToSphericalTrianglePdf(const Vector3f &a, const Vector3f &b, const Vector3f &c);
+
+    /* Batch versions of the warps above for the SIMD BSDF kernels, one sample per row */
+
+    /// Batch version of \ref squareToCosineHemisphere()
+    static Vector3fBatch squareToCosineHemisphereBatch(const Point2fBatch &sample);
+
+    /// Batch version of \ref squareToCosineHemispherePdf()
+    static FloatBatch squareToCosineHemispherePdfBatch(const Vector3fBatch &v);
+
+    /// Batch version of \ref squareToBeckmann(), with one roughness per sample
+    static Vector3fBatch squareToBeckmannBatch(const Point2fBatch &sample, const FloatBatch &alpha);
+
+    /// Batch version of \ref squareToBeckmannPdf(), with one roughness per direction
+    static FloatBatch squareToBeckmannPdfBatch(const Vector3fBatch &m, const FloatBatch &alpha);
+
+    /// Batch version of \ref squareToBeckmannVisible(), with one roughness per sample
+    static Vector3fBatch squareToBeckmannVisibleBatch(const Point2fBatch &sample, const Vector3fBatch &wi, const FloatBatch &alpha);
+
+    /// Batch version of \ref squareToBeckmannVisiblePdf(), with one roughness per direction
+    static FloatBatch squareToBeckmannVisiblePdfBatch(const Vector3fBatch &m, const Vector3fBatch &wi, const FloatBatch &alpha);
+
+    /// Batch version of \ref squareToGGX(), with one roughness per sample
+    static Vector3fBatch squareToGGXBatch(const Point2fBatch &sample, const FloatBatch &alpha);
+
+    /// Batch version of \ref squareToGGXPdf(), with one roughness per direction
+    static FloatBatch squareToGGXPdfBatch(const Vector3fBatch &m, const FloatBatch &alpha);
+
+    /// Batch version of \ref squareToGGXVisible(), with one roughness per sample
+    static Vector3fBatch squareToGGXVisibleBatch(const Point2fBatch &sample, const Vector3fBatch &wi, const FloatBatch &alpha);
+
+    /// Batch version of \ref squareToGGXVisiblePdf(), with one roughness per direction
+    static FloatBatch squareToGGXVisiblePdfBatch(const Vector3fBatch &m, const Vector3fBatch &wi, const FloatBatch &alpha);
 };
 
 NORI_NAMESPACE_END
@@ -17,12 +17,33 @@ public:
 
     virtual Color3f eval(const EmitterQueryRecord & record) const override;
 
+    virtual uint32_t getPrimitiveCount() const override;
+
+    virtual bool getLightBounds(uint32_t primitive, LightBounds & bounds) const override;
+
+    virtual Color3f samplePrimitive(EmitterQueryRecord & record, const Point2f & sample2D, float sample1D) const override;
+
+    virtual float pdfPrimitive(const EmitterQueryRecord & record) const override;
+
+    virtual Color3f sampleRay(Ray3f & ray, Normal3f & n, const Point2f & positionSample, const Point2f & directionSample,
+                              float sample1D, const BoundingBox3f & sceneBounds) const override;
+
+    virtual void pdfRay(const Ray3f & ray, const Normal3f & n, const BoundingBox3f & sceneBounds,
+                        float & pdfPosition, float & pdfDirection) const override;
+
     virtual void setParent(NoriObject * pParentObj, const std::string &name) override;
 
     virtual std::string toString() const override;
 
 protected:
+    /**
+     * \brief Density of the spherical triangle sampling of \c record.primitive as seen
+     * from \c record.ref, zero when the triangle is sampled by area instead
+     */
+    float pdfSolidAngle(const EmitterQueryRecord & record) const;
+
     Color3f m_radiance;
+    bool m_bSolidAngleSampling;
 };
 
 NORI_NAMESPACE_END
\ No newline at end of file
@@ -17,6 +17,12 @@ public:
 
     virtual Color3f eval(const EmitterQueryRecord & record) const override;
 
+    virtual Color3f sampleRay(Ray3f & ray, Normal3f & n, const Point2f & positionSample, const Point2f & directionSample,
+                              float sample1D, const BoundingBox3f & sceneBounds) const override;
+
+    virtual void pdfRay(const Ray3f & ray, const Normal3f & n, const BoundingBox3f & sceneBounds,
+                        float & pdfPosition, float & pdfDirection) const override;
+
     virtual std::string toString() const override;
 
 protected:
@@ -24,8 +30,9 @@ protected:
     float m_scale;
     Transform m_toWorld;
     Transform m_toLocal;
-    std::unique_ptr<Bitmap> m_pEnvironmentMap = nullptr;
-    std::unique_ptr<DiscretePDF2D> m_pPdf = nullptr;
+    std::unique_ptr<Bitmap> m_pEnvironmentMap;
+    std::unique_ptr<DiscretePDF2D> m_pPdf;
+    bool m_bAliasTable; ///< Sample the map in constant time, at the expense of the stratification
 };
 
 NORI_NAMESPACE_END
\ No newline at end of file
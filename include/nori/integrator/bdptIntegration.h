@@ -0,0 +1,149 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#pragma once
+#include <nori/core/common.h>
+#include <nori/core/integrator.h>
+#include <nori/core/intersection.h>
+#include <nori/core/bbox.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <atomic>
+
+NORI_NAMESPACE_BEGIN
+
+/**
+ * \brief Bidirectional path tracing (Veach, 1997)
+ *
+ * For every camera sample, a subpath is traced from the camera and another one
+ * from a uniformly selected emitter, and all prefixes of both subpaths are
+ * connected. Every connection strategy is weighted with the balance heuristic
+ * over all strategies which could have generated the same path, so paths
+ * which are hard to find from the camera (e.g. light arriving indirectly from
+ * small emitters) are picked up by the strategies starting on the light.
+ *
+ * Connections of light subpaths to the camera (light tracing) generally land
+ * on other pixels than the one being sampled. They are splatted into a film
+ * shared by all threads with atomic additions and added to the image in
+ * \ref postprocess(), normalized by the number of traced light subpaths. The
+ * splats reach pixels of every block, so crop windows, checkpoints and
+ * distributed workers are not supported.
+ */
+class BDPTIntegrator : public Integrator
+{
+public:
+    BDPTIntegrator(const PropertyList & propList);
+
+    /// Allocate the film of the light tracing contributions
+    virtual void preprocess(const Scene * pScene) override;
+
+    /// Estimate the radiance along \c ray, the light tracing contributions are splatted
+    virtual Color3f li(const Scene * pScene, Sampler * pSampler, const Ray3f & ray) const override;
+
+    /// Add the light tracing contributions to the image
+    virtual void postprocess(const Scene * pScene, ImageBlock & result) const override;
+
+    /// The light tracing splats reach the entire image
+    virtual bool hasIndependentBlocks() const override { return false; }
+
+    /// Return a human-readable description for debugging purposes
+    virtual std::string toString() const override;
+
+protected:
+    enum class EVertexType
+    {
+        ECamera,
+        ELight,
+        ESurface
+    };
+
+    /// Scene data needed to evaluate the densities of the vertices
+    struct PathContext
+    {
+        const Scene * pScene;
+        const Camera * pCamera;
+        const Emitter * pEnvironmentEmitter;
+        BoundingBox3f sceneBounds;
+        float emitterCount;
+    };
+
+    /**
+     * \brief Vertex of a camera or light subpath
+     *
+     * The densities \c pdfFwd and \c pdfRev of sampling the vertex from its
+     * predecessor and from its successor are expressed with respect to areas,
+     * except for vertices on environment emitters (solid angles).
+     */
+    struct PathVertex
+    {
+        EVertexType type = EVertexType::ESurface;
+        ETransportMode mode = ETransportMode::ERadiance;
+        Color3f beta = Color3f(0.0f);
+        Intersection its;             ///< Surface vertices only
+        Point3f p;
+        Normal3f n = Normal3f(0.0f);  ///< Geometric normal, zero for the pinhole camera
+        Vector3f wo;                  ///< Direction towards the previous vertex (surface vertices only)
+        const Emitter * pEmitter = nullptr;
+        bool bDelta = false;
+        float pdfFwd = 0.0f;
+        float pdfRev = 0.0f;
+
+        bool isOnSurface() const { return !n.isZero(); }
+        bool isLight() const { return type == EVertexType::ELight || (type == EVertexType::ESurface && pEmitter != nullptr); }
+        bool isInfiniteLight() const;
+        bool isDeltaLight() const;
+        bool isConnectible() const;
+        Normal3f getShadingNormal() const { return type == EVertexType::ESurface ? its.shFrame.n : n; }
+
+        /// Evaluate the BSDF towards \c next (with the shading normal correction for importance transport)
+        Color3f f(const PathVertex & next) const;
+
+        /// Convert the solid angle density \c pdf of sampling \c next from this vertex to the area measure
+        float convertDensity(float pdf, const PathVertex & next) const;
+
+        /// Density of sampling \c next from this vertex, which was reached from \c pPrev
+        float pdf(const PathContext & context, const PathVertex * pPrev, const PathVertex & next) const;
+
+        /// Density of sampling \c next when a light subpath starts from this vertex
+        float pdfLight(const PathContext & context, const PathVertex & next) const;
+
+        /// Density of starting a light subpath at this vertex (towards \c next)
+        float pdfLightOrigin(const PathContext & context, const PathVertex & next) const;
+
+        /// Radiance emitted from this vertex towards \c next
+        Color3f le(const PathContext & context, const PathVertex & next) const;
+    };
+
+    /// Extend \c path by sampling the BSDFs starting with \c ray, return the number of added vertices
+    int randomWalk(const PathContext & context, Sampler * pSampler, Ray3f ray, Color3f beta, float pdf,
+                   int maxDepth, ETransportMode mode, std::vector<PathVertex> & path) const;
+
+    int generateCameraSubpath(const PathContext & context, Sampler * pSampler, const Ray3f & ray,
+                              std::vector<PathVertex> & path) const;
+
+    int generateLightSubpath(const PathContext & context, Sampler * pSampler, std::vector<PathVertex> & path) const;
+
+    /**
+     * \brief Connect the first \c s vertices of the light subpath with the first \c t
+     * vertices of the camera subpath and return the weighted contribution
+     *
+     * \param pixel Set to the position on the film for light tracing strategies (\c t = 1)
+     */
+    Color3f connect(const PathContext & context, Sampler * pSampler, const std::vector<PathVertex> & lightPath,
+                    const std::vector<PathVertex> & cameraPath, int s, int t, Point2f & pixel) const;
+
+    /// Balance heuristic weight of the strategy (s, t), \c sampled replaces an endpoint sampled during the connection
+    float misWeight(const PathContext & context, const std::vector<PathVertex> & lightPath,
+                    const std::vector<PathVertex> & cameraPath, const PathVertex & sampled, int s, int t) const;
+
+    /// Add a light tracing contribution to the shared film
+    void splat(const Point2f & pixel, const Color3f & value) const;
+
+    uint32_t m_depth;
+    bool m_bLightTracing;
+    Vector2i m_outputSize = Vector2i(0, 0);
+    std::unique_ptr<std::atomic<float>[]> m_pSplats;
+    mutable tbb::enumerable_thread_specific<uint64_t> m_lightPathCount; ///< Light subpaths traced by each thread
+};
+
+NORI_NAMESPACE_END
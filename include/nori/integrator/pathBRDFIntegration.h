@@ -4,25 +4,49 @@
 
 #include <nori/core/common.h>
 #include <nori/core/integrator.h>
+#include <nori/core/radianceCache.h>
+#include <tbb/enumerable_thread_specific.h>
 
 NORI_NAMESPACE_BEGIN
 
 /**
 *\brief This integrator simulates a simple path tracing integrator.
+*
+* Supports adjoint-driven Russian roulette and splitting with a \ref RadianceCache
+* learned in a pre-pass, like \ref PathMISIntegrator.
 */
 class PathBRDFIntegrator : public Integrator
 {
 public:
     PathBRDFIntegrator(const PropertyList & propList);
 
+    /// Learn the radiance cache of ADRRS (if enabled)
+    virtual void preprocess(const Scene * pScene) override;
+
+    /// The radiance cache accumulates the training paths in the order the threads finish them
+    virtual bool hasReproduciblePreprocess() const override { return !m_bAdrrs; }
+
     /// Compute the radiance value for a given ray. Just return green here
     virtual Color3f li(const Scene * pScene, Sampler * pSampler, const Ray3f & ray) const override;
 
+    /// Report the average path length and the number of splits
+    virtual void postprocess(const Scene * pScene, ImageBlock & result) const override;
+
     /// Return a human-readable description for debugging purposes
     virtual std::string toString() const override;
 
 protected:
+    /// Trace a path, the reflected radiance at its vertices is recorded into the radiance cache if \c bRecord is set
+    Color3f trace(const Scene * pScene, Sampler * pSampler, const Ray3f & ray, bool bRecord) const;
+
     uint32_t m_depth;
+
+    bool m_bAdrrs;
+    uint32_t m_adrrsSampleCount; ///< Samples per pixel of the pre-pass learning the radiance cache
+    float m_adrrsMaxSplit;
+    std::unique_ptr<RadianceCache> m_pRadianceCache;
+
+    mutable tbb::enumerable_thread_specific<AdrrsStatistics> m_statistics; ///< Only recorded with ADRRS
 };
 
 NORI_NAMESPACE_END
@@ -23,6 +23,7 @@ public:
 
 protected:
     uint32_t m_depth;
+    bool m_bLightBVH; ///< Sample one light from the light BVH instead of every emitter
 };
 
 NORI_NAMESPACE_END
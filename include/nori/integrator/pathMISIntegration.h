@@ -4,25 +4,82 @@
 
 #include <nori/core/common.h>
 #include <nori/core/integrator.h>
+#include <nori/core/radianceCache.h>
+#include <tbb/enumerable_thread_specific.h>
 
 NORI_NAMESPACE_BEGIN
 
 /**
 *\brief This integrator simulates a simple path tracing integrator.
+*
+* With guiding enabled, the incident radiance is learned in an \ref SDTree over a
+* few progressive training passes before rendering, and indirect directions are
+* sampled from a one-sample MIS mixture of the learned distribution and the BSDF.
+*
+* With adjoint-driven Russian roulette and splitting (ADRRS), a \ref RadianceCache
+* is learned in a pre-pass, and paths are terminated or split depending on their
+* expected contribution relative to the estimate of their pixel, which is looked
+* up in the cache at the primary hit.
 */
 class PathMISIntegrator : public Integrator
 {
 public:
     PathMISIntegrator(const PropertyList & propList);
 
+    virtual ~PathMISIntegrator();
+
+    /// Train the guiding distribution and the radiance cache of ADRRS (if enabled)
+    virtual void preprocess(const Scene * pScene) override;
+
+    /// The SD-tree and the radiance cache accumulate the training paths in the order the threads finish them
+    virtual bool hasReproduciblePreprocess() const override { return !m_bGuiding && !m_bAdrrs; }
+
     /// Compute the radiance value for a given ray. Just return green here
     virtual Color3f li(const Scene * pScene, Sampler * pSampler, const Ray3f & ray) const override;
 
+    /// Report the average path length and the number of splits
+    virtual void postprocess(const Scene * pScene, ImageBlock & result) const override;
+
     /// Return a human-readable description for debugging purposes
     virtual std::string toString() const override;
 
 protected:
+    enum class ETraceMode
+    {
+        ERender,
+        ETrainGuiding,        ///< Record the incident radiance at the vertices into the guiding distribution
+        ETrainRadianceCache   ///< Record the reflected radiance at the vertices into the radiance cache
+    };
+
+    /// Trace a path, the radiance at its vertices is recorded in the training modes
+    Color3f trace(const Scene * pScene, Sampler * pSampler, const Ray3f & ray, ETraceMode mode) const;
+
+    /**
+     * \brief Sample the next direction from the BSDF, or from the mixture of the BSDF
+     * and the guiding distribution \c pDTree (if not null)
+     *
+     * \param pdf Set to the density of the sampled direction
+     * \return The BSDF value times the cosine divided by \c pdf
+     */
+    Color3f sampleDirection(const BSDF * pBSDF, const DTreeWrapper * pDTree, const Intersection & its,
+                            BSDFQueryRecord & bsdfQueryRecord, Sampler * pSampler, float & pdf) const;
+
     uint32_t m_depth;
+    bool m_bLightBVH; ///< Sample one light from the light BVH instead of every emitter
+
+    bool m_bGuiding;
+    uint32_t m_guidingPasses;
+    float m_guidingBsdfFraction;
+    uint32_t m_guidingSpatialThreshold;
+    float m_guidingDirectionalThreshold;
+    std::unique_ptr<SDTree> m_pSDTree;
+
+    bool m_bAdrrs;
+    uint32_t m_adrrsSampleCount; ///< Samples per pixel of the pre-pass learning the radiance cache
+    float m_adrrsMaxSplit;
+    std::unique_ptr<RadianceCache> m_pRadianceCache;
+
+    mutable tbb::enumerable_thread_specific<AdrrsStatistics> m_statistics; ///< Only recorded with ADRRS
 };
 
 NORI_NAMESPACE_END
@@ -0,0 +1,113 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#pragma once
+#include <nori/core/common.h>
+#include <nori/core/integrator.h>
+
+NORI_NAMESPACE_BEGIN
+
+/**
+ * \brief Direct illumination with reservoir-based spatiotemporal importance resampling
+ * (Bitterli et al., "Spatiotemporal reservoir resampling for real-time ray tracing
+ * with dynamic direct lighting", 2020)
+ *
+ * At every diffuse shading point, a number of candidate light samples are drawn
+ * from the emitters of the scene and streamed through a weighted reservoir, which
+ * keeps one of them with probability proportional to its unshadowed contribution.
+ * Only the selected candidate is tested with a shadow ray.
+ *
+ * Optionally, the reservoir of the camera hit is combined with the one of the
+ * previous sample of the same pixel (temporal reuse) and with those of pixels that
+ * were already shaded in the same block (spatial reuse). Reuse greatly reduces the
+ * noise but is biased, since neighbours are weighted without visibility.
+ * Specular surfaces are followed up to the maximum depth.
+ */
+class RestirIntegrator : public Integrator
+{
+public:
+    RestirIntegrator(const PropertyList & propList);
+
+    /// Start a new rendering, which invalidates the reservoirs of the previous one
+    virtual void preprocess(const Scene * pScene) override;
+
+    /// Compute the radiance value for a given ray
+    virtual Color3f li(const Scene * pScene, Sampler * pSampler, const Ray3f & ray) const override;
+
+    /// Return a human-readable description for debugging purposes
+    virtual std::string toString() const override;
+
+protected:
+    /// A light sample which can be re-evaluated at other shading points
+    struct LightSample
+    {
+        const Emitter * pEmitter = nullptr;
+        uint32_t primitive = 0;
+        Point3f p;                 ///< Position on the emitter (area lights)
+        Normal3f n;                ///< Normal at the position (area lights)
+        Vector3f wi;               ///< Direction towards the emitter (environment/directional lights)
+        bool bInfinite = false;
+    };
+
+    /// Weighted reservoir holding a single light sample
+    struct Reservoir
+    {
+        LightSample y;
+        float wSum = 0.0f;         ///< Sum of the resampling weights
+        float M = 0.0f;            ///< Number of candidates seen
+        float W = 0.0f;            ///< Unbiased contribution weight of \c y
+        float targetPdf = 0.0f;    ///< Target function of \c y at the owning shading point
+
+        Normal3f n;                ///< Normal of the owning shading point
+        float t = 0.0f;            ///< Camera distance of the owning shading point
+        bool bValid = false;
+
+        bool update(const LightSample & sample, float weight, float count, float u)
+        {
+            wSum += weight;
+            M += count;
+            if (weight > 0.0f && u * wSum < weight)
+            {
+                y = sample;
+                return true;
+            }
+            return false;
+        }
+    };
+
+    /// Draw one candidate light sample and return its density (in the measure of the sample)
+    float sampleCandidate(const Scene * pScene, Sampler * pSampler, const Point3f & ref, const Normal3f & n,
+                          LightSample & sample) const;
+
+    /**
+     * \brief Compute the unshadowed contribution of a light sample at a shading point
+     *
+     * Area light samples include the geometry term, as they are measured by area on the
+     * emitter. \c record is filled for the shadow ray.
+     */
+    Color3f evalContribution(const Intersection & its, const Vector3f & woLocal, Sampler * pSampler,
+                             const Scene * pScene, const LightSample & sample, EmitterQueryRecord & record) const;
+
+    /// Combine \c source (owned by another shading point) into \c target
+    void combine(Reservoir & target, const Reservoir & source, const Intersection & its, const Vector3f & woLocal,
+                 Sampler * pSampler, const Scene * pScene) const;
+
+    /// Estimate the direct illumination at a diffuse shading point
+    Color3f estimateDirect(const Scene * pScene, Sampler * pSampler, const Intersection & its,
+                           const Vector3f & woLocal, bool bReuse) const;
+
+    uint32_t m_depth;
+    uint32_t m_candidates;
+    bool m_bLightBVH;
+    bool m_bTemporalReuse;
+    bool m_bSpatialReuse;
+    uint32_t m_spatialNeighbors;
+    int m_spatialRadius;
+    float m_historyLimit;
+
+    /// Identifies the current rendering, unique across all integrator instances
+    uint64_t m_generation = 0;
+};
+
+NORI_NAMESPACE_END
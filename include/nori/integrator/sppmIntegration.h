@@ -0,0 +1,76 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#pragma once
+#include <nori/core/common.h>
+#include <nori/core/integrator.h>
+#include <nori/core/intersection.h>
+#include <atomic>
+
+NORI_NAMESPACE_BEGIN
+
+/**
+ * \brief Stochastic progressive photon mapping (Hachisuka and Jensen, 2009)
+ *
+ * Every iteration traces one camera path per pixel up to the first diffuse
+ * surface (the visible point), where direct illumination is estimated with
+ * emitter sampling. The visible points are inserted into a spatial hash grid,
+ * which is built without locks, and photons traced from the emitters add their
+ * flux to the visible points within the search radius of each pixel. The radii
+ * shrink progressively, so the estimate converges, and caustics seen directly
+ * or through specular surfaces are resolved much faster than with path tracing.
+ *
+ * The image is rendered by \ref render() and updated after every iteration.
+ */
+class SPPMIntegrator : public Integrator
+{
+public:
+    SPPMIntegrator(const PropertyList & propList);
+
+    /// Photon mapping does not provide independent per-ray estimates, see \ref render()
+    virtual Color3f li(const Scene * pScene, Sampler * pSampler, const Ray3f & ray) const override;
+
+    /// Run the progressive iterations and write the image into \c result
+    virtual bool render(const Scene * pScene, ImageBlock & result) const override;
+
+    /// The photons of every iteration reach the entire image
+    virtual bool hasIndependentBlocks() const override { return false; }
+
+    /// Return a human-readable description for debugging purposes
+    virtual std::string toString() const override;
+
+protected:
+    struct VisiblePoint
+    {
+        Intersection its;
+        Vector3f wi;               ///< Direction towards the camera
+        Color3f beta = Color3f(0.0f);
+        bool bValid = false;
+    };
+
+    struct SPPMPixel
+    {
+        float radius = 0.0f;
+        Color3f ld = Color3f(0.0f); ///< Sum of the direct illumination of all iterations
+        VisiblePoint visiblePoint;
+        std::atomic<float> phi[3];  ///< Flux of the photons of the current iteration
+        std::atomic<int> M;         ///< Number of photons of the current iteration
+        float N = 0.0f;             ///< Accumulated photon count
+        Color3f tau = Color3f(0.0f);///< Accumulated flux
+    };
+
+    /// Trace the camera path of a pixel and store its visible point
+    void traceCameraPath(const Scene * pScene, Sampler * pSampler, const Point2i & pixel, SPPMPixel & sppmPixel) const;
+
+    /// Estimate the direct illumination at a visible point with emitter sampling
+    Color3f estimateDirect(const Scene * pScene, Sampler * pSampler, const Intersection & its, const Vector3f & wi) const;
+
+    uint32_t m_depth;
+    uint32_t m_iterations;
+    uint32_t m_photonCount;
+    float m_initialRadius;
+    float m_alpha;
+};
+
+NORI_NAMESPACE_END
@@ -22,6 +22,7 @@ protected:
     Color3f liRecursive(const Scene * pScene, Sampler * pSampler, const Ray3f & ray, uint32_t depth) const;
 
     uint32_t m_depth;
+    bool m_bLightBVH; ///< Sample one light from the light BVH instead of every emitter
 };
 
 NORI_NAMESPACE_END
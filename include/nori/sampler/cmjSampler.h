@@ -0,0 +1,49 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#pragma once
+#include <nori/core/common.h>
+#include <nori/core/sampler.h>
+
+NORI_NAMESPACE_BEGIN
+
+/**
+ * \brief Correlated multi-jittered sampler (Kensler 2013)
+ *
+ * The samples of a pixel are placed on an m x n grid with m = floor(sqrt(N))
+ * and n = ceil(N / m), with the formulation for arbitrary N of the paper: the
+ * first coordinate is stratified over the m columns and their n sub-columns,
+ * the second one over N strata, so that no region is left out when N is not
+ * a product of the grid size. Every dimension pair
+ * uses an independent pattern, hashed from the pixel, the dimension and the
+ * seed, and the permutations are evaluated without any precomputed tables.
+ * One-dimensional requests are jittered-stratified over N strata.
+ */
+class CMJSampler : public Sampler
+{
+public:
+    CMJSampler(const PropertyList & propList);
+
+    virtual std::unique_ptr<Sampler> clone() const override;
+
+    /// Change the number of pixel samples and adapt the grid to it
+    virtual void setSampleCount(size_t sampleCount) override;
+
+    virtual void prepare(const ImageBlock & block) override;
+
+    virtual float next1D() override;
+
+    virtual Point2f next2D() override;
+
+    virtual std::string toString() const override;
+
+protected:
+    CMJSampler() = default;
+
+private:
+    uint32_t m_gridX = 1;   ///< Number of grid columns
+    uint32_t m_gridY = 1;   ///< Number of grid rows
+};
+
+NORI_NAMESPACE_END
@@ -29,18 +29,23 @@ public:
 
     virtual void prepare(const ImageBlock &block) override;
 
-    virtual void generate() override;
-    virtual void advance() override;
-
     virtual float next1D() override;
 
     virtual Point2f next2D() override;
 
+    /// Generate the values with eight interleaved lanes of the PCG32 stream
+    virtual void next1DArray(float * pValues, size_t count) override;
+
+    virtual void next2DArray(Point2f * pValues, size_t count) override;
+
     virtual std::string toString() const override;
 protected:
     IndependentSampler();
 
 private:
+    /// Fill \c pValues with the next \c count floats of the stream
+    void nextFloats(float * pValues, size_t count);
+
     pcg32 m_random;
 };
 
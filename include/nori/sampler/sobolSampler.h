@@ -0,0 +1,43 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#pragma once
+#include <nori/core/common.h>
+#include <nori/core/sampler.h>
+
+NORI_NAMESPACE_BEGIN
+
+/**
+ * \brief Owen-scrambled Sobol sampler
+ *
+ * Every pair of dimensions is drawn from the first two dimensions of the
+ * Sobol sequence, a (0,2)-sequence in base 2, which is indexed by the sample
+ * index within the pixel. The sequence is randomized with the hash-based Owen
+ * scrambling of Burley, seeded by the pixel, the dimension and the seed of
+ * the sampler, so that the samples of a pixel do not depend on the block or
+ * on the order in which the blocks are rendered. The index is shuffled per
+ * dimension pair to decorrelate the padded dimensions.
+ *
+ * The stratification is best when the sample count is a power of two.
+ */
+class SobolSampler : public Sampler
+{
+public:
+    SobolSampler(const PropertyList & propList);
+
+    virtual std::unique_ptr<Sampler> clone() const override;
+
+    virtual void prepare(const ImageBlock & block) override;
+
+    virtual float next1D() override;
+
+    virtual Point2f next2D() override;
+
+    virtual std::string toString() const override;
+
+protected:
+    SobolSampler() = default;
+};
+
+NORI_NAMESPACE_END
@@ -0,0 +1,48 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#pragma once
+#include <nori/core/common.h>
+#include <nori/core/sampler.h>
+
+NORI_NAMESPACE_BEGIN
+
+/**
+ * \brief Padded stratified sampler
+ *
+ * Two-dimensional requests are stratified over an m x n grid with
+ * m = floor(sqrt(N)) and n = ceil(N / m), one-dimensional requests over N
+ * strata. The samples of a pixel visit the strata in a random order which
+ * is hashed from the pixel, the dimension and the seed, so that different
+ * dimensions are decorrelated ("padded"). With \c jitter disabled, every
+ * sample is placed at the center of its stratum.
+ */
+class StratifiedSampler : public Sampler
+{
+public:
+    StratifiedSampler(const PropertyList & propList);
+
+    virtual std::unique_ptr<Sampler> clone() const override;
+
+    /// Change the number of pixel samples and adapt the grid to it
+    virtual void setSampleCount(size_t sampleCount) override;
+
+    virtual void prepare(const ImageBlock & block) override;
+
+    virtual float next1D() override;
+
+    virtual Point2f next2D() override;
+
+    virtual std::string toString() const override;
+
+protected:
+    StratifiedSampler() = default;
+
+private:
+    uint32_t m_gridX = 1;   ///< Number of grid columns
+    uint32_t m_gridY = 1;   ///< Number of grid rows
+    bool m_bJitter = true;  ///< Jitter the samples within their strata
+};
+
+NORI_NAMESPACE_END
@@ -0,0 +1,58 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#pragma once
+#include <nori/core/common.h>
+#include <nori/core/sampler.h>
+
+NORI_NAMESPACE_BEGIN
+
+/**
+ * \brief Blue-noise Sobol sampler (Ahmed and Wonka, "Screen-Space Blue-Noise
+ * Diffusion of Monte Carlo Sampling Error via Hierarchical Ordering of Pixels", 2020)
+ *
+ * All pixels of the image share one Owen-scrambled Sobol sequence. The pixels
+ * are enumerated along a Morton curve, and a pixel receives the consecutive
+ * samples <tt>(mortonCode << log2(N)) + i</tt>. Before the sequence is
+ * indexed, the base-4 digits of this index are randomly permuted per dimension,
+ * where the permutation of a digit depends on the more significant digits.
+ * Neighbouring pixels therefore receive well-stratified, complementary points,
+ * which turns the error at low sample counts into blue noise in screen space.
+ *
+ * The samples only depend on the pixel, the dimension and the seed, not on
+ * the blocks. The sample count should be a power of two.
+ */
+class ZSobolSampler : public Sampler
+{
+public:
+    ZSobolSampler(const PropertyList & propList);
+
+    virtual std::unique_ptr<Sampler> clone() const override;
+
+    /// Adapt the Morton index range to the resolution of the camera
+    virtual void preprocess(const Scene * pScene) override;
+
+    virtual void prepare(const ImageBlock & block) override;
+
+    virtual float next1D() override;
+
+    virtual Point2f next2D() override;
+
+    virtual std::string toString() const override;
+
+protected:
+    ZSobolSampler() = default;
+
+private:
+    /// Return the permuted index of the current pixel sample for the current dimension
+    uint64_t getSobolIndex() const;
+
+    /// Return the scrambling seeds of the current dimension for the given permuted index
+    uint64_t getScrambleHash(uint64_t sobolIndex) const;
+
+    int m_log2SampleCount = 0;
+    int m_base4Digits = 0;
+};
+
+NORI_NAMESPACE_END
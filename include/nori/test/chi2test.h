@@ -45,6 +45,7 @@ private:
     int m_minExpFrequency;
     int m_sampleCount;
     int m_testCount;
+    int m_batchSize;
     float m_significanceLevel;
     std::vector<BSDF *> m_bsdfs;
 };
@@ -12,15 +12,66 @@
 #include <nori/core/bitmap.h>
 #include <nori/core/sampler.h>
 #include <nori/core/integrator.h>
+#include <nori/core/checkpoint.h>
+#include <nori/core/numa.h>
+#include <nori/core/denoiser.h>
+#include <nori/core/shadowRayQueue.h>
 #include <nori/gui/gui.h>
 #include <tbb/parallel_for.h>
 #include <tbb/task_scheduler_init.h>
 #include <thread>
+#include <atomic>
+#include <functional>
+#include <cstdlib>
+#include <cstdio>
+#include <sstream>
 
 using namespace nori;
 
 static int threadCount = -1;
 static bool gui = true;
+static float checkpointInterval = 0.0f;
+static bool resume = false;
+static int workerIndex = 0;
+static int workerCount = 0;
+static bool splitSamples = false;
+static bool server = false;
+static std::string cropWindow = "";
+static bool dataWindow = false;
+static bool numa = false;
+static bool numaReplicate = false;
+static bool denoise = false;
+
+/// Strip the extension of the scene filename to obtain the name of the output files
+static std::string getOutputName(const std::string &filename) {
+    std::string outputName = filename;
+    size_t lastdot = outputName.find_last_of(".");
+    if (lastdot != std::string::npos)
+        outputName.erase(lastdot, std::string::npos);
+    return outputName;
+}
+
+/**
+ * \brief Convert a crop window "x,y,width,height" into camera parameters
+ *
+ * The value "none" disables a previously configured crop window
+ */
+static void parseCropWindow(const std::string &value, PropertyList &propList) {
+    std::vector<int> window(4, 0);
+    if (value != "none") {
+        std::vector<std::string> tokens = tokenize(value);
+        if (tokens.size() != 4)
+            throw NoriException("Expected a crop window \"x,y,width,height\", got \"%s\"", value);
+        for (int i = 0; i < 4; ++i)
+            window[i] = toInt(tokens[i]);
+        if (window[2] <= 0 || window[3] <= 0)
+            throw NoriException("The crop window \"%s\" is empty", value);
+    }
+    propList.setInteger("cropOffsetX", window[0]);
+    propList.setInteger("cropOffsetY", window[1]);
+    propList.setInteger("cropWidth", window[2]);
+    propList.setInteger("cropHeight", window[3]);
+}
 
 static void renderBlock(const Scene *scene, Sampler *sampler, ImageBlock &block) {
     const Camera *camera = scene->getCamera();
@@ -32,9 +83,16 @@ static void renderBlock(const Scene *scene, Sampler *sampler, ImageBlock &block)
     /* Clear the block contents */
     block.clear();
 
+    /* Shadow rays of next-event estimation are traced in batches */
+    ShadowRayQueue shadowRays;
+    ShadowRayQueue::setActive(&shadowRays);
+
     /* For each pixel and pixel sample sample */
     for (int y=0; y<size.y(); ++y) {
         for (int x=0; x<size.x(); ++x) {
+            /* Samples are indexed per pixel, independently of the block */
+            sampler->generate(Point2i(x + offset.x(), y + offset.y()));
+
             for (uint32_t i=0; i<sampler->getSampleCount(); ++i) {
                 Point2f pixelSample = Point2f((float) (x + offset.x()), (float) (y + offset.y())) + sampler->next2D();
                 Point2f apertureSample = sampler->next2D();
@@ -42,29 +100,177 @@ static void renderBlock(const Scene *scene, Sampler *sampler, ImageBlock &block)
                 /* Sample a ray from the camera */
                 Ray3f ray;
                 Color3f value = camera->sampleRay(ray, pixelSample, apertureSample);
+                ray.scaleDifferentials(Ray3f::differentialScale(sampler->getTotalSampleCount()));
+                shadowRays.beginSample(pixelSample, value);
 
                 /* Compute the incident radiance */
                 value *= integrator->li(scene, sampler, ray);
 
                 /* Store in the image block */
                 block.put(pixelSample, value);
+
+                if (shadowRays.isFull())
+                    shadowRays.flush(scene, block);
+
+                sampler->advance();
             }
         }
     }
+
+    shadowRays.flush(scene, block);
+    ShadowRayQueue::setActive(nullptr);
+}
+
+/**
+ * \brief Render all blocks with threads pinned to the NUMA nodes of the machine
+ *
+ * The image is split into horizontal bands, one per node, and the blocks of a
+ * band are queued on its node. The threads of a node first drain their own
+ * queue and then help the other nodes. If requested, the acceleration structure
+ * and the mesh buffers are replicated on every node before rendering starts.
+ *
+ * Only the scene data, the blocks and the samplers are node-local. The output
+ * image is a single allocation which the main thread initializes (the pixels
+ * are constructed on allocation), so it lives on the node of that thread, and
+ * the band split does not keep the writes of the other nodes local.
+ */
+static void renderNuma(Scene *scene, BlockGenerator &blockGenerator,
+                       const std::function<void(ImageBlock &, Sampler *)> &process) {
+    const Camera *camera = scene->getCamera();
+    NumaTopology topology;
+    int nodeCount = std::min(topology.getNodeCount(), NORI_MAX_NUMA_NODES);
+    cout << "using " << nodeCount << " NUMA node(s) .. ";
+    cout.flush();
+
+    if (numaReplicate && nodeCount > 1) {
+        std::vector<std::thread> replicators;
+        for (int node = 0; node < nodeCount; ++node) {
+            replicators.emplace_back([&, node] {
+                topology.pinCurrentThread(node);
+                scene->replicateForNode(node);
+            });
+        }
+        for (auto &thread : replicators)
+            thread.join();
+    }
+
+    /* Queue the blocks on the node owning their band of the image */
+    std::vector<std::vector<std::pair<Point2i, Vector2i>>> queues(nodeCount);
+    int height = camera->getOutputSize().y();
+    ImageBlock block(Vector2i(NORI_BLOCK_SIZE), nullptr);
+    for (int i = 0; i < blockGenerator.getBlockCount(); ++i) {
+        blockGenerator.next(block);
+        int node = std::min(nodeCount - 1, block.getOffset().y() * nodeCount / height);
+        queues[node].push_back(std::make_pair(block.getOffset(), block.getSize()));
+    }
+    std::unique_ptr<std::atomic<int>[]> heads(new std::atomic<int>[nodeCount]);
+    for (int node = 0; node < nodeCount; ++node)
+        heads[node] = 0;
+
+    /* Split the threads among the nodes according to their number of CPUs */
+    int cpuCount = 0;
+    for (int node = 0; node < nodeCount; ++node)
+        cpuCount += (int) topology.getCpus(node).size();
+    int totalThreads = threadCount > 0 ? threadCount : cpuCount;
+
+    std::vector<std::thread> workers;
+    for (int node = 0; node < nodeCount; ++node) {
+        int nodeThreads = std::max(1, totalThreads * (int) topology.getCpus(node).size() / cpuCount);
+        for (int i = 0; i < nodeThreads; ++i) {
+            workers.emplace_back([&, node] {
+                topology.pinCurrentThread(node);
+
+                /* Allocate the block and the sampler on the node of the thread */
+                ImageBlock block(Vector2i(NORI_BLOCK_SIZE), camera->getReconstructionFilter());
+                std::unique_ptr<Sampler> sampler(scene->getSampler()->clone());
+
+                for (int k = 0; k < nodeCount; ++k) {
+                    int queue = (node + k) % nodeCount;
+                    int index;
+                    while ((index = heads[queue]++) < (int) queues[queue].size()) {
+                        block.setOffset(queues[queue][index].first);
+                        block.setSize(queues[queue][index].second);
+                        process(block, sampler.get());
+                    }
+                }
+            });
+        }
+    }
+    for (auto &thread : workers)
+        thread.join();
 }
 
 static void render(Scene *scene, const std::string &filename) {
     const Camera *camera = scene->getCamera();
     Vector2i outputSize = camera->getOutputSize();
+
+    /* These modes render a subset of the blocks, which the image of an
+       integrator with its own rendering loop cannot be split into */
+    if (!scene->getIntegrator()->hasIndependentBlocks()) {
+        if (camera->hasCropWindow())
+            throw NoriException("The integrator does not support rendering a crop window");
+        if (checkpointInterval > 0 || resume)
+            throw NoriException("The integrator does not support checkpoints (--checkpoint, --resume)");
+        if (workerCount > 0)
+            throw NoriException("The integrator does not support distributed rendering (--worker)");
+    }
+    if ((checkpointInterval > 0 || resume) && !scene->getIntegrator()->hasReproduciblePreprocess())
+        throw NoriException("The preprocess of the integrator cannot be reproduced, "
+                            "which is required by checkpoints (--checkpoint, --resume)");
+
     scene->getIntegrator()->preprocess(scene);
 
-    /* Create a block generator (i.e. a work scheduler) */
-    BlockGenerator blockGenerator(outputSize, NORI_BLOCK_SIZE);
+    /* Determine the filename of the output bitmap */
+    std::string outputName = getOutputName(filename);
+
+    /* A distributed worker renders either a subset of the blocks or its
+       share of the pixel samples, which continues the sample sequence of
+       the preceding workers */
+    if (workerCount > 0) {
+        outputName += tfm::format(".part%i", workerIndex);
+
+        if (splitSamples) {
+            Sampler *sampler = scene->getSampler();
+            size_t sampleCount = sampler->getSampleCount();
+            size_t firstSample = sampleCount * workerIndex / workerCount;
+            sampler->setSampleRange(firstSample, sampleCount * (workerIndex + 1) / workerCount - firstSample);
+        }
+    }
+
+    scene->getSampler()->preprocess(scene);
 
     /* Allocate memory for the entire output image and clear it */
     ImageBlock result(outputSize, camera->getReconstructionFilter());
     result.clear();
 
+    /* Create a block generator (i.e. a work scheduler) which only hands out
+       the blocks intersecting the crop window or the filter footprint around
+       it, the output only keeps the window itself */
+    BlockGenerator blockGenerator(outputSize, NORI_BLOCK_SIZE,
+                                  camera->getCropOffset(), camera->getCropSize(),
+                                  result.getBorderSize());
+
+    /* Keep track of the completed blocks so that an interrupted render can be resumed */
+    std::unique_ptr<RenderCheckpoint> checkpoint;
+    std::string checkpointName = outputName + ".checkpoint";
+    if (checkpointInterval > 0 || resume) {
+        const Sampler *sampler = scene->getSampler();
+        std::string configuration = scene->getIntegrator()->toString() + sampler->toString() + camera->toString()
+            + tfm::format("samples [%i, %i)", sampler->getFirstSample(), sampler->getFirstSample() + sampler->getSampleCount());
+        checkpoint.reset(new RenderCheckpoint(outputSize, NORI_BLOCK_SIZE,
+            (uint32_t) sampler->getSampleCount(), sampler->getSeed(),
+            RenderCheckpoint::hashConfiguration(configuration)));
+
+        if (resume && filesystem::path(checkpointName).exists()) {
+            checkpoint->load(checkpointName, result);
+            cout << "Resuming from \"" << checkpointName << "\" ("
+                 << checkpoint->getCompletedCount() << "/" << blockGenerator.getBlockCount()
+                 << " blocks completed)" << endl;
+        } else if (resume) {
+            LOG(WARNING) << "No checkpoint \"" << checkpointName << "\" found, starting from scratch." << endl;
+        }
+    }
+
     /* Create a window that visualizes the partially rendered result */
     NoriScreen *screen = nullptr;
     if (gui) {
@@ -74,12 +280,55 @@ static void render(Scene *scene, const std::string &filename) {
 
     /* Do the following in parallel and asynchronously */
     std::thread render_thread([&] {
-        tbb::task_scheduler_init init(threadCount);
-
         cout << "Rendering .. ";
         cout.flush();
         Timer timer;
 
+        auto process = [&](ImageBlock &block, Sampler *sampler) {
+            /* Skip blocks which were restored from the checkpoint */
+            if (checkpoint && checkpoint->isCompleted(block))
+                return;
+
+            /* Skip blocks which are assigned to other workers */
+            if (workerCount > 0 && !splitSamples &&
+                blockGenerator.getBlockIndex(block) % workerCount != workerIndex)
+                return;
+
+            /* Inform the sampler about the block to be rendered */
+            sampler->prepare(block);
+
+            /* Render all contained pixels */
+            renderBlock(scene, sampler, block);
+
+            /* The image block has been processed. Now add it to
+               the "big" block that represents the entire image */
+            if (checkpoint) {
+                checkpoint->commit(result, block);
+                checkpoint->saveIfDue(checkpointName, result, checkpointInterval);
+            } else {
+                result.put(block);
+            }
+        };
+
+        /* Integrators with their own rendering loop fill in the result themselves
+           (the modes which rely on the blocks were rejected above) */
+        {
+            tbb::task_scheduler_init init(threadCount);
+            if (scene->getIntegrator()->render(scene, result)) {
+                cout << "done. (took " << timer.elapsedString() << ")" << endl;
+                return;
+            }
+        }
+
+        if (numa) {
+            renderNuma(scene, blockGenerator, process);
+            scene->getIntegrator()->postprocess(scene, result);
+            cout << "done. (took " << timer.elapsedString() << ")" << endl;
+            return;
+        }
+
+        tbb::task_scheduler_init init(threadCount);
+
         tbb::blocked_range<int> range(0, blockGenerator.getBlockCount());
 
         auto map = [&](const tbb::blocked_range<int> &range) {
@@ -95,15 +344,7 @@ static void render(Scene *scene, const std::string &filename) {
                 /* Request an image block from the block generator */
                 blockGenerator.next(block);
 
-                /* Inform the sampler about the block to be rendered */
-                sampler->prepare(block);
-
-                /* Render all contained pixels */
-                renderBlock(scene, sampler.get(), block);
-
-                /* The image block has been processed. Now add it to
-                   the "big" block that represents the entire image */
-                result.put(block);
+                process(block, sampler.get());
             }
         };
 
@@ -113,6 +354,8 @@ static void render(Scene *scene, const std::string &filename) {
         /// (equivalent to the following single-threaded call)
         // map(range);
 
+        scene->getIntegrator()->postprocess(scene, result);
+
         cout << "done. (took " << timer.elapsedString() << ")" << endl;
     });
 
@@ -128,33 +371,258 @@ static void render(Scene *scene, const std::string &filename) {
         nanogui::shutdown();
     }
 
-    /* Now turn the rendered image block into
-       a properly normalized bitmap */
-    std::unique_ptr<Bitmap> bitmap(result.toBitmap());
+    if (workerCount > 0) {
+        /* Keep the filter weights so that the parts can be merged exactly */
+        result.saveWeightedEXR(outputName, camera->getCropOffset(), camera->getCropSize());
+    } else {
+        /* Now turn the rendered image block (or its crop
+           window) into a properly normalized bitmap */
+        std::unique_ptr<Bitmap> bitmap(result.toBitmap(camera->getCropOffset(), camera->getCropSize()));
+
+        /* Save using the OpenEXR format, either cropped or as the data
+           window of a full-size image */
+        if (camera->hasCropWindow() && dataWindow)
+            bitmap->saveEXR(outputName, camera->getCropOffset(), outputSize);
+        else
+            bitmap->saveEXR(outputName);
+
+        /* Save tonemapped (sRGB) output using the PNG format */
+        bitmap->savePNG(outputName);
+
+        /* Save the feature buffers and the filtered image */
+        if (denoise) {
+            cout << "Denoising .. ";
+            cout.flush();
+            Timer timer;
+            tbb::task_scheduler_init init(threadCount);
+
+            FeatureBuffers features;
+            Denoiser::renderFeatures(scene, 16, features);
+            features.albedo.saveEXR(outputName + "_albedo");
+            features.normal.saveEXR(outputName + "_normal");
+            features.depth.saveEXR(outputName + "_depth");
+
+            std::unique_ptr<Bitmap> denoised(Denoiser().denoise(*bitmap, features));
+            denoised->saveEXR(outputName + "_denoised");
+            denoised->savePNG(outputName + "_denoised");
+            cout << "done. (took " << timer.elapsedString() << ")" << endl;
+        }
+    }
+
+    /* The render is complete, the checkpoint is no longer needed */
+    if (checkpoint)
+        std::remove(checkpointName.c_str());
+}
 
-    /* Determine the filename of the output bitmap */
-    std::string outputName = filename;
-    size_t lastdot = outputName.find_last_of(".");
-    if (lastdot != std::string::npos)
-        outputName.erase(lastdot, std::string::npos);
+/**
+ * \brief Render jobs read from the standard input with a resident scene
+ *
+ * Every line describes one job as a list of key=value pairs, e.g.
+ *
+ *   output=shot01.exr width=640 height=360 spp=64 fov=40 origin=0,1,5 target=0,0,0 up=0,1,0
+ *
+ * Besides the output path, a job may set the resolution (width, height), the
+ * field of view and clipping planes (fov, nearClip, farClip), the camera
+ * placement (origin, target, up), the number of samples per pixel (spp) and
+ * the sampler seed (seed) and the crop window (crop=x,y,width,height or
+ * crop=none). Parameters persist for subsequent jobs. After each
+ * job, a line "done <output>" or "error <message>" is written to the
+ * standard output. The server exits at the end of the input or on "quit".
+ *
+ * The standard output only carries these protocol lines (and "ready" once
+ * the scene is loaded), the progress of the renders goes to the standard
+ * error instead.
+ */
+static void serve(Scene *scene) {
+    Camera *camera = scene->getCamera();
+    Sampler *sampler = scene->getSampler();
+
+    /* Keep the TBB worker threads alive across jobs */
+    tbb::task_scheduler_init init(threadCount);
+
+    /* Redirect the progress output, so that a client can parse the standard output line by line */
+    std::ostream protocol(cout.rdbuf());
+    cout.rdbuf(cerr.rdbuf());
+
+    protocol << "ready" << endl;
+
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        std::istringstream tokens(line);
+        std::string token, output;
+        PropertyList cameraOverrides;
+        std::string origin, target, up;
+        size_t sampleCount = sampler->getSampleCount();
+        uint64_t seed = sampler->getSeed();
+
+        if (!(tokens >> token) || token[0] == '#')
+            continue;
+        if (token == "quit" || token == "exit")
+            break;
+
+        try {
+            do {
+                size_t pos = token.find('=');
+                if (pos == std::string::npos)
+                    throw NoriException("Expected key=value, got \"%s\"", token);
+                std::string key = token.substr(0, pos), value = token.substr(pos + 1);
+
+                if (key == "output")
+                    output = value;
+                else if (key == "spp")
+                    sampleCount = (size_t) toUInt(value);
+                else if (key == "seed")
+                    seed = (uint64_t) toUInt(value);
+                else if (key == "width" || key == "height")
+                    cameraOverrides.setInteger(key, toInt(value));
+                else if (key == "fov" || key == "nearClip" || key == "farClip")
+                    cameraOverrides.setFloat(key, toFloat(value));
+                else if (key == "crop")
+                    parseCropWindow(value, cameraOverrides);
+                else if (key == "origin")
+                    origin = value;
+                else if (key == "target")
+                    target = value;
+                else if (key == "up")
+                    up = value;
+                else
+                    throw NoriException("Unknown job parameter \"%s\"", key);
+            } while (tokens >> token);
+
+            if (output.empty())
+                throw NoriException("The job does not specify an output path");
+
+            if (!origin.empty() || !target.empty() || !up.empty()) {
+                if (origin.empty() || target.empty() || up.empty())
+                    throw NoriException("The camera placement requires origin, target and up");
+
+                /* Same convention as the <lookat> transform of the scene description */
+                Vector3f o = toVector3f(origin);
+                Vector3f dir = (toVector3f(target) - o).normalized();
+                Vector3f left = toVector3f(up).normalized().cross(dir).normalized();
+                Vector3f newUp = dir.cross(left).normalized();
+
+                Eigen::Matrix4f trafo;
+                trafo << left, newUp, dir, o,
+                          0, 0, 0, 1;
+                cameraOverrides.setTransform("toWorld", Transform(trafo));
+            }
+
+            if (sampleCount == 0)
+                throw NoriException("The sample count must be positive");
+
+            /* The camera validates its parameters first, a rejected job changes nothing */
+            camera->applyOverrides(cameraOverrides);
+            sampler->setSampleCount(sampleCount);
+            sampler->setSeed(seed);
+            render(scene, output);
+
+            protocol << "done " << output << endl;
+        } catch (const std::exception &e) {
+            protocol << "error " << e.what() << endl;
+        }
+    }
 
-    /* Save using the OpenEXR format */
-    bitmap->saveEXR(outputName);
+    cout.rdbuf(protocol.rdbuf());
+}
+
+/**
+ * \brief Combine the weighted partial images written by distributed workers
+ *
+ * The output is cropped to the crop window the workers rendered, and stored
+ * as the data window of a full-size image when requested (--data-window)
+ */
+static void merge(const std::string &outputName, const std::vector<std::string> &partNames) {
+    Vector2i size;
+    {
+        Bitmap first(partNames[0]);
+        size = Vector2i((int) first.cols(), (int) first.rows());
+    }
+
+    Point2i cropOffset;
+    Vector2i cropSize;
+    ImageBlock::loadWeightedEXRCropWindow(partNames[0], cropOffset, cropSize);
+
+    ImageBlock result(size, nullptr);
+    result.clear();
+    for (const std::string &partName : partNames) {
+        Point2i partOffset;
+        Vector2i partSize;
+        ImageBlock::loadWeightedEXRCropWindow(partName, partOffset, partSize);
+        if (partOffset != cropOffset || partSize != cropSize)
+            throw NoriException("The crop window of \"%s\" differs from the one of \"%s\"!", partName, partNames[0]);
+        result.addWeightedEXR(partName);
+    }
 
-    /* Save tonemapped (sRGB) output using the PNG format */
+    std::unique_ptr<Bitmap> bitmap(result.toBitmap(cropOffset, cropSize));
+    if (cropSize != size && dataWindow)
+        bitmap->saveEXR(outputName, cropOffset, size);
+    else
+        bitmap->saveEXR(outputName);
     bitmap->savePNG(outputName);
 }
 
+/// Render a scene using several local worker processes and merge their results
+static void distribute(const std::string &executable, const std::string &sceneName, int count) {
+    int threadsPerWorker = threadCount > 0 ? threadCount
+        : std::max(1, (int) std::thread::hardware_concurrency() / count);
+
+    cout << "Rendering with " << count << " worker processes .. " << endl;
+    Timer timer;
+
+    std::vector<std::thread> workers;
+    std::vector<int> status(count, 0);
+    for (int i = 0; i < count; ++i) {
+        std::string command = tfm::format("\"%s\" \"%s\" --no-gui --threads %i --worker %i/%i --split %s",
+            executable, sceneName, threadsPerWorker, i, count, splitSamples ? "samples" : "tiles");
+        if (checkpointInterval > 0)
+            command += tfm::format(" --checkpoint %f", checkpointInterval);
+        if (resume)
+            command += " --resume";
+        if (cropWindow != "")
+            command += " --crop " + cropWindow;
+        if (dataWindow)
+            command += " --data-window";
+#if defined(PLATFORM_WINDOWS)
+        /* cmd.exe strips the outermost pair of quotes */
+        command = "\"" + command + "\"";
+#endif
+        workers.emplace_back([&status, i, command] { status[i] = std::system(command.c_str()); });
+    }
+    for (auto &worker : workers)
+        worker.join();
+
+    std::string outputName = getOutputName(sceneName);
+    std::vector<std::string> partNames;
+    for (int i = 0; i < count; ++i) {
+        if (status[i] != 0)
+            throw NoriException("Worker %i/%i failed with exit status %i!", i, count, status[i]);
+        partNames.push_back(tfm::format("%s.part%i.exr", outputName, i));
+    }
+
+    merge(outputName, partNames);
+    for (const std::string &partName : partNames)
+        std::remove(partName.c_str());
+
+    cout << "done. (took " << timer.elapsedString() << ")" << endl;
+}
+
 int main(int argc, char **argv) {
     google::InitGoogleLogging("SuperNori");
     google::SetStderrLogging(google::GLOG_INFO);
     if (argc < 2) {
-        LOG(ERROR) << "Syntax: " << argv[0] << " <scene.xml> [--no-gui] [--threads N]" <<  endl;
+        LOG(ERROR) << "Syntax: " << argv[0] << " <scene.xml> [--no-gui] [--threads N] [--checkpoint SECONDS] [--resume]"
+                   << " [--worker I/N | --distribute N] [--split tiles|samples] [--server]"
+                   << " [--crop X,Y,WIDTH,HEIGHT] [--data-window] [--numa] [--numa-replicate] [--denoise]" << endl;
+        LOG(ERROR) << "       " << argv[0] << " --merge <output> <part0.exr> <part1.exr> .." << endl;
         return -1;
     }
 
     std::string sceneName = "";
     std::string exrName = "";
+    std::string mergeName = "";
+    std::vector<std::string> partNames;
+    int distributeCount = 0;
 
     for (int i = 1; i < argc; ++i) {
         std::string token(argv[i]);
@@ -176,6 +644,84 @@ int main(int argc, char **argv) {
             gui = false;
             continue;
         }
+        else if (token == "--checkpoint") {
+            if (i+1 >= argc || (checkpointInterval = (float) atof(argv[i+1])) <= 0) {
+                LOG(ERROR) << "\"--checkpoint\" argument expects a positive interval in seconds following it." << endl;
+                return -1;
+            }
+            i++;
+            continue;
+        }
+        else if (token == "--crop") {
+            if (i+1 >= argc) {
+                LOG(ERROR) << "\"--crop\" argument expects a window X,Y,WIDTH,HEIGHT following it." << endl;
+                return -1;
+            }
+            cropWindow = argv[i+1];
+            i++;
+            continue;
+        }
+        else if (token == "--data-window") {
+            dataWindow = true;
+            continue;
+        }
+        else if (token == "--numa") {
+            numa = true;
+            continue;
+        }
+        else if (token == "--numa-replicate") {
+            numa = numaReplicate = true;
+            continue;
+        }
+        else if (token == "--denoise") {
+            denoise = true;
+            continue;
+        }
+        else if (token == "--server") {
+            server = true;
+            gui = false;
+            continue;
+        }
+        else if (token == "--resume") {
+            resume = true;
+            continue;
+        }
+        else if (token == "--worker") {
+            if (i+1 >= argc || sscanf(argv[i+1], "%i/%i", &workerIndex, &workerCount) != 2 ||
+                workerCount <= 0 || workerIndex < 0 || workerIndex >= workerCount) {
+                LOG(ERROR) << "\"--worker\" argument expects an index and a worker count (e.g. 0/4) following it." << endl;
+                return -1;
+            }
+            i++;
+            continue;
+        }
+        else if (token == "--distribute") {
+            if (i+1 >= argc || (distributeCount = atoi(argv[i+1])) <= 0) {
+                LOG(ERROR) << "\"--distribute\" argument expects a positive number of workers following it." << endl;
+                return -1;
+            }
+            i++;
+            continue;
+        }
+        else if (token == "--split") {
+            std::string mode = i+1 < argc ? argv[i+1] : "";
+            if (mode != "tiles" && mode != "samples") {
+                LOG(ERROR) << "\"--split\" argument expects \"tiles\" or \"samples\" following it." << endl;
+                return -1;
+            }
+            splitSamples = mode == "samples";
+            i++;
+            continue;
+        }
+        else if (token == "--merge") {
+            if (i+1 >= argc) {
+                LOG(ERROR) << "\"--merge\" argument expects the name of the output image following it." << endl;
+                return -1;
+            }
+            mergeName = getOutputName(argv[i+1]);
+            i++;
+            continue;
+        }
 
         filesystem::path path(argv[i]);
 
@@ -190,6 +736,7 @@ int main(int argc, char **argv) {
             } else if (path.extension() == "exr") {
                 /* Alternatively, provide a basic OpenEXR image viewer */
                 exrName = argv[i];
+                partNames.push_back(argv[i]);
             } else {
                 LOG(ERROR) << "Fatal error: unknown file \"" << argv[i]
                            << "\", expected an extension of type .xml or .exr" << endl;
@@ -200,7 +747,26 @@ int main(int argc, char **argv) {
         }
     }
 
-    if (exrName !="" && sceneName !="") {
+    /* The denoiser needs the complete image and the scene for its feature
+       buffers, which neither the workers nor the merge step have */
+    if (denoise && (distributeCount > 0 || workerCount > 0 || mergeName != "")) {
+        LOG(ERROR) << "\"--denoise\" cannot be combined with distributed rendering (--distribute, --worker, --merge)." << endl;
+        return -1;
+    }
+
+    if (mergeName != "") {
+        if (partNames.empty()) {
+            LOG(ERROR) << "\"--merge\" expects the partial .exr files written by the workers." << endl;
+            return -1;
+        }
+        try {
+            merge(mergeName, partNames);
+        } catch (const std::exception &e) {
+            LOG(ERROR) << e.what() << endl;
+            return -1;
+        }
+    }
+    else if (exrName !="" && sceneName !="") {
         LOG(ERROR) << "Both .xml and .exr files were provided. Please only provide one of them." << endl;
         return -1;
     }
@@ -228,14 +794,32 @@ int main(int argc, char **argv) {
         }
     }
     else { // sceneName != ""
-        if (threadCount < 0) {
-            threadCount = tbb::task_scheduler_init::automatic;
-        }
         try {
+            if (distributeCount > 0) {
+                /* Launch the workers instead of rendering in this process */
+                distribute(argv[0], sceneName, distributeCount);
+                google::ShutdownGoogleLogging();
+                return 0;
+            }
+            if (threadCount < 0) {
+                threadCount = tbb::task_scheduler_init::automatic;
+            }
             std::unique_ptr<NoriObject> root(loadFromXML(sceneName));
             /* When the XML root object is a scene, start rendering it .. */
-            if (root->getClassType() == NoriObject::EScene)
-                render(static_cast<Scene *>(root.get()), sceneName);
+            if (root->getClassType() == NoriObject::EScene) {
+                Scene *scene = static_cast<Scene *>(root.get());
+                if (cropWindow != "") {
+                    /* The command line overrides the crop window of the scene description */
+                    PropertyList cropOverrides;
+                    parseCropWindow(cropWindow, cropOverrides);
+                    scene->getCamera()->applyOverrides(cropOverrides);
+                }
+
+                if (server)
+                    serve(scene);
+                else
+                    render(scene, sceneName);
+            }
         } catch (const std::exception &e) {
             LOG(ERROR) << e.what() << endl;
             return -1;
@@ -451,7 +451,7 @@ bool BvhAccel::rayIntersect(const Ray3f &ray_, Intersection &its, bool shadowRay
                     if (shadowRay)
                         return true;
                     ray.maxt = its.t = t;
-                    its.uv = Point2f(u, v);
+                    its.barycentric = Point2f(u, v);
                     its.mesh = mesh;
                     f = idx;
                     foundIntersection = true;
@@ -78,6 +78,10 @@ HLBVHAccel::HLBVHAccel(const PropertyList & propList) :
 HLBVHAccel::~HLBVHAccel()
 {
     delete[] m_pNodes;
+    for (LinearBVHNode * pNodeReplica : m_pNodeReplicas)
+    {
+        delete[] pNodeReplica;
+    }
 }
 
 void HLBVHAccel::build()
@@ -212,8 +216,19 @@ bool HLBVHAccel::rayIntersect(const Ray3f & ray, Intersection & its, bool bShado
         return false;
     }
 
+    /* Traverse the copy on the NUMA node of the calling thread, if there is one */
+    const LinearBVHNode * pNodes = m_pNodes;
+    PrimitiveShape * const * pShapes = m_pShapes.data();
+    int iNumaNode = NumaTopology::getCurrentNode();
+    if (iNumaNode >= 0 && iNumaNode < NORI_MAX_NUMA_NODES && m_pNodeReplicas[iNumaNode] != nullptr)
+    {
+        pNodes = m_pNodeReplicas[iNumaNode];
+        pShapes = m_shapeReplicas[iNumaNode].data();
+    }
+
     bool bFoundIntersection = false;       // Was an intersection found so far?
     PrimitiveShape * pFoundShape = nullptr;
+    Point2f foundBarycentric;              // The traversal only tracks a compact hit
 
     Ray3f rayCopy(ray);
     bool bDirNeg[3] = {rayCopy.dRcp.x() < 0, rayCopy.dRcp.y() < 0, rayCopy.dRcp.z() < 0 };
@@ -223,7 +238,7 @@ bool HLBVHAccel::rayIntersect(const Ray3f & ray, Intersection & its, bool bShado
 
     while (true)
     {
-        const LinearBVHNode * pLinearNode = &m_pNodes[iCurrentNodeIndex];
+        const LinearBVHNode * pLinearNode = &pNodes[iCurrentNodeIndex];
 
         if (pLinearNode->bBox.rayIntersect(rayCopy))
         {
@@ -233,7 +248,7 @@ bool HLBVHAccel::rayIntersect(const Ray3f & ray, Intersection & its, bool bShado
                 for (uint32_t i = 0; i < pLinearNode->nShape; i++)
                 {
                     float U, V, T;
-                    PrimitiveShape * pShape = m_pShapes[pLinearNode->nShapeOffset + i];
+                    PrimitiveShape * pShape = pShapes[pLinearNode->nShapeOffset + i];
                     if (pShape->rayIntersect(rayCopy, U, V, T))
                     {
                         if (bShadowRay)
@@ -241,10 +256,8 @@ bool HLBVHAccel::rayIntersect(const Ray3f & ray, Intersection & its, bool bShado
                             return true;
                         }
 
-                        rayCopy.maxt = its.t = T;
-                        its.uv = Point2f(U, V);
-                        its.pShape = pShape;
-
+                        rayCopy.maxt = T;
+                        foundBarycentric = Point2f(U, V);
                         pFoundShape = pShape;
                         bFoundIntersection = true;
                     }
@@ -284,13 +297,35 @@ bool HLBVHAccel::rayIntersect(const Ray3f & ray, Intersection & its, bool bShado
 
     if (bFoundIntersection)
     {
+        its.t = rayCopy.maxt;
+        its.barycentric = foundBarycentric;
+        its.pShape = pFoundShape;
         pFoundShape->postIntersect(its);
-        its.computeScreenSpacePartial(ray);
+        its.setRayDifferentials(ray);
     }
 
     return bFoundIntersection;
 }
 
+void HLBVHAccel::replicateForNode(int node)
+{
+    if (node < 0 || node >= NORI_MAX_NUMA_NODES)
+    {
+        throw NoriException("HLBVHAccel::replicateForNode(): invalid NUMA node %i!", node);
+    }
+
+    if (m_pNodes == nullptr || m_pNodeReplicas[node] != nullptr)
+    {
+        return;
+    }
+
+    /* The copies are written (and thus first touched) by the calling thread */
+    LinearBVHNode * pNodeReplica = new LinearBVHNode[m_nNodes];
+    std::copy(m_pNodes, m_pNodes + m_nNodes, pNodeReplica);
+    m_shapeReplicas[node] = m_pShapes;
+    m_pNodeReplicas[node] = pNodeReplica;
+}
+
 std::string HLBVHAccel::toString() const
 {
     return tfm::format(
@@ -8,6 +8,8 @@
 #include <nori/core/texture.h>
 #include <nori/core/frame.h>
 #include <nori/core/bsdfQueryRecord.h>
+#include <nori/core/bsdfQueryBatch.h>
+#include <nori/core/ray.h>
 
 NORI_NAMESPACE_BEGIN
 
@@ -115,6 +117,130 @@ Color3f DielectricBSDF::sample(BSDFQueryRecord &bRec, const Point2f &sample) con
     }
 }
 
+void DielectricBSDF::propagateDifferentials(const BSDFQueryRecord &bRec, const Ray3f &incident, Ray3f &scattered) const
+{
+    if (!incident.bHasDifferentials || bRec.measure != EMeasure::EDiscrete)
+    {
+        scattered.bHasDifferentials = false;
+        return;
+    }
+
+    if (Frame::cosTheta(bRec.wi) * Frame::cosTheta(bRec.wo) > 0.0f)
+    {
+        reflectDifferentials(bRec, incident, scattered);
+    }
+    else
+    {
+        refractDifferentials(bRec, incident, scattered);
+    }
+}
+
+void DielectricBSDF::evalBatch(const BSDFQueryBatch & batch, Color3fBatch & result) const
+{
+    FloatBatch fresnel, cosThetaT;
+    MaskBatch reflected, refracted;
+    getSpecularLanes(batch, fresnel, cosThetaT, reflected, refracted);
+
+    Color3fBatch reflectance = evalTextureBatch(m_pKsReflect.get(), batch);
+    Color3fBatch transmittance = evalTextureBatch(m_pKsRefract.get(), batch);
+    reflectance.colwise() *= fresnel;
+    if (batch.mode == ETransportMode::ERadiance)
+    {
+        FloatBatch factor = (cosThetaT < 0.0f).select(FloatBatch::Constant(fresnel.size(), m_invEta), m_eta);
+        transmittance.colwise() *= factor.square() * (1.0f - fresnel);
+    }
+    else
+    {
+        transmittance.colwise() *= 1.0f - fresnel;
+    }
+
+    result.resize(fresnel.size(), 3);
+    for (Eigen::Index i = 0; i < 3; i++)
+    {
+        result.col(i) = reflected.select(reflectance.col(i), refracted.select(transmittance.col(i), 0.0f));
+    }
+}
+
+void DielectricBSDF::pdfBatch(const BSDFQueryBatch & batch, FloatBatch & result) const
+{
+    FloatBatch fresnel, cosThetaT;
+    MaskBatch reflected, refracted;
+    getSpecularLanes(batch, fresnel, cosThetaT, reflected, refracted);
+
+    result = reflected.select(fresnel, refracted.select(1.0f - fresnel, 0.0f));
+}
+
+void DielectricBSDF::sampleBatch(BSDFQueryBatch & batch, const Point2fBatch & sample, Color3fBatch & result) const
+{
+    Eigen::Index size = Eigen::Index(batch.size());
+    batch.measure = EMeasure::EDiscrete;
+
+    FloatBatch cosThetaI = batch.wi.col(2);
+    FloatBatch fresnel, cosThetaT;
+    fresnelDielectricBatch(cosThetaI, m_eta, m_invEta, fresnel, cosThetaT);
+
+    MaskBatch reflect = sample.col(0) < fresnel;
+    MaskBatch exiting = cosThetaT < 0.0f;
+
+    /* See reflect() and refract() */
+    FloatBatch scale = exiting.select(FloatBatch::Constant(size, -m_invEta), -m_eta);
+    batch.wo.col(0) = reflect.select(-batch.wi.col(0), scale * batch.wi.col(0));
+    batch.wo.col(1) = reflect.select(-batch.wi.col(1), scale * batch.wi.col(1));
+    batch.wo.col(2) = reflect.select(cosThetaI, cosThetaT);
+    batch.eta = reflect.select(1.0f, exiting.select(FloatBatch::Constant(size, m_eta), m_invEta));
+
+    Color3fBatch reflectance = evalTextureBatch(m_pKsReflect.get(), batch);
+    Color3fBatch transmittance = evalTextureBatch(m_pKsRefract.get(), batch);
+
+    /* Radiance must be scaled to account for the solid angle compression
+    that occurs when crossing the interface. */
+    if (batch.mode == ETransportMode::ERadiance)
+    {
+        transmittance.colwise() *= exiting.select(FloatBatch::Constant(size, m_invEta), m_eta).square();
+    }
+
+    result.resize(size, 3);
+    for (Eigen::Index i = 0; i < 3; i++)
+    {
+        result.col(i) = reflect.select(reflectance.col(i), transmittance.col(i));
+    }
+}
+
+Color3fBatch DielectricBSDF::evalTextureBatch(const Texture * pTexture, const BSDFQueryBatch & batch)
+{
+    /* Textures are not vectorized, they are looked up lane by lane */
+    Color3fBatch values(Eigen::Index(batch.size()), 3);
+    for (size_t lane = 0; lane < batch.size(); lane++)
+    {
+        Color3f value = pTexture->eval(batch.getIntersection(lane));
+        values.row(Eigen::Index(lane)) << value.r(), value.g(), value.b();
+    }
+    return values;
+}
+
+void DielectricBSDF::getSpecularLanes(const BSDFQueryBatch & batch, FloatBatch & fresnel, FloatBatch & cosThetaT,
+                                      MaskBatch & reflected, MaskBatch & refracted) const
+{
+    Eigen::Index size = Eigen::Index(batch.size());
+    FloatBatch cosThetaI = batch.wi.col(2);
+    FloatBatch cosThetaO = batch.wo.col(2);
+    fresnelDielectricBatch(cosThetaI, m_eta, m_invEta, fresnel, cosThetaT);
+
+    /* Dot products of the outgoing directions with reflect(wi) and refract(wi), see eval() */
+    FloatBatch reflectDot = -batch.wi.col(0) * batch.wo.col(0) - batch.wi.col(1) * batch.wo.col(1) + cosThetaI * cosThetaO;
+    FloatBatch scale = (cosThetaT < 0.0f).select(FloatBatch::Constant(size, -m_invEta), -m_eta);
+    FloatBatch refractDot = scale * (batch.wi.col(0) * batch.wo.col(0) + batch.wi.col(1) * batch.wo.col(1)) + cosThetaT * cosThetaO;
+
+    MaskBatch sameSide = cosThetaI * cosThetaO >= 0.0f;
+    reflected = sameSide && (reflectDot - 1.0f).abs() <= DeltaEpsilon;
+    refracted = !sameSide && (refractDot - 1.0f).abs() <= DeltaEpsilon;
+}
+
+bool DielectricBSDF::usesRayDifferentials() const
+{
+    return m_pKsReflect->usesRayDifferentials() || m_pKsRefract->usesRayDifferentials();
+}
+
 std::string DielectricBSDF::toString() const
 {
     return tfm::format(
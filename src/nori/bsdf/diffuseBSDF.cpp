@@ -8,7 +8,9 @@
 #include <nori/core/frame.h>
 #include <nori/core/warp.h>
 #include <nori/core/bsdfQueryRecord.h>
+#include <nori/core/bsdfQueryBatch.h>
 #include <nori/core/texture.h>
+#include <nori/core/memoryHelper.h>
 
 NORI_NAMESPACE_BEGIN
 
@@ -28,7 +30,7 @@ Color3f DiffuseBSDF::eval(const BSDFQueryRecord &bRec) const
         return Color3f(0.0f);
 
     /* The BRDF is simply the albedo / pi */
-    return m_pAlbedo->eval(bRec.its) * INV_PI;
+    return getAlbedoParameter(bRec.its) * INV_PI;
 }
 
 /// Compute the density of \ref sample() wrt. solid angles
@@ -68,7 +70,41 @@ Color3f DiffuseBSDF::sample(BSDFQueryRecord &bRec, const Point2f &sample) const
 
     /* eval() / pdf() * cos(theta) = albedo. There
        is no need to call these functions. */
-    return m_pAlbedo->eval(bRec.its);
+    return getAlbedoParameter(bRec.its);
+}
+
+void DiffuseBSDF::evalBatch(const BSDFQueryBatch & batch, Color3fBatch & result) const
+{
+    if (batch.measure != ESolidAngle)
+    {
+        result.setZero(Eigen::Index(batch.size()), 3);
+        return;
+    }
+
+    result = getAlbedoBatch(batch) * INV_PI;
+    maskLanes(result, batch.wi.col(2) > 0.0f && batch.wo.col(2) > 0.0f);
+}
+
+void DiffuseBSDF::pdfBatch(const BSDFQueryBatch & batch, FloatBatch & result) const
+{
+    if (batch.measure != ESolidAngle)
+    {
+        result.setZero(Eigen::Index(batch.size()));
+        return;
+    }
+
+    result = INV_PI * batch.wo.col(2);
+    maskLanes(result, batch.wi.col(2) > 0.0f && batch.wo.col(2) > 0.0f);
+}
+
+void DiffuseBSDF::sampleBatch(BSDFQueryBatch & batch, const Point2fBatch & sample, Color3fBatch & result) const
+{
+    batch.measure = ESolidAngle;
+    batch.wo = Warp::squareToCosineHemisphereBatch(sample);
+    batch.eta.setOnes(Eigen::Index(batch.size()));
+
+    result = getAlbedoBatch(batch);
+    maskLanes(result, batch.wi.col(2) > 0.0f);
 }
 
 bool DiffuseBSDF::isDiffuse() const
@@ -76,6 +112,45 @@ bool DiffuseBSDF::isDiffuse() const
     return true;
 }
 
+bool DiffuseBSDF::usesRayDifferentials() const
+{
+    return m_pAlbedo->usesRayDifferentials();
+}
+
+void DiffuseBSDF::prepare(Intersection & its, MemoryArena & arena) const
+{
+    Color3f * pAlbedo = arena.alloc<Color3f>(1, false);
+    *pAlbedo = m_pAlbedo->eval(its);
+    its.pBSDFParams = pAlbedo;
+}
+
+Color3f DiffuseBSDF::getAlbedo(const Intersection & its) const
+{
+    return getAlbedoParameter(its);
+}
+
+Color3f DiffuseBSDF::getAlbedoParameter(const Intersection & its) const
+{
+    /* The albedo is the only parameter, see prepare() */
+    if (its.pBSDFParams != nullptr)
+    {
+        return *static_cast<const Color3f *>(its.pBSDFParams);
+    }
+    return m_pAlbedo->eval(its);
+}
+
+Color3fBatch DiffuseBSDF::getAlbedoBatch(const BSDFQueryBatch & batch) const
+{
+    /* Textures are not vectorized, they are looked up lane by lane */
+    Color3fBatch albedo(Eigen::Index(batch.size()), 3);
+    for (size_t lane = 0; lane < batch.size(); lane++)
+    {
+        Color3f value = getAlbedoParameter(batch.getIntersection(lane));
+        albedo.row(Eigen::Index(lane)) << value.r(), value.g(), value.b();
+    }
+    return albedo;
+}
+
 /// Return a human-readable summary
 std::string DiffuseBSDF::toString() const
 {
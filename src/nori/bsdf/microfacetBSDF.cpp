@@ -9,9 +9,29 @@
 #include <nori/core/warp.h>
 #include <nori/core/texture.h>
 #include <nori/core/bsdfQueryRecord.h>
+#include <nori/core/bsdfQueryBatch.h>
+#include <nori/core/memoryHelper.h>
 
 NORI_NAMESPACE_BEGIN
 
+namespace
+{
+    /// Normalized half vectors of every lane
+    Vector3fBatch halfVectorBatch(const Vector3fBatch & wi, const Vector3fBatch & wo)
+    {
+        Vector3fBatch wh = wi + wo;
+        FloatBatch invLength = wh.square().rowwise().sum().rsqrt();
+        wh.colwise() *= invLength;
+        return wh;
+    }
+
+    /// Dot products of every lane
+    FloatBatch dotBatch(const Vector3fBatch & a, const Vector3fBatch & b)
+    {
+        return (a * b).rowwise().sum();
+    }
+}
+
 MicrofacetBSDF::MicrofacetBSDF(const PropertyList &propList)
 {
     /* RMS surface roughness */
@@ -26,6 +46,24 @@ MicrofacetBSDF::MicrofacetBSDF(const PropertyList &propList)
     /* Albedo of the diffuse base material (a.k.a "kd") */
     m_pKd.reset(new ConstantColor3fTexture(propList.getColor(XML_BSDF_MICROFACET_KD, DEFAULT_BSDF_MICROFACET_ALBEDO)));
 
+    /* Microfacet normal distribution (default: Beckmann) */
+    std::string type = propList.getString(XML_BSDF_MICROFACET_TYPE, DEFAULT_BSDF_MICROFACET_TYPE);
+    if (type == XML_BSDF_BECKMANN)
+    {
+        m_distribution = EDistribution::EBeckmann;
+    }
+    else if (type == XML_BSDF_GGX)
+    {
+        m_distribution = EDistribution::EGGX;
+    }
+    else
+    {
+        throw NoriException("MicrofacetBSDF: unknown microfacet distribution \"%s\"!", type);
+    }
+
+    /* Sample only the normals visible from the incident direction (default: true) */
+    m_bSampleVisible = propList.getBoolean(XML_BSDF_MICROFACET_SAMPLE_VISIBLE, DEFAULT_BSDF_MICROFACET_SAMPLE_VISIBLE);
+
     /* To ensure energy conservation, we must scale the
        specular component by 1-kd.
 
@@ -38,6 +76,23 @@ MicrofacetBSDF::MicrofacetBSDF(const PropertyList &propList)
     m_invEta = 1.0f / m_eta;
 }
 
+void MicrofacetBSDF::prepare(Intersection & its, MemoryArena & arena) const
+{
+    Parameters * pParams = arena.alloc<Parameters>(1, false);
+    pParams->alpha = clamp(m_pAlpha->eval(its)[0], float(MIN_ALPHA), float(MAX_ALPHA));
+    pParams->kd = m_pKd->eval(its);
+    its.pBSDFParams = pParams;
+}
+
+MicrofacetBSDF::Parameters MicrofacetBSDF::getParameters(const Intersection & its) const
+{
+    if (its.pBSDFParams != nullptr)
+    {
+        return *static_cast<const Parameters *>(its.pBSDFParams);
+    }
+    return { clamp(m_pAlpha->eval(its)[0], float(MIN_ALPHA), float(MAX_ALPHA)), m_pKd->eval(its) };
+}
+
 /// Evaluate the BRDF for the given pair of directions
 Color3f MicrofacetBSDF::eval(const BSDFQueryRecord &bRec) const
 {
@@ -49,8 +104,9 @@ Color3f MicrofacetBSDF::eval(const BSDFQueryRecord &bRec) const
         return Color3f(0.0f);
     }
 
-    float alpha = clamp(m_pAlpha->eval(bRec.its)[0], float(MIN_ALPHA), float(MAX_ALPHA));
-    Color3f kd = m_pKd->eval(bRec.its);
+    Parameters params = getParameters(bRec.its);
+    float alpha = params.alpha;
+    Color3f kd = params.kd;
 
     /*
     To ensure energy conservation, we must scale the
@@ -66,9 +122,9 @@ Color3f MicrofacetBSDF::eval(const BSDFQueryRecord &bRec) const
 
     float CosThetaT;
 
-    float D = beckmannD(wh, alpha);
+    float D = distribution(wh, alpha);
     float F = fresnelDielectric(wh.dot(bRec.wi), m_eta, m_invEta, CosThetaT);
-    float G = smithBeckmannG1(bRec.wi, wh, alpha) * smithBeckmannG1(bRec.wo, wh, alpha);
+    float G = smithG1(bRec.wi, wh, alpha) * smithG1(bRec.wo, wh, alpha);
 
     Color3f specularTerm = ks * F * D * G / (4.0f * Frame::cosTheta(bRec.wi) * Frame::cosTheta(bRec.wo));
     if (!specularTerm.isValid())
@@ -91,8 +147,9 @@ float MicrofacetBSDF::pdf(const BSDFQueryRecord &bRec) const
         return 0.0f;
     }
 
-    float alpha = clamp(m_pAlpha->eval(bRec.its)[0], float(MIN_ALPHA), float(MAX_ALPHA));
-    Color3f kd = m_pKd->eval(bRec.its);
+    Parameters params = getParameters(bRec.its);
+    float alpha = params.alpha;
+    Color3f kd = params.kd;
 
     /*
     To ensure energy conservation, we must scale the
@@ -106,7 +163,7 @@ float MicrofacetBSDF::pdf(const BSDFQueryRecord &bRec) const
 
     Vector3f wh = (bRec.wi + bRec.wo).normalized();
     float J = 0.25f / wh.dot(bRec.wo);
-    float specularPdf = ks * Warp::squareToBeckmannPdf(wh, alpha) * J;
+    float specularPdf = ks * pdfNormal(bRec.wi, wh, alpha) * J;
     float diffusePdf = (1.0f - ks) * Warp::squareToCosineHemispherePdf(bRec.wo);
     return specularPdf + diffusePdf;
 }
@@ -121,8 +178,9 @@ Color3f MicrofacetBSDF::sample(BSDFQueryRecord &bRec, const Point2f &_sample) co
 
     bRec.measure = EMeasure::ESolidAngle;
 
-    float alpha = clamp(m_pAlpha->eval(bRec.its)[0], float(MIN_ALPHA), float(MAX_ALPHA));
-    Color3f kd = m_pKd->eval(bRec.its);
+    Parameters params = getParameters(bRec.its);
+    float alpha = params.alpha;
+    Color3f kd = params.kd;
 
     /*
     To ensure energy conservation, we must scale the
@@ -138,7 +196,7 @@ Color3f MicrofacetBSDF::sample(BSDFQueryRecord &bRec, const Point2f &_sample) co
     {
         // Specular reflection
         float reuseSampleX = _sample.x() / ks;
-        Normal3f wh = Warp::squareToBeckmann(Point2f(reuseSampleX, _sample.y()), alpha);
+        Normal3f wh = sampleNormal(bRec.wi, Point2f(reuseSampleX, _sample.y()), alpha);
         bRec.wo = 2.0f * wh.dot(bRec.wi) * wh - bRec.wi;
     }
     else
@@ -159,9 +217,9 @@ Color3f MicrofacetBSDF::sample(BSDFQueryRecord &bRec, const Point2f &_sample) co
     float cosThetaT;
     Vector3f wh = (bRec.wi + bRec.wo).normalized();
 
-    float D = beckmannD(wh, alpha);
+    float D = distribution(wh, alpha);
     float F = fresnelDielectric(wh.dot(bRec.wi), m_eta, m_invEta, cosThetaT);
-    float G = smithBeckmannG1(bRec.wi, wh, alpha) * smithBeckmannG1(bRec.wo, wh, alpha);
+    float G = smithG1(bRec.wi, wh, alpha) * smithG1(bRec.wo, wh, alpha);
 
     Color3f specularTerm = ks * F * D * G / (4.0f * Frame::cosTheta(bRec.wi) * Frame::cosTheta(bRec.wo));
     if (!specularTerm.isValid())
@@ -174,6 +232,74 @@ Color3f MicrofacetBSDF::sample(BSDFQueryRecord &bRec, const Point2f &_sample) co
     return (specularTerm + diffuseTerm) * Frame::cosTheta(bRec.wo) / PDF;
 }
 
+void MicrofacetBSDF::evalBatch(const BSDFQueryBatch & batch, Color3fBatch & result) const
+{
+    if (batch.measure != EMeasure::ESolidAngle)
+    {
+        result.setZero(Eigen::Index(batch.size()), 3);
+        return;
+    }
+
+    FloatBatch alpha;
+    Color3fBatch kd;
+    getParameterBatch(batch, alpha, kd);
+    FloatBatch ks = 1.0f - kd.rowwise().maxCoeff();
+
+    result = evalKernel(batch.wi, batch.wo, alpha, kd, ks);
+    maskLanes(result, batch.wi.col(2) > 0.0f && batch.wo.col(2) > 0.0f);
+}
+
+void MicrofacetBSDF::pdfBatch(const BSDFQueryBatch & batch, FloatBatch & result) const
+{
+    if (batch.measure != EMeasure::ESolidAngle)
+    {
+        result.setZero(Eigen::Index(batch.size()));
+        return;
+    }
+
+    FloatBatch alpha;
+    Color3fBatch kd;
+    getParameterBatch(batch, alpha, kd);
+    FloatBatch ks = 1.0f - kd.rowwise().maxCoeff();
+
+    result = pdfKernel(batch.wi, batch.wo, alpha, ks);
+    maskLanes(result, batch.wi.col(2) > 0.0f && batch.wo.col(2) > 0.0f);
+}
+
+void MicrofacetBSDF::sampleBatch(BSDFQueryBatch & batch, const Point2fBatch & sample, Color3fBatch & result) const
+{
+    Eigen::Index size = Eigen::Index(batch.size());
+    batch.measure = EMeasure::ESolidAngle;
+    batch.eta.setOnes(size);
+
+    FloatBatch alpha;
+    Color3fBatch kd;
+    getParameterBatch(batch, alpha, kd);
+    FloatBatch ks = 1.0f - kd.rowwise().maxCoeff();
+
+    /* Both lobes are sampled for every lane and the chosen one is selected afterwards */
+    MaskBatch specular = sample.col(0) < ks;
+
+    Point2fBatch specularSample = sample;
+    specularSample.col(0) = sample.col(0) / ks;
+    Vector3fBatch wh = sampleNormalBatch(batch.wi, specularSample, alpha);
+    Vector3fBatch reflected = wh.colwise() * (2.0f * dotBatch(wh, batch.wi)) - batch.wi;
+
+    Point2fBatch diffuseSample = sample;
+    diffuseSample.col(0) = (sample.col(0) - ks) / (1.0f - ks);
+    Vector3fBatch diffuse = Warp::squareToCosineHemisphereBatch(diffuseSample);
+
+    for (Eigen::Index i = 0; i < 3; i++)
+    {
+        batch.wo.col(i) = specular.select(reflected.col(i), diffuse.col(i));
+    }
+
+    FloatBatch pdf = pdfKernel(batch.wi, batch.wo, alpha, ks);
+    result = evalKernel(batch.wi, batch.wo, alpha, kd, ks);
+    result.colwise() *= batch.wo.col(2) / pdf;
+    maskLanes(result, batch.wi.col(2) > 0.0f && batch.wo.col(2) > 0.0f && pdf != 0.0f);
+}
+
 bool MicrofacetBSDF::isDiffuse() const
 {
     /* While microfacet BRDFs are not perfectly diffuse, they can be
@@ -182,6 +308,18 @@ bool MicrofacetBSDF::isDiffuse() const
     return true;
 }
 
+bool MicrofacetBSDF::usesRayDifferentials() const
+{
+    return m_pAlpha->usesRayDifferentials() || m_pKd->usesRayDifferentials();
+}
+
+Color3f MicrofacetBSDF::getAlbedo(const Intersection & its) const
+{
+    /* Diffuse base plus the specular component, which is scaled by 1 - max(kd) */
+    Color3f kd = getParameters(its).kd;
+    return kd + Color3f(1.0f - kd.maxCoeff());
+}
+
 std::string MicrofacetBSDF::toString() const
 {
     return tfm::format(
@@ -189,12 +327,16 @@ std::string MicrofacetBSDF::toString() const
             "  alpha = %s,\n"
             "  intIOR = %f,\n"
             "  extIOR = %f,\n"
-            "  kd = %s\n"
+            "  kd = %s,\n"
+            "  type = %s,\n"
+            "  sampleVisible = %s\n"
             "]",
             m_pAlpha->isConstant() ? std::to_string(m_pAlpha->getAverage()[0]) : indent(m_pAlpha->toString()),
             m_intIOR,
             m_extIOR,
-            m_pKd->isConstant() ? m_pKd->getAverage().toString() : indent(m_pKd->toString())
+            m_pKd->isConstant() ? m_pKd->getAverage().toString() : indent(m_pKd->toString()),
+            m_distribution == EDistribution::EGGX ? XML_BSDF_GGX : XML_BSDF_BECKMANN,
+            m_bSampleVisible ? "true" : "false"
     );
 }
 
@@ -251,6 +393,34 @@ void MicrofacetBSDF::activate()
     }
 }
 
+float MicrofacetBSDF::distribution(const Normal3f & M, float alpha) const
+{
+    return m_distribution == EDistribution::EGGX ? ggxD(M, alpha) : beckmannD(M, alpha);
+}
+
+float MicrofacetBSDF::smithG1(const Vector3f & V, const Normal3f & M, float alpha) const
+{
+    return m_distribution == EDistribution::EGGX ? smithGGXG1(V, M, alpha) : smithBeckmannG1(V, M, alpha);
+}
+
+Normal3f MicrofacetBSDF::sampleNormal(const Vector3f & wi, const Point2f & sample, float alpha) const
+{
+    if (m_distribution == EDistribution::EGGX)
+    {
+        return m_bSampleVisible ? Warp::squareToGGXVisible(sample, wi, alpha) : Warp::squareToGGX(sample, alpha);
+    }
+    return m_bSampleVisible ? Warp::squareToBeckmannVisible(sample, wi, alpha) : Warp::squareToBeckmann(sample, alpha);
+}
+
+float MicrofacetBSDF::pdfNormal(const Vector3f & wi, const Normal3f & M, float alpha) const
+{
+    if (m_distribution == EDistribution::EGGX)
+    {
+        return m_bSampleVisible ? Warp::squareToGGXVisiblePdf(M, wi, alpha) : Warp::squareToGGXPdf(M, alpha);
+    }
+    return m_bSampleVisible ? Warp::squareToBeckmannVisiblePdf(M, wi, alpha) : Warp::squareToBeckmannPdf(M, alpha);
+}
+
 float MicrofacetBSDF::beckmannD(const Normal3f & M, float alpha)
 {
     float Expon = Frame::tanTheta(M) / alpha;
@@ -285,5 +455,142 @@ float MicrofacetBSDF::smithBeckmannG1(const Vector3f & V, const Normal3f & M, fl
     return (3.535f * B + 2.181f * B2) / (1.0f + 2.276f * B + 2.577f * B2);
 }
 
+float MicrofacetBSDF::ggxD(const Normal3f & M, float alpha)
+{
+    float Root = 1.0f + Frame::tanTheta(M) * Frame::tanTheta(M) / (alpha * alpha);
+    float CosTheta = Frame::cosTheta(M);
+    float CosTheta2 = CosTheta * CosTheta;
+    return 1.0f / (float(M_PI) * alpha * alpha * CosTheta2 * CosTheta2 * Root * Root);
+}
+
+float MicrofacetBSDF::smithGGXG1(const Vector3f & V, const Normal3f & M, float alpha)
+{
+    float TanTheta = Frame::tanTheta(V);
+
+    // Perpendicular indidence
+    if (TanTheta == 0.0f)
+    {
+        return 1.0f;
+    }
+
+    // Backside
+    if (M.dot(V) * Frame::cosTheta(V) <= 0.0f)
+    {
+        return 0.0f;
+    }
+
+    float Root = alpha * TanTheta;
+    return 2.0f / (1.0f + std::sqrt(1.0f + Root * Root));
+}
+
+void MicrofacetBSDF::getParameterBatch(const BSDFQueryBatch & batch, FloatBatch & alpha, Color3fBatch & kd) const
+{
+    /* Textures are not vectorized, they are looked up lane by lane */
+    alpha.resize(Eigen::Index(batch.size()));
+    kd.resize(Eigen::Index(batch.size()), 3);
+    for (size_t lane = 0; lane < batch.size(); lane++)
+    {
+        Parameters params = getParameters(batch.getIntersection(lane));
+        alpha(Eigen::Index(lane)) = params.alpha;
+        kd.row(Eigen::Index(lane)) << params.kd.r(), params.kd.g(), params.kd.b();
+    }
+}
+
+Color3fBatch MicrofacetBSDF::evalKernel(const Vector3fBatch & wi, const Vector3fBatch & wo, const FloatBatch & alpha,
+                                        const Color3fBatch & kd, const FloatBatch & ks) const
+{
+    Vector3fBatch wh = halfVectorBatch(wi, wo);
+
+    FloatBatch F, cosThetaT;
+    fresnelDielectricBatch(dotBatch(wh, wi), m_eta, m_invEta, F, cosThetaT);
+    FloatBatch D = distributionBatch(wh, alpha);
+    FloatBatch G = smithG1Batch(wi, wh, alpha) * smithG1Batch(wo, wh, alpha);
+
+    FloatBatch specularTerm = ks * F * D * G / (4.0f * wi.col(2) * wo.col(2));
+    specularTerm = (specularTerm.isFinite() && specularTerm >= 0.0f).select(specularTerm, 0.0f);
+
+    Color3fBatch result = kd / float(M_PI);
+    result.colwise() += specularTerm;
+    return result;
+}
+
+FloatBatch MicrofacetBSDF::pdfKernel(const Vector3fBatch & wi, const Vector3fBatch & wo, const FloatBatch & alpha, const FloatBatch & ks) const
+{
+    Vector3fBatch wh = halfVectorBatch(wi, wo);
+    FloatBatch J = 0.25f / dotBatch(wh, wo);
+    FloatBatch specularPdf = ks * pdfNormalBatch(wi, wh, alpha) * J;
+    FloatBatch diffusePdf = (1.0f - ks) * Warp::squareToCosineHemispherePdfBatch(wo);
+    return specularPdf + diffusePdf;
+}
+
+FloatBatch MicrofacetBSDF::distributionBatch(const Vector3fBatch & M, const FloatBatch & alpha) const
+{
+    return m_distribution == EDistribution::EGGX ? ggxDBatch(M, alpha) : beckmannDBatch(M, alpha);
+}
+
+FloatBatch MicrofacetBSDF::smithG1Batch(const Vector3fBatch & V, const Vector3fBatch & M, const FloatBatch & alpha) const
+{
+    return m_distribution == EDistribution::EGGX ? smithGGXG1Batch(V, M, alpha) : smithBeckmannG1Batch(V, M, alpha);
+}
+
+Vector3fBatch MicrofacetBSDF::sampleNormalBatch(const Vector3fBatch & wi, const Point2fBatch & sample, const FloatBatch & alpha) const
+{
+    if (m_distribution == EDistribution::EGGX)
+    {
+        return m_bSampleVisible ? Warp::squareToGGXVisibleBatch(sample, wi, alpha) : Warp::squareToGGXBatch(sample, alpha);
+    }
+    return m_bSampleVisible ? Warp::squareToBeckmannVisibleBatch(sample, wi, alpha) : Warp::squareToBeckmannBatch(sample, alpha);
+}
+
+FloatBatch MicrofacetBSDF::pdfNormalBatch(const Vector3fBatch & wi, const Vector3fBatch & M, const FloatBatch & alpha) const
+{
+    if (m_distribution == EDistribution::EGGX)
+    {
+        return m_bSampleVisible ? Warp::squareToGGXVisiblePdfBatch(M, wi, alpha) : Warp::squareToGGXPdfBatch(M, alpha);
+    }
+    return m_bSampleVisible ? Warp::squareToBeckmannVisiblePdfBatch(M, wi, alpha) : Warp::squareToBeckmannPdfBatch(M, alpha);
+}
+
+FloatBatch MicrofacetBSDF::beckmannDBatch(const Vector3fBatch & M, const FloatBatch & alpha)
+{
+    FloatBatch cosTheta2 = M.col(2).square();
+    FloatBatch tanTheta2 = (1.0f - cosTheta2).max(0.0f) / cosTheta2;
+    return (-tanTheta2 / alpha.square()).exp() / (float(M_PI) * alpha.square() * cosTheta2.square());
+}
+
+FloatBatch MicrofacetBSDF::smithBeckmannG1Batch(const Vector3fBatch & V, const Vector3fBatch & M, const FloatBatch & alpha)
+{
+    FloatBatch cosTheta = V.col(2);
+    FloatBatch sinTheta2 = 1.0f - cosTheta.square();
+    FloatBatch tanTheta = (sinTheta2 <= 0.0f).select(0.0f, sinTheta2.max(0.0f).sqrt() / cosTheta);
+
+    FloatBatch B = 1.0f / (alpha * tanTheta);
+    FloatBatch B2 = B.square();
+    FloatBatch G1 = (B >= 1.6f).select(1.0f, (3.535f * B + 2.181f * B2) / (1.0f + 2.276f * B + 2.577f * B2));
+
+    /* Same order of the special cases as the scalar version: perpendicular incidence, then the backside */
+    G1 = (dotBatch(M, V) * cosTheta <= 0.0f).select(0.0f, G1);
+    return (tanTheta == 0.0f).select(1.0f, G1);
+}
+
+FloatBatch MicrofacetBSDF::ggxDBatch(const Vector3fBatch & M, const FloatBatch & alpha)
+{
+    FloatBatch cosTheta2 = M.col(2).square();
+    FloatBatch tanTheta2 = (1.0f - cosTheta2).max(0.0f) / cosTheta2;
+    FloatBatch root = 1.0f + tanTheta2 / alpha.square();
+    return 1.0f / (float(M_PI) * alpha.square() * cosTheta2.square() * root.square());
+}
+
+FloatBatch MicrofacetBSDF::smithGGXG1Batch(const Vector3fBatch & V, const Vector3fBatch & M, const FloatBatch & alpha)
+{
+    FloatBatch cosTheta = V.col(2);
+    FloatBatch tanTheta2 = (1.0f - cosTheta.square()).max(0.0f) / cosTheta.square();
+    FloatBatch G1 = 2.0f / (1.0f + (1.0f + alpha.square() * tanTheta2).sqrt());
+
+    /* Same order of the special cases as the scalar version: perpendicular incidence, then the backside */
+    G1 = (dotBatch(M, V) * cosTheta <= 0.0f).select(0.0f, G1);
+    return (tanTheta2 == 0.0f).select(1.0f, G1);
+}
+
 NORI_REGISTER_CLASS(MicrofacetBSDF, XML_BSDF_MICROFACET);
 NORI_NAMESPACE_END
@@ -7,6 +7,7 @@
 #include <nori/bsdf/mirrorBSDF.h>
 #include <nori/core/frame.h>
 #include <nori/core/bsdfQueryRecord.h>
+#include <nori/core/ray.h>
 
 NORI_NAMESPACE_BEGIN
 
@@ -59,6 +60,16 @@ Color3f MirrorBSDF::sample(BSDFQueryRecord &bRec, const Point2f &) const
     return Color3f(1.0f);
 }
 
+void MirrorBSDF::propagateDifferentials(const BSDFQueryRecord &bRec, const Ray3f &incident, Ray3f &scattered) const
+{
+    if (!incident.bHasDifferentials || bRec.measure != EDiscrete)
+    {
+        scattered.bHasDifferentials = false;
+        return;
+    }
+    reflectDifferentials(bRec, incident, scattered);
+}
+
 std::string MirrorBSDF::toString() const
 {
     return "Mirror[]";
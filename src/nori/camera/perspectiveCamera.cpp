@@ -16,6 +16,12 @@ PerspectiveCamera::PerspectiveCamera(const PropertyList &propList)
     m_outputSize.y() = propList.getInteger("height", 720);
     m_invOutputSize = m_outputSize.cast<float>().cwiseInverse();
 
+    /* Optional crop window in pixels. Default: the entire image */
+    m_cropOffset.x() = propList.getInteger("cropOffsetX", 0);
+    m_cropOffset.y() = propList.getInteger("cropOffsetY", 0);
+    m_cropSize.x() = propList.getInteger("cropWidth", 0);
+    m_cropSize.y() = propList.getInteger("cropHeight", 0);
+
     /* Specifies an optional camera-to-world transformation. Default: none */
     m_cameraToWorld = propList.getTransform("toWorld", Transform());
 
@@ -31,6 +37,12 @@ PerspectiveCamera::PerspectiveCamera(const PropertyList &propList)
 
 void PerspectiveCamera::activate()
 {
+    if (m_cropSize.prod() > 0 && ((m_cropOffset.array() < 0).any() ||
+        ((m_cropOffset + m_cropSize).array() > m_outputSize.array()).any()))
+        throw NoriException("PerspectiveCamera: the crop window (offset %s, size %s) "
+                            "exceeds the output size %s!", m_cropOffset.toString(),
+                            m_cropSize.toString(), m_outputSize.toString());
+
     float aspect = m_outputSize.x() / (float) m_outputSize.y();
 
     /* Project vectors in camera space onto a plane at z=1:
@@ -58,6 +70,14 @@ void PerspectiveCamera::activate()
     m_sampleToCamera = Transform(
             Eigen::DiagonalMatrix<float, 3>(Vector3f(-0.5f, -0.5f * aspect, 1.0f)) *
             Eigen::Translation<float, 3>(-1.0f, -1.0f/aspect, 0.0f) * perspective).inverse();
+    m_cameraToSample = m_sampleToCamera.inverse();
+
+    /* Project the corners of the film onto the plane at z=1 */
+    Point3f pMin = m_sampleToCamera * Point3f(0.0f, 0.0f, 0.0f);
+    Point3f pMax = m_sampleToCamera * Point3f(1.0f, 1.0f, 0.0f);
+    pMin /= pMin.z();
+    pMax /= pMax.z();
+    m_imageArea = std::abs((pMax.x() - pMin.x()) * (pMax.y() - pMin.y()));
 
     /* If no reconstruction filter was assigned, instantiate a Gaussian filter */
     if (!m_rfilter)
@@ -65,6 +85,45 @@ void PerspectiveCamera::activate()
                 NoriObjectFactory::createInstance("gaussian", PropertyList()));
 }
 
+void PerspectiveCamera::applyOverrides(const PropertyList &propList)
+{
+    Vector2i outputSize(propList.getInteger("width", m_outputSize.x()),
+                        propList.getInteger("height", m_outputSize.y()));
+    Point2i cropOffset(propList.getInteger("cropOffsetX", m_cropOffset.x()),
+                       propList.getInteger("cropOffsetY", m_cropOffset.y()));
+    Vector2i cropSize(propList.getInteger("cropWidth", m_cropSize.x()),
+                      propList.getInteger("cropHeight", m_cropSize.y()));
+    Transform cameraToWorld = propList.getTransform("toWorld", m_cameraToWorld);
+    float fov = propList.getFloat("fov", m_fov);
+    float nearClip = propList.getFloat("nearClip", m_nearClip);
+    float farClip = propList.getFloat("farClip", m_farClip);
+
+    /* Validate everything before the camera is modified, a rejected job keeps the previous view */
+    if ((outputSize.array() <= 0).any())
+        throw NoriException("PerspectiveCamera: invalid output size %s!", outputSize.toString());
+    if (!(fov > 0.0f && fov < 180.0f))
+        throw NoriException("PerspectiveCamera: the field of view %f is not in (0, 180)!", fov);
+    if (!(nearClip > 0.0f && farClip > nearClip))
+        throw NoriException("PerspectiveCamera: invalid clipping planes [%f, %f]!", nearClip, farClip);
+    if (cropSize.prod() > 0 && ((cropOffset.array() < 0).any() ||
+        ((cropOffset + cropSize).array() > outputSize.array()).any()))
+        throw NoriException("PerspectiveCamera: the crop window (offset %s, size %s) "
+                            "exceeds the output size %s!", cropOffset.toString(),
+                            cropSize.toString(), outputSize.toString());
+
+    m_outputSize = outputSize;
+    m_invOutputSize = m_outputSize.cast<float>().cwiseInverse();
+    m_cropOffset = cropOffset;
+    m_cropSize = cropSize;
+    m_cameraToWorld = cameraToWorld;
+    m_fov = fov;
+    m_nearClip = nearClip;
+    m_farClip = farClip;
+
+    /* Recompute the sample-to-camera transformation */
+    activate();
+}
+
 Color3f PerspectiveCamera::sampleRay(Ray3f &ray,
                   const Point2f &samplePosition,
                   const Point2f &apertureSample) const
@@ -86,9 +145,80 @@ Color3f PerspectiveCamera::sampleRay(Ray3f &ray,
     ray.maxt = m_farClip * invZ;
     ray.update();
 
+    ray.bHasDifferentials = m_bRayDifferentials;
+    if (!m_bRayDifferentials)
+        return Color3f(1.0f);
+
+    /* Differentials for a shift of one pixel, the caller scales them by the sample count */
+    Vector3f dx = (m_sampleToCamera * Point3f(
+            (samplePosition.x() + 1.0f) * m_invOutputSize.x(),
+            samplePosition.y() * m_invOutputSize.y(), 0.0f)).normalized();
+    Vector3f dy = (m_sampleToCamera * Point3f(
+            samplePosition.x() * m_invOutputSize.x(),
+            (samplePosition.y() + 1.0f) * m_invOutputSize.y(), 0.0f)).normalized();
+
+    ray.rxOrigin = ray.o;
+    ray.ryOrigin = ray.o;
+    ray.rxDirection = m_cameraToWorld * dx;
+    ray.ryDirection = m_cameraToWorld * dy;
+
     return Color3f(1.0f);
 }
 
+Color3f PerspectiveCamera::evalImportance(const Ray3f &ray, Point2f &pixel) const {
+    /* The importance is normalized over the film, which is
+       the plane at z=1 (the aperture is a single point) */
+    Vector3f d = (m_cameraToWorld.inverse() * ray.d).normalized();
+    float cosTheta = d.z();
+    if (cosTheta <= 0.0f)
+        return Color3f(0.0f);
+
+    Point3f sample = m_cameraToSample * Point3f(d / cosTheta);
+    pixel = Point2f(sample.x() * m_outputSize.x(), sample.y() * m_outputSize.y());
+    if (pixel.x() < 0.0f || pixel.y() < 0.0f ||
+        pixel.x() >= (float) m_outputSize.x() || pixel.y() >= (float) m_outputSize.y())
+        return Color3f(0.0f);
+
+    float cos2Theta = cosTheta * cosTheta;
+    return Color3f(1.0f / (m_imageArea * cos2Theta * cos2Theta));
+}
+
+void PerspectiveCamera::pdfImportance(const Ray3f &ray, float &pdfPosition, float &pdfDirection) const {
+    Point2f pixel;
+    if (evalImportance(ray, pixel).isZero()) {
+        pdfPosition = pdfDirection = 0.0f;
+        return;
+    }
+
+    float cosTheta = (m_cameraToWorld.inverse() * ray.d).normalized().z();
+    pdfPosition = 1.0f;
+    pdfDirection = 1.0f / (m_imageArea * cosTheta * cosTheta * cosTheta);
+}
+
+Color3f PerspectiveCamera::sampleImportance(const Point3f &ref, const Point2f &apertureSample,
+                  Point3f &p, Normal3f &n, Point2f &pixel, float &pdf) const {
+    p = m_cameraToWorld * Point3f(0.0f, 0.0f, 0.0f);
+    n = (m_cameraToWorld * Vector3f(0.0f, 0.0f, 1.0f)).normalized();
+
+    Vector3f d = ref - p;
+    float distance = d.norm();
+    if (distance == 0.0f) {
+        pdf = 0.0f;
+        return Color3f(0.0f);
+    }
+    d /= distance;
+
+    /* Density of the (single) aperture position with respect to solid angles */
+    float cosTheta = n.dot(d);
+    if (cosTheta <= 0.0f) {
+        pdf = 0.0f;
+        return Color3f(0.0f);
+    }
+    pdf = distance * distance / cosTheta;
+
+    return evalImportance(Ray3f(p, d), pixel) / pdf;
+}
+
 void PerspectiveCamera::addChild(NoriObject *obj, const std::string & name)
 {
     switch (obj->getClassType()) {
@@ -111,12 +241,15 @@ std::string PerspectiveCamera::toString() const
             "PerspectiveCamera[\n"
             "  cameraToWorld = %s,\n"
             "  outputSize = %s,\n"
+            "  crop = [%s, %s],\n"
             "  fov = %f,\n"
             "  clip = [%f, %f],\n"
             "  rfilter = %s\n"
             "]",
             indent(m_cameraToWorld.toString(), 18),
             m_outputSize.toString(),
+            m_cropOffset.toString(),
+            getCropSize().toString(),
             m_fov,
             m_nearClip,
             m_farClip,
@@ -33,7 +33,7 @@ uint32_t Accel::BaseInternals::findMesh(Accel const &accel, uint32_t &idx) {
 void Accel::BaseInternals::getHitAttributes(const uint32_t& hitIndexThisMesh, Intersection& its){
     /* Find the barycentric coordinates */
     Vector3f bary;
-    bary << 1-its.uv.sum(), its.uv;
+    bary << 1-its.barycentric.sum(), its.barycentric;
     /* References to all relevant mesh buffers */
     const Mesh *mesh   = its.mesh;
     const MatrixXf &V  = mesh->getVertexPositions();
@@ -115,6 +115,7 @@ size_t Accel::getUsedMemoryForPrimitive() const
 bool Accel::rayIntersect(const Ray3f &ray_, Intersection &its, bool bShadowRay) const {
     bool bFoundIntersection = false;  // Was an intersection found so far?
     PrimitiveShape* pHitPrimitive = nullptr;
+    Point2f hitBarycentric;
     Ray3f ray(ray_); /// Make a copy of the ray (we will need to update its '.maxt' value)
     for(size_t i = 0; i < m_pShapes.size(); i++)
     {
@@ -128,10 +129,8 @@ bool Accel::rayIntersect(const Ray3f &ray_, Intersection &its, bool bShadowRay)
                 return true;
             }
 
-            ray.maxt = its.t = t;
-            its.uv = Point2f(u, v);
-            its.pShape = m_pShapes[i];
-
+            ray.maxt = t;
+            hitBarycentric = Point2f(u, v);
             pHitPrimitive = m_pShapes[i];
             bFoundIntersection = true;
         }
@@ -139,11 +138,22 @@ bool Accel::rayIntersect(const Ray3f &ray_, Intersection &its, bool bShadowRay)
 
     if (bFoundIntersection)
     {
+        its.t = ray.maxt;
+        its.barycentric = hitBarycentric;
+        its.pShape = pHitPrimitive;
         pHitPrimitive->postIntersect(its);
-        its.computeScreenSpacePartial(ray_);
+        its.setRayDifferentials(ray_);
     }
     return bFoundIntersection;
 }
 
+void Accel::rayOccluded(const Ray3f *pRays, size_t count, bool *pOccluded) const {
+    Intersection its; /* Unused */
+    for (size_t i = 0; i < count; i++)
+    {
+        pOccluded[i] = rayIntersect(pRays[i], its, true);
+    }
+}
+
 NORI_REGISTER_CLASS(Accel, XML_ACCELERATION_BRUTO_LOOP);
 NORI_NAMESPACE_END
\ No newline at end of file
@@ -56,7 +56,9 @@ Bitmap::Bitmap(const std::string &filename) {
            pixelStride = 3 * compStride,
            rowStride = pixelStride * cols();
 
-    char *ptr = reinterpret_cast<char *>(data());
+    /* The slices are addressed relative to the data window origin */
+    char *ptr = reinterpret_cast<char *>(data())
+        - (std::ptrdiff_t) dw.min.x * (std::ptrdiff_t) pixelStride - (std::ptrdiff_t) dw.min.y * (std::ptrdiff_t) rowStride;
 
     Imf::FrameBuffer frameBuffer;
     frameBuffer.insert(ch_r, Imf::Slice(Imf::FLOAT, ptr, pixelStride, rowStride)); ptr += compStride;
@@ -67,12 +69,20 @@ Bitmap::Bitmap(const std::string &filename) {
 }
 
 void Bitmap::saveEXR(const std::string &filename) {
+    saveEXR(filename, Point2i(0, 0), Vector2i((int) cols(), (int) rows()));
+}
+
+void Bitmap::saveEXR(const std::string &filename, const Point2i &offset, const Vector2i &displaySize) {
     LOG(INFO) << "Writing a " << cols() << "x" << rows()
          << " OpenEXR file to \"" << filename << "\"" << endl;
 
     std::string path = filename + ".exr";
 
-    Imf::Header header((int) cols(), (int) rows());
+    Imath::Box2i displayWindow(Imath::V2i(0, 0), Imath::V2i(displaySize.x() - 1, displaySize.y() - 1));
+    Imath::Box2i dataWindow(Imath::V2i(offset.x(), offset.y()),
+                            Imath::V2i(offset.x() + (int) cols() - 1, offset.y() + (int) rows() - 1));
+
+    Imf::Header header(displayWindow, dataWindow);
     header.insert("comments", Imf::StringAttribute("Generated by Nori"));
 
     Imf::ChannelList &channels = header.channels();
@@ -85,7 +95,8 @@ void Bitmap::saveEXR(const std::string &filename) {
            pixelStride = 3 * compStride,
            rowStride = pixelStride * cols();
 
-    char *ptr = reinterpret_cast<char *>(data());
+    char *ptr = reinterpret_cast<char *>(data())
+        - (std::ptrdiff_t) offset.x() * (std::ptrdiff_t) pixelStride - (std::ptrdiff_t) offset.y() * (std::ptrdiff_t) rowStride;
     frameBuffer.insert("R", Imf::Slice(Imf::FLOAT, ptr, pixelStride, rowStride)); ptr += compStride;
     frameBuffer.insert("G", Imf::Slice(Imf::FLOAT, ptr, pixelStride, rowStride)); ptr += compStride;
     frameBuffer.insert("B", Imf::Slice(Imf::FLOAT, ptr, pixelStride, rowStride));
@@ -9,6 +9,11 @@
 #include <nori/core/rfilter.h>
 #include <nori/core/bbox.h>
 #include <tbb/tbb.h>
+#include <ImfInputFile.h>
+#include <ImfOutputFile.h>
+#include <ImfChannelList.h>
+#include <ImfStringAttribute.h>
+#include <ImfBoxAttribute.h>
 
 NORI_NAMESPACE_BEGIN
 
@@ -43,10 +48,15 @@ ImageBlock::~ImageBlock() {
 }
 
 Bitmap *ImageBlock::toBitmap() const {
-    Bitmap *result = new Bitmap(m_size);
-    for (int y=0; y<m_size.y(); ++y)
-        for (int x=0; x<m_size.x(); ++x)
-            result->coeffRef(y, x) = coeff(y + m_borderSize, x + m_borderSize).divideByFilterWeight();
+    return toBitmap(Point2i(0, 0), m_size);
+}
+
+Bitmap *ImageBlock::toBitmap(const Point2i &offset, const Vector2i &size) const {
+    Bitmap *result = new Bitmap(size);
+    for (int y=0; y<size.y(); ++y)
+        for (int x=0; x<size.x(); ++x)
+            result->coeffRef(y, x) = coeff(y + offset.y() + m_borderSize,
+                                           x + offset.x() + m_borderSize).divideByFilterWeight();
     return result;
 }
 
@@ -59,13 +69,125 @@ void ImageBlock::fromBitmap(const Bitmap &bitmap) {
             coeffRef(y, x) << bitmap.coeff(y, x), 1;
 }
 
-void ImageBlock::put(const Point2f &_pos, const Color3f &value) {
+void ImageBlock::saveWeightedEXR(const std::string &filename, const Point2i &cropOffset, const Vector2i &cropSize) const {
+    LOG(INFO) << "Writing a " << m_size.x() << "x" << m_size.y()
+         << " weighted OpenEXR file to \"" << filename << "\"" << endl;
+
+    std::string path = filename + ".exr";
+
+    /* Copy the pixels without the border region */
+    std::vector<float> pixels(4 * (size_t) m_size.x() * (size_t) m_size.y());
+    float *dst = pixels.data();
+    for (int y=0; y<m_size.y(); ++y) {
+        for (int x=0; x<m_size.x(); ++x) {
+            const Color4f &c = coeff(y + m_borderSize, x + m_borderSize);
+            for (int i=0; i<4; ++i)
+                *dst++ = c[i];
+        }
+    }
+
+    Imf::Header header(m_size.x(), m_size.y());
+    header.insert("comments", Imf::StringAttribute("Weighted partial image generated by Nori"));
+    header.insert("cropWindow", Imf::Box2iAttribute(Imath::Box2i(
+        Imath::V2i(cropOffset.x(), cropOffset.y()),
+        Imath::V2i(cropOffset.x() + cropSize.x() - 1, cropOffset.y() + cropSize.y() - 1))));
+
+    Imf::ChannelList &channels = header.channels();
+    channels.insert("R", Imf::Channel(Imf::FLOAT));
+    channels.insert("G", Imf::Channel(Imf::FLOAT));
+    channels.insert("B", Imf::Channel(Imf::FLOAT));
+    channels.insert("W", Imf::Channel(Imf::FLOAT));
+
+    Imf::FrameBuffer frameBuffer;
+    size_t compStride = sizeof(float),
+           pixelStride = 4 * compStride,
+           rowStride = pixelStride * m_size.x();
+
+    char *ptr = reinterpret_cast<char *>(pixels.data());
+    frameBuffer.insert("R", Imf::Slice(Imf::FLOAT, ptr, pixelStride, rowStride)); ptr += compStride;
+    frameBuffer.insert("G", Imf::Slice(Imf::FLOAT, ptr, pixelStride, rowStride)); ptr += compStride;
+    frameBuffer.insert("B", Imf::Slice(Imf::FLOAT, ptr, pixelStride, rowStride)); ptr += compStride;
+    frameBuffer.insert("W", Imf::Slice(Imf::FLOAT, ptr, pixelStride, rowStride));
+
+    Imf::OutputFile file(path.c_str(), header);
+    file.setFrameBuffer(frameBuffer);
+    file.writePixels(m_size.y());
+}
+
+void ImageBlock::addWeightedEXR(const std::string &filename) {
+    Imf::InputFile file(filename.c_str());
+    const Imf::Header &header = file.header();
+
+    Imath::Box2i dw = header.dataWindow();
+    Vector2i size(dw.max.x - dw.min.x + 1, dw.max.y - dw.min.y + 1);
+    if (size != m_size)
+        throw NoriException("ImageBlock::addWeightedEXR(): \"%s\" has size %s, expected %s!",
+                            filename, size.toString(), m_size.toString());
+
+    const Imf::ChannelList &channels = header.channels();
+    if (!channels.findChannel("R") || !channels.findChannel("G") ||
+        !channels.findChannel("B") || !channels.findChannel("W"))
+        throw NoriException("ImageBlock::addWeightedEXR(): \"%s\" is not a weighted OpenEXR file!", filename);
+
+    std::vector<float> pixels(4 * (size_t) m_size.x() * (size_t) m_size.y());
+    size_t compStride = sizeof(float),
+           pixelStride = 4 * compStride,
+           rowStride = pixelStride * m_size.x();
+
+    /* The slices are addressed relative to the data window origin */
+    char *ptr = reinterpret_cast<char *>(pixels.data())
+        - (std::ptrdiff_t) dw.min.x * (std::ptrdiff_t) pixelStride - (std::ptrdiff_t) dw.min.y * (std::ptrdiff_t) rowStride;
+
+    Imf::FrameBuffer frameBuffer;
+    frameBuffer.insert("R", Imf::Slice(Imf::FLOAT, ptr, pixelStride, rowStride)); ptr += compStride;
+    frameBuffer.insert("G", Imf::Slice(Imf::FLOAT, ptr, pixelStride, rowStride)); ptr += compStride;
+    frameBuffer.insert("B", Imf::Slice(Imf::FLOAT, ptr, pixelStride, rowStride)); ptr += compStride;
+    frameBuffer.insert("W", Imf::Slice(Imf::FLOAT, ptr, pixelStride, rowStride));
+    file.setFrameBuffer(frameBuffer);
+    file.readPixels(dw.min.y, dw.max.y);
+
+    const float *src = pixels.data();
+    for (int y=0; y<m_size.y(); ++y) {
+        for (int x=0; x<m_size.x(); ++x) {
+            Color4f &c = coeffRef(y + m_borderSize, x + m_borderSize);
+            for (int i=0; i<4; ++i)
+                c[i] += *src++;
+        }
+    }
+}
+
+void ImageBlock::loadWeightedEXRCropWindow(const std::string &filename, Point2i &cropOffset, Vector2i &cropSize) {
+    Imf::InputFile file(filename.c_str());
+    const Imf::Header &header = file.header();
+
+    Imath::Box2i window = header.dataWindow();
+    if (const Imf::Box2iAttribute *crop = header.findTypedAttribute<Imf::Box2iAttribute>("cropWindow"))
+        window = crop->value();
+    cropOffset = Point2i(window.min.x, window.min.y);
+    cropSize = Vector2i(window.max.x - window.min.x + 1, window.max.y - window.min.y + 1);
+}
+
+void ImageBlock::put(const Point2f &pos, const Color3f &value) {
     if (!value.isValid()) {
         /* If this happens, go fix your code instead of removing this warning ;) */
         cerr << "Integrator: computed an invalid radiance value: " << value.toString() << endl;
         return;
     }
 
+    accumulate(pos, Color4f(value));
+}
+
+void ImageBlock::splat(const Point2f &pos, const Color3f &value) {
+    if (!value.isValid()) {
+        cerr << "Integrator: computed an invalid radiance value: " << value.toString() << endl;
+        return;
+    }
+
+    /* The weight of the sample was already recorded by put() */
+    accumulate(pos, Color4f(value.r(), value.g(), value.b(), 0.0f));
+}
+
+void ImageBlock::accumulate(const Point2f &_pos, const Color4f &value) {
     /* Convert to pixel coordinates within the image block */
     Point2f pos(
         _pos.x() - 0.5f - (m_offset.x() - m_borderSize),
@@ -87,7 +209,7 @@ void ImageBlock::put(const Point2f &_pos, const Color3f &value) {
 
     for (int y=bbox.min.y(), yr=0; y<=bbox.max.y(); ++y, ++yr) 
         for (int x=bbox.min.x(), xr=0; x<=bbox.max.x(); ++x, ++xr) 
-            coeffRef(y, x) += Color4f(value) * m_weightsX[xr] * m_weightsY[yr];
+            coeffRef(y, x) += value * m_weightsX[xr] * m_weightsY[yr];
 }
     
 void ImageBlock::put(ImageBlock &b) {
@@ -107,13 +229,25 @@ std::string ImageBlock::toString() const {
 }
 
 BlockGenerator::BlockGenerator(const Vector2i &size, int blockSize)
+        : BlockGenerator(size, blockSize, Point2i(0, 0), size) { }
+
+BlockGenerator::BlockGenerator(const Vector2i &size, int blockSize,
+                               const Point2i &cropOffset, const Vector2i &cropSize, int margin)
         : m_size(size), m_blockSize(blockSize) {
     m_numBlocks = Vector2i(
         (int) std::ceil(size.x() / (float) blockSize),
         (int) std::ceil(size.y() / (float) blockSize));
-    m_blocksLeft = m_numBlocks.x() * m_numBlocks.y();
+
+    /* Range of blocks (inclusive) that intersect the crop window and its margin */
+    Point2i regionMin = (cropOffset - Vector2i::Constant(margin)).cwiseMax(Point2i(0, 0));
+    Point2i regionMax = (cropOffset + cropSize + Vector2i::Constant(margin - 1)).cwiseMin(size - Vector2i::Constant(1));
+    m_blockMin = regionMin / blockSize;
+    m_blockMax = regionMax / blockSize;
+    Vector2i numCropBlocks = m_blockMax - m_blockMin + Vector2i::Constant(1);
+
+    m_blocksLeft = numCropBlocks.x() * numCropBlocks.y();
     m_direction = ERight;
-    m_block = Point2i(m_numBlocks / 2);
+    m_block = m_blockMin + numCropBlocks / 2;
     m_stepsLeft = 1;
     m_numSteps = 1;
 }
@@ -145,8 +279,8 @@ bool BlockGenerator::next(ImageBlock &block) {
                 ++m_numSteps;
             m_stepsLeft = m_numSteps;
         }
-    } while ((m_block.array() < 0).any() ||
-             (m_block.array() >= m_numBlocks.array()).any());
+    } while ((m_block.array() < m_blockMin.array()).any() ||
+             (m_block.array() > m_blockMax.array()).any());
 
     return true;
 }
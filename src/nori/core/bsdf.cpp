@@ -2,6 +2,8 @@
 // Created by superqqli on 2021/12/13.
 //
 #include <nori/core/bsdf.h>
+#include <nori/core/bsdfQueryBatch.h>
+#include <nori/core/ray.h>
 
 NORI_NAMESPACE_BEGIN
 
@@ -9,11 +11,135 @@ NoriObject::EClassType BSDF::getClassType() const { return EBSDF; }
 
 bool BSDF::isDiffuse() const { return false; }
 
+void BSDF::sampleBatch(BSDFQueryBatch & batch, const Point2fBatch & sample, Color3fBatch & result) const
+{
+    result.resize(Eigen::Index(batch.size()), 3);
+    for (size_t lane = 0; lane < batch.size(); lane++)
+    {
+        Eigen::Index i = Eigen::Index(lane);
+        BSDFQueryRecord bRec = batch.getRecord(lane);
+        Color3f value = this->sample(bRec, Point2f(sample(i, 0), sample(i, 1)));
+
+        result.row(i) << value.r(), value.g(), value.b();
+        batch.wo.row(i) << bRec.wo.x(), bRec.wo.y(), bRec.wo.z();
+        batch.eta(i) = bRec.eta;
+        batch.measure = bRec.measure;
+    }
+}
+
+void BSDF::evalBatch(const BSDFQueryBatch & batch, Color3fBatch & result) const
+{
+    result.resize(Eigen::Index(batch.size()), 3);
+    for (size_t lane = 0; lane < batch.size(); lane++)
+    {
+        Color3f value = eval(batch.getRecord(lane));
+        result.row(Eigen::Index(lane)) << value.r(), value.g(), value.b();
+    }
+}
+
+void BSDF::pdfBatch(const BSDFQueryBatch & batch, FloatBatch & result) const
+{
+    result.resize(Eigen::Index(batch.size()));
+    for (size_t lane = 0; lane < batch.size(); lane++)
+    {
+        result(Eigen::Index(lane)) = pdf(batch.getRecord(lane));
+    }
+}
+
+void BSDF::prepare(Intersection & its, MemoryArena & arena) const
+{
+
+}
+
+void BSDF::propagateDifferentials(const BSDFQueryRecord & bRec, const Ray3f & incident, Ray3f & scattered) const
+{
+    scattered.bHasDifferentials = false;
+}
+
+void BSDF::reflectDifferentials(const BSDFQueryRecord & bRec, const Ray3f & incident, Ray3f & scattered)
+{
+    const Intersection & its = bRec.its;
+    Vector3f n = its.shFrame.n;
+    Vector3f wi = its.toWorld(bRec.wi);
+    Vector3f wo = its.toWorld(bRec.wo);
+
+    /* Change of the shading normal across the footprint, zero for flat shading */
+    Vector3f dNdX(0.0f), dNdY(0.0f);
+    its.computeScreenSpacePartials();
+    if (its.bHasUVPartial)
+    {
+        dNdX = its.dNdU * its.dUdX + its.dNdV * its.dVdX;
+        dNdY = its.dNdU * its.dUdY + its.dNdV * its.dVdY;
+    }
+
+    Vector3f dWidX = -incident.rxDirection - wi;
+    Vector3f dWidY = -incident.ryDirection - wi;
+    float dDNdX = dWidX.dot(n) + wi.dot(dNdX);
+    float dDNdY = dWidY.dot(n) + wi.dot(dNdY);
+
+    scattered.rxOrigin = its.p + its.dPdX;
+    scattered.ryOrigin = its.p + its.dPdY;
+    scattered.rxDirection = wo - dWidX + 2.0f * (wi.dot(n) * dNdX + dDNdX * n);
+    scattered.ryDirection = wo - dWidY + 2.0f * (wi.dot(n) * dNdY + dDNdY * n);
+    scattered.bHasDifferentials = true;
+}
+
+void BSDF::refractDifferentials(const BSDFQueryRecord & bRec, const Ray3f & incident, Ray3f & scattered)
+{
+    const Intersection & its = bRec.its;
+    Vector3f n = its.shFrame.n;
+    Vector3f wi = its.toWorld(bRec.wi);
+    Vector3f wo = its.toWorld(bRec.wo);
+
+    Vector3f dNdX(0.0f), dNdY(0.0f);
+    its.computeScreenSpacePartials();
+    if (its.bHasUVPartial)
+    {
+        dNdX = its.dNdU * its.dUdX + its.dNdV * its.dVdX;
+        dNdY = its.dNdU * its.dUdY + its.dNdV * its.dVdY;
+    }
+
+    /* Flip the normal to the side of wi, bRec.eta is the ratio of the
+       refractive index on the side of wo to the one on the side of wi */
+    if (wi.dot(n) < 0.0f)
+    {
+        n = -n;
+        dNdX = -dNdX;
+        dNdY = -dNdY;
+    }
+    float eta = 1.0f / bRec.eta;
+
+    Vector3f dWidX = -incident.rxDirection - wi;
+    Vector3f dWidY = -incident.ryDirection - wi;
+    float dDNdX = dWidX.dot(n) + wi.dot(dNdX);
+    float dDNdY = dWidY.dot(n) + wi.dot(dNdY);
+
+    float cosThetaO = std::abs(wo.dot(n));
+    float mu = eta * wi.dot(n) - cosThetaO;
+    float dMu = eta - eta * eta * wi.dot(n) / cosThetaO;
+
+    scattered.rxOrigin = its.p + its.dPdX;
+    scattered.ryOrigin = its.p + its.dPdY;
+    scattered.rxDirection = wo - eta * dWidX + (mu * dNdX + dMu * dDNdX * n);
+    scattered.ryDirection = wo - eta * dWidY + (mu * dNdY + dMu * dDNdY * n);
+    scattered.bHasDifferentials = true;
+}
+
+Color3f BSDF::getAlbedo(const Intersection & its) const
+{
+    return Color3f(1.0f);
+}
+
 bool BSDF::isAnisotropic() const
 {
     return false;
 }
 
+bool BSDF::usesRayDifferentials() const
+{
+    return false;
+}
+
 void BSDF::addBsdfType(uint32_t Type)
 {
     m_combinedType |= Type;
@@ -0,0 +1,179 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#include <nori/core/bsdfBatchTest.h>
+#include <nori/core/bsdf.h>
+#include <nori/core/bsdfQueryRecord.h>
+#include <nori/core/bsdfQueryBatch.h>
+#include <nori/core/warp.h>
+#include <pcg32.h>
+
+NORI_NAMESPACE_BEGIN
+
+namespace
+{
+    /// Whether a value of a batch kernel agrees with the scalar one, up to the rounding of the kernels
+    bool isClose(float batchValue, float scalarValue)
+    {
+        return std::abs(batchValue - scalarValue) <= 1e-3f * std::max(1.0f, std::abs(scalarValue));
+    }
+
+    bool isClose(const Color3fBatch & batchValues, Eigen::Index lane, const Color3f & scalarValue)
+    {
+        return isClose(batchValues(lane, 0), scalarValue.r()) &&
+               isClose(batchValues(lane, 1), scalarValue.g()) &&
+               isClose(batchValues(lane, 2), scalarValue.b());
+    }
+}
+
+BSDFBatchTest::BSDFBatchTest(const PropertyList & propList)
+{
+    /* Number of incident directions per BSDF */
+    m_sampleCount = propList.getInteger(XML_TEST_BSDF_BATCH_SAMPLE_COUNT, DEFAULT_TEST_BSDF_BATCH_SAMPLE_COUNT);
+
+    /* Number of lanes of every batch */
+    m_batchSize = propList.getInteger(XML_TEST_BSDF_BATCH_BATCH_SIZE, DEFAULT_TEST_BSDF_BATCH_BATCH_SIZE);
+
+    if (m_sampleCount <= 0 || m_batchSize <= 0 || m_batchSize > NORI_MAX_BATCH_SIZE)
+    {
+        throw NoriException("BSDFBatchTest: the sample count must be positive and the batch size in [1, %i]!",
+                            NORI_MAX_BATCH_SIZE);
+    }
+}
+
+BSDFBatchTest::~BSDFBatchTest()
+{
+    for (BSDF * pBSDF : m_bsdfs)
+    {
+        delete pBSDF;
+    }
+}
+
+void BSDFBatchTest::addChild(NoriObject * pChildObj, const std::string & name)
+{
+    switch (pChildObj->getClassType())
+    {
+        case EBSDF:
+            m_bsdfs.push_back(static_cast<BSDF *>(pChildObj));
+            break;
+
+        default:
+            throw NoriException("BSDFBatchTest::addChild(<%s>, <%s>) is not supported!",
+                                classTypeName(pChildObj->getClassType()), name);
+    }
+}
+
+void BSDFBatchTest::activate()
+{
+    int passed = 0, total = 0;
+
+    auto report = [&](const std::string & name, int mismatches) {
+        ++total;
+        passed += mismatches == 0 ? 1 : 0;
+        cout << tfm::format("%-20s: %i mismatches .. %s", name, mismatches, mismatches == 0 ? "passed" : "FAILED") << endl;
+    };
+
+    for (const BSDF * pBSDF : m_bsdfs)
+    {
+        cout << "------------------------------------------------------" << endl;
+        cout << "Testing the batch kernels of " << pBSDF->toString() << endl;
+
+        pcg32 random;
+        int mismatchesSample = 0, mismatchesEval = 0, mismatchesPdf = 0;
+        BSDFQueryBatch batch;
+        Point2fBatch samples;
+        Color3fBatch results, values;
+        FloatBatch pdfs;
+
+        /* Compare evalBatch() and pdfBatch() with the scalar versions for the current directions */
+        auto evaluate = [&]() {
+            pBSDF->evalBatch(batch, values);
+            pBSDF->pdfBatch(batch, pdfs);
+            for (size_t lane = 0; lane < batch.size(); lane++)
+            {
+                BSDFQueryRecord bRec = batch.getRecord(lane);
+                mismatchesEval += isClose(values, Eigen::Index(lane), pBSDF->eval(bRec)) ? 0 : 1;
+                mismatchesPdf += isClose(pdfs(Eigen::Index(lane)), pBSDF->pdf(bRec)) ? 0 : 1;
+            }
+        };
+
+        for (int offset = 0; offset < m_sampleCount; offset += m_batchSize)
+        {
+            int size = std::min(m_batchSize, m_sampleCount - offset);
+            batch.resize(size_t(size));
+            samples.resize(size, 2);
+            for (int lane = 0; lane < size; lane++)
+            {
+                Vector3f wi = Warp::squareToUniformSphere(Point2f(random.nextFloat(), random.nextFloat()));
+                batch.wi.row(lane) << wi.x(), wi.y(), wi.z();
+                samples(lane, 0) = random.nextFloat();
+                samples(lane, 1) = random.nextFloat();
+            }
+
+            /* Sampling */
+            pBSDF->sampleBatch(batch, samples, results);
+            for (int lane = 0; lane < size; lane++)
+            {
+                Vector3f wi(batch.wi(lane, 0), batch.wi(lane, 1), batch.wi(lane, 2));
+                BSDFQueryRecord bRec(wi, batch.mode, nullptr, batch.getIntersection(size_t(lane)));
+                Color3f value = pBSDF->sample(bRec, Point2f(samples(lane, 0), samples(lane, 1)));
+
+                bool bMatch = isClose(results, lane, value);
+                if (!value.isZero())
+                {
+                    /* The direction is only defined for valid samples */
+                    bMatch = bMatch && bRec.measure == batch.measure && isClose(batch.eta(lane), bRec.eta) &&
+                             isClose(batch.wo(lane, 0), bRec.wo.x()) &&
+                             isClose(batch.wo(lane, 1), bRec.wo.y()) &&
+                             isClose(batch.wo(lane, 2), bRec.wo.z());
+                }
+                mismatchesSample += bMatch ? 0 : 1;
+            }
+
+            /* Evaluation of the sampled directions (the only ones with a value for discrete BSDFs) */
+            evaluate();
+
+            /* Evaluation of random directions */
+            batch.measure = ESolidAngle;
+            for (int lane = 0; lane < size; lane++)
+            {
+                Vector3f wo = Warp::squareToUniformSphere(Point2f(random.nextFloat(), random.nextFloat()));
+                batch.wo.row(lane) << wo.x(), wo.y(), wo.z();
+            }
+            evaluate();
+        }
+
+        report("sampleBatch", mismatchesSample);
+        report("evalBatch", mismatchesEval);
+        report("pdfBatch", mismatchesPdf);
+    }
+
+    cout << "Passed " << passed << "/" << total << " tests." << endl;
+    if (passed < total)
+    {
+        throw std::runtime_error("Some tests failed :(");
+    }
+}
+
+std::string BSDFBatchTest::toString() const
+{
+    return tfm::format(
+            "BSDFBatchTest[\n"
+            "  bsdfCount = %i,\n"
+            "  sampleCount = %i,\n"
+            "  batchSize = %i\n"
+            "]",
+            int(m_bsdfs.size()),
+            m_sampleCount,
+            m_batchSize
+    );
+}
+
+NoriObject::EClassType BSDFBatchTest::getClassType() const
+{
+    return ETest;
+}
+
+NORI_REGISTER_CLASS(BSDFBatchTest, XML_TEST_BSDF_BATCH);
+NORI_NAMESPACE_END
@@ -0,0 +1,45 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#include <nori/core/bsdfQueryBatch.h>
+
+NORI_NAMESPACE_BEGIN
+
+namespace
+{
+    /// Surface interaction of the lanes without one, textures are evaluated at its defaults
+    const Intersection DefaultIntersection;
+}
+
+BSDFQueryBatch::BSDFQueryBatch(size_t size)
+{
+    resize(size);
+}
+
+void BSDFQueryBatch::resize(size_t size)
+{
+    if (size > NORI_MAX_BATCH_SIZE)
+    {
+        throw NoriException("BSDFQueryBatch: %u lanes exceed the maximum batch size of %u!", size, NORI_MAX_BATCH_SIZE);
+    }
+    wi.resize(Eigen::Index(size), 3);
+    wo.resize(Eigen::Index(size), 3);
+    eta.setOnes(Eigen::Index(size));
+}
+
+const Intersection & BSDFQueryBatch::getIntersection(size_t lane) const
+{
+    return lane < pIts.size() && pIts[lane] != nullptr ? *pIts[lane] : DefaultIntersection;
+}
+
+BSDFQueryRecord BSDFQueryBatch::getRecord(size_t lane) const
+{
+    Eigen::Index i = Eigen::Index(lane);
+    BSDFQueryRecord bRec(Vector3f(wi(i, 0), wi(i, 1), wi(i, 2)), Vector3f(wo(i, 0), wo(i, 1), wo(i, 2)),
+                         measure, mode, nullptr, getIntersection(lane));
+    bRec.eta = eta(i);
+    return bRec;
+}
+
+NORI_NAMESPACE_END
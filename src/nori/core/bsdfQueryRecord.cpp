@@ -7,13 +7,15 @@
 
 NORI_NAMESPACE_BEGIN
 
-BSDFQueryRecord::BSDFQueryRecord(const Vector3f & wi) : wi(wi)
+BSDFQueryRecord::BSDFQueryRecord(const Vector3f & wi) : wi(wi), eta(1.f), measure(EUnknownMeasure),
+        mode(ETransportMode::ERadiance), pSampler(nullptr)
 {
 
 }
 
 BSDFQueryRecord::BSDFQueryRecord(const Vector3f & wi, const Vector3f & wo,
-                EMeasure measure) :wi(wi), wo(wo)
+                EMeasure measure) :wi(wi), wo(wo), eta(1.f), measure(measure),
+        mode(ETransportMode::ERadiance), pSampler(nullptr)
 {
 
 }
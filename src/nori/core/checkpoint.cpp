@@ -0,0 +1,263 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#include <nori/core/checkpoint.h>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+
+NORI_NAMESPACE_BEGIN
+
+namespace
+{
+    const char CHECKPOINT_MAGIC[8] = { 'N', 'O', 'R', 'I', 'C', 'K', 'P', 'T' };
+    const uint32_t CHECKPOINT_VERSION = 2;
+
+    template <typename T> void writeValue(std::ostream & stream, const T & value)
+    {
+        stream.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    template <typename T> void readValue(std::istream & stream, T & value)
+    {
+        stream.read(reinterpret_cast<char *>(&value), sizeof(T));
+    }
+}
+
+RenderCheckpoint::RenderCheckpoint(const Vector2i & size, int blockSize, uint32_t sampleCount, uint64_t seed,
+                                   uint64_t configHash) :
+        m_size(size), m_blockSize(blockSize), m_sampleCount(sampleCount), m_seed(seed), m_configHash(configHash)
+{
+    m_numBlocks = Vector2i(
+            (size.x() + blockSize - 1) / blockSize,
+            (size.y() + blockSize - 1) / blockSize
+    );
+    m_completed.resize(size_t(m_numBlocks.x() * m_numBlocks.y()), 0);
+    m_pixelSampleCounts.resize(size_t(size.x()) * size_t(size.y()), 0);
+}
+
+uint64_t RenderCheckpoint::hashConfiguration(const std::string & description)
+{
+    /* FNV-1a, which unlike std::hash is the same for every build */
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (char c : description)
+    {
+        hash = (hash ^ uint64_t(uint8_t(c))) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+int RenderCheckpoint::blockIndex(const ImageBlock & block) const
+{
+    Point2i index = block.getOffset() / m_blockSize;
+    return index.y() * m_numBlocks.x() + index.x();
+}
+
+bool RenderCheckpoint::isCompleted(const ImageBlock & block) const
+{
+    tbb::mutex::scoped_lock lock(m_mutex);
+    return m_completed[blockIndex(block)] != 0;
+}
+
+int RenderCheckpoint::getCompletedCount() const
+{
+    tbb::mutex::scoped_lock lock(m_mutex);
+    return int(std::count(m_completed.begin(), m_completed.end(), uint8_t(1)));
+}
+
+void RenderCheckpoint::commit(ImageBlock & result, ImageBlock & block)
+{
+    tbb::mutex::scoped_lock lock(m_mutex);
+
+    result.put(block);
+
+    m_completed[blockIndex(block)] = 1;
+
+    const Point2i & offset = block.getOffset();
+    const Vector2i & size = block.getSize();
+    for (int y = offset.y(); y < offset.y() + size.y(); y++)
+    {
+        for (int x = offset.x(); x < offset.x() + size.x(); x++)
+        {
+            m_pixelSampleCounts[size_t(y) * m_size.x() + x] += m_sampleCount;
+        }
+    }
+}
+
+void RenderCheckpoint::save(const std::string & filename, const ImageBlock & result) const
+{
+    /* Take a consistent snapshot, the file is written without holding the lock */
+    std::vector<uint8_t> completed;
+    std::vector<uint32_t> pixelSampleCounts;
+    std::vector<float> pixels;
+    int rows = int(result.rows()), cols = int(result.cols());
+    {
+        tbb::mutex::scoped_lock lock(m_mutex);
+        completed = m_completed;
+        pixelSampleCounts = m_pixelSampleCounts;
+        const float * pData = reinterpret_cast<const float *>(result.data());
+        pixels.assign(pData, pData + size_t(rows) * size_t(cols) * 4);
+    }
+
+    std::string tempName = filename + ".tmp";
+    {
+        std::ofstream stream(tempName, std::ios::binary | std::ios::trunc);
+        if (!stream)
+        {
+            throw NoriException("RenderCheckpoint::save(): Unable to open \"%s\" for writing!", tempName);
+        }
+
+        stream.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+        writeValue(stream, CHECKPOINT_VERSION);
+        writeValue(stream, int32_t(m_size.x()));
+        writeValue(stream, int32_t(m_size.y()));
+        writeValue(stream, int32_t(m_blockSize));
+        writeValue(stream, m_sampleCount);
+        writeValue(stream, m_seed);
+        writeValue(stream, m_configHash);
+        writeValue(stream, int32_t(rows));
+        writeValue(stream, int32_t(cols));
+        stream.write(reinterpret_cast<const char *>(completed.data()), completed.size());
+        stream.write(reinterpret_cast<const char *>(pixelSampleCounts.data()), pixelSampleCounts.size() * sizeof(uint32_t));
+        stream.write(reinterpret_cast<const char *>(pixels.data()), pixels.size() * sizeof(float));
+
+        if (!stream)
+        {
+            throw NoriException("RenderCheckpoint::save(): Error while writing \"%s\"!", tempName);
+        }
+    }
+
+    /* std::rename() does not replace existing files on every platform */
+    std::remove(filename.c_str());
+    if (std::rename(tempName.c_str(), filename.c_str()) != 0)
+    {
+        throw NoriException("RenderCheckpoint::save(): Unable to move \"%s\" to \"%s\"!", tempName, filename);
+    }
+
+    LOG(INFO) << "Saved checkpoint \"" << filename << "\" ("
+              << std::count(completed.begin(), completed.end(), uint8_t(1)) << "/"
+              << completed.size() << " blocks completed)";
+}
+
+bool RenderCheckpoint::saveIfDue(const std::string & filename, const ImageBlock & result, float interval)
+{
+    if (interval <= 0.0f || !m_saveMutex.try_lock())
+    {
+        return false;
+    }
+
+    bool bSaved = false;
+    if (m_timer.elapsed() >= interval * 1000.0)
+    {
+        try
+        {
+            save(filename, result);
+            bSaved = true;
+        }
+        catch (const NoriException & e)
+        {
+            LOG(ERROR) << e.what();
+        }
+        m_timer.reset();
+    }
+
+    m_saveMutex.unlock();
+    return bSaved;
+}
+
+void RenderCheckpoint::load(const std::string & filename, ImageBlock & result)
+{
+    std::ifstream stream(filename, std::ios::binary);
+    if (!stream)
+    {
+        throw NoriException("RenderCheckpoint::load(): Unable to open \"%s\"!", filename);
+    }
+
+    char magic[sizeof(CHECKPOINT_MAGIC)];
+    uint32_t version = 0, sampleCount = 0;
+    int32_t width = 0, height = 0, blockSize = 0, rows = 0, cols = 0;
+    uint64_t seed = 0, configHash = 0;
+
+    stream.read(magic, sizeof(magic));
+    readValue(stream, version);
+    if (!stream || std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0 || version != CHECKPOINT_VERSION)
+    {
+        throw NoriException("RenderCheckpoint::load(): \"%s\" is not a valid checkpoint file!", filename);
+    }
+
+    readValue(stream, width);
+    readValue(stream, height);
+    readValue(stream, blockSize);
+    readValue(stream, sampleCount);
+    readValue(stream, seed);
+    readValue(stream, configHash);
+    readValue(stream, rows);
+    readValue(stream, cols);
+
+    if (width != m_size.x() || height != m_size.y() || blockSize != m_blockSize ||
+        rows != result.rows() || cols != result.cols())
+    {
+        throw NoriException("RenderCheckpoint::load(): \"%s\" was written for a %ix%i image "
+                            "(block size %i), but the scene renders a %ix%i image (block size %i)!",
+                            filename, width, height, blockSize, m_size.x(), m_size.y(), m_blockSize);
+    }
+
+    if (sampleCount != m_sampleCount || seed != m_seed)
+    {
+        throw NoriException("RenderCheckpoint::load(): \"%s\" was written with %i samples per pixel "
+                            "and seed %i, but the sampler uses %i samples per pixel and seed %i!",
+                            filename, sampleCount, seed, m_sampleCount, m_seed);
+    }
+
+    if (configHash != m_configHash)
+    {
+        throw NoriException("RenderCheckpoint::load(): \"%s\" was written with a different integrator, "
+                            "sampler or camera configuration!", filename);
+    }
+
+    std::vector<uint8_t> completed(m_completed.size());
+    std::vector<uint32_t> pixelSampleCounts(m_pixelSampleCounts.size());
+    stream.read(reinterpret_cast<char *>(completed.data()), completed.size());
+    stream.read(reinterpret_cast<char *>(pixelSampleCounts.data()), pixelSampleCounts.size() * sizeof(uint32_t));
+
+    tbb::mutex::scoped_lock lock(m_mutex);
+    stream.read(reinterpret_cast<char *>(result.data()), std::streamsize(size_t(rows) * size_t(cols) * 4 * sizeof(float)));
+    if (!stream)
+    {
+        result.clear();
+        throw NoriException("RenderCheckpoint::load(): \"%s\" is truncated!", filename);
+    }
+
+    m_completed = std::move(completed);
+    m_pixelSampleCounts = std::move(pixelSampleCounts);
+}
+
+uint32_t RenderCheckpoint::getSampleCount(const Point2i & pixel) const
+{
+    tbb::mutex::scoped_lock lock(m_mutex);
+    return m_pixelSampleCounts[size_t(pixel.y()) * m_size.x() + pixel.x()];
+}
+
+std::string RenderCheckpoint::toString() const
+{
+    return tfm::format(
+            "RenderCheckpoint[\n"
+            "  size = %s,\n"
+            "  blockSize = %i,\n"
+            "  sampleCount = %i,\n"
+            "  seed = %i,\n"
+            "  configHash = %016x,\n"
+            "  completed = %i/%i\n"
+            "]",
+            m_size.toString(),
+            m_blockSize,
+            m_sampleCount,
+            m_seed,
+            m_configHash,
+            getCompletedCount(),
+            m_completed.size()
+    );
+}
+
+NORI_NAMESPACE_END
@@ -233,6 +233,31 @@ float fresnelDielectric(float cosThetaI, float eta, float invEta, float & cosThe
     return 0.5f * (rs * rs + rp * rp);
 }
 
+void fresnelDielectricBatch(const FloatBatch & cosThetaI, float eta, float invEta, FloatBatch & fresnel, FloatBatch & cosThetaT)
+{
+    Eigen::Index size = cosThetaI.size();
+    if (eta == 1.0f)
+    {
+        fresnel.setZero(size);
+        cosThetaT = -cosThetaI;
+        return;
+    }
+
+    /* Same as the scalar version, with the branches turned into selects */
+    FloatBatch scale = (cosThetaI > 0.0f).select(FloatBatch::Constant(size, invEta), FloatBatch::Constant(size, eta));
+    FloatBatch cosThetaTSqr = 1.0f - (1.0f - cosThetaI.square()) * scale.square();
+
+    FloatBatch cosThetaIi = cosThetaI.abs();
+    FloatBatch cosThetaTt = cosThetaTSqr.max(0.0f).sqrt();
+
+    FloatBatch rs = (cosThetaIi - eta * cosThetaTt) / (cosThetaIi + eta * cosThetaTt);
+    FloatBatch rp = (eta * cosThetaIi - cosThetaTt) / (eta * cosThetaIi + cosThetaTt);
+
+    /* Total internal reflection where cosThetaTSqr <= 0 */
+    fresnel = (cosThetaTSqr <= 0.0f).select(1.0f, 0.5f * (rs.square() + rp.square()));
+    cosThetaT = (cosThetaTSqr <= 0.0f).select(0.0f, (cosThetaI > 0.0f).select(-cosThetaTt, cosThetaTt));
+}
+
 Color3f fresnelConductor(float cosThetaI, const Color3f & eta, const Color3f & etaK)
 {
     float cosThetaI2 = cosThetaI * cosThetaI;
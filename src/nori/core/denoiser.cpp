@@ -0,0 +1,197 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#include <nori/core/denoiser.h>
+#include <nori/core/scene.h>
+#include <nori/core/camera.h>
+#include <nori/core/bsdf.h>
+#include <nori/core/intersection.h>
+#include <tbb/tbb.h>
+#include <pcg32.h>
+
+NORI_NAMESPACE_BEGIN
+
+namespace
+{
+    /// Weights of the 5-tap B3-spline kernel, indexed by the distance to the center
+    const float SplineWeights[3] = { 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f };
+
+    /// Albedo below which a channel is filtered without demodulation
+    const float MinAlbedo = 1e-3f;
+}
+
+Denoiser::Denoiser(int iterations, float sigmaColor, float sigmaNormal, float sigmaDepth, float sigmaAlbedo) :
+        m_iterations(iterations), m_sigmaColor(sigmaColor), m_sigmaNormal(sigmaNormal),
+        m_sigmaDepth(sigmaDepth), m_sigmaAlbedo(sigmaAlbedo)
+{
+
+}
+
+void Denoiser::renderFeatures(const Scene * pScene, uint32_t sampleCount, FeatureBuffers & features)
+{
+    const Camera * pCamera = pScene->getCamera();
+    Point2i offset = pCamera->getCropOffset();
+    Vector2i size = pCamera->getCropSize();
+
+    features.albedo.resize(size.y(), size.x());
+    features.normal.resize(size.y(), size.x());
+    features.depth.resize(size.y(), size.x());
+
+    tbb::parallel_for(tbb::blocked_range<int>(0, size.y()), [&](const tbb::blocked_range<int> & range) {
+        for (int y = range.begin(); y < range.end(); y++)
+        {
+            pcg32 random;
+            random.seed(uint64_t(y + offset.y()), PCG32_DEFAULT_STREAM);
+
+            for (int x = 0; x < size.x(); x++)
+            {
+                Color3f albedo(0.0f), normal(0.0f);
+                float depth = 0.0f;
+                for (uint32_t i = 0; i < sampleCount; i++)
+                {
+                    Point2f pixelSample(float(x + offset.x()) + random.nextFloat(), float(y + offset.y()) + random.nextFloat());
+                    Point2f apertureSample(random.nextFloat(), random.nextFloat());
+
+                    Ray3f ray;
+                    pCamera->sampleRay(ray, pixelSample, apertureSample);
+                    ray.scaleDifferentials(Ray3f::differentialScale(sampleCount));
+
+                    Intersection its;
+                    if (!pScene->rayIntersect(ray, its))
+                    {
+                        albedo += Color3f(1.0f);
+                        continue;
+                    }
+                    albedo += its.pBSDF != nullptr ? its.pBSDF->getAlbedo(its) : Color3f(1.0f);
+                    normal += Color3f(its.shFrame.n.x(), its.shFrame.n.y(), its.shFrame.n.z());
+                    depth += its.t;
+                }
+
+                float invSampleCount = 1.0f / float(sampleCount);
+                features.albedo(y, x) = albedo * invSampleCount;
+                features.normal(y, x) = normal * invSampleCount;
+                features.depth(y, x) = Color3f(depth * invSampleCount);
+            }
+        }
+    });
+}
+
+Bitmap * Denoiser::denoise(const Bitmap & color, const FeatureBuffers & features) const
+{
+    int width = int(color.cols()), height = int(color.rows());
+    if (features.albedo.cols() != width || features.albedo.rows() != height)
+    {
+        throw NoriException("Denoiser: the feature buffers (%ix%i) do not match the image (%ix%i)!",
+                            int(features.albedo.cols()), int(features.albedo.rows()), width, height);
+    }
+
+    /* Demodulate the albedo */
+    Bitmap current(Vector2i(width, height)), next(Vector2i(width, height));
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            const Color3f & albedo = features.albedo(y, x);
+            for (int i = 0; i < 3; i++)
+            {
+                current(y, x)[i] = albedo[i] > MinAlbedo ? color(y, x)[i] / albedo[i] : color(y, x)[i];
+            }
+        }
+    }
+
+    float sigmaColor = m_sigmaColor;
+    for (int iteration = 0; iteration < m_iterations; iteration++)
+    {
+        int step = 1 << iteration;
+        float invSigmaColor2 = 1.0f / (sigmaColor * sigmaColor);
+        float invSigmaNormal2 = 1.0f / (m_sigmaNormal * m_sigmaNormal);
+        float invSigmaAlbedo2 = 1.0f / (m_sigmaAlbedo * m_sigmaAlbedo);
+
+        tbb::parallel_for(tbb::blocked_range<int>(0, height), [&](const tbb::blocked_range<int> & range) {
+            for (int y = range.begin(); y < range.end(); y++)
+            {
+                for (int x = 0; x < width; x++)
+                {
+                    const Color3f & colorP = current(y, x);
+                    const Color3f & normalP = features.normal(y, x);
+                    const Color3f & albedoP = features.albedo(y, x);
+                    float depthP = features.depth(y, x).r();
+                    Color3f logColorP = (colorP + 1.0f).log();
+
+                    Color3f sum(0.0f);
+                    float weightSum = 0.0f;
+                    for (int dy = -2; dy <= 2; dy++)
+                    {
+                        int qy = y + dy * step;
+                        if (qy < 0 || qy >= height)
+                        {
+                            continue;
+                        }
+                        for (int dx = -2; dx <= 2; dx++)
+                        {
+                            int qx = x + dx * step;
+                            if (qx < 0 || qx >= width)
+                            {
+                                continue;
+                            }
+
+                            const Color3f & colorQ = current(qy, qx);
+                            float depthQ = features.depth(qy, qx).r();
+
+                            /* Colors are compared in log space, the image is HDR */
+                            float colorDistance = (logColorP - (colorQ + 1.0f).log()).matrix().squaredNorm();
+                            float normalDistance = (normalP - features.normal(qy, qx)).matrix().squaredNorm();
+                            float albedoDistance = (albedoP - features.albedo(qy, qx)).matrix().squaredNorm();
+                            float depthDistance = std::abs(depthP - depthQ) / (m_sigmaDepth * std::max(depthP, depthQ) + Epsilon);
+
+                            float weight = SplineWeights[std::abs(dx)] * SplineWeights[std::abs(dy)] * std::exp(
+                                    -colorDistance * invSigmaColor2
+                                    - normalDistance * invSigmaNormal2
+                                    - albedoDistance * invSigmaAlbedo2
+                                    - depthDistance);
+
+                            sum += colorQ * weight;
+                            weightSum += weight;
+                        }
+                    }
+                    next(y, x) = sum / weightSum;
+                }
+            }
+        });
+
+        current.swap(next);
+        sigmaColor *= 0.5f;
+    }
+
+    /* Restore the texture detail */
+    Bitmap * pResult = new Bitmap(Vector2i(width, height));
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            const Color3f & albedo = features.albedo(y, x);
+            for (int i = 0; i < 3; i++)
+            {
+                (*pResult)(y, x)[i] = albedo[i] > MinAlbedo ? current(y, x)[i] * albedo[i] : current(y, x)[i];
+            }
+        }
+    }
+    return pResult;
+}
+
+std::string Denoiser::toString() const
+{
+    return tfm::format(
+            "Denoiser[\n"
+            "  iterations = %i,\n"
+            "  sigmaColor = %f,\n"
+            "  sigmaNormal = %f,\n"
+            "  sigmaDepth = %f,\n"
+            "  sigmaAlbedo = %f\n"
+            "]",
+            m_iterations, m_sigmaColor, m_sigmaNormal, m_sigmaDepth, m_sigmaAlbedo
+    );
+}
+
+NORI_NAMESPACE_END
@@ -8,8 +8,14 @@
 
 NORI_NAMESPACE_BEGIN
 
-DiscretePDF1D::DiscretePDF1D(const float * pFunc, const int& count) :
-        m_func(pFunc, pFunc + count), m_cdf(count + 1)
+namespace
+{
+    /// Largest float below one
+    const float OneMinusEpsilon = 0x1.fffffep-1f;
+}
+
+DiscretePDF1D::DiscretePDF1D(const float * pFunc, const int& count, bool bAliasTable) :
+        m_func(pFunc, pFunc + count), m_cdf(count + 1), m_bAliasTable(bAliasTable)
 {
     m_cdf[0] = 0.0f;
     for (int i = 1; i < count + 1; i++)
@@ -33,30 +39,104 @@ DiscretePDF1D::DiscretePDF1D(const float * pFunc, const int& count) :
             m_cdf[i] /= m_funcIntegral;
         }
     }
+
+    if (m_bAliasTable)
+    {
+        buildAliasTable();
+    }
 }
 
-int DiscretePDF1D::count() const
+void DiscretePDF1D::buildAliasTable()
 {
-    return int(m_func.size());
+    int n = count();
+    double sum = 0.0;
+    for (float value : m_func)
+    {
+        sum += double(value);
+    }
+
+    /* Probabilities scaled by the count (one on average), uniform like the CDF when the function vanishes */
+    std::vector<double> scaled(n);
+    std::vector<int> small, large;
+    for (int i = 0; i < n; i++)
+    {
+        scaled[i] = m_funcIntegral < Epsilon ? 1.0 : double(m_func[i]) * double(n) / sum;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+
+    /* Vose: fill every underfull bin with the excess of an overfull one */
+    m_aliasTable.resize(n);
+    while (!small.empty() && !large.empty())
+    {
+        int less = small.back();
+        int more = large.back();
+        small.pop_back();
+
+        m_aliasTable[less] = { float(scaled[less]), more };
+        scaled[more] -= 1.0 - scaled[less];
+        if (scaled[more] < 1.0)
+        {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+
+    /* The remaining bins are full up to rounding errors */
+    for (int i : large)
+    {
+        m_aliasTable[i] = { 1.0f, i };
+    }
+    for (int i : small)
+    {
+        m_aliasTable[i] = { 1.0f, i };
+    }
 }
 
-float DiscretePDF1D::sampleContinuous(const float& sample, float * pPdf, int * pIdx) const
+int DiscretePDF1D::sampleIndex(const float& sample, float& sampleRemapped) const
 {
+    if (m_bAliasTable)
+    {
+        double scaled = double(sample) * double(m_aliasTable.size());
+        int bin = std::min(int(scaled), int(m_aliasTable.size()) - 1);
+        float u = std::min(float(scaled - double(bin)), OneMinusEpsilon);
+
+        const AliasEntry & entry = m_aliasTable[bin];
+        if (u < entry.prob)
+        {
+            sampleRemapped = u / entry.prob;
+            return bin;
+        }
+        sampleRemapped = (u - entry.prob) / (1.0f - entry.prob);
+        return entry.alias;
+    }
+
     auto iter = std::lower_bound(m_cdf.begin(), m_cdf.end(), sample);
     int idx = int(std::min(
             size_t(std::max(std::ptrdiff_t(0), iter - m_cdf.begin() - 1)),
             m_cdf.size() - 2
     ));
 
-    if (pIdx != nullptr)
+    sampleRemapped = sample - m_cdf[idx];
+    if (m_cdf[idx + 1] - m_cdf[idx] > 0.0f)
     {
-        *pIdx = idx;
+        sampleRemapped /= (m_cdf[idx + 1] - m_cdf[idx]);
     }
+    return idx;
+}
 
-    float du = sample - m_cdf[idx];
-    if (m_cdf[idx + 1] - m_cdf[idx] > 0.0f)
+int DiscretePDF1D::count() const
+{
+    return int(m_func.size());
+}
+
+float DiscretePDF1D::sampleContinuous(const float& sample, float * pPdf, int * pIdx) const
+{
+    float du;
+    int idx = sampleIndex(sample, du);
+
+    if (pIdx != nullptr)
     {
-        du /= (m_cdf[idx + 1] - m_cdf[idx]);
+        *pIdx = idx;
     }
     CHECK(!std::isnan(du));
 
@@ -71,11 +151,8 @@ float DiscretePDF1D::sampleContinuous(const float& sample, float * pPdf, int * p
 
 int DiscretePDF1D::sampleDiscrete(const float& sample, float * pPdf, float * pSampleRemapped) const
 {
-    auto iter = std::lower_bound(m_cdf.begin(), m_cdf.end(), sample);
-    int idx = int(std::min(
-            size_t(std::max(std::ptrdiff_t(0), iter - m_cdf.begin() - 1)),
-            m_cdf.size() - 2
-    ));
+    float sampleRemapped;
+    int idx = sampleIndex(sample, sampleRemapped);
 
     if (pPdf != nullptr)
     {
@@ -84,7 +161,7 @@ int DiscretePDF1D::sampleDiscrete(const float& sample, float * pPdf, float * pSa
 
     if (pSampleRemapped != nullptr)
     {
-        *pSampleRemapped = (sample - m_cdf[idx]) / (m_cdf[idx + 1] - m_cdf[idx]);
+        *pSampleRemapped = sampleRemapped;
         CHECK(*pSampleRemapped <= 1.0f && *pSampleRemapped >= 0.0f);
     }
 
@@ -99,12 +176,12 @@ float DiscretePDF1D::pdf(const int& index) const
 
 
 
-DiscretePDF2D::DiscretePDF2D(float * pDatas, const int& width, const int& height)
+DiscretePDF2D::DiscretePDF2D(float * pDatas, const int& width, const int& height, bool bAliasTable)
 {
     m_pConditionalRow.reserve(height);
     for (int i = 0; i < height; i++)
     {
-        m_pConditionalRow.emplace_back(new DiscretePDF1D(&pDatas[i * width], width));
+        m_pConditionalRow.emplace_back(new DiscretePDF1D(&pDatas[i * width], width, bAliasTable));
     }
 
     std::vector<float> marginal;
@@ -113,7 +190,7 @@ DiscretePDF2D::DiscretePDF2D(float * pDatas, const int& width, const int& height
     {
         marginal.push_back(m_pConditionalRow[i]->m_funcIntegral);
     }
-    m_pMarginalCol.reset(new DiscretePDF1D(marginal.data(), height));
+    m_pMarginalCol.reset(new DiscretePDF1D(marginal.data(), height, bAliasTable));
 }
 
 Point2f DiscretePDF2D::sampleContinuous(const Point2f& sample, float * pPdf, Point2i * idx) const
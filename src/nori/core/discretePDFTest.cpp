@@ -0,0 +1,299 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#include <nori/core/discretePDFTest.h>
+#include <nori/core/discretePDF.h>
+#include <nori/core/mesh.h>
+#include <nori/core/bsdf.h>
+#include <nori/core/timer.h>
+#include <pcg32.h>
+#include <hypothesis.h>
+
+NORI_NAMESPACE_BEGIN
+
+namespace
+{
+    /// Deviation (in standard errors) above which a test fails
+    const double MaxDeviation = 5.0;
+
+    /// Cells with a lower expected frequency are pooled for the chi^2 test
+    const double MinExpFrequency = 5.0;
+
+    /// Significance level of the chi^2 tests (shared by all of them)
+    const double SignificanceLevel = 0.01;
+
+    /// Number of chi^2 tests: both backends in 1D, for a mesh and in 2D
+    const int Chi2TestCount = 6;
+
+    /// Random weights, most of them close to zero
+    std::vector<float> createWeights(int count, pcg32 & random)
+    {
+        std::vector<float> weights(count);
+        for (float & weight : weights)
+        {
+            weight = std::pow(random.nextFloat(), 8.0f);
+        }
+        return weights;
+    }
+
+    /// Mesh of disjoint right triangles whose areas are the given weights
+    class WeightedMesh : public Mesh
+    {
+    public:
+        WeightedMesh(const std::vector<float> & weights, bool bAliasTable)
+        {
+            m_V.resize(3, 3 * weights.size());
+            m_F.resize(3, weights.size());
+            for (size_t i = 0; i < weights.size(); i++)
+            {
+                float size = std::sqrt(2.0f * weights[i]);
+                Point3f p(float(i), 0.0f, 0.0f);
+                m_V.col(3 * i) = p;
+                m_V.col(3 * i + 1) = p + Vector3f(size, 0.0f, 0.0f);
+                m_V.col(3 * i + 2) = p + Vector3f(0.0f, size, 0.0f);
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    m_F(k, i) = uint32_t(3 * i) + k;
+                }
+                m_bbox.expandBy(p);
+            }
+            m_name = "weighted";
+            m_bsdf = static_cast<BSDF *>(NoriObjectFactory::createInstance(DEFAULT_MESH_BSDF, PropertyList()));
+            m_bAliasTable = bAliasTable;
+            activate();
+        }
+    };
+
+    /**
+     * \brief Compare the average of the reported densities against its expected value
+     *
+     * \param moments  Sums of the squared and the cubed probabilities of the entries
+     */
+    bool checkDensities(const std::string & name, double densitySum, const Vector2d & moments,
+                        int sampleCount, double milliseconds)
+    {
+        double mean = densitySum / double(sampleCount);
+        double stdError = std::sqrt(std::max(moments.y() - moments.x() * moments.x(), 0.0) / double(sampleCount));
+        double deviation = std::abs(mean - moments.x()) / std::max(stdError, 1e-12);
+
+        bool passed = deviation <= MaxDeviation;
+        cout << tfm::format("%-14s: %8.2f ns/sample, average density %f (expected %f, %.2f standard errors) .. %s",
+                            name, milliseconds * 1e6 / double(sampleCount), mean, moments.x(), deviation,
+                            passed ? "passed" : "FAILED") << endl;
+        return passed;
+    }
+
+    /// Chi^2 test of the histogram of the sampled entries against the expected frequencies
+    bool checkHistogram(const std::string & name, const std::vector<double> & obsFrequencies,
+                        const std::vector<double> & expFrequencies, int sampleCount)
+    {
+        std::pair<bool, std::string> result = hypothesis::chi2_test(int(obsFrequencies.size()), obsFrequencies.data(),
+                                                                    expFrequencies.data(), sampleCount, MinExpFrequency,
+                                                                    SignificanceLevel, Chi2TestCount);
+        cout << tfm::format("%-14s: %s .. %s", name, result.second, result.first ? "passed" : "FAILED") << endl;
+        return result.first;
+    }
+}
+
+DiscretePDFTest::DiscretePDFTest(const PropertyList & propList)
+{
+    /* Number of entries of the 1D distributions */
+    m_count = propList.getInteger(XML_TEST_DISCRETE_PDF_COUNT, DEFAULT_TEST_DISCRETE_PDF_COUNT);
+
+    /* Resolution of the 2D distributions (e.g. an environment map) */
+    m_width = propList.getInteger(XML_TEST_DISCRETE_PDF_WIDTH, DEFAULT_TEST_DISCRETE_PDF_WIDTH);
+    m_height = propList.getInteger(XML_TEST_DISCRETE_PDF_HEIGHT, DEFAULT_TEST_DISCRETE_PDF_HEIGHT);
+
+    /* Number of samples drawn from every distribution */
+    m_sampleCount = propList.getInteger(XML_TEST_DISCRETE_PDF_SAMPLE_COUNT, DEFAULT_TEST_DISCRETE_PDF_SAMPLE_COUNT);
+
+    if (m_count <= 0 || m_width <= 0 || m_height <= 0 || m_sampleCount <= 1)
+    {
+        throw NoriException("DiscretePDFTest: the sizes and the sample count must be positive!");
+    }
+}
+
+void DiscretePDFTest::activate()
+{
+    int passed = 0, total = 0;
+    pcg32 random;
+
+    /* 1D: selection of an entry, e.g. a triangle of a mesh */
+    std::vector<float> weights = createWeights(m_count, random);
+    double weightSum = 0.0;
+    for (float weight : weights)
+    {
+        weightSum += double(weight);
+    }
+    Vector2d moments(0.0, 0.0);
+    std::vector<double> expFrequencies(m_count);
+    for (int i = 0; i < m_count; i++)
+    {
+        double p = double(weights[i]) / weightSum;
+        moments += Vector2d(p * p, p * p * p);
+        expFrequencies[i] = p * double(m_sampleCount);
+    }
+
+    cout << "------------------------------------------------------" << endl;
+    cout << "Testing DiscretePDF1D with " << m_count << " entries, " << m_sampleCount << " samples" << endl;
+    for (bool bAliasTable : { false, true })
+    {
+        DiscretePDF1D pdf(weights.data(), m_count, bAliasTable);
+        pcg32 sampler;
+        double densitySum = 0.0;
+        int mismatches = 0;
+        std::vector<double> obsFrequencies(m_count, 0.0);
+
+        Timer timer;
+        for (int i = 0; i < m_sampleCount; i++)
+        {
+            float density;
+            int index = pdf.sampleDiscrete(sampler.nextFloat(), &density);
+            densitySum += double(density);
+            mismatches += density != pdf.pdf(index) ? 1 : 0;
+            obsFrequencies[index] += 1.0;
+        }
+        double milliseconds = timer.elapsed();
+
+        std::string name = bAliasTable ? "alias table" : "CDF inversion";
+        total += 2;
+        if (checkDensities(name, densitySum, moments, m_sampleCount, milliseconds) && mismatches == 0)
+        {
+            ++passed;
+        }
+        if (checkHistogram(name, obsFrequencies, expFrequencies, m_sampleCount))
+        {
+            ++passed;
+        }
+    }
+
+    /* 1D through a mesh: area sampling of a mesh light, as done by Mesh::samplePosition() */
+    cout << "------------------------------------------------------" << endl;
+    cout << "Testing Mesh::samplePosition() with " << m_count << " triangles, " << m_sampleCount << " samples" << endl;
+    for (bool bAliasTable : { false, true })
+    {
+        WeightedMesh mesh(weights, bAliasTable);
+        double areaSum = 0.0;
+        for (uint32_t i = 0; i < mesh.getTriangleCount(); i++)
+        {
+            areaSum += double(mesh.surfaceArea(i));
+        }
+        for (int i = 0; i < m_count; i++)
+        {
+            expFrequencies[i] = double(mesh.surfaceArea(uint32_t(i))) / areaSum * double(m_sampleCount);
+        }
+
+        pcg32 sampler;
+        Point3f positionSum(0.0f);
+        Timer timer;
+        for (int i = 0; i < m_sampleCount; i++)
+        {
+            Point3f position;
+            Normal3f normal;
+            mesh.samplePosition(sampler.nextFloat(), Point2f(sampler.nextFloat(), sampler.nextFloat()), position, normal);
+            positionSum += position;
+        }
+        double milliseconds = timer.elapsed();
+
+        /* The same sequence, binned by the triangles that were selected */
+        sampler = pcg32();
+        std::vector<double> obsFrequencies(m_count, 0.0);
+        for (int i = 0; i < m_sampleCount; i++)
+        {
+            obsFrequencies[mesh.sampleTriangleIndex(sampler.nextFloat())] += 1.0;
+            sampler.nextFloat();
+            sampler.nextFloat();
+        }
+
+        std::string name = bAliasTable ? "alias table" : "CDF inversion";
+        cout << tfm::format("%-14s: %8.2f ns/sample (average position %s)", name,
+                            milliseconds * 1e6 / double(m_sampleCount),
+                            Point3f(positionSum / float(m_sampleCount)).toString()) << endl;
+        total++;
+        if (checkHistogram(name, obsFrequencies, expFrequencies, m_sampleCount))
+        {
+            ++passed;
+        }
+    }
+
+    /* 2D: importance sampling of an image, e.g. an environment map */
+    int cellCount = m_width * m_height;
+    std::vector<float> image = createWeights(cellCount, random);
+    double imageSum = 0.0;
+    for (float value : image)
+    {
+        imageSum += double(value);
+    }
+    moments = Vector2d(0.0, 0.0);
+    expFrequencies.resize(cellCount);
+    for (int i = 0; i < cellCount; i++)
+    {
+        /* Densities wrt. the unit square, every cell has the area 1 / cellCount */
+        double density = double(image[i]) / imageSum * double(cellCount);
+        moments += Vector2d(density * density, density * density * density) / double(cellCount);
+        expFrequencies[i] = double(image[i]) / imageSum * double(m_sampleCount);
+    }
+
+    cout << "------------------------------------------------------" << endl;
+    cout << "Testing DiscretePDF2D with " << m_width << "x" << m_height << " cells, " << m_sampleCount << " samples" << endl;
+    for (bool bAliasTable : { false, true })
+    {
+        DiscretePDF2D pdf(image.data(), m_width, m_height, bAliasTable);
+        pcg32 sampler;
+        double densitySum = 0.0;
+        std::vector<double> obsFrequencies(cellCount, 0.0);
+
+        Timer timer;
+        for (int i = 0; i < m_sampleCount; i++)
+        {
+            float density;
+            Point2i cell;
+            pdf.sampleContinuous(Point2f(sampler.nextFloat(), sampler.nextFloat()), &density, &cell);
+            densitySum += double(density);
+            obsFrequencies[cell.y() * m_width + cell.x()] += 1.0;
+        }
+        double milliseconds = timer.elapsed();
+
+        std::string name = bAliasTable ? "alias table" : "CDF inversion";
+        total += 2;
+        if (checkDensities(name, densitySum, moments, m_sampleCount, milliseconds))
+        {
+            ++passed;
+        }
+        if (checkHistogram(name, obsFrequencies, expFrequencies, m_sampleCount))
+        {
+            ++passed;
+        }
+    }
+
+    cout << "Passed " << passed << "/" << total << " tests." << endl;
+    if (passed < total)
+    {
+        throw std::runtime_error("Some tests failed :(");
+    }
+}
+
+std::string DiscretePDFTest::toString() const
+{
+    return tfm::format(
+            "DiscretePDFTest[\n"
+            "  count = %i,\n"
+            "  width = %i,\n"
+            "  height = %i,\n"
+            "  sampleCount = %i\n"
+            "]",
+            m_count,
+            m_width,
+            m_height,
+            m_sampleCount
+    );
+}
+
+NoriObject::EClassType DiscretePDFTest::getClassType() const
+{
+    return ETest;
+}
+
+NORI_REGISTER_CLASS(DiscretePDFTest, XML_TEST_DISCRETE_PDF);
+NORI_NAMESPACE_END
@@ -26,4 +26,16 @@ bool Emitter::isDelta() const
     return m_type == EEmitterType::EPoint;
 }
 
+Color3f Emitter::sampleRay(Ray3f & ray, Normal3f & n, const Point2f & positionSample, const Point2f & directionSample,
+                           float sample1D, const BoundingBox3f & sceneBounds) const
+{
+    throw NoriException("Emitter::sampleRay() is not implemented for <%s>!", toString());
+}
+
+void Emitter::pdfRay(const Ray3f & ray, const Normal3f & n, const BoundingBox3f & sceneBounds,
+                     float & pdfPosition, float & pdfDirection) const
+{
+    throw NoriException("Emitter::pdfRay() is not implemented for <%s>!", toString());
+}
+
 NORI_NAMESPACE_END
\ No newline at end of file
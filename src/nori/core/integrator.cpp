@@ -0,0 +1,52 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#include <nori/core/integrator.h>
+#include <nori/core/scene.h>
+#include <nori/core/camera.h>
+#include <nori/core/sampler.h>
+#include <nori/core/block.h>
+#include <tbb/tbb.h>
+
+NORI_NAMESPACE_BEGIN
+
+void Integrator::traceCameraRays(const Scene *pScene, uint32_t sampleCount, uint64_t seed,
+                                 const std::function<void(Sampler *, const Ray3f &)> &trace) const {
+    const Camera *pCamera = pScene->getCamera();
+    Vector2i outputSize = pCamera->getOutputSize();
+    std::unique_ptr<Sampler> pSampler(static_cast<Sampler *>(NoriObjectFactory::createInstance("independent", PropertyList())));
+    BlockGenerator blockGenerator(outputSize, NORI_BLOCK_SIZE);
+
+    tbb::parallel_for(tbb::blocked_range<int>(0, blockGenerator.getBlockCount()),
+        [&](const tbb::blocked_range<int> &range) {
+            ImageBlock block(Vector2i(NORI_BLOCK_SIZE), pCamera->getReconstructionFilter());
+            std::unique_ptr<Sampler> pLocalSampler(pSampler->clone());
+            pLocalSampler->setSeed(seed);
+
+            for (int i = range.begin(); i < range.end(); i++) {
+                blockGenerator.next(block);
+                pLocalSampler->prepare(block);
+
+                Point2i offset = block.getOffset();
+                Vector2i size = block.getSize();
+                for (int y = 0; y < size.y(); y++) {
+                    for (int x = 0; x < size.x(); x++) {
+                        pLocalSampler->generate(Point2i(x + offset.x(), y + offset.y()));
+                        for (uint32_t j = 0; j < sampleCount; j++) {
+                            Point2f pixelSample = Point2f(float(x + offset.x()), float(y + offset.y())) + pLocalSampler->next2D();
+                            Point2f apertureSample = pLocalSampler->next2D();
+
+                            Ray3f ray;
+                            pCamera->sampleRay(ray, pixelSample, apertureSample);
+                            ray.scaleDifferentials(Ray3f::differentialScale(sampleCount));
+                            trace(pLocalSampler.get(), ray);
+                            pLocalSampler->advance();
+                        }
+                    }
+                }
+            }
+        });
+}
+
+NORI_NAMESPACE_END
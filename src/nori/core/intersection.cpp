@@ -27,22 +27,31 @@ Ray3f Intersection::generateShadowRay(const Point3f & destPoint) const
     return shadowRay;
 }
 
-void Intersection::computeScreenSpacePartial(const Ray3f & Ray)
+void Intersection::computePartials() const
 {
-    /* Compute the texture coordinates partials wrt.
-	changes in the screen-space position. Based on PBRT 10.1.1 */
-
-    if (!Ray.bHasDifferentials || !bHasUVPartial)
+    if (bPartialsComputed || pShape == nullptr)
     {
         return;
     }
+    pShape->computePartials(*this);
+    bPartialsComputed = true;
+}
 
-    if (dPdU.isZero() && dPdV.isZero())
+void Intersection::setRayDifferentials(const Ray3f & Ray)
+{
+    /* Compute the position partials wrt. changes in the
+	screen-space position. Based on PBRT 10.1.1 */
+
+    dPdX = Vector3f(0.0f);
+    dPdY = Vector3f(0.0f);
+    dUdX = 0.0f;
+    dUdY = 0.0f;
+    dVdX = 0.0f;
+    dVdY = 0.0f;
+    bScreenSpacePartialsComputed = true;
+
+    if (!Ray.bHasDifferentials)
     {
-        dUdX = 0.0f;
-        dUdY = 0.0f;
-        dVdX = 0.0f;
-        dVdY = 0.0f;
         return;
     }
 
@@ -55,10 +64,6 @@ void Intersection::computeScreenSpacePartial(const Ray3f & Ray)
 
     if (pRxDirection == 0.0 || pRyDirection == 0.0)
     {
-        dUdX = 0.0f;
-        dUdY = 0.0f;
-        dVdX = 0.0f;
-        dVdY = 0.0f;
         return;
     }
 
@@ -66,6 +71,34 @@ void Intersection::computeScreenSpacePartial(const Ray3f & Ray)
     float Tx = (pP - pRxOrigin) / pRxDirection;
     float Ty = (pP - pRyOrigin) / pRyDirection;
 
+    /* Auxilary intersection point of the adjacent rays */
+    Point3f Px = Ray.rxOrigin + Ray.rxDirection * Tx;
+    Point3f	Py = Ray.ryOrigin + Ray.ryDirection * Ty;
+    dPdX = Px - p;
+    dPdY = Py - p;
+
+    /* The texture coordinate partials are only needed by filtered lookups */
+    bScreenSpacePartialsComputed = false;
+}
+
+void Intersection::computeScreenSpacePartials() const
+{
+    if (bScreenSpacePartialsComputed)
+    {
+        return;
+    }
+    bScreenSpacePartialsComputed = true;
+    if (dPdX.isZero() && dPdY.isZero())
+    {
+        return;
+    }
+
+    computePartials();
+    if (!bHasUVPartial || (dPdU.isZero() && dPdV.isZero()))
+    {
+        return;
+    }
+
     /* Calculate the U and V partials by solving two out
     of a set of 3 equations in an overconstrained system */
     float AbsX = std::abs(geoFrame.n.x());
@@ -93,14 +126,10 @@ void Intersection::computeScreenSpacePartial(const Ray3f & Ray)
     A[1][0] = dPdU[Axes[1]];
     A[1][1] = dPdV[Axes[1]];
 
-    /* Auxilary intersection point of the adjacent rays */
-    Point3f Px = Ray.rxOrigin + Ray.rxDirection * Tx;
-    Point3f	Py = Ray.ryOrigin + Ray.ryDirection * Ty;
-
-    Bx[0] = Px[Axes[0]] - p[Axes[0]];
-    Bx[1] = Px[Axes[1]] - p[Axes[1]];
-    By[0] = Py[Axes[0]] - p[Axes[0]];
-    By[1] = Py[Axes[1]] - p[Axes[1]];
+    Bx[0] = dPdX[Axes[0]];
+    Bx[1] = dPdX[Axes[1]];
+    By[0] = dPdY[Axes[0]];
+    By[1] = dPdY[Axes[1]];
 
     if (solveLinearSystem2x2(A, Bx, X))
     {
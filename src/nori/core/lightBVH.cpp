@@ -0,0 +1,454 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#include <nori/core/lightBVH.h>
+#include <nori/core/emitter.h>
+#include <nori/core/emitterQueryRecord.h>
+#include <nori/core/timer.h>
+
+NORI_NAMESPACE_BEGIN
+
+namespace
+{
+    const uint64_t INVALID_BIT_TRAIL = ~uint64_t(0);
+    const int BUCKET_COUNT = 12;
+    const int MAX_DEPTH = 63;
+
+    inline float safeSqrt(float x)
+    {
+        return std::sqrt(std::max(x, 0.0f));
+    }
+
+    inline float safeAcos(float x)
+    {
+        return std::acos(clamp(x, -1.0f, 1.0f));
+    }
+
+    /// cos(max(0, a - b)) given the sines and cosines of both angles
+    inline float cosSubClamped(float sinThetaA, float cosThetaA, float sinThetaB, float cosThetaB)
+    {
+        if (cosThetaA > cosThetaB)
+        {
+            return 1.0f;
+        }
+        return cosThetaA * cosThetaB + sinThetaA * sinThetaB;
+    }
+
+    /// sin(max(0, a - b)) given the sines and cosines of both angles
+    inline float sinSubClamped(float sinThetaA, float cosThetaA, float sinThetaB, float cosThetaB)
+    {
+        if (cosThetaA > cosThetaB)
+        {
+            return 0.0f;
+        }
+        return sinThetaA * cosThetaB - cosThetaA * sinThetaB;
+    }
+
+    /// Rotate \c v by \c theta around the unit axis \c k (Rodrigues' formula)
+    inline Vector3f rotate(const Vector3f & v, const Vector3f & k, float theta)
+    {
+        float cosTheta = std::cos(theta), sinTheta = std::sin(theta);
+        return v * cosTheta + k.cross(v) * sinTheta + k * k.dot(v) * (1.0f - cosTheta);
+    }
+}
+
+float LightBounds::importance(const Point3f & p, const Normal3f & n) const
+{
+    Point3f center = bounds.getCenter();
+    float distanceSquared = (p - center).squaredNorm();
+    distanceSquared = std::max(distanceSquared, bounds.getRadius());
+
+    /* Angle between the cone axis and the direction towards the point */
+    Vector3f wi = (p - center).normalized();
+    float cosThetaW = w.dot(wi);
+    if (bTwoSided)
+    {
+        cosThetaW = std::abs(cosThetaW);
+    }
+    float sinThetaW = safeSqrt(1.0f - cosThetaW * cosThetaW);
+
+    /* Angle subtended by the bounds as seen from the point */
+    float radius = bounds.getRadius();
+    float cosThetaB = -1.0f;
+    if ((p - center).squaredNorm() > radius * radius)
+    {
+        cosThetaB = safeSqrt(1.0f - radius * radius / (p - center).squaredNorm());
+    }
+    float sinThetaB = safeSqrt(1.0f - cosThetaB * cosThetaB);
+
+    /* Minimum angle between the emitted directions and the point */
+    float sinThetaO = safeSqrt(1.0f - cosThetaO * cosThetaO);
+    float cosThetaX = cosSubClamped(sinThetaW, cosThetaW, sinThetaO, cosThetaO);
+    float sinThetaX = sinSubClamped(sinThetaW, cosThetaW, sinThetaO, cosThetaO);
+    float cosThetaP = cosSubClamped(sinThetaX, cosThetaX, sinThetaB, cosThetaB);
+    if (cosThetaP <= cosThetaE)
+    {
+        return 0.0f;
+    }
+
+    float result = phi * cosThetaP / distanceSquared;
+
+    /* Maximum cosine at the receiver */
+    if (!n.isZero())
+    {
+        float cosThetaI = std::abs(wi.dot(n));
+        float sinThetaI = safeSqrt(1.0f - cosThetaI * cosThetaI);
+        result *= cosSubClamped(sinThetaI, cosThetaI, sinThetaB, cosThetaB);
+    }
+
+    return std::max(result, 0.0f);
+}
+
+LightBounds LightBounds::merge(const LightBounds & a, const LightBounds & b)
+{
+    if (a.phi == 0.0f)
+    {
+        return b;
+    }
+    if (b.phi == 0.0f)
+    {
+        return a;
+    }
+
+    LightBounds result;
+    result.bounds = BoundingBox3f::merge(a.bounds, b.bounds);
+    result.phi = a.phi + b.phi;
+    result.cosThetaE = std::min(a.cosThetaE, b.cosThetaE);
+    result.bTwoSided = a.bTwoSided || b.bTwoSided;
+
+    /* Smallest cone containing both normal cones */
+    float thetaA = safeAcos(a.cosThetaO), thetaB = safeAcos(b.cosThetaO);
+    float thetaD = safeAcos(a.w.dot(b.w));
+    if (std::min(thetaD + thetaB, float(M_PI)) <= thetaA)
+    {
+        result.w = a.w;
+        result.cosThetaO = a.cosThetaO;
+        return result;
+    }
+    if (std::min(thetaD + thetaA, float(M_PI)) <= thetaB)
+    {
+        result.w = b.w;
+        result.cosThetaO = b.cosThetaO;
+        return result;
+    }
+
+    float thetaO = (thetaA + thetaD + thetaB) * 0.5f;
+    Vector3f axis = a.w.cross(b.w);
+    if (thetaO >= M_PI || axis.squaredNorm() == 0.0f)
+    {
+        result.w = a.w;
+        result.cosThetaO = -1.0f;
+        return result;
+    }
+
+    result.w = rotate(a.w, axis.normalized(), thetaO - thetaA).normalized();
+    result.cosThetaO = std::cos(thetaO);
+    return result;
+}
+
+LightBVH::LightBVH(const std::vector<Emitter *> & emitters, float sceneRadius) :
+        m_sceneRadius(sceneRadius)
+{
+    Timer timer;
+
+    std::vector<BuildLight> buildLights;
+    for (const Emitter * pEmitter : emitters)
+    {
+        uint32_t primitiveCount = pEmitter->getPrimitiveCount();
+        LightBounds bounds;
+        if (primitiveCount == 0 || !pEmitter->getLightBounds(0, bounds))
+        {
+            m_infiniteEmitters.push_back(pEmitter);
+            continue;
+        }
+
+        m_emitterOffsets[pEmitter] = uint32_t(m_bitTrails.size());
+        for (uint32_t i = 0; i < primitiveCount; i++)
+        {
+            m_bitTrails.push_back(INVALID_BIT_TRAIL);
+            if (!pEmitter->getLightBounds(i, bounds) || bounds.phi <= 0.0f)
+            {
+                continue;
+            }
+
+            buildLights.push_back({ uint32_t(m_lights.size()), bounds });
+            m_lights.push_back({ pEmitter, i });
+        }
+    }
+
+    if (!buildLights.empty())
+    {
+        m_nodes.reserve(2 * buildLights.size() - 1);
+        buildRecursive(buildLights, 0, buildLights.size(), 0, 0);
+    }
+
+    LOG(INFO) << "Build light BVH (" << m_lights.size() << " lights, " << m_nodes.size() << " nodes, "
+              << m_infiniteEmitters.size() << " infinite emitters) in " << timer.elapsedString() << ".";
+}
+
+uint32_t LightBVH::buildRecursive(std::vector<BuildLight> & buildLights, size_t begin, size_t end,
+                                  uint64_t bitTrail, int depth)
+{
+    uint32_t nodeIndex = uint32_t(m_nodes.size());
+    m_nodes.push_back(Node());
+
+    if (end - begin == 1)
+    {
+        const LightRef & light = m_lights[buildLights[begin].lightIndex];
+        m_bitTrails[m_emitterOffsets[light.pEmitter] + light.primitive] = bitTrail;
+
+        m_nodes[nodeIndex].bounds = buildLights[begin].bounds;
+        m_nodes[nodeIndex].childOrLightIndex = buildLights[begin].lightIndex;
+        m_nodes[nodeIndex].bLeaf = true;
+        return nodeIndex;
+    }
+
+    BoundingBox3f bounds, centroidBounds;
+    for (size_t i = begin; i < end; i++)
+    {
+        bounds.expandBy(buildLights[i].bounds.bounds);
+        centroidBounds.expandBy(buildLights[i].bounds.bounds.getCenter());
+    }
+
+    /* Find the bucket split with the lowest surface area orientation cost */
+    float minCost = std::numeric_limits<float>::infinity();
+    int minBucket = -1, minDim = -1;
+    Vector3f centroidExtents = centroidBounds.getExtents();
+    for (int dim = 0; dim < 3 && depth < MAX_DEPTH - 16; dim++)
+    {
+        if (centroidExtents[dim] <= 0.0f)
+        {
+            continue;
+        }
+
+        LightBounds buckets[BUCKET_COUNT];
+        for (size_t i = begin; i < end; i++)
+        {
+            float offset = (buildLights[i].bounds.bounds.getCenter()[dim] - centroidBounds.min[dim]) / centroidExtents[dim];
+            int bucket = std::min(int(offset * BUCKET_COUNT), BUCKET_COUNT - 1);
+            buckets[bucket] = LightBounds::merge(buckets[bucket], buildLights[i].bounds);
+        }
+
+        for (int split = 0; split < BUCKET_COUNT - 1; split++)
+        {
+            LightBounds below, above;
+            for (int i = 0; i <= split; i++)
+            {
+                below = LightBounds::merge(below, buckets[i]);
+            }
+            for (int i = split + 1; i < BUCKET_COUNT; i++)
+            {
+                above = LightBounds::merge(above, buckets[i]);
+            }
+
+            float cost = evaluateCost(below, bounds, dim) + evaluateCost(above, bounds, dim);
+            if (cost > 0.0f && cost < minCost)
+            {
+                minCost = cost;
+                minBucket = split;
+                minDim = dim;
+            }
+        }
+    }
+
+    size_t mid;
+    if (minDim == -1)
+    {
+        mid = (begin + end) / 2;
+    }
+    else
+    {
+        auto pMid = std::partition(buildLights.begin() + begin, buildLights.begin() + end,
+            [&](const BuildLight & light) {
+                float offset = (light.bounds.bounds.getCenter()[minDim] - centroidBounds.min[minDim]) / centroidExtents[minDim];
+                return std::min(int(offset * BUCKET_COUNT), BUCKET_COUNT - 1) <= minBucket;
+            });
+        mid = size_t(pMid - buildLights.begin());
+        if (mid == begin || mid == end)
+        {
+            mid = (begin + end) / 2;
+        }
+    }
+
+    buildRecursive(buildLights, begin, mid, bitTrail, depth + 1);
+    uint32_t secondChild = buildRecursive(buildLights, mid, end, bitTrail | (uint64_t(1) << depth), depth + 1);
+
+    m_nodes[nodeIndex].bounds = LightBounds::merge(m_nodes[nodeIndex + 1].bounds, m_nodes[secondChild].bounds);
+    m_nodes[nodeIndex].childOrLightIndex = secondChild;
+    m_nodes[nodeIndex].bLeaf = false;
+    return nodeIndex;
+}
+
+float LightBVH::evaluateCost(const LightBounds & bounds, const BoundingBox3f & centroidBounds, int dim) const
+{
+    if (bounds.phi == 0.0f)
+    {
+        return 0.0f;
+    }
+
+    float thetaO = safeAcos(bounds.cosThetaO), thetaE = safeAcos(bounds.cosThetaE);
+    float thetaW = std::min(thetaO + thetaE, float(M_PI));
+    float sinThetaO = safeSqrt(1.0f - bounds.cosThetaO * bounds.cosThetaO);
+    float omega = 2.0f * M_PI * (1.0f - bounds.cosThetaO) +
+                  M_PI / 2.0f * (2.0f * thetaW * sinThetaO - std::cos(thetaO - 2.0f * thetaW) -
+                                 2.0f * thetaO * sinThetaO + bounds.cosThetaO);
+
+    /* Penalize thin slabs */
+    Vector3f extents = centroidBounds.getExtents();
+    float kr = extents[dim] > 0.0f ? extents.maxCoeff() / extents[dim] : 1.0f;
+
+    return bounds.phi * omega * kr * bounds.bounds.getSurfaceArea();
+}
+
+float LightBVH::getTreeProbability() const
+{
+    if (m_nodes.empty())
+    {
+        return 0.0f;
+    }
+    return 1.0f / float(m_infiniteEmitters.size() + 1);
+}
+
+Color3f LightBVH::sample(EmitterQueryRecord & record, const Normal3f & n, float sampleLight,
+                         const Point2f & sample2D, float sample1D) const
+{
+    float pTree = getTreeProbability();
+    const Emitter * pEmitter = nullptr;
+    uint32_t primitive = 0;
+    float pmf = 0.0f;
+
+    if (sampleLight >= pTree)
+    {
+        /* Select one of the unbounded emitters uniformly */
+        if (m_infiniteEmitters.empty())
+        {
+            return Color3f(0.0f);
+        }
+        size_t count = m_infiniteEmitters.size();
+        size_t index = std::min(size_t((sampleLight - pTree) / (1.0f - pTree) * count), count - 1);
+        pEmitter = m_infiniteEmitters[index];
+        pmf = (1.0f - pTree) / float(count);
+        record.distance = m_sceneRadius;
+    }
+    else
+    {
+        /* Descend the tree, choosing children by their importance */
+        float u = std::min(sampleLight / pTree, 0x1.fffffep-1f);
+        pmf = pTree;
+        uint32_t nodeIndex = 0;
+        while (!m_nodes[nodeIndex].bLeaf)
+        {
+            const Node & node = m_nodes[nodeIndex];
+            float importance0 = m_nodes[nodeIndex + 1].bounds.importance(record.ref, n);
+            float importance1 = m_nodes[node.childOrLightIndex].bounds.importance(record.ref, n);
+            if (importance0 == 0.0f && importance1 == 0.0f)
+            {
+                return Color3f(0.0f);
+            }
+
+            float p0 = importance0 / (importance0 + importance1);
+            if (u < p0)
+            {
+                nodeIndex = nodeIndex + 1;
+                u = std::min(u / p0, 0x1.fffffep-1f);
+                pmf *= p0;
+            }
+            else
+            {
+                nodeIndex = node.childOrLightIndex;
+                u = std::min((u - p0) / (1.0f - p0), 0x1.fffffep-1f);
+                pmf *= 1.0f - p0;
+            }
+        }
+
+        if (nodeIndex == 0 && m_nodes[0].bounds.importance(record.ref, n) == 0.0f)
+        {
+            return Color3f(0.0f);
+        }
+
+        const LightRef & light = m_lights[m_nodes[nodeIndex].childOrLightIndex];
+        pEmitter = light.pEmitter;
+        primitive = light.primitive;
+    }
+
+    record.primitive = primitive;
+    Color3f value = pEmitter->samplePrimitive(record, sample2D, sample1D);
+    record.pdf *= pmf;
+    return value / pmf;
+}
+
+float LightBVH::pdf(const EmitterQueryRecord & record, const Normal3f & n) const
+{
+    float pmfLight = pmf(record.ref, n, record.pEmitter, record.primitive);
+    if (pmfLight == 0.0f)
+    {
+        return 0.0f;
+    }
+    return pmfLight * record.pEmitter->pdfPrimitive(record);
+}
+
+float LightBVH::pmf(const Point3f & p, const Normal3f & n, const Emitter * pEmitter, uint32_t primitive) const
+{
+    float pTree = getTreeProbability();
+    if (std::find(m_infiniteEmitters.begin(), m_infiniteEmitters.end(), pEmitter) != m_infiniteEmitters.end())
+    {
+        return (1.0f - pTree) / float(m_infiniteEmitters.size());
+    }
+
+    auto it = m_emitterOffsets.find(pEmitter);
+    if (it == m_emitterOffsets.end() || m_nodes.empty())
+    {
+        return 0.0f;
+    }
+
+    uint64_t bitTrail = m_bitTrails[it->second + primitive];
+    if (bitTrail == INVALID_BIT_TRAIL)
+    {
+        return 0.0f;
+    }
+
+    /* Follow the path to the leaf and accumulate the probabilities of the choices */
+    float result = pTree;
+    uint32_t nodeIndex = 0;
+    while (!m_nodes[nodeIndex].bLeaf)
+    {
+        const Node & node = m_nodes[nodeIndex];
+        float importance0 = m_nodes[nodeIndex + 1].bounds.importance(p, n);
+        float importance1 = m_nodes[node.childOrLightIndex].bounds.importance(p, n);
+        if (importance0 == 0.0f && importance1 == 0.0f)
+        {
+            return 0.0f;
+        }
+
+        if (bitTrail & 1)
+        {
+            result *= importance1 / (importance0 + importance1);
+            nodeIndex = node.childOrLightIndex;
+        }
+        else
+        {
+            result *= importance0 / (importance0 + importance1);
+            nodeIndex = nodeIndex + 1;
+        }
+        bitTrail >>= 1;
+    }
+
+    return result;
+}
+
+std::string LightBVH::toString() const
+{
+    return tfm::format(
+            "LightBVH[\n"
+            "  lights = %i,\n"
+            "  nodes = %i,\n"
+            "  infiniteEmitters = %i\n"
+            "]",
+            m_lights.size(),
+            m_nodes.size(),
+            m_infiniteEmitters.size()
+    );
+}
+
+NORI_NAMESPACE_END
@@ -3,6 +3,10 @@
 //
 #include <nori/core/memoryHelper.h>
 
+#if defined(PLATFORM_LINUX)
+#include <malloc.h>
+#endif
+
 NORI_NAMESPACE_BEGIN
 void * allocAligned(size_t Size)
 {
@@ -8,6 +8,7 @@
 #include <nori/core/bsdf.h>
 #include <nori/core/emitter.h>
 #include <nori/core/discretePDF.h>
+#include <nori/core/warp.h>
 
 NORI_NAMESPACE_BEGIN
 
@@ -36,7 +37,7 @@ void Mesh::activate() {
     }
     m_invMeshArea = 1.0f / m_meshArea;
 
-    m_pPDF.reset(new DiscretePDF1D(areas.data(), int(areas.size())));
+    m_pPDF.reset(new DiscretePDF1D(areas.data(), int(areas.size()), m_bAliasTable));
 
 }
 
@@ -49,8 +50,12 @@ float Mesh::surfaceArea(uint32_t index) const {
 }
 
 bool Mesh::rayIntersect(uint32_t index, const Ray3f &ray, float &u, float &v, float &t) const {
-    uint32_t i0 = m_F(0, index), i1 = m_F(1, index), i2 = m_F(2, index);
-    const Point3f p0 = m_V.col(i0), p1 = m_V.col(i1), p2 = m_V.col(i2);
+    /* Resolve the replica once for both buffers */
+    const NodeBuffers *pNodeBuffers = getNodeBuffers();
+    const MatrixXu &F = pNodeBuffers != nullptr ? pNodeBuffers->F : m_F;
+    const MatrixXf &V = pNodeBuffers != nullptr ? pNodeBuffers->V : m_V;
+    uint32_t i0 = F(0, index), i1 = F(1, index), i2 = F(2, index);
+    const Point3f p0 = V.col(i0), p1 = V.col(i1), p2 = V.col(i2);
 
     /* Find vectors for two edges sharing v[0] */
     Vector3f edge1 = p1 - p0, edge2 = p2 - p0;
@@ -87,24 +92,26 @@ bool Mesh::rayIntersect(uint32_t index, const Ray3f &ray, float &u, float &v, fl
     return t >= ray.mint && t <= ray.maxt;
 }
 
-const MatrixXf &Mesh::getVertexPositions() const
-{
-    return m_V;
-}
-
-const MatrixXf &Mesh::getVertexNormals() const
+void Mesh::replicateForNode(int node)
 {
-    return m_N;
-}
+    if (node < 0 || node >= NORI_MAX_NUMA_NODES)
+    {
+        throw NoriException("Mesh::replicateForNode(): invalid NUMA node %i!", node);
+    }
 
-const MatrixXf &Mesh::getVertexTexCoords() const
-{
-    return m_UV;
-}
+    if (m_pNodeBuffers[node] != nullptr)
+    {
+        return;
+    }
 
-const MatrixXu &Mesh::getIndices() const
-{
-    return m_F;
+    /* The copies are written (and thus first touched) by the calling thread */
+    std::unique_ptr<NodeBuffers> pNodeBuffers(new NodeBuffers());
+    pNodeBuffers->V = m_V;
+    pNodeBuffers->N = m_N;
+    pNodeBuffers->UV = m_UV;
+    pNodeBuffers->F = m_F;
+    m_pNodeBuffers[node] = std::move(pNodeBuffers);
+    m_bReplicated.store(true, std::memory_order_relaxed);
 }
 
 bool Mesh::isEmitter() const
@@ -177,12 +184,14 @@ std::string Mesh::toString() const
         "  name = \"%s\",\n"
         "  vertexCount = %i,\n"
         "  triangleCount = %i,\n"
+        "  aliasTable = %s,\n"
         "  bsdf = %s,\n"
         "  emitter = %s\n"
         "]",
         m_name,
         m_V.cols(),
         m_F.cols(),
+        m_bAliasTable ? "true" : "false",
         m_bsdf ? indent(m_bsdf->toString()) : std::string("null"),
         m_emitter ? indent(m_emitter->toString()) : std::string("null")
     );
@@ -196,26 +205,87 @@ NoriObject::EClassType Mesh::getClassType() const
 
 void Mesh::samplePosition(float sample1D, const Point2f & sample2D, Point3f & samplePoint, Normal3f & sampleNormal) const
 {
-    size_t triangleIdx = m_pPDF->sampleDiscrete(sample1D);
+    sampleTriangle(sampleTriangleIndex(sample1D), sample2D, samplePoint, sampleNormal);
+}
 
+void Mesh::sampleTriangle(uint32_t index, const Point2f & sample2D, Point3f & samplePoint, Normal3f & sampleNormal) const
+{
     float sqrOneMinusEpsilon1 = std::sqrt(1.0f - sample2D.x());
     float alpha = 1.0f - sqrOneMinusEpsilon1;
     float beta = sample2D.y() * sqrOneMinusEpsilon1;
+
+    interpolate(index, alpha, beta, samplePoint, sampleNormal);
+}
+
+uint32_t Mesh::sampleTriangleIndex(float sample1D) const
+{
+    return uint32_t(m_pPDF->sampleDiscrete(sample1D));
+}
+
+float Mesh::sampleTriangleSolidAngle(uint32_t index, const Point3f & ref, const Point2f & sample2D,
+                                     Point3f & samplePoint, Normal3f & sampleNormal) const
+{
+    float pdf = pdfTriangleSolidAngle(index, ref);
+    if (pdf == 0.0f)
+    {
+        return 0.0f;
+    }
+
+    uint32_t idx0 = m_F(0, index), idx1 = m_F(1, index), idx2 = m_F(2, index);
+    Point3f p0 = m_V.col(idx0), p1 = m_V.col(idx1), p2 = m_V.col(idx2);
+    Vector3f w = Warp::squareToSphericalTriangle(sample2D, (p0 - ref).normalized(), (p1 - ref).normalized(), (p2 - ref).normalized());
+
+    /* Barycentric coordinates of the point where the sampled direction meets the triangle (Moller-Trumbore) */
+    Vector3f e1 = p1 - p0, e2 = p2 - p0;
+    Vector3f s1 = w.cross(e2);
+    float divisor = s1.dot(e1);
+    if (divisor == 0.0f)
+    {
+        return 0.0f;
+    }
+
+    Vector3f s = ref - p0;
+    float alpha = clamp(s.dot(s1) / divisor, 0.0f, 1.0f);
+    float beta = clamp(w.dot(s.cross(e1)) / divisor, 0.0f, 1.0f);
+    if (alpha + beta > 1.0f)
+    {
+        float sum = alpha + beta;
+        alpha /= sum;
+        beta /= sum;
+    }
+
+    interpolate(index, alpha, beta, samplePoint, sampleNormal);
+    return pdf;
+}
+
+float Mesh::pdfTriangleSolidAngle(uint32_t index, const Point3f & ref) const
+{
+    uint32_t idx0 = m_F(0, index), idx1 = m_F(1, index), idx2 = m_F(2, index);
+    Vector3f a = m_V.col(idx0) - ref, b = m_V.col(idx1) - ref, c = m_V.col(idx2) - ref;
+    if (a.squaredNorm() == 0.0f || b.squaredNorm() == 0.0f || c.squaredNorm() == 0.0f)
+    {
+        return 0.0f;
+    }
+    return Warp::squareToSphericalTrianglePdf(a.normalized(), b.normalized(), c.normalized());
+}
+
+void Mesh::interpolate(uint32_t index, float alpha, float beta, Point3f & point, Normal3f & normal) const
+{
     float gamma = 1.0f - alpha - beta;
 
-    uint32_t idx0 = m_F(0, triangleIdx), idx1 = m_F(1, triangleIdx), idx2 = m_F(2, triangleIdx);
+    uint32_t idx0 = m_F(0, index), idx1 = m_F(1, index), idx2 = m_F(2, index);
     Point3f p0 = m_V.col(idx0), p1 = m_V.col(idx1), p2 = m_V.col(idx2);
 
-    samplePoint = gamma * p0 + alpha * p1 + beta * p2;
+    point = gamma * p0 + alpha * p1 + beta * p2;
 
     if (m_N.size() > 0)
     {
         Normal3f N0 = m_N.col(idx0), N1 = m_N.col(idx1), N2 = m_N.col(idx2);
-        sampleNormal = gamma * N0 + alpha * N1 + beta * N2;
+        normal = (gamma * N0 + alpha * N1 + beta * N2).normalized();
     }
     else
     {
-        sampleNormal = (p1 - p0).cross(p2 - p0).normalized();
+        normal = (p1 - p0).cross(p2 - p0).normalized();
     }
 }
 
@@ -0,0 +1,114 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#include <nori/core/numa.h>
+#include <fstream>
+
+#if defined(PLATFORM_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+NORI_NAMESPACE_BEGIN
+
+namespace
+{
+    thread_local int currentNumaNode = -1;
+
+    /// Parse a kernel CPU list such as "0-7,16-23"
+    std::vector<int> parseCpuList(const std::string & cpuList)
+    {
+        std::vector<int> cpus;
+        for (const std::string & range : tokenize(cpuList, ","))
+        {
+            size_t dash = range.find('-');
+            int first = toInt(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : toInt(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; cpu++)
+            {
+                cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+}
+
+NumaTopology::NumaTopology()
+{
+#if defined(PLATFORM_LINUX)
+    for (int node = 0; node < NORI_MAX_NUMA_NODES; node++)
+    {
+        std::ifstream stream(tfm::format("/sys/devices/system/node/node%i/cpulist", node));
+        std::string cpuList;
+        if (!stream || !std::getline(stream, cpuList))
+        {
+            break;
+        }
+
+        std::vector<int> cpus = parseCpuList(cpuList);
+        if (cpus.empty())
+        {
+            /* Memory-only node */
+            continue;
+        }
+        m_nodeCpus.push_back(cpus);
+    }
+#endif
+
+    if (m_nodeCpus.empty())
+    {
+        std::vector<int> cpus(std::max(std::thread::hardware_concurrency(), 1u));
+        for (size_t i = 0; i < cpus.size(); i++)
+        {
+            cpus[i] = int(i);
+        }
+        m_nodeCpus.push_back(cpus);
+    }
+}
+
+bool NumaTopology::pinCurrentThread(int node) const
+{
+    currentNumaNode = node;
+
+#if defined(PLATFORM_LINUX)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (int cpu : m_nodeCpus[node])
+    {
+        CPU_SET(cpu, &cpuSet);
+    }
+
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet) != 0)
+    {
+        LOG(WARNING) << "Unable to pin the thread to the CPUs of NUMA node " << node << ".";
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+int NumaTopology::getCurrentNode()
+{
+    return currentNumaNode;
+}
+
+std::string NumaTopology::toString() const
+{
+    std::string nodes;
+    for (int node = 0; node < getNodeCount(); node++)
+    {
+        nodes += tfm::format("  node%i = %i cpus%s\n", node, m_nodeCpus[node].size(),
+                             node + 1 < getNodeCount() ? "," : "");
+    }
+    return tfm::format(
+            "NumaTopology[\n"
+            "%s"
+            "]",
+            nodes
+    );
+}
+
+NORI_NAMESPACE_END
@@ -0,0 +1,132 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#include <nori/core/pcg32x8Test.h>
+#include <nori/core/pcg32x8.h>
+#include <nori/core/sampler.h>
+#include <nori/core/block.h>
+
+NORI_NAMESPACE_BEGIN
+
+PCG32x8Test::PCG32x8Test(const PropertyList & propList)
+{
+    /* Number of independently seeded streams */
+    m_streamCount = propList.getInteger(XML_TEST_PCG32X8_STREAM_COUNT, DEFAULT_TEST_PCG32X8_STREAM_COUNT);
+
+    /* Number of values drawn from every stream, rounded up to a multiple of eight */
+    m_sampleCount = propList.getInteger(XML_TEST_PCG32X8_SAMPLE_COUNT, DEFAULT_TEST_PCG32X8_SAMPLE_COUNT);
+
+    if (m_streamCount <= 0 || m_sampleCount <= 0)
+    {
+        throw NoriException("PCG32x8Test: the stream and the sample count must be positive!");
+    }
+}
+
+void PCG32x8Test::activate()
+{
+    int batchCount = (m_sampleCount + 7) / 8;
+    int passed = 0, total = 0;
+
+    cout << "------------------------------------------------------" << endl;
+    cout << "Testing PCG32x8 (" << (PCG32x8::isVectorized() ? "AVX2" : "scalar") << " build) with "
+         << m_streamCount << " streams of " << batchCount * 8 << " values" << endl;
+
+    int mismatchesDefault = 0, mismatchesScalar = 0, mismatchesFloat = 0;
+    for (int stream = 0; stream < m_streamCount; stream++)
+    {
+        pcg32 reference;
+        reference.seed(uint64_t(stream) * 0x9e3779b97f4a7c15ull + 1u, uint64_t(stream));
+
+        /* Start in the middle of the stream to exercise arbitrary states */
+        reference.advance(int64_t(stream) * 977);
+
+        PCG32x8 batchDefault(reference), batchScalar(reference), batchFloat(reference);
+        pcg32 referenceFloat = reference;
+
+        for (int batch = 0; batch < batchCount; batch++)
+        {
+            uint32_t valuesDefault[8], valuesScalar[8];
+            float valuesFloat[8];
+            batchDefault.nextUInt(valuesDefault);
+            batchScalar.nextUIntScalar(valuesScalar);
+            batchFloat.nextFloat(valuesFloat);
+
+            for (int i = 0; i < 8; i++)
+            {
+                uint32_t expected = reference.nextUInt();
+                mismatchesDefault += valuesDefault[i] != expected ? 1 : 0;
+                mismatchesScalar += valuesScalar[i] != expected ? 1 : 0;
+                mismatchesFloat += valuesFloat[i] != referenceFloat.nextFloat() ? 1 : 0;
+            }
+        }
+
+        mismatchesDefault += batchDefault.getScalarState() != reference.state ? 1 : 0;
+        mismatchesScalar += batchScalar.getScalarState() != reference.state ? 1 : 0;
+        mismatchesFloat += batchFloat.getScalarState() != referenceFloat.state ? 1 : 0;
+    }
+
+    auto report = [&](const std::string & name, int mismatches) {
+        ++total;
+        passed += mismatches == 0 ? 1 : 0;
+        cout << tfm::format("%-20s: %i mismatches .. %s", name, mismatches, mismatches == 0 ? "passed" : "FAILED") << endl;
+    };
+    report(PCG32x8::isVectorized() ? "nextUInt (AVX2)" : "nextUInt", mismatchesDefault);
+    report("nextUIntScalar", mismatchesScalar);
+    report("nextFloat", mismatchesFloat);
+
+    /* The array requests of the independent sampler continue its scalar stream */
+    std::unique_ptr<Sampler> pArraySampler(static_cast<Sampler *>(
+            NoriObjectFactory::createInstance("independent", PropertyList())));
+    std::unique_ptr<Sampler> pScalarSampler(pArraySampler->clone());
+    ImageBlock block(Vector2i(NORI_BLOCK_SIZE), nullptr);
+    block.setOffset(Point2i(3 * NORI_BLOCK_SIZE, 5 * NORI_BLOCK_SIZE));
+    pArraySampler->prepare(block);
+    pScalarSampler->prepare(block);
+
+    int mismatchesSampler = 0;
+    std::vector<float> values1D;
+    std::vector<Point2f> values2D;
+    for (int count = 1; count <= 67; count += 3)
+    {
+        values1D.resize(count);
+        values2D.resize(count);
+        pArraySampler->next1DArray(values1D.data(), size_t(count));
+        pArraySampler->next2DArray(values2D.data(), size_t(count));
+        for (int i = 0; i < count; i++)
+        {
+            mismatchesSampler += values1D[i] != pScalarSampler->next1D() ? 1 : 0;
+        }
+        for (int i = 0; i < count; i++)
+        {
+            mismatchesSampler += values2D[i] != pScalarSampler->next2D() ? 1 : 0;
+        }
+    }
+    report("independent arrays", mismatchesSampler);
+
+    cout << "Passed " << passed << "/" << total << " tests." << endl;
+    if (passed < total)
+    {
+        throw std::runtime_error("Some tests failed :(");
+    }
+}
+
+std::string PCG32x8Test::toString() const
+{
+    return tfm::format(
+            "PCG32x8Test[\n"
+            "  streamCount = %i,\n"
+            "  sampleCount = %i\n"
+            "]",
+            m_streamCount,
+            m_sampleCount
+    );
+}
+
+NoriObject::EClassType PCG32x8Test::getClassType() const
+{
+    return ETest;
+}
+
+NORI_REGISTER_CLASS(PCG32x8Test, XML_TEST_PCG32X8);
+NORI_NAMESPACE_END
@@ -31,8 +31,14 @@ const Emitter * PrimitiveShape::getEmitter() const
     return nullptr;
 }
 
+void PrimitiveShape::computePartials(const Intersection & Isect) const
+{
+    Isect.bHasUVPartial = false;
+}
+
 void PrimitiveShape::computeCurvature(const Intersection & isect, float & H, float & K) const
 {
+    isect.computePartials();
     if (!isect.bHasUVPartial)
     {
         H = 0.0f;
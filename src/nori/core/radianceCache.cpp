@@ -0,0 +1,112 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#include <nori/core/radianceCache.h>
+#include <nori/core/color.h>
+
+NORI_NAMESPACE_BEGIN
+
+namespace
+{
+    /// Ratio between the upper and the lower bound of the weight window
+    const float WindowWidth = 5.0f;
+
+    /// Lower bound of the survival probability, dark regions of the cache may just be undersampled
+    const float MinSurvival = 0.05f;
+
+    inline void atomicAdd(std::atomic<float> & target, float value)
+    {
+        float current = target.load(std::memory_order_relaxed);
+        while (!target.compare_exchange_weak(current, current + value, std::memory_order_relaxed))
+        {
+        }
+    }
+}
+
+RadianceCache::RadianceCache(const BoundingBox3f & bounds, int resolution)
+{
+    Vector3f extents = bounds.getExtents();
+    float cellSize = extents.maxCoeff() / float(resolution) + Epsilon;
+    for (int i = 0; i < 3; i++)
+    {
+        m_resolution[i] = std::max(int(std::ceil(extents[i] / cellSize)), 1);
+    }
+    m_bounds = BoundingBox3f(bounds.min, bounds.min + m_resolution.cast<float>() * cellSize);
+
+    size_t cellCount = size_t(m_resolution.x()) * size_t(m_resolution.y()) * size_t(m_resolution.z());
+    m_pCells.reset(new Cell[cellCount]);
+    for (size_t i = 0; i < cellCount; i++)
+    {
+        m_pCells[i].sum.store(0.0f, std::memory_order_relaxed);
+        m_pCells[i].count.store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t RadianceCache::getCellIndex(const Point3f & p) const
+{
+    Vector3f pos = (p - m_bounds.min).cwiseQuotient(m_bounds.getExtents()).cwiseProduct(m_resolution.cast<float>());
+    Vector3i cell;
+    for (int i = 0; i < 3; i++)
+    {
+        cell[i] = clamp(int(pos[i]), 0, m_resolution[i] - 1);
+    }
+    return (size_t(cell.z()) * size_t(m_resolution.y()) + size_t(cell.y())) * size_t(m_resolution.x()) + size_t(cell.x());
+}
+
+void RadianceCache::record(const Point3f & p, float value)
+{
+    Cell & cell = m_pCells[getCellIndex(p)];
+    atomicAdd(cell.sum, value);
+    cell.count.fetch_add(1, std::memory_order_relaxed);
+}
+
+float RadianceCache::lookup(const Point3f & p) const
+{
+    const Cell & cell = m_pCells[getCellIndex(p)];
+    uint32_t count = cell.count.load(std::memory_order_relaxed);
+    if (count == 0)
+    {
+        return -1.0f;
+    }
+    return cell.sum.load(std::memory_order_relaxed) / float(count);
+}
+
+float RadianceCache::getSplittingFactor(const Point3f & p, const Color3f & beta, float pixelEstimate,
+                                        float maxSplit, float fallback) const
+{
+    float radiance = lookup(p);
+    if (radiance < 0.0f || pixelEstimate <= 0.0f)
+    {
+        return fallback;
+    }
+
+    /* Weight window around the pixel value, centered such that its bounds are 2 / (1 + s) and 2 s / (1 + s) times the estimate */
+    float expected = beta.getLuminance() * radiance;
+    float lower = 2.0f * pixelEstimate / (1.0f + WindowWidth);
+    float upper = WindowWidth * lower;
+
+    if (expected < lower)
+    {
+        return std::max(expected / lower, MinSurvival);
+    }
+    if (expected > upper)
+    {
+        return std::min(expected / upper, maxSplit);
+    }
+    return 1.0f;
+}
+
+std::string RadianceCache::toString() const
+{
+    return tfm::format(
+            "RadianceCache[\n"
+            "  bounds = %s,\n"
+            "  resolution = %s\n"
+            "]",
+            indent(m_bounds.toString()),
+            m_resolution.toString()
+    );
+}
+
+NORI_NAMESPACE_END
@@ -0,0 +1,150 @@
+//
+// Created by superqqli on 2026/10/19.
+//
+
+#include <nori/core/samplerTest.h>
+#include <nori/core/sampler.h>
+#include <hypothesis.h>
+
+NORI_NAMESPACE_BEGIN
+
+namespace
+{
+    /// Cells with a lower expected frequency are pooled for the chi^2 test
+    const double MinExpFrequency = 5.0;
+}
+
+SamplerTest::SamplerTest(const PropertyList & propList)
+{
+    /* Sampler types to test */
+    m_samplers = tokenize(propList.getString(XML_TEST_SAMPLER_SAMPLERS, DEFAULT_TEST_SAMPLER_SAMPLERS));
+
+    /* Sample counts per pixel, preferably ones that are not a product of the grid size */
+    for (const std::string & sampleCount : tokenize(propList.getString(XML_TEST_SAMPLER_SAMPLE_COUNTS,
+                                                                       DEFAULT_TEST_SAMPLER_SAMPLE_COUNTS)))
+    {
+        m_sampleCounts.push_back(toInt(sampleCount));
+    }
+
+    /* Number of cells along both axes of the 2D histogram and of the 1D one */
+    m_resolution = propList.getInteger(XML_TEST_SAMPLER_RESOLUTION, DEFAULT_TEST_SAMPLER_RESOLUTION);
+
+    /* Total number of samples drawn per sampler and sample count, spread over the pixels */
+    m_sampleCount = propList.getInteger(XML_TEST_SAMPLER_SAMPLE_COUNT, DEFAULT_TEST_SAMPLER_SAMPLE_COUNT);
+
+    /* The null hypothesis will be rejected when the associated
+       p-value is below the significance level specified here. */
+    m_significanceLevel = propList.getFloat(XML_TEST_SAMPLER_SIGNIFICANCE_LEVEL, DEFAULT_TEST_SAMPLER_SIGNIFICANCE_LEVEL);
+
+    if (m_samplers.empty() || m_sampleCounts.empty() || m_resolution <= 0 || m_sampleCount <= 0)
+    {
+        throw NoriException("SamplerTest: the sampler list, the sample counts, the resolution and the sample count must not be empty!");
+    }
+
+    for (int sampleCount : m_sampleCounts)
+    {
+        if (sampleCount <= 0)
+        {
+            throw NoriException("SamplerTest: the sample counts must be positive!");
+        }
+    }
+}
+
+void SamplerTest::activate()
+{
+    int passed = 0, total = 0;
+    int testCount = int(m_samplers.size() * m_sampleCounts.size()) * 2;
+
+    for (const std::string & samplerType : m_samplers)
+    {
+        for (int sampleCount : m_sampleCounts)
+        {
+            cout << "------------------------------------------------------" << endl;
+            cout << "Testing the \"" << samplerType << "\" sampler with " << sampleCount << " samples per pixel" << endl;
+            total += 2;
+
+            PropertyList propList;
+            propList.setInteger("sampleCount", sampleCount);
+            std::unique_ptr<Sampler> pSampler(static_cast<Sampler *>(
+                    NoriObjectFactory::createInstance(samplerType, propList)));
+
+            /* Whole pixels only, so that every stratum of a pixel is drawn exactly once */
+            int pixelCount = std::max((m_sampleCount + sampleCount - 1) / sampleCount, 1);
+            int drawn = pixelCount * sampleCount;
+            int cellCount = m_resolution * m_resolution;
+            std::vector<double> obs1D(m_resolution, 0.0), exp1D(m_resolution, double(drawn) / m_resolution);
+            std::vector<double> obs2D(cellCount, 0.0), exp2D(cellCount, double(drawn) / cellCount);
+
+            for (int pixel = 0; pixel < pixelCount; pixel++)
+            {
+                pSampler->generate(Point2i(pixel % 1024, pixel / 1024));
+                for (int i = 0; i < sampleCount; i++)
+                {
+                    /* The camera dimensions, followed by a 1D dimension */
+                    Point2f sample = pSampler->next2D();
+                    float value = pSampler->next1D();
+                    int x = std::min(int(sample.x() * m_resolution), m_resolution - 1);
+                    int y = std::min(int(sample.y() * m_resolution), m_resolution - 1);
+                    obs2D[y * m_resolution + x] += 1.0;
+                    obs1D[std::min(int(value * m_resolution), m_resolution - 1)] += 1.0;
+                    pSampler->advance();
+                }
+            }
+
+            std::pair<bool, std::string> result1D =
+                    hypothesis::chi2_test(m_resolution, obs1D.data(), exp1D.data(), drawn,
+                                          MinExpFrequency, m_significanceLevel, testCount);
+            cout << "1D: " << result1D.second << endl;
+            std::pair<bool, std::string> result2D =
+                    hypothesis::chi2_test(cellCount, obs2D.data(), exp2D.data(), drawn,
+                                          MinExpFrequency, m_significanceLevel, testCount);
+            cout << "2D: " << result2D.second << endl;
+
+            passed += int(result1D.first) + int(result2D.first);
+        }
+    }
+
+    cout << "Passed " << passed << "/" << total << " tests." << endl;
+    if (passed < total)
+    {
+        throw std::runtime_error("Some tests failed :(");
+    }
+}
+
+std::string SamplerTest::toString() const
+{
+    std::string sampleCounts;
+    for (size_t i = 0; i < m_sampleCounts.size(); i++)
+    {
+        sampleCounts += (i == 0 ? "" : ", ") + std::to_string(m_sampleCounts[i]);
+    }
+
+    std::string samplers;
+    for (size_t i = 0; i < m_samplers.size(); i++)
+    {
+        samplers += (i == 0 ? "" : ", ") + m_samplers[i];
+    }
+
+    return tfm::format(
+            "SamplerTest[\n"
+            "  samplers = \"%s\",\n"
+            "  sampleCounts = \"%s\",\n"
+            "  resolution = %i,\n"
+            "  sampleCount = %i,\n"
+            "  significanceLevel = %f\n"
+            "]",
+            samplers,
+            sampleCounts,
+            m_resolution,
+            m_sampleCount,
+            m_significanceLevel
+    );
+}
+
+NoriObject::EClassType SamplerTest::getClassType() const
+{
+    return ETest;
+}
+
+NORI_REGISTER_CLASS(SamplerTest, XML_TEST_SAMPLER);
+NORI_NAMESPACE_END
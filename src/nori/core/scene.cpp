@@ -12,6 +12,8 @@
 #include <nori/core/accel.h>
 #include <nori/core/intersection.h>
 #include <nori/core/mesh.h>
+#include <nori/core/bsdf.h>
+#include <nori/core/lightBVH.h>
 
 NORI_NAMESPACE_BEGIN
 
@@ -65,6 +67,11 @@ const Camera* Scene::getCamera() const
     return m_pCamera;
 }
 
+Camera* Scene::getCamera()
+{
+    return m_pCamera;
+}
+
 const Sampler* Scene::getSampler() const
 {
     return m_pSampler;
@@ -85,6 +92,13 @@ const std::vector<Emitter*> & Scene::getEmitters() const
     return m_pEmitters;
 }
 
+const LightBVH * Scene::getLightBVH() const
+{
+    /* The construction does not spawn tasks, so a render thread cannot re-enter it */
+    std::call_once(m_lightBVHFlag, [this] { m_pLightBVH.reset(new LightBVH(m_pEmitters, m_bBox.getRadius())); });
+    return m_pLightBVH.get();
+}
+
 const Emitter * Scene::getEnvironmentEmitter() const
 {
     return m_pEnvironmentEmitter;
@@ -121,6 +135,20 @@ bool Scene::rayIntersect(const Ray3f &ray) const
     return m_pAccel->rayIntersect(ray, its, true);
 }
 
+void Scene::rayOccluded(const Ray3f *pRays, size_t count, bool *pOccluded) const
+{
+    m_pAccel->rayOccluded(pRays, count, pOccluded);
+}
+
+void Scene::replicateForNode(int node)
+{
+    m_pAccel->replicateForNode(node);
+    for (auto& pMesh : m_pMeshes)
+    {
+        pMesh->replicateForNode(node);
+    }
+}
+
 void Scene::activate() {
     if (m_pAccel == nullptr)
     {
@@ -143,6 +171,12 @@ void Scene::activate() {
 
     if (!m_pCamera)
         throw NoriException("No camera was specified!");
+
+    /* Ray differentials are only generated when a texture is filtered with them */
+    bool bRayDifferentials = false;
+    for (const Mesh *pMesh : m_pMeshes)
+        bRayDifferentials = bRayDifferentials || pMesh->getBSDF()->usesRayDifferentials();
+    m_pCamera->setRayDifferentials(bRayDifferentials);
     
     if (!m_pSampler) {
         /* Create a default (independent) sampler */
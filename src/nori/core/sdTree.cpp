@@ -0,0 +1,399 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#include <nori/core/sdTree.h>
+#include <tbb/tbb.h>
+
+NORI_NAMESPACE_BEGIN
+
+namespace
+{
+    const float OneMinusEpsilon = 0x1.fffffep-1f;
+
+    inline void atomicAdd(std::atomic<float> & target, float value)
+    {
+        float current = target.load(std::memory_order_relaxed);
+        while (!target.compare_exchange_weak(current, current + value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    /// Map a direction to the unit square with the cylindrical (equal-area) mapping
+    inline Point2f directionToCanonical(const Vector3f & d)
+    {
+        float cosTheta = clamp(d.z(), -1.0f, 1.0f);
+        float phi = std::atan2(d.y(), d.x());
+        if (phi < 0.0f)
+        {
+            phi += 2.0f * float(M_PI);
+        }
+        return Point2f(
+                clamp((cosTheta + 1.0f) * 0.5f, 0.0f, OneMinusEpsilon),
+                clamp(phi * float(INV_TWOPI), 0.0f, OneMinusEpsilon));
+    }
+
+    inline Vector3f canonicalToDirection(const Point2f & p)
+    {
+        float cosTheta = 2.0f * p.x() - 1.0f;
+        float sinTheta = std::sqrt(std::max(1.0f - cosTheta * cosTheta, 0.0f));
+        float phi = 2.0f * float(M_PI) * p.y();
+        return Vector3f(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta);
+    }
+}
+
+DTree::Node::Node()
+{
+    for (int i = 0; i < 4; i++)
+    {
+        sum[i].store(0.0f, std::memory_order_relaxed);
+        child[i] = 0;
+    }
+}
+
+DTree::Node::Node(const Node & other)
+{
+    *this = other;
+}
+
+DTree::Node & DTree::Node::operator=(const Node & other)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        sum[i].store(other.sum[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        child[i] = other.child[i];
+    }
+    return *this;
+}
+
+float DTree::Node::getSum() const
+{
+    float total = 0.0f;
+    for (int i = 0; i < 4; i++)
+    {
+        total += sum[i].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+DTree::DTree()
+{
+    m_nodes.emplace_back();
+}
+
+DTree::DTree(const DTree & other) :
+        m_nodes(other.m_nodes)
+{
+
+}
+
+DTree & DTree::operator=(const DTree & other)
+{
+    m_nodes = other.m_nodes;
+    return *this;
+}
+
+void DTree::record(const Vector3f & d, float value)
+{
+    if (!std::isfinite(value) || value <= 0.0f)
+    {
+        return;
+    }
+
+    Point2f p = directionToCanonical(d);
+    uint32_t index = 0;
+    while (true)
+    {
+        int x = p.x() >= 0.5f ? 1 : 0, y = p.y() >= 0.5f ? 1 : 0;
+        int quadrant = x + 2 * y;
+        atomicAdd(m_nodes[index].sum[quadrant], value);
+
+        if (m_nodes[index].child[quadrant] == 0)
+        {
+            break;
+        }
+        index = m_nodes[index].child[quadrant];
+        p = Point2f(2.0f * p.x() - float(x), 2.0f * p.y() - float(y));
+    }
+}
+
+Vector3f DTree::sample(const Point2f & sample2D) const
+{
+    Point2f u = sample2D;
+    Point2f origin(0.0f, 0.0f);
+    float size = 1.0f;
+    uint32_t index = 0;
+
+    while (true)
+    {
+        const Node & node = m_nodes[index];
+        float sums[4];
+        for (int i = 0; i < 4; i++)
+        {
+            sums[i] = node.sum[i].load(std::memory_order_relaxed);
+        }
+        float total = sums[0] + sums[1] + sums[2] + sums[3];
+        if (total <= 0.0f)
+        {
+            /* Nothing was recorded, sample the node uniformly */
+            break;
+        }
+
+        /* Select the column, then the quadrant within the column */
+        float pLeft = (sums[0] + sums[2]) / total;
+        int x;
+        if (u.x() < pLeft)
+        {
+            x = 0;
+            u.x() = u.x() / pLeft;
+        }
+        else
+        {
+            x = 1;
+            u.x() = (u.x() - pLeft) / (1.0f - pLeft);
+        }
+
+        float pBottom = sums[x] / (sums[x] + sums[x + 2]);
+        int y;
+        if (u.y() < pBottom)
+        {
+            y = 0;
+            u.y() = u.y() / pBottom;
+        }
+        else
+        {
+            y = 1;
+            u.y() = (u.y() - pBottom) / (1.0f - pBottom);
+        }
+        u = Point2f(std::min(u.x(), OneMinusEpsilon), std::min(u.y(), OneMinusEpsilon));
+
+        size *= 0.5f;
+        origin += Vector2f(float(x), float(y)) * size;
+
+        uint32_t child = node.child[x + 2 * y];
+        if (child == 0)
+        {
+            break;
+        }
+        index = child;
+    }
+
+    return canonicalToDirection(origin + Vector2f(u.x(), u.y()) * size);
+}
+
+float DTree::pdf(const Vector3f & d) const
+{
+    Point2f p = directionToCanonical(d);
+    float result = 1.0f;
+    uint32_t index = 0;
+
+    while (true)
+    {
+        const Node & node = m_nodes[index];
+        float total = node.getSum();
+        if (total <= 0.0f)
+        {
+            break;
+        }
+
+        int x = p.x() >= 0.5f ? 1 : 0, y = p.y() >= 0.5f ? 1 : 0;
+        int quadrant = x + 2 * y;
+        result *= 4.0f * node.sum[quadrant].load(std::memory_order_relaxed) / total;
+
+        if (node.child[quadrant] == 0 || result == 0.0f)
+        {
+            break;
+        }
+        index = node.child[quadrant];
+        p = Point2f(2.0f * p.x() - float(x), 2.0f * p.y() - float(y));
+    }
+
+    /* The cylindrical mapping has a constant Jacobian of 4 pi */
+    return result * float(INV_FOURPI);
+}
+
+void DTree::build(const DTree & previous, float threshold, int maxDepth)
+{
+    m_nodes.clear();
+    m_nodes.emplace_back();
+
+    float total = previous.getEnergy();
+    if (total <= 0.0f)
+    {
+        /* Keep the previous topology */
+        m_nodes = previous.m_nodes;
+        for (Node & node : m_nodes)
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                node.sum[i].store(0.0f, std::memory_order_relaxed);
+            }
+        }
+        return;
+    }
+
+    float sums[4];
+    for (int i = 0; i < 4; i++)
+    {
+        sums[i] = previous.m_nodes[0].sum[i].load(std::memory_order_relaxed);
+    }
+    buildRecursive(previous, 0, sums, 0, total, threshold, 1, maxDepth);
+}
+
+void DTree::buildRecursive(const DTree & previous, int previousIndex, const float * previousSums,
+                           uint32_t index, float total, float threshold, int depth, int maxDepth)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        if (depth >= maxDepth || previousSums[i] <= threshold * total)
+        {
+            continue;
+        }
+
+        /* Subdivided leaves of the previous tree spread their energy evenly */
+        int childPrevious = -1;
+        float childSums[4];
+        if (previousIndex >= 0 && previous.m_nodes[previousIndex].child[i] != 0)
+        {
+            childPrevious = int(previous.m_nodes[previousIndex].child[i]);
+            for (int j = 0; j < 4; j++)
+            {
+                childSums[j] = previous.m_nodes[childPrevious].sum[j].load(std::memory_order_relaxed);
+            }
+        }
+        else
+        {
+            for (int j = 0; j < 4; j++)
+            {
+                childSums[j] = previousSums[i] * 0.25f;
+            }
+        }
+
+        uint32_t childIndex = uint32_t(m_nodes.size());
+        m_nodes.emplace_back();
+        m_nodes[index].child[i] = childIndex;
+        buildRecursive(previous, childPrevious, childSums, childIndex, total, threshold, depth + 1, maxDepth);
+    }
+}
+
+float DTree::getEnergy() const
+{
+    return m_nodes[0].getSum();
+}
+
+SDTree::SDTree(const BoundingBox3f & bounds)
+{
+    /* Cube-shaped bounds keep the cells of the binary tree isotropic */
+    float size = bounds.getExtents().maxCoeff() * 1.001f + Epsilon;
+    m_bounds = BoundingBox3f(bounds.min, bounds.min + Vector3f(size));
+    m_nodes.emplace_back();
+}
+
+DTreeWrapper * SDTree::lookup(const Point3f & p)
+{
+    return const_cast<DTreeWrapper *>(static_cast<const SDTree *>(this)->lookup(p));
+}
+
+const DTreeWrapper * SDTree::lookup(const Point3f & p) const
+{
+    Vector3f pos = (p - m_bounds.min).cwiseQuotient(m_bounds.getExtents());
+    pos = pos.cwiseMax(0.0f).cwiseMin(OneMinusEpsilon);
+
+    uint32_t index = 0;
+    while (m_nodes[index].child[0] != 0)
+    {
+        int axis = m_nodes[index].axis;
+        if (pos[axis] < 0.5f)
+        {
+            pos[axis] *= 2.0f;
+            index = m_nodes[index].child[0];
+        }
+        else
+        {
+            pos[axis] = pos[axis] * 2.0f - 1.0f;
+            index = m_nodes[index].child[1];
+        }
+    }
+    return &m_nodes[index].dTree;
+}
+
+void SDTree::subdivide(uint32_t index, uint64_t threshold)
+{
+    if (m_nodes[index].child[0] == 0)
+    {
+        if (m_nodes[index].dTree.count.load() <= threshold)
+        {
+            return;
+        }
+
+        /* Both halves start with the directional trees of the parent */
+        Node child;
+        child.axis = (m_nodes[index].axis + 1) % 3;
+        child.dTree = m_nodes[index].dTree;
+        child.dTree.count = m_nodes[index].dTree.count.load() / 2;
+
+        uint32_t childIndex = uint32_t(m_nodes.size());
+        m_nodes.push_back(child);
+        m_nodes.push_back(child);
+        m_nodes[index].child[0] = childIndex;
+        m_nodes[index].child[1] = childIndex + 1;
+    }
+
+    uint32_t child0 = m_nodes[index].child[0], child1 = m_nodes[index].child[1];
+    subdivide(child0, threshold);
+    subdivide(child1, threshold);
+}
+
+void SDTree::refine(uint64_t spatialThreshold, float directionalThreshold, int maxDirectionalDepth)
+{
+    subdivide(0, spatialThreshold);
+
+    std::vector<uint32_t> leaves;
+    for (uint32_t i = 0; i < uint32_t(m_nodes.size()); i++)
+    {
+        if (m_nodes[i].child[0] == 0)
+        {
+            leaves.push_back(i);
+        }
+    }
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, leaves.size()),
+        [&](const tbb::blocked_range<size_t> & range) {
+            for (size_t i = range.begin(); i < range.end(); i++)
+            {
+                DTreeWrapper & dTree = m_nodes[leaves[i]].dTree;
+                dTree.sampling = dTree.building;
+                dTree.building.build(dTree.sampling, directionalThreshold, maxDirectionalDepth);
+                dTree.count = 0;
+            }
+        });
+}
+
+size_t SDTree::getLeafCount() const
+{
+    size_t count = 0;
+    for (const Node & node : m_nodes)
+    {
+        if (node.child[0] == 0)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+std::string SDTree::toString() const
+{
+    return tfm::format(
+            "SDTree[\n"
+            "  bounds = %s,\n"
+            "  nodes = %i,\n"
+            "  leaves = %i\n"
+            "]",
+            indent(m_bounds.toString()),
+            m_nodes.size(),
+            getLeafCount()
+    );
+}
+
+NORI_NAMESPACE_END
@@ -0,0 +1,79 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#include <nori/core/shadowRayQueue.h>
+#include <nori/core/scene.h>
+#include <nori/core/block.h>
+
+NORI_NAMESPACE_BEGIN
+
+namespace
+{
+    thread_local ShadowRayQueue * pActiveQueue = nullptr;
+}
+
+ShadowRayQueue::ShadowRayQueue(size_t batchSize) :
+        m_batchSize(batchSize), m_pixelSample(0.0f), m_weight(1.0f),
+        m_pOccluded(new bool[batchSize]), m_occludedCapacity(batchSize)
+{
+    m_rays.reserve(batchSize);
+    m_contributions.reserve(batchSize);
+}
+
+void ShadowRayQueue::beginSample(const Point2f & pixelSample, const Color3f & weight)
+{
+    m_pixelSample = pixelSample;
+    m_weight = weight;
+}
+
+void ShadowRayQueue::push(const Ray3f & shadowRay, const Color3f & value)
+{
+    Color3f weightedValue = m_weight * value;
+    if (weightedValue.isZero())
+    {
+        return;
+    }
+    m_rays.push_back(shadowRay);
+    m_contributions.push_back({ m_pixelSample, weightedValue });
+}
+
+void ShadowRayQueue::flush(const Scene * pScene, ImageBlock & block)
+{
+    size_t count = m_rays.size();
+    if (count == 0)
+    {
+        return;
+    }
+
+    /* The last sample before a flush may push the queue beyond its batch size */
+    if (count > m_occludedCapacity)
+    {
+        m_pOccluded.reset(new bool[count]);
+        m_occludedCapacity = count;
+    }
+
+    pScene->rayOccluded(m_rays.data(), count, m_pOccluded.get());
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!m_pOccluded[i])
+        {
+            block.splat(m_contributions[i].pixelSample, m_contributions[i].value);
+        }
+    }
+
+    m_rays.clear();
+    m_contributions.clear();
+}
+
+ShadowRayQueue * ShadowRayQueue::getActive()
+{
+    return pActiveQueue;
+}
+
+void ShadowRayQueue::setActive(ShadowRayQueue * pQueue)
+{
+    pActiveQueue = pQueue;
+}
+
+NORI_NAMESPACE_END
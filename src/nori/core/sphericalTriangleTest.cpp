@@ -0,0 +1,180 @@
+//
+// Created by superqqli on 2026/10/19.
+//
+
+#include <nori/core/sphericalTriangleTest.h>
+#include <nori/core/warp.h>
+#include <nori/core/vector.h>
+#include <hypothesis.h>
+#include <pcg32.h>
+
+NORI_NAMESPACE_BEGIN
+
+namespace
+{
+    /// Cells with a lower expected frequency are pooled for the chi^2 test
+    const double MinExpFrequency = 5.0;
+
+    /// Tolerance of the barycentric coordinates of the sampled directions and of the densities
+    const double Tolerance = 1e-3;
+
+    /// Triangle as seen from the origin
+    struct Triangle
+    {
+        const char * name;
+        Vector3d p0, p1, p2;
+    };
+
+    const Triangle Triangles[] = {
+        { "regular", Vector3d(-0.5, -0.5, 2.0), Vector3d(0.5, -0.5, 2.0), Vector3d(0.0, 0.5, 2.0) },
+        { "octant", Vector3d(1.0, 0.0, 0.0), Vector3d(0.0, 1.0, 0.0), Vector3d(0.0, 0.0, 1.0) },
+        /* Sliver with an angle close to pi */
+        { "thin", Vector3d(-1.0, 0.0, 1.0), Vector3d(1.0, 0.0, 1.0), Vector3d(0.0, 0.01, 1.0) },
+        /* Sliver with an angle close to zero */
+        { "needle", Vector3d(0.0, 0.0, 1.0), Vector3d(2.0, 0.01, 1.0), Vector3d(2.0, -0.01, 1.0) },
+        /* Covers most of the hemisphere */
+        { "large", Vector3d(-4.0, -4.0, 0.1), Vector3d(8.0, -4.0, 0.1), Vector3d(-4.0, 8.0, 0.1) }
+    };
+
+    /// Solid angle by Van Oosterom and Strackee, in double precision
+    double solidAngle(const Triangle & triangle)
+    {
+        Vector3d a = triangle.p0.normalized(), b = triangle.p1.normalized(), c = triangle.p2.normalized();
+        return std::abs(2.0 * std::atan2(a.dot(b.cross(c)), 1.0 + a.dot(b) + a.dot(c) + b.dot(c)));
+    }
+}
+
+SphericalTriangleTest::SphericalTriangleTest(const PropertyList & propList)
+{
+    /* Number of cells along both axes of the parameterization */
+    m_resolution = propList.getInteger(XML_TEST_SPHERICAL_TRIANGLE_RESOLUTION, DEFAULT_TEST_SPHERICAL_TRIANGLE_RESOLUTION);
+
+    /* Number of directions sampled per triangle */
+    m_sampleCount = propList.getInteger(XML_TEST_SPHERICAL_TRIANGLE_SAMPLE_COUNT, DEFAULT_TEST_SPHERICAL_TRIANGLE_SAMPLE_COUNT);
+
+    /* The null hypothesis will be rejected when the associated
+       p-value is below the significance level specified here. */
+    m_significanceLevel = propList.getFloat(XML_TEST_SPHERICAL_TRIANGLE_SIGNIFICANCE_LEVEL,
+                                            DEFAULT_TEST_SPHERICAL_TRIANGLE_SIGNIFICANCE_LEVEL);
+
+    if (m_resolution <= 0 || m_sampleCount <= 0)
+    {
+        throw NoriException("SphericalTriangleTest: the resolution and the sample count must be positive!");
+    }
+}
+
+void SphericalTriangleTest::activate()
+{
+    int passed = 0, total = 0;
+    int cellCount = m_resolution * m_resolution;
+    int testCount = int(sizeof(Triangles) / sizeof(Triangles[0]));
+
+    for (const Triangle & triangle : Triangles)
+    {
+        cout << "------------------------------------------------------" << endl;
+        cout << "Testing the solid angle sampling of the \"" << triangle.name << "\" triangle" << endl;
+        ++total;
+
+        Vector3d e1 = triangle.p1 - triangle.p0, e2 = triangle.p2 - triangle.p0;
+        Vector3d n = e1.cross(e2);
+        double area = 0.5 * n.norm();
+        n.normalize();
+
+        double omega = solidAngle(triangle);
+        Vector3f a = triangle.p0.normalized().cast<float>();
+        Vector3f b = triangle.p1.normalized().cast<float>();
+        Vector3f c = triangle.p2.normalized().cast<float>();
+        float pdf = Warp::squareToSphericalTrianglePdf(a, b, c);
+        bool bPdfMatch = std::abs(double(pdf) * omega - 1.0) <= Tolerance;
+        cout << tfm::format("solid angle %f, pdf %f (expected %f) .. %s",
+                            omega, pdf, 1.0 / omega, bPdfMatch ? "passed" : "FAILED") << endl;
+
+        /* Bin the hit points in the parameterization of uniform area sampling (see Mesh::sampleTriangle) */
+        std::vector<double> obsFrequencies(cellCount, 0.0), expFrequencies(cellCount, 0.0);
+        pcg32 random;
+        int misses = 0;
+        for (int i = 0; i < m_sampleCount; i++)
+        {
+            Vector3f wf = Warp::squareToSphericalTriangle(Point2f(random.nextFloat(), random.nextFloat()), a, b, c);
+            Vector3d w = wf.cast<double>();
+
+            /* Moller-Trumbore with the ray origin at the reference point */
+            Vector3d s1 = w.cross(e2);
+            double divisor = s1.dot(e1);
+            Vector3d s = -triangle.p0;
+            Vector3d s2 = s.cross(e1);
+            double alpha = s.dot(s1) / divisor;
+            double beta = w.dot(s2) / divisor;
+            double t = e2.dot(s2) / divisor;
+            if (divisor == 0.0 || t <= 0.0 || alpha < -Tolerance || beta < -Tolerance || alpha + beta > 1.0 + Tolerance)
+            {
+                ++misses;
+                continue;
+            }
+
+            alpha = std::min(std::max(alpha, 0.0), 1.0);
+            beta = std::min(std::max(beta, 0.0), 1.0 - alpha);
+            double u1 = 1.0 - (1.0 - alpha) * (1.0 - alpha);
+            double u2 = alpha < 1.0 ? beta / (1.0 - alpha) : 0.0;
+            int x = std::min(int(u1 * m_resolution), m_resolution - 1);
+            int y = std::min(int(u2 * m_resolution), m_resolution - 1);
+            obsFrequencies[y * m_resolution + x] += 1.0;
+        }
+
+        /* Uniform in solid angle: cos(theta) / (d^2 * omega) wrt. area, and uniform area sampling has the density 1 / area */
+        auto integrand = [&](double u1, double u2) -> double {
+            double root = std::sqrt(std::max(0.0, 1.0 - u1));
+            Vector3d p = triangle.p0 + (1.0 - root) * e1 + u2 * root * e2;
+            double distance = p.norm();
+            return area * std::abs(n.dot(p)) / (distance * distance * distance * omega);
+        };
+        for (int y = 0; y < m_resolution; y++)
+        {
+            for (int x = 0; x < m_resolution; x++)
+            {
+                expFrequencies[y * m_resolution + x] = hypothesis::adaptiveSimpson2D(
+                        integrand, double(x) / m_resolution, double(y) / m_resolution,
+                        double(x + 1) / m_resolution, double(y + 1) / m_resolution) * m_sampleCount;
+            }
+        }
+
+        std::pair<bool, std::string> result =
+                hypothesis::chi2_test(cellCount, obsFrequencies.data(), expFrequencies.data(), m_sampleCount,
+                                      MinExpFrequency, m_significanceLevel, testCount);
+        cout << result.second << endl;
+        cout << tfm::format("%i directions missed the triangle .. %s", misses, misses == 0 ? "passed" : "FAILED") << endl;
+
+        if (bPdfMatch && misses == 0 && result.first)
+        {
+            ++passed;
+        }
+    }
+
+    cout << "Passed " << passed << "/" << total << " tests." << endl;
+    if (passed < total)
+    {
+        throw std::runtime_error("Some tests failed :(");
+    }
+}
+
+std::string SphericalTriangleTest::toString() const
+{
+    return tfm::format(
+            "SphericalTriangleTest[\n"
+            "  resolution = %i,\n"
+            "  sampleCount = %i,\n"
+            "  significanceLevel = %f\n"
+            "]",
+            m_resolution,
+            m_sampleCount,
+            m_significanceLevel
+    );
+}
+
+NoriObject::EClassType SphericalTriangleTest::getClassType() const
+{
+    return ETest;
+}
+
+NORI_REGISTER_CLASS(SphericalTriangleTest, XML_TEST_SPHERICAL_TRIANGLE);
+NORI_NAMESPACE_END
@@ -151,6 +151,7 @@ Color3f Texture::eval(const Intersection & isect, bool bFilter) const
 
 void Texture::evalGradient(const Intersection & isect, Color3f * pGradients) const
 {
+    isect.computePartials();
     Intersection isectCopy(isect);
 
     Color3f value = eval(isect, false);
@@ -197,6 +198,11 @@ bool Texture::isMonochromatic() const
     throw NoriException("Texture::isMonochromatic() is not implemented!");
 }
 
+bool Texture::usesRayDifferentials() const
+{
+    return false;
+}
+
 Texture * Texture::actualTexture()
 {
     return this;
@@ -213,6 +219,7 @@ Color3f Texture2D::eval(const Intersection & isect, bool bFilter) const
 
     if (bFilter)
     {
+        isect.computeScreenSpacePartials();
         return eval(uv,
                     Vector2f(isect.dUdX * m_uvScale.x(), isect.dVdX * m_uvScale.y()),
                     Vector2f(isect.dUdY * m_uvScale.x(), isect.dVdY * m_uvScale.y()));
@@ -231,6 +238,11 @@ void Texture2D::evalGradient(const Intersection & isect, Color3f * pGradients) c
     pGradients[1] *= m_uvScale.y();
 }
 
+bool Texture2D::usesRayDifferentials() const
+{
+    return true;
+}
+
 void Texture2D::evalGradient(const Point2f & uv, Color3f * pGradients) const
 {
     Color3f value = eval(uv);
@@ -369,6 +381,11 @@ bool Color3fAdditionTexture::isConstant() const
     return m_pTextureA->isConstant() && m_pTextureB->isConstant();
 }
 
+bool Color3fAdditionTexture::usesRayDifferentials() const
+{
+    return m_pTextureA->usesRayDifferentials() || m_pTextureB->usesRayDifferentials();
+}
+
 bool Color3fAdditionTexture::isMonochromatic() const
 {
     return m_pTextureA->isMonochromatic() && m_pTextureB->isMonochromatic();
@@ -426,6 +443,11 @@ bool Color3fSubtractionTexture::isConstant() const
     return m_pTextureA->isConstant() && m_pTextureB->isConstant();
 }
 
+bool Color3fSubtractionTexture::usesRayDifferentials() const
+{
+    return m_pTextureA->usesRayDifferentials() || m_pTextureB->usesRayDifferentials();
+}
+
 bool Color3fSubtractionTexture::isMonochromatic() const
 {
     return m_pTextureA->isMonochromatic() && m_pTextureB->isMonochromatic();
@@ -484,6 +506,11 @@ bool Color3fProductTexture::isConstant() const
     return m_pTextureA->isConstant() && m_pTextureB->isConstant();
 }
 
+bool Color3fProductTexture::usesRayDifferentials() const
+{
+    return m_pTextureA->usesRayDifferentials() || m_pTextureB->usesRayDifferentials();
+}
+
 bool Color3fProductTexture::isMonochromatic() const
 {
     return m_pTextureA->isMonochromatic() && m_pTextureB->isMonochromatic();
@@ -76,15 +76,19 @@ void Triangle::postIntersect(Intersection & its) const
     and we know the triangle index of the closest such intersection.
 
     The following computes a number of additional properties which
-    characterize the intersection (normals, texture coordinates, etc..)
+    characterize the intersection (normals, texture coordinates, etc..).
+    The partials are left to computePartials(), which runs on demand.
     */
 
     its.pEmitter = its.pShape->getEmitter();
     its.pBSDF = its.pShape->getBSDF();
+    its.pBSDFParams = nullptr;
+    its.bPartialsComputed = false;
+    its.bHasUVPartial = false;
 
     /* Find the barycentric coordinates */
     Vector3f Barycentric;
-    Barycentric << 1 - its.uv.sum(), its.uv;
+    Barycentric << 1 - its.barycentric.sum(), its.barycentric;
     its.uv = Point2f(0.0f);
 
     /* References to all relevant mesh buffers */
@@ -123,44 +127,19 @@ void Triangle::postIntersect(Intersection & its) const
         }
         else
         {
+            Normal3f NShade = (Barycentric.x() * N.col(Idx0) + Barycentric.y() * N.col(Idx1) + Barycentric.z() * N.col(Idx2)).normalized();
             float Det = dUV1.x() * dUV2.y() - dUV1.y() * dUV2.x();
 
             if (Det == 0.0f)
             {
                 // Triangle degeneration
-
-                its.shFrame = Frame(
-                        (Barycentric.x() * N.col(Idx0) + Barycentric.y() * N.col(Idx1) + Barycentric.z() * N.col(Idx2)).normalized()
-                );
-
-                its.dPdU = its.shFrame.s;
-                its.dPdV = its.shFrame.t;
-                its.dNdU = Vector3f(0.0f);
-                its.dNdV = Vector3f(0.0f);
-                its.bHasUVPartial = true;
+                its.shFrame = Frame(NShade);
             }
             else
             {
+                /* The tangent of the shading frame follows the texture parameterization */
                 float InvDet = 1.0f / Det;
-                Vector3f dPdU = ( dUV2.y() * dP1 - dUV1.y() * dP2) * InvDet;
-                Vector3f dPdV = (-dUV2.x() * dP1 + dUV1.x() * dP2) * InvDet;
-
-                Normal3f NShade = Barycentric.x() * N.col(Idx0) + Barycentric.y() * N.col(Idx1) + Barycentric.z() * N.col(Idx2);
-                float Ln = NShade.norm();
-                float InvLn = 1.0f / Ln;
-                NShade *= InvLn;
-
-                Vector3f dNdU = (N.col(Idx1) - N.col(Idx0)) * InvLn;
-                dNdU -= NShade * NShade.dot(dNdU);
-                Vector3f dNdV = (N.col(Idx2) - N.col(Idx0)) * InvLn;
-                dNdV -= NShade * NShade.dot(dNdV);
-
-                its.dNdU = ( dUV2.y() * dNdU - dUV1.y() * dNdV) * InvDet;
-                its.dNdV = (-dUV2.x() * dNdU + dUV1.x() * dNdV) * InvDet;
-                its.dPdU = dPdU;
-                its.dPdV = dPdV;
-                its.bHasUVPartial = true;
-
+                Vector3f dPdU = (dUV2.y() * dP1 - dUV1.y() * dP2) * InvDet;
                 its.shFrame = Frame(NShade, dPdU);
             }
         }
@@ -177,6 +156,68 @@ void Triangle::postIntersect(Intersection & its) const
     }
 }
 
+void Triangle::computePartials(const Intersection & its) const
+{
+    its.bHasUVPartial = false;
+
+    const Mesh * pMesh = its.pShape->getMesh();
+    const MatrixXf & V = pMesh->getVertexPositions();
+    const MatrixXf & N = pMesh->getVertexNormals();
+    const MatrixXf & UV = pMesh->getVertexTexCoords();
+    const MatrixXu & F = pMesh->getIndices();
+
+    if (N.size() == 0 || UV.size() == 0)
+    {
+        return;
+    }
+
+    uint32_t Idx0 = F(0, m_iFacet), Idx1 = F(1, m_iFacet), Idx2 = F(2, m_iFacet);
+    Point3f P0 = V.col(Idx0), P1 = V.col(Idx1), P2 = V.col(Idx2);
+    Point2f UV0 = UV.col(Idx0), UV1 = UV.col(Idx1), UV2 = UV.col(Idx2);
+    Vector3f dP1 = P1 - P0, dP2 = P2 - P0;
+    Vector2f dUV1 = UV1 - UV0, dUV2 = UV2 - UV0;
+
+    if (dP1.cross(dP2).norm() == 0)
+    {
+        return;
+    }
+
+    float Det = dUV1.x() * dUV2.y() - dUV1.y() * dUV2.x();
+    if (Det == 0.0f)
+    {
+        // Triangle degeneration
+        its.dPdU = its.shFrame.s;
+        its.dPdV = its.shFrame.t;
+        its.dNdU = Vector3f(0.0f);
+        its.dNdV = Vector3f(0.0f);
+        its.bHasUVPartial = true;
+        return;
+    }
+
+    Vector3f Barycentric;
+    Barycentric << 1 - its.barycentric.sum(), its.barycentric;
+
+    float InvDet = 1.0f / Det;
+    Vector3f dPdU = ( dUV2.y() * dP1 - dUV1.y() * dP2) * InvDet;
+    Vector3f dPdV = (-dUV2.x() * dP1 + dUV1.x() * dP2) * InvDet;
+
+    Normal3f NShade = Barycentric.x() * N.col(Idx0) + Barycentric.y() * N.col(Idx1) + Barycentric.z() * N.col(Idx2);
+    float Ln = NShade.norm();
+    float InvLn = 1.0f / Ln;
+    NShade *= InvLn;
+
+    Vector3f dNdU = (N.col(Idx1) - N.col(Idx0)) * InvLn;
+    dNdU -= NShade * NShade.dot(dNdU);
+    Vector3f dNdV = (N.col(Idx2) - N.col(Idx0)) * InvLn;
+    dNdV -= NShade * NShade.dot(dNdV);
+
+    its.dNdU = ( dUV2.y() * dNdU - dUV1.y() * dNdV) * InvDet;
+    its.dNdV = (-dUV2.x() * dNdU + dUV1.x() * dNdV) * InvDet;
+    its.dPdU = dPdU;
+    its.dPdV = dPdV;
+    its.bHasUVPartial = true;
+}
+
 Mesh * Triangle::getMesh() const
 {
     return m_pMesh;
@@ -11,6 +11,7 @@
 #include <nori/core/integrator.h>
 #include <nori/core/sampler.h>
 #include <nori/core/bsdfQueryRecord.h>
+#include <nori/core/bsdfQueryBatch.h>
 #include <hypothesis.h>
 #include <pcg32.h>
 
@@ -43,6 +44,10 @@ StudentsTTest::StudentsTTest(const PropertyList &propList)
 
     /* Number of BSDF samples that should be generated (default: 100K) */
     m_sampleCount = propList.getInteger("sampleCount", 100000);
+
+    /* Number of lanes when sampling the BSDFs through their
+       batch (SIMD) interface (0: use the scalar interface) */
+    m_batchSize = propList.getInteger("batchSize", 0);
 }
 
 StudentsTTest::~StudentsTTest()
@@ -96,15 +101,38 @@ void StudentsTTest::activate()
 
                 cout << "Drawing " << m_sampleCount << " samples .. " << endl;
                 double mean=0, variance = 0;
-                for (int k=0; k<m_sampleCount; ++k) {
-                    Point2f sample(random.nextFloat(), random.nextFloat());
-                    double result = (double) bsdf->sample(bRec, sample).getLuminance();
-
+                int k = 0;
+                auto addSample = [&](double result) {
                     /* Numerically robust online variance estimation using an
                        algorithm proposed by Donald Knuth (TAOCP vol.2, 3rd ed., p.232) */
                     double delta = result - mean;
-                    mean += delta / (double) (k+1);
+                    mean += delta / (double) (++k);
                     variance += delta * (result - mean);
+                };
+
+                if (m_batchSize > 0) {
+                    BSDFQueryBatch batch;
+                    Point2fBatch samples;
+                    Color3fBatch results;
+                    while (k < m_sampleCount) {
+                        int size = std::min(m_batchSize, m_sampleCount - k);
+                        batch.resize(size);
+                        samples.resize(size, 2);
+                        for (int j=0; j<size; ++j) {
+                            batch.wi.row(j) << bRec.wi.x(), bRec.wi.y(), bRec.wi.z();
+                            samples(j, 0) = random.nextFloat();
+                            samples(j, 1) = random.nextFloat();
+                        }
+                        bsdf->sampleBatch(batch, samples, results);
+
+                        for (int j=0; j<size; ++j)
+                            addSample((double) Color3f(results(j, 0), results(j, 1), results(j, 2)).getLuminance());
+                    }
+                } else {
+                    while (k < m_sampleCount) {
+                        Point2f sample(random.nextFloat(), random.nextFloat());
+                        addSample((double) bsdf->sample(bRec, sample).getLuminance());
+                    }
                 }
                 variance /= m_sampleCount - 1;
                 std::pair<bool, std::string>
@@ -174,10 +202,12 @@ std::string StudentsTTest::toString() const
     return tfm::format(
             "StudentsTTest[\n"
             "  significanceLevel = %f,\n"
-            "  sampleCount= %i\n"
+            "  sampleCount= %i,\n"
+            "  batchSize = %i\n"
             "]",
             m_significanceLevel,
-            m_sampleCount
+            m_sampleCount,
+            m_batchSize
     );
 }
 
@@ -104,4 +104,356 @@ float Warp::squareToBeckmannPdf(const Vector3f &m, float alpha) {
     return azimuthal * longitudinal;
 }
 
+/// Inverse error function, single precision approximation by Giles, "Approximating the erfinv function", 2010
+static float erfinv(float x) {
+    float w = -std::log((1 - x) * (1 + x)), p;
+    if (w < 5) {
+        w = w - 2.5f;
+        p = 2.81022636e-08f;
+        p = 3.43273939e-07f + p * w;
+        p = -3.5233877e-06f + p * w;
+        p = -4.39150654e-06f + p * w;
+        p = 0.00021858087f + p * w;
+        p = -0.00125372503f + p * w;
+        p = -0.00417768164f + p * w;
+        p = 0.246640727f + p * w;
+        p = 1.50140941f + p * w;
+    } else {
+        w = std::sqrt(w) - 3;
+        p = -0.000200214257f;
+        p = 0.000100950558f + p * w;
+        p = 0.00134934322f + p * w;
+        p = -0.00367342844f + p * w;
+        p = 0.00573950773f + p * w;
+        p = -0.0076224613f + p * w;
+        p = 0.00943887047f + p * w;
+        p = 1.00167406f + p * w;
+        p = 2.83297682f + p * w;
+    }
+    return p * x;
+}
+
+/// Exact Smith masking term of the Beckmann distribution, matches the distribution of visible normals
+static float smithBeckmannG1(const Vector3f &v, const Vector3f &m, float alpha) {
+    if (v.dot(m) * v.z() <= 0)
+        return 0;
+    float tanTheta = std::sqrt(v.x() * v.x() + v.y() * v.y()) / std::abs(v.z());
+    if (tanTheta == 0)
+        return 1;
+    float a = 1 / (alpha * tanTheta);
+    float lambda = (std::erf(a) - 1) / 2 + std::exp(-a * a) / (2 * a * std::sqrt((float) M_PI));
+    return 1 / (1 + lambda);
+}
+
+/// Smith masking term of the GGX distribution
+static float smithGGXG1(const Vector3f &v, const Vector3f &m, float alpha) {
+    if (v.dot(m) * v.z() <= 0)
+        return 0;
+    float tanTheta2 = (v.x() * v.x() + v.y() * v.y()) / (v.z() * v.z());
+    return 2 / (1 + std::sqrt(1 + alpha * alpha * tanTheta2));
+}
+
+/// Sample the slopes of the Beckmann normals (alpha = 1) visible from the direction at the angle 'thetaI' in the xz-plane
+static Point2f sampleBeckmannVisibleSlope(float thetaI, const Point2f &sample) {
+    const float invSqrtPi = 1 / std::sqrt((float) M_PI);
+
+    /* Normal incidence: the visible slopes follow the full distribution */
+    if (thetaI < 1e-4f) {
+        float r = std::sqrt(-std::log(1 - sample.x()));
+        float phi = (float) M_PI * 2 * sample.y();
+        return Point2f(r * std::cos(phi), r * std::sin(phi));
+    }
+
+    /* Numerical inversion of the CDF of the x slope, which is parameterized in the erf() domain.
+       The analytic inversion of the paper has discontinuities, which break up stratified samples */
+    float tanThetaI = std::tan(thetaI);
+    float cotThetaI = 1 / tanThetaI;
+    float a = -1, c = std::erf(cotThetaI);
+    float sampleX = std::max(sample.x(), 1e-6f);
+
+    /* Initial guess from a fit of the inverse CDF */
+    float fit = 1 + thetaI * (-0.876f + thetaI * (0.4265f - 0.0594f * thetaI));
+    float b = c - (1 + c) * std::pow(1 - sampleX, fit);
+
+    float normalization = 1 / (1 + c + invSqrtPi * tanThetaI * std::exp(-cotThetaI * cotThetaI));
+
+    for (int i = 0; i < 10; i++) {
+        /* Bisect when Newton leaves the bracket, the negated comparison also catches NaNs */
+        if (!(b >= a && b <= c))
+            b = 0.5f * (a + c);
+
+        float invErf = erfinv(b);
+        float value = normalization * (1 + b + invSqrtPi * tanThetaI * std::exp(-invErf * invErf)) - sampleX;
+        float derivative = normalization * (1 - invErf * tanThetaI);
+        if (std::abs(value) < 1e-5f)
+            break;
+
+        if (value > 0)
+            c = b;
+        else
+            a = b;
+        b -= value / derivative;
+    }
+
+    /* The y slope is independent of the x slope and the incident direction */
+    return Point2f(erfinv(b), erfinv(2 * std::max(sample.y(), 1e-6f) - 1));
+}
+
+Vector3f Warp::squareToBeckmannVisible(const Point2f &sample, const Vector3f &wi, float alpha) {
+    /* Stretch the incident direction to the configuration with alpha = 1 */
+    Vector3f wiStretched = Vector3f(alpha * wi.x(), alpha * wi.y(), wi.z()).normalized();
+    float thetaI = 0, phiI = 0;
+    if (wiStretched.z() < 0.99999f) {
+        thetaI = std::acos(wiStretched.z());
+        phiI = std::atan2(wiStretched.y(), wiStretched.x());
+    }
+
+    Point2f slope = sampleBeckmannVisibleSlope(thetaI, sample);
+
+    /* Rotate to the azimuth of the incident direction and unstretch */
+    float cosPhi = std::cos(phiI);
+    float sinPhi = std::sin(phiI);
+    float slopeX = alpha * (cosPhi * slope.x() - sinPhi * slope.y());
+    float slopeY = alpha * (sinPhi * slope.x() + cosPhi * slope.y());
+    return Vector3f(-slopeX, -slopeY, 1).normalized();
+}
+
+float Warp::squareToBeckmannVisiblePdf(const Vector3f &m, const Vector3f &wi, float alpha) {
+    if (wi.z() <= 0 || m.z() <= 0) {
+        return 0;
+    }
+    return smithBeckmannG1(wi, m, alpha) * std::max(0.f, wi.dot(m)) * squareToBeckmannPdf(m, alpha) / (m.z() * wi.z());
+}
+
+Vector3f Warp::squareToGGX(const Point2f &sample, float alpha) {
+    /* The CDF of tan^2(theta) is t / (alpha^2 + t) */
+    float phi = M_PI * 2 * sample.x();
+    float tanTheta2 = alpha * alpha * sample.y() / (1 - sample.y());
+    float cosTheta = 1 / std::sqrt(1 + tanTheta2);
+    float sinTheta = std::sqrt(tanTheta2) * cosTheta;
+    return Vector3f(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta);
+}
+
+float Warp::squareToGGXPdf(const Vector3f &m, float alpha) {
+    if (m.z() <= 0) {
+        return 0;
+    }
+    float alpha2 = alpha * alpha;
+    float cosTheta = m.z();
+    float tanTheta2 = (m.x() * m.x() + m.y() * m.y()) / (cosTheta * cosTheta);
+    float cosTheta3 = cosTheta * cosTheta * cosTheta;
+    float root = 1 + tanTheta2 / alpha2;
+    return INV_PI / (alpha2 * cosTheta3 * root * root);
+}
+
+Vector3f Warp::squareToGGXVisible(const Point2f &sample, const Vector3f &wi, float alpha) {
+    /* Stretch the incident direction to the configuration with alpha = 1 (a hemisphere) */
+    Vector3f vh = Vector3f(alpha * wi.x(), alpha * wi.y(), wi.z()).normalized();
+
+    /* Orthonormal basis around it */
+    float lengthSquared = vh.x() * vh.x() + vh.y() * vh.y();
+    Vector3f t1(1, 0, 0);
+    if (lengthSquared > 0)
+        t1 = Vector3f(-vh.y(), vh.x(), 0) / std::sqrt(lengthSquared);
+    Vector3f t2 = vh.cross(t1);
+
+    /* Uniform sample on the disk, warped onto the projection of the visible hemisphere */
+    float r = std::sqrt(sample.x());
+    float phi = (float) M_PI * 2 * sample.y();
+    float p1 = r * std::cos(phi);
+    float p2 = r * std::sin(phi);
+    float s = 0.5f * (1 + vh.z());
+    p2 = (1 - s) * std::sqrt(1 - p1 * p1) + s * p2;
+
+    /* Reproject onto the hemisphere and unstretch */
+    Vector3f nh = p1 * t1 + p2 * t2 + std::sqrt(std::max(0.f, 1 - p1 * p1 - p2 * p2)) * vh;
+    return Vector3f(alpha * nh.x(), alpha * nh.y(), std::max(0.f, nh.z())).normalized();
+}
+
+float Warp::squareToGGXVisiblePdf(const Vector3f &m, const Vector3f &wi, float alpha) {
+    if (wi.z() <= 0 || m.z() <= 0) {
+        return 0;
+    }
+    return smithGGXG1(wi, m, alpha) * std::max(0.f, wi.dot(m)) * squareToGGXPdf(m, alpha) / (m.z() * wi.z());
+}
+
+/// Angle between two unit vectors, accurate for small and large angles
+static double angleBetween(const Vector3d &v1, const Vector3d &v2) {
+    if (v1.dot(v2) < 0)
+        return M_PI - 2 * std::asin(std::min((v1 + v2).norm() / 2, 1.0));
+    return 2 * std::asin(std::min((v2 - v1).norm() / 2, 1.0));
+}
+
+Vector3f Warp::squareToSphericalTriangle(const Point2f &sample, const Vector3f &af, const Vector3f &bf, const Vector3f &cf) {
+    /* Evaluated in double precision: for slivers, the area is the small difference of angles
+       close to pi and float rounding visibly skews the samples towards the edges */
+    Vector3d a = af.cast<double>(), b = bf.cast<double>(), c = cf.cast<double>();
+
+    /* Normals of the great circles through the edges and the interior angles at the vertices */
+    Vector3d nab = a.cross(b), nbc = b.cross(c), nca = c.cross(a);
+    if (nab.squaredNorm() == 0 || nbc.squaredNorm() == 0 || nca.squaredNorm() == 0)
+        return af;
+    nab.normalize();
+    nbc.normalize();
+    nca.normalize();
+
+    double alpha = angleBetween(nab, -nca);
+    double beta = angleBetween(nbc, -nab);
+    double gamma = angleBetween(nca, -nbc);
+
+    /* Choose the sub-triangle a, b, c' whose area is the fraction sample.x() of the whole */
+    double areaPi = alpha + beta + gamma;
+    double subAreaPi = M_PI + sample.x() * (areaPi - M_PI);
+    double sinAlpha = std::sin(alpha), cosAlpha = std::cos(alpha);
+    double sinPhi = std::sin(subAreaPi) * cosAlpha - std::cos(subAreaPi) * sinAlpha;
+    double cosPhi = std::cos(subAreaPi) * cosAlpha + std::sin(subAreaPi) * sinAlpha;
+    double k1 = cosPhi + cosAlpha;
+    double k2 = sinPhi - sinAlpha * a.dot(b);
+    double cosBp = (k2 + (k2 * cosPhi - k1 * sinPhi) * cosAlpha) / ((k2 * sinPhi + k1 * cosPhi) * sinAlpha);
+    cosBp = std::min(std::max(cosBp, -1.0), 1.0);
+    double sinBp = std::sqrt(std::max(0.0, 1 - cosBp * cosBp));
+
+    Vector3d ca = c - c.dot(a) * a;
+    if (ca.squaredNorm() == 0)
+        return af;
+    Vector3d cp = cosBp * a + sinBp * ca.normalized();
+
+    /* Sample the arc between b and c' */
+    double cosTheta = 1 - sample.y() * (1 - cp.dot(b));
+    double sinTheta = std::sqrt(std::max(0.0, 1 - cosTheta * cosTheta));
+    Vector3d cpb = cp - cp.dot(b) * b;
+    if (cpb.squaredNorm() == 0)
+        return bf;
+    return (cosTheta * b + sinTheta * cpb.normalized()).normalized().cast<float>();
+}
+
+float Warp::squareToSphericalTrianglePdf(const Vector3f &a, const Vector3f &b, const Vector3f &c) {
+    /* Solid angle by Van Oosterom and Strackee */
+    float solidAngle = std::abs(2 * std::atan2(a.dot(b.cross(c)), 1 + a.dot(b) + a.dot(c) + b.dot(c)));
+    return solidAngle > 0 ? 1 / solidAngle : 0.f;
+}
+
+Vector3fBatch Warp::squareToCosineHemisphereBatch(const Point2fBatch &sample) {
+    /* Project uniform samples on the disk onto the hemisphere */
+    FloatBatch radius = sample.col(0).sqrt();
+    FloatBatch angle = sample.col(1) * (float) M_PI * 2;
+
+    Vector3fBatch result(sample.rows(), 3);
+    result.col(0) = radius * angle.cos();
+    result.col(1) = radius * angle.sin();
+    result.col(2) = (1.f - result.col(0).square() - result.col(1).square()).max(0.f).sqrt();
+    return result;
+}
+
+FloatBatch Warp::squareToCosineHemispherePdfBatch(const Vector3fBatch &v) {
+    return (v.col(2) < 0).select(0.f, v.col(2) * INV_PI);
+}
+
+Vector3fBatch Warp::squareToBeckmannBatch(const Point2fBatch &sample, const FloatBatch &alpha) {
+    /* cos(atan(x)) = 1 / sqrt(1 + x^2) and sin(atan(x)) = x / sqrt(1 + x^2) */
+    FloatBatch phi = (float) M_PI * 2 * sample.col(0);
+    FloatBatch tanTheta2 = -alpha.square() * (1 - sample.col(1)).log();
+    FloatBatch cosTheta = (1 + tanTheta2).rsqrt();
+    FloatBatch sinTheta = tanTheta2.sqrt() * cosTheta;
+
+    Vector3fBatch result(sample.rows(), 3);
+    result.col(0) = sinTheta * phi.cos();
+    result.col(1) = sinTheta * phi.sin();
+    result.col(2) = cosTheta;
+    return result;
+}
+
+FloatBatch Warp::squareToBeckmannPdfBatch(const Vector3fBatch &m, const FloatBatch &alpha) {
+    FloatBatch alpha2 = alpha.square();
+    FloatBatch cosTheta = m.col(2);
+    FloatBatch tanTheta2 = (m.col(0).square() + m.col(1).square()) / cosTheta.square();
+    FloatBatch longitudinal = (-tanTheta2 / alpha2).exp() / (alpha2 * cosTheta.cube());
+    return (cosTheta <= 0).select(0.f, INV_PI * longitudinal);
+}
+
+Vector3fBatch Warp::squareToBeckmannVisibleBatch(const Point2fBatch &sample, const Vector3fBatch &wi, const FloatBatch &alpha) {
+    /* The numerical inversion of the CDF does not vectorize, the lanes are warped one by one */
+    Vector3fBatch result(sample.rows(), 3);
+    for (Eigen::Index i = 0; i < sample.rows(); i++) {
+        Vector3f m = squareToBeckmannVisible(Point2f(sample(i, 0), sample(i, 1)), Vector3f(wi(i, 0), wi(i, 1), wi(i, 2)), alpha(i));
+        result.row(i) << m.x(), m.y(), m.z();
+    }
+    return result;
+}
+
+FloatBatch Warp::squareToBeckmannVisiblePdfBatch(const Vector3fBatch &m, const Vector3fBatch &wi, const FloatBatch &alpha) {
+    FloatBatch cosThetaI = wi.col(2);
+    FloatBatch tanThetaI = (wi.col(0).square() + wi.col(1).square()).sqrt() / cosThetaI;
+    FloatBatch a = 1 / (alpha * tanThetaI);
+    FloatBatch erfA = a.unaryExpr([](float x) { return std::erf(x); });
+    FloatBatch lambda = (erfA - 1) / 2 + (-a.square()).exp() / (2 * std::sqrt((float) M_PI) * a);
+    FloatBatch G1 = (tanThetaI == 0).select(1.f, 1 / (1 + lambda));
+
+    FloatBatch cosThetaIM = (m * wi).rowwise().sum();
+    FloatBatch result = G1 * cosThetaIM * squareToBeckmannPdfBatch(m, alpha) / (m.col(2) * cosThetaI);
+    return (cosThetaI <= 0 || m.col(2) <= 0 || cosThetaIM <= 0).select(0.f, result);
+}
+
+Vector3fBatch Warp::squareToGGXBatch(const Point2fBatch &sample, const FloatBatch &alpha) {
+    FloatBatch phi = (float) M_PI * 2 * sample.col(0);
+    FloatBatch tanTheta2 = alpha.square() * sample.col(1) / (1 - sample.col(1));
+    FloatBatch cosTheta = (1 + tanTheta2).rsqrt();
+    FloatBatch sinTheta = tanTheta2.sqrt() * cosTheta;
+
+    Vector3fBatch result(sample.rows(), 3);
+    result.col(0) = sinTheta * phi.cos();
+    result.col(1) = sinTheta * phi.sin();
+    result.col(2) = cosTheta;
+    return result;
+}
+
+FloatBatch Warp::squareToGGXPdfBatch(const Vector3fBatch &m, const FloatBatch &alpha) {
+    FloatBatch alpha2 = alpha.square();
+    FloatBatch cosTheta = m.col(2);
+    FloatBatch tanTheta2 = (m.col(0).square() + m.col(1).square()) / cosTheta.square();
+    FloatBatch root = 1 + tanTheta2 / alpha2;
+    return (cosTheta <= 0).select(0.f, INV_PI / (alpha2 * cosTheta.cube() * root.square()));
+}
+
+Vector3fBatch Warp::squareToGGXVisibleBatch(const Point2fBatch &sample, const Vector3fBatch &wi, const FloatBatch &alpha) {
+    Vector3fBatch vh(sample.rows(), 3);
+    vh.col(0) = alpha * wi.col(0);
+    vh.col(1) = alpha * wi.col(1);
+    vh.col(2) = wi.col(2);
+    vh.colwise() *= vh.square().rowwise().sum().rsqrt();
+
+    /* Basis (t1, t2, vh) as in the scalar version, t1 lies in the xy-plane */
+    FloatBatch lengthSquared = vh.col(0).square() + vh.col(1).square();
+    FloatBatch invLength = lengthSquared.rsqrt();
+    FloatBatch t1x = (lengthSquared > 0).select(-vh.col(1) * invLength, 1.f);
+    FloatBatch t1y = (lengthSquared > 0).select(vh.col(0) * invLength, 0.f);
+    FloatBatch t2x = -vh.col(2) * t1y;
+    FloatBatch t2y = vh.col(2) * t1x;
+    FloatBatch t2z = vh.col(0) * t1y - vh.col(1) * t1x;
+
+    FloatBatch r = sample.col(0).sqrt();
+    FloatBatch phi = (float) M_PI * 2 * sample.col(1);
+    FloatBatch p1 = r * phi.cos();
+    FloatBatch s = 0.5f * (1 + vh.col(2));
+    FloatBatch p2 = (1 - s) * (1 - p1.square()).sqrt() + s * r * phi.sin();
+    FloatBatch p3 = (1 - p1.square() - p2.square()).max(0.f).sqrt();
+
+    Vector3fBatch result(sample.rows(), 3);
+    result.col(0) = alpha * (p1 * t1x + p2 * t2x + p3 * vh.col(0));
+    result.col(1) = alpha * (p1 * t1y + p2 * t2y + p3 * vh.col(1));
+    result.col(2) = (p2 * t2z + p3 * vh.col(2)).max(0.f);
+    result.colwise() *= result.square().rowwise().sum().rsqrt();
+    return result;
+}
+
+FloatBatch Warp::squareToGGXVisiblePdfBatch(const Vector3fBatch &m, const Vector3fBatch &wi, const FloatBatch &alpha) {
+    FloatBatch cosThetaI = wi.col(2);
+    FloatBatch tanThetaI2 = (wi.col(0).square() + wi.col(1).square()) / cosThetaI.square();
+    FloatBatch G1 = 2 / (1 + (1 + alpha.square() * tanThetaI2).sqrt());
+
+    FloatBatch cosThetaIM = (m * wi).rowwise().sum();
+    FloatBatch result = G1 * cosThetaIM * squareToGGXPdfBatch(m, alpha) / (m.col(2) * cosThetaI);
+    return (cosThetaI <= 0 || m.col(2) <= 0 || cosThetaIM <= 0).select(0.f, result);
+}
+
 NORI_NAMESPACE_END
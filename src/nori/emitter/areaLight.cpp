@@ -4,12 +4,28 @@
 #include <nori/emitter/areaLight.h>
 #include <nori/core/mesh.h>
 #include <nori/core/emitterQueryRecord.h>
+#include <nori/core/lightBVH.h>
+#include <nori/core/frame.h>
+#include <nori/core/warp.h>
+#include <nori/core/bbox.h>
 
 NORI_NAMESPACE_BEGIN
 
+namespace
+{
+    /* Triangles subtending a solid angle outside of this range are sampled by area instead. Arvo's
+       construction is measurably biased in single precision below about 1e-3 sr (where sampling by
+       area is close to uniform in solid angle anyway), and unstable close to a hemisphere */
+    const float MinSolidAngle = 2e-3f;
+    const float MaxSolidAngle = 6.22f;
+}
+
 AreaLight::AreaLight(const PropertyList & propList)
 {
     m_radiance = propList.getColor(XML_EMITTER_AREA_LIGHT_RADIANCE);
+
+    /* Sample the triangles uniformly in solid angle (instead of area) as seen from the reference point */
+    m_bSolidAngleSampling = propList.getBoolean(XML_EMITTER_AREA_LIGHT_SOLID_ANGLE, DEFAULT_EMITTER_AREA_LIGHT_SOLID_ANGLE);
     m_type = EEmitterType::EArea;
 }
 
@@ -20,21 +36,17 @@ Color3f AreaLight::sample(EmitterQueryRecord & record, const Point2f & sample2D,
         throw NoriException("There is no shape attached to this AreaLight!");
     }
 
-    m_pMesh->samplePosition(sample1D, sample2D, record.p, record.n);
-
-    Vector3f wi = record.p - record.ref;
-
-    record.distance = wi.norm();
-    record.wi = wi.normalized();
-    record.pEmitter = this;
-    record.pdf = pdf(record);
-
-    if (record.pdf == 0.0f || std::isinf(record.pdf))
+    /* Select a triangle by area, then sample a position on it */
+    record.primitive = m_pMesh->sampleTriangleIndex(sample1D);
+    Color3f value = samplePrimitive(record, sample2D, sample1D);
+    if (value.isZero())
     {
         return Color3f(0.0f);
     }
 
-    return eval(record) / record.pdf;
+    float selectionPdf = m_pMesh->surfaceArea(record.primitive) * m_pMesh->pdf();
+    record.pdf *= selectionPdf;
+    return value / selectionPdf;
 }
 
 float AreaLight::pdf(const EmitterQueryRecord & record) const
@@ -44,6 +56,13 @@ float AreaLight::pdf(const EmitterQueryRecord & record) const
         throw NoriException("There is no shape attached to this AreaLight!");
     }
 
+    float solidAnglePdf = pdfSolidAngle(record);
+    if (solidAnglePdf > 0.0f)
+    {
+        /* Probability of selecting the triangle times the density on it */
+        return m_pMesh->surfaceArea(record.primitive) * m_pMesh->pdf() * solidAnglePdf;
+    }
+
     /* Transform the integration variable from the position domain to solid angle domain */
     float gDenominator = std::abs((-1.0f * record.wi).dot(record.n));
 
@@ -75,6 +94,167 @@ Color3f AreaLight::eval(const EmitterQueryRecord & record) const
     return Color3f(0.0f);
 }
 
+uint32_t AreaLight::getPrimitiveCount() const
+{
+    if (m_pMesh == nullptr)
+    {
+        throw NoriException("There is no shape attached to this AreaLight!");
+    }
+
+    return m_pMesh->getTriangleCount();
+}
+
+bool AreaLight::getLightBounds(uint32_t primitive, LightBounds & bounds) const
+{
+    if (m_pMesh == nullptr)
+    {
+        throw NoriException("There is no shape attached to this AreaLight!");
+    }
+
+    const MatrixXf & V = m_pMesh->getVertexPositions();
+    const MatrixXf & N = m_pMesh->getVertexNormals();
+    const MatrixXu & F = m_pMesh->getIndices();
+    uint32_t idx0 = F(0, primitive), idx1 = F(1, primitive), idx2 = F(2, primitive);
+
+    bounds.bounds = m_pMesh->getBoundingBox(primitive);
+    bounds.phi = m_radiance.getLuminance() * m_pMesh->surfaceArea(primitive) * float(M_PI);
+    bounds.cosThetaE = 0.0f;
+    bounds.bTwoSided = false;
+
+    Point3f p0 = V.col(idx0), p1 = V.col(idx1), p2 = V.col(idx2);
+    Vector3f faceNormal = (p1 - p0).cross(p2 - p0);
+    if (N.size() > 0)
+    {
+        /* Bound the interpolated shading normals by a cone around their average */
+        Normal3f n0 = N.col(idx0), n1 = N.col(idx1), n2 = N.col(idx2);
+        Vector3f w = n0 + n1 + n2;
+        if (w.squaredNorm() == 0.0f)
+        {
+            bounds.w = n0;
+            bounds.cosThetaO = -1.0f;
+            return true;
+        }
+        bounds.w = w.normalized();
+        bounds.cosThetaO = std::min({ bounds.w.dot(n0), bounds.w.dot(n1), bounds.w.dot(n2) });
+    }
+    else if (faceNormal.squaredNorm() > 0.0f)
+    {
+        bounds.w = faceNormal.normalized();
+        bounds.cosThetaO = 1.0f;
+    }
+    else
+    {
+        bounds.cosThetaO = -1.0f;
+    }
+
+    return true;
+}
+
+Color3f AreaLight::samplePrimitive(EmitterQueryRecord & record, const Point2f & sample2D, float sample1D) const
+{
+    if (m_pMesh == nullptr)
+    {
+        throw NoriException("There is no shape attached to this AreaLight!");
+    }
+
+    float solidAnglePdf = pdfSolidAngle(record);
+    if (solidAnglePdf > 0.0f)
+    {
+        if (m_pMesh->sampleTriangleSolidAngle(record.primitive, record.ref, sample2D, record.p, record.n) == 0.0f)
+        {
+            return Color3f(0.0f);
+        }
+    }
+    else
+    {
+        m_pMesh->sampleTriangle(record.primitive, sample2D, record.p, record.n);
+    }
+
+    Vector3f wi = record.p - record.ref;
+
+    record.distance = wi.norm();
+    record.wi = wi.normalized();
+    record.pEmitter = this;
+    record.pdf = solidAnglePdf > 0.0f ? solidAnglePdf : pdfPrimitive(record);
+
+    if (record.pdf == 0.0f || std::isinf(record.pdf))
+    {
+        return Color3f(0.0f);
+    }
+
+    return eval(record) / record.pdf;
+}
+
+float AreaLight::pdfPrimitive(const EmitterQueryRecord & record) const
+{
+    if (m_pMesh == nullptr)
+    {
+        throw NoriException("There is no shape attached to this AreaLight!");
+    }
+
+    float solidAnglePdf = pdfSolidAngle(record);
+    if (solidAnglePdf > 0.0f)
+    {
+        return solidAnglePdf;
+    }
+
+    /* Uniform density on the triangle, transformed to the solid angle domain */
+    float gDenominator = std::abs((-1.0f * record.wi).dot(record.n));
+    float area = m_pMesh->surfaceArea(record.primitive);
+
+    if (gDenominator == 0.0f || area == 0.0f)
+    {
+        return 0.0f;
+    }
+
+    return record.distance * record.distance / (area * gDenominator);
+}
+
+float AreaLight::pdfSolidAngle(const EmitterQueryRecord & record) const
+{
+    if (!m_bSolidAngleSampling)
+    {
+        return 0.0f;
+    }
+
+    float pdf = m_pMesh->pdfTriangleSolidAngle(record.primitive, record.ref);
+    if (pdf > 1.0f / MinSolidAngle || pdf < 1.0f / MaxSolidAngle)
+    {
+        return 0.0f;
+    }
+    return pdf;
+}
+
+Color3f AreaLight::sampleRay(Ray3f & ray, Normal3f & n, const Point2f & positionSample, const Point2f & directionSample,
+                             float sample1D, const BoundingBox3f & sceneBounds) const
+{
+    if (m_pMesh == nullptr)
+    {
+        throw NoriException("There is no shape attached to this AreaLight!");
+    }
+
+    Point3f p;
+    m_pMesh->samplePosition(sample1D, positionSample, p, n);
+
+    /* Cosine-weighted emission on the front side, the cosine cancels with the density */
+    Vector3f d = Frame(n).toWorld(Warp::squareToCosineHemisphere(directionSample));
+    ray = Ray3f(p, d);
+
+    return m_radiance * float(M_PI) / m_pMesh->pdf();
+}
+
+void AreaLight::pdfRay(const Ray3f & ray, const Normal3f & n, const BoundingBox3f & sceneBounds,
+                       float & pdfPosition, float & pdfDirection) const
+{
+    if (m_pMesh == nullptr)
+    {
+        throw NoriException("There is no shape attached to this AreaLight!");
+    }
+
+    pdfPosition = m_pMesh->pdf();
+    pdfDirection = Warp::squareToCosineHemispherePdf(Frame(n).toLocal(ray.d));
+}
+
 void AreaLight::setParent(NoriObject * pParentObj, const std::string &name)
 {
     EClassType clzType = pParentObj->getClassType();
@@ -94,8 +274,9 @@ void AreaLight::setParent(NoriObject * pParentObj, const std::string &name)
 std::string AreaLight::toString() const
 {
     return tfm::format(
-            "AreaLight[radiance = %s]",
-            m_radiance.toString()
+            "AreaLight[radiance = %s, solidAngleSampling = %s]",
+            m_radiance.toString(),
+            m_bSolidAngleSampling ? "true" : "false"
     );
 }
 
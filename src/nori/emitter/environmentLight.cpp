@@ -6,6 +6,9 @@
 #include <nori/core/emitterQueryRecord.h>
 #include <nori/core/bitmap.h>
 #include <nori/core/discretePDF.h>
+#include <nori/core/frame.h>
+#include <nori/core/warp.h>
+#include <nori/core/bbox.h>
 
 NORI_NAMESPACE_BEGIN
 
@@ -13,6 +16,7 @@ EnvironmentLight::EnvironmentLight(const PropertyList & propList)
 {
     m_scale = propList.getFloat(XML_EMITTER_ENVIRONMENT_LIGHT_SCALE, DEFAULT_EMITTER_ENVIRONMENT_SCALE);
     m_toWorld = propList.getTransform(XML_EMITTER_ENVIRONMENT_LIGHT_TO_WORLD, DEFAULT_EMITTER_ENVIRONMENT_TO_WORLD);
+    m_bAliasTable = propList.getBoolean(XML_EMITTER_ENVIRONMENT_LIGHT_ALIAS_TABLE, DEFAULT_EMITTER_ENVIRONMENT_ALIAS_TABLE);
     m_type = EEmitterType::EEnvironment;
     filesystem::path Filename = getFileResolver()->resolve(propList.getString(XML_EMITTER_ENVIRONMENT_LIGHT_FILENAME));
     m_name = Filename.str();
@@ -33,7 +37,7 @@ EnvironmentLight::EnvironmentLight(const PropertyList & propList)
         }
     }
 
-    m_pPdf.reset(new DiscretePDF2D(luminance.data(), int(m_pEnvironmentMap->cols()), int(m_pEnvironmentMap->rows())));
+    m_pPdf.reset(new DiscretePDF2D(luminance.data(), int(m_pEnvironmentMap->cols()), int(m_pEnvironmentMap->rows()), m_bAliasTable));
 }
 
 Color3f EnvironmentLight::sample(EmitterQueryRecord & record, const Point2f & sample2D, float sample1D) const
@@ -108,16 +112,53 @@ Color3f EnvironmentLight::eval(const EmitterQueryRecord & record) const
     return radiance * m_scale;
 }
 
+Color3f EnvironmentLight::sampleRay(Ray3f & ray, Normal3f & n, const Point2f & positionSample, const Point2f & directionSample,
+                                    float sample1D, const BoundingBox3f & sceneBounds) const
+{
+    // Ref : PBRT P851
+    Point3f center = sceneBounds.getCenter();
+    float radius = sceneBounds.getRadius();
+
+    EmitterQueryRecord record(center);
+    record.distance = radius;
+    Color3f value = sample(record, directionSample, sample1D);
+    if (value.isZero())
+    {
+        return Color3f(0.0f);
+    }
+
+    /* The ray starts on a disk perpendicular to the direction which covers the scene */
+    Vector3f d = -record.wi;
+    Point2f disk = Warp::squareToUniformDisk(positionSample);
+    ray = Ray3f(center + radius * Frame(d).toWorld(Vector3f(disk.x(), disk.y(), -1.0f)), d);
+    n = d;
+
+    return value * float(M_PI) * radius * radius;
+}
+
+void EnvironmentLight::pdfRay(const Ray3f & ray, const Normal3f & n, const BoundingBox3f & sceneBounds,
+                              float & pdfPosition, float & pdfDirection) const
+{
+    EmitterQueryRecord record(sceneBounds.getCenter());
+    record.wi = -ray.d;
+
+    float radius = sceneBounds.getRadius();
+    pdfPosition = 1.0f / (float(M_PI) * radius * radius);
+    pdfDirection = pdf(record);
+}
+
 std::string EnvironmentLight::toString() const
 {
     return tfm::format(
             "EnvironmentLight[\n"
             "  filename = %s,\n"
             "  scale = %f,\n"
+            "  aliasTable = %s,\n"
             "  toWorld = %s\n"
             "]",
             m_name,
             m_scale,
+            m_bAliasTable ? "true" : "false",
             indent(m_toWorld.toString(), 12)
     );
 }
@@ -23,10 +23,15 @@ Color3f AoIntegrator::li(const Scene * pScene, Sampler * pSampler, const Ray3f &
     Intersection its;
     if (!pScene->rayIntersect(ray, its))
         return Color3f(0.0f);
+    /* Draw the samples of all occlusion rays at once */
+    thread_local std::vector<Point2f> samples;
+    samples.resize(m_sampleCount);
+    pSampler->next2DArray(samples.data(), m_sampleCount);
+
     Color3f li(0.0f);
     for (uint32_t i = 0; i < m_sampleCount; i++)
     {
-        Vector3f wo = Warp::squareToCosineHemisphere(pSampler->next2D());
+        Vector3f wo = Warp::squareToCosineHemisphere(samples[i]);
         Vector3f destPoint = its.p + m_alpha * its.shFrame.toWorld(wo);
 
         Ray3f aoRay;
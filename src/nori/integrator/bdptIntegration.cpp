@@ -0,0 +1,728 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#include <nori/integrator/bdptIntegration.h>
+#include <nori/core/scene.h>
+#include <nori/core/camera.h>
+#include <nori/core/sampler.h>
+#include <nori/core/emitterQueryRecord.h>
+#include <nori/core/emitter.h>
+#include <nori/core/bsdfQueryRecord.h>
+#include <nori/core/bsdf.h>
+#include <nori/core/block.h>
+
+NORI_NAMESPACE_BEGIN
+
+namespace
+{
+    inline void atomicAdd(std::atomic<float> & target, float value)
+    {
+        float current = target.load(std::memory_order_relaxed);
+        while (!target.compare_exchange_weak(current, current + value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    /// Compensate the asymmetry of shading normals for importance transport (Veach, 1997, Section 5.3)
+    inline float correctShadingNormal(const Intersection & its, const Vector3f & wo, const Vector3f & wi)
+    {
+        float numerator = std::abs(wo.dot(its.shFrame.n) * wi.dot(its.geoFrame.n));
+        float denominator = std::abs(wo.dot(its.geoFrame.n) * wi.dot(its.shFrame.n));
+        return denominator == 0.0f ? 0.0f : numerator / denominator;
+    }
+
+    inline float remapZero(float pdf)
+    {
+        return pdf != 0.0f ? pdf : 1.0f;
+    }
+}
+
+bool BDPTIntegrator::PathVertex::isInfiniteLight() const
+{
+    return type == EVertexType::ELight && pEmitter != nullptr &&
+           pEmitter->getEmitterType() == EEmitterType::EEnvironment;
+}
+
+bool BDPTIntegrator::PathVertex::isDeltaLight() const
+{
+    return type == EVertexType::ELight && pEmitter != nullptr && pEmitter->isDelta();
+}
+
+bool BDPTIntegrator::PathVertex::isConnectible() const
+{
+    switch (type)
+    {
+        case EVertexType::ECamera:
+            return true;
+        case EVertexType::ELight:
+            return true;
+        default:
+            return (its.pBSDF->getBsdfTypes() & (EDiffuseReflection | EDiffuseTransmission |
+                                                  EGlossyReflection | EGlossyTransmission)) != 0;
+    }
+}
+
+Color3f BDPTIntegrator::PathVertex::f(const PathVertex & next) const
+{
+    if (type != EVertexType::ESurface)
+    {
+        return Color3f(0.0f);
+    }
+
+    Vector3f wi = next.p - p;
+    if (wi.squaredNorm() == 0.0f)
+    {
+        return Color3f(0.0f);
+    }
+    wi.normalize();
+
+    BSDFQueryRecord bsdfQueryRecord(its.toLocal(wo), its.toLocal(wi), EMeasure::ESolidAngle, mode, nullptr, its);
+    Color3f value = its.pBSDF->eval(bsdfQueryRecord);
+    if (mode == ETransportMode::EImportance)
+    {
+        value *= correctShadingNormal(its, wo, wi);
+    }
+    return value;
+}
+
+float BDPTIntegrator::PathVertex::convertDensity(float pdf, const PathVertex & next) const
+{
+    if (next.isInfiniteLight())
+    {
+        return pdf;
+    }
+
+    Vector3f w = next.p - p;
+    float distance2 = w.squaredNorm();
+    if (distance2 == 0.0f)
+    {
+        return 0.0f;
+    }
+
+    float invDistance2 = 1.0f / distance2;
+    if (next.isOnSurface())
+    {
+        pdf *= std::abs(next.n.dot(w * std::sqrt(invDistance2)));
+    }
+    return pdf * invDistance2;
+}
+
+float BDPTIntegrator::PathVertex::pdf(const PathContext & context, const PathVertex * pPrev, const PathVertex & next) const
+{
+    if (type == EVertexType::ELight)
+    {
+        return pdfLight(context, next);
+    }
+
+    Vector3f wn = next.p - p;
+    if (wn.squaredNorm() == 0.0f)
+    {
+        return 0.0f;
+    }
+    wn.normalize();
+
+    float pdf = 0.0f;
+    if (type == EVertexType::ECamera)
+    {
+        float pdfPosition;
+        context.pCamera->pdfImportance(Ray3f(p, wn), pdfPosition, pdf);
+    }
+    else
+    {
+        Vector3f wp = (pPrev->p - p).normalized();
+        BSDFQueryRecord bsdfQueryRecord(its.toLocal(wp), its.toLocal(wn), EMeasure::ESolidAngle, mode, nullptr, its);
+        pdf = its.pBSDF->pdf(bsdfQueryRecord);
+    }
+
+    return convertDensity(pdf, next);
+}
+
+float BDPTIntegrator::PathVertex::pdfLight(const PathContext & context, const PathVertex & next) const
+{
+    Vector3f w = next.p - p;
+    float distance2 = w.squaredNorm();
+    if (distance2 == 0.0f)
+    {
+        return 0.0f;
+    }
+    float invDistance2 = 1.0f / distance2;
+    w *= std::sqrt(invDistance2);
+
+    float pdf;
+    if (isInfiniteLight())
+    {
+        /* Density of the origin on the disk covering the scene, see EnvironmentLight::sampleRay() */
+        float radius = context.sceneBounds.getRadius();
+        pdf = 1.0f / (float(M_PI) * radius * radius);
+    }
+    else
+    {
+        float pdfPosition, pdfDirection;
+        pEmitter->pdfRay(Ray3f(p, w), getShadingNormal(), context.sceneBounds, pdfPosition, pdfDirection);
+        pdf = pdfDirection * invDistance2;
+    }
+
+    if (next.isOnSurface())
+    {
+        pdf *= std::abs(next.n.dot(w));
+    }
+    return pdf;
+}
+
+float BDPTIntegrator::PathVertex::pdfLightOrigin(const PathContext & context, const PathVertex & next) const
+{
+    Vector3f w = next.p - p;
+    if (w.squaredNorm() == 0.0f)
+    {
+        return 0.0f;
+    }
+    w.normalize();
+
+    /* Emitters are selected uniformly */
+    if (isInfiniteLight())
+    {
+        EmitterQueryRecord emitterQueryRecord(next.p);
+        emitterQueryRecord.wi = -w;
+        return pEmitter->pdf(emitterQueryRecord) / context.emitterCount;
+    }
+
+    float pdfPosition, pdfDirection;
+    pEmitter->pdfRay(Ray3f(p, w), getShadingNormal(), context.sceneBounds, pdfPosition, pdfDirection);
+    return pdfPosition / context.emitterCount;
+}
+
+Color3f BDPTIntegrator::PathVertex::le(const PathContext & context, const PathVertex & next) const
+{
+    if (!isLight())
+    {
+        return Color3f(0.0f);
+    }
+
+    Vector3f w = next.p - p;
+    if (w.squaredNorm() == 0.0f)
+    {
+        return Color3f(0.0f);
+    }
+    w.normalize();
+
+    if (isInfiniteLight())
+    {
+        EmitterQueryRecord emitterQueryRecord(next.p);
+        emitterQueryRecord.wi = -w;
+        return pEmitter->eval(emitterQueryRecord);
+    }
+
+    EmitterQueryRecord emitterQueryRecord(pEmitter, next.p, p, getShadingNormal());
+    return pEmitter->eval(emitterQueryRecord);
+}
+
+BDPTIntegrator::BDPTIntegrator(const PropertyList & propList)
+{
+    m_depth = uint32_t(propList.getInteger(XML_INTEGRATOR_BDPT_DEPTH, DEFAULT_PATH_TRACING_DEPTH));
+    m_bLightTracing = propList.getBoolean(XML_INTEGRATOR_BDPT_LIGHT_TRACING, DEFAULT_INTEGRATOR_BDPT_LIGHT_TRACING);
+}
+
+void BDPTIntegrator::preprocess(const Scene * pScene)
+{
+    m_outputSize = pScene->getCamera()->getOutputSize();
+    size_t count = 3 * size_t(m_outputSize.x()) * size_t(m_outputSize.y());
+    m_pSplats.reset(new std::atomic<float>[count]);
+    for (size_t i = 0; i < count; i++)
+    {
+        m_pSplats[i].store(0.0f, std::memory_order_relaxed);
+    }
+    m_lightPathCount.clear();
+}
+
+int BDPTIntegrator::randomWalk(const PathContext & context, Sampler * pSampler, Ray3f ray, Color3f beta, float pdf,
+                               int maxDepth, ETransportMode mode, std::vector<PathVertex> & path) const
+{
+    if (maxDepth <= 0)
+    {
+        return 0;
+    }
+
+    int bounces = 0;
+    float pdfFwd = pdf, pdfRev = 0.0f;
+    bool bForceBackground = context.pScene->getForceBackground();
+
+    while (true)
+    {
+        if (beta.isZero())
+        {
+            break;
+        }
+
+        Intersection its;
+        size_t prevIndex = path.size() - 1;
+        if (!context.pScene->rayIntersect(ray, its))
+        {
+            /* Radiance paths end on the environment emitter (if any) */
+            if (mode == ETransportMode::ERadiance && context.pEnvironmentEmitter != nullptr &&
+                !(bForceBackground && path[prevIndex].type == EVertexType::ECamera))
+            {
+                PathVertex vertex;
+                vertex.type = EVertexType::ELight;
+                vertex.mode = mode;
+                vertex.beta = beta;
+                vertex.p = ray.o + ray.d.normalized();
+                vertex.n = -ray.d.normalized();
+                vertex.pEmitter = context.pEnvironmentEmitter;
+                vertex.pdfFwd = pdfFwd;
+                path.push_back(vertex);
+                bounces++;
+            }
+            break;
+        }
+
+        if (its.pBSDF == nullptr)
+        {
+            break;
+        }
+
+        PathVertex vertex;
+        vertex.type = EVertexType::ESurface;
+        vertex.mode = mode;
+        vertex.beta = beta;
+        vertex.its = its;
+        vertex.p = its.p;
+        vertex.n = its.geoFrame.n;
+        vertex.wo = -ray.d.normalized();
+        vertex.pEmitter = its.pEmitter;
+        vertex.pdfFwd = path[prevIndex].convertDensity(pdfFwd, vertex);
+        path.push_back(vertex);
+        size_t index = path.size() - 1;
+
+        if (++bounces >= maxDepth)
+        {
+            break;
+        }
+
+        BSDFQueryRecord bsdfQueryRecord(its.toLocal(path[index].wo), mode, pSampler, its);
+        Color3f F = its.pBSDF->sample(bsdfQueryRecord, pSampler->next2D());
+        if (F.isZero())
+        {
+            break;
+        }
+
+        Vector3f wi = its.toWorld(bsdfQueryRecord.wo);
+        if (bsdfQueryRecord.measure == EMeasure::EDiscrete)
+        {
+            path[index].bDelta = true;
+            pdfFwd = pdfRev = 0.0f;
+        }
+        else
+        {
+            pdfFwd = its.pBSDF->pdf(bsdfQueryRecord);
+            if (pdfFwd == 0.0f)
+            {
+                break;
+            }
+            BSDFQueryRecord reverseRecord(bsdfQueryRecord.wo, bsdfQueryRecord.wi, EMeasure::ESolidAngle, mode, pSampler, its);
+            pdfRev = its.pBSDF->pdf(reverseRecord);
+        }
+
+        beta *= F;
+        if (mode == ETransportMode::EImportance)
+        {
+            beta *= correctShadingNormal(its, path[index].wo, wi);
+        }
+
+        path[index - 1].pdfRev = path[index].convertDensity(pdfRev, path[index - 1]);
+        ray = Ray3f(its.p, wi);
+    }
+
+    return bounces;
+}
+
+int BDPTIntegrator::generateCameraSubpath(const PathContext & context, Sampler * pSampler, const Ray3f & ray,
+                                          std::vector<PathVertex> & path) const
+{
+    PathVertex vertex;
+    vertex.type = EVertexType::ECamera;
+    vertex.beta = Color3f(1.0f);
+    vertex.p = ray.o;
+    path.push_back(vertex);
+
+    float pdfPosition, pdfDirection;
+    context.pCamera->pdfImportance(ray, pdfPosition, pdfDirection);
+    return randomWalk(context, pSampler, ray, Color3f(1.0f), pdfDirection, int(m_depth) + 1,
+                      ETransportMode::ERadiance, path) + 1;
+}
+
+int BDPTIntegrator::generateLightSubpath(const PathContext & context, Sampler * pSampler, std::vector<PathVertex> & path) const
+{
+    const std::vector<Emitter *> & emitters = context.pScene->getEmitters();
+    if (emitters.empty())
+    {
+        return 0;
+    }
+
+    float sampleLight = pSampler->next1D();
+    const Emitter * pEmitter = emitters[std::min(size_t(sampleLight * emitters.size()), emitters.size() - 1)];
+    float lightPdf = 1.0f / context.emitterCount;
+
+    Ray3f ray;
+    Normal3f n;
+    Point2f positionSample = pSampler->next2D();
+    Point2f directionSample = pSampler->next2D();
+    Color3f weight = pEmitter->sampleRay(ray, n, positionSample, directionSample, pSampler->next1D(), context.sceneBounds);
+    float pdfPosition, pdfDirection;
+    pEmitter->pdfRay(ray, n, context.sceneBounds, pdfPosition, pdfDirection);
+    if (weight.isZero() || pdfPosition == 0.0f || pdfDirection == 0.0f)
+    {
+        return 0;
+    }
+
+    /* The weight of the ray is the emitted radiance times the cosine over the densities */
+    PathVertex vertex;
+    vertex.type = EVertexType::ELight;
+    vertex.mode = ETransportMode::EImportance;
+    vertex.p = ray.o;
+    vertex.n = n;
+    vertex.pEmitter = pEmitter;
+    vertex.pdfFwd = pdfPosition * lightPdf;
+    float cosTheta = std::abs(n.dot(ray.d));
+    vertex.beta = cosTheta > 0.0f ? weight * pdfDirection / (cosTheta * lightPdf) : Color3f(0.0f);
+    path.push_back(vertex);
+
+    int count = randomWalk(context, pSampler, ray, weight / lightPdf, pdfDirection, int(m_depth),
+                           ETransportMode::EImportance, path) + 1;
+
+    /* Environment emitters are measured in solid angles, the first hit samples their disk */
+    if (path[0].isInfiniteLight())
+    {
+        if (count > 1)
+        {
+            path[1].pdfFwd = pdfPosition;
+            if (path[1].isOnSurface())
+            {
+                path[1].pdfFwd *= std::abs(ray.d.dot(path[1].n));
+            }
+        }
+        EmitterQueryRecord emitterQueryRecord(context.sceneBounds.getCenter());
+        emitterQueryRecord.wi = -ray.d;
+        path[0].pdfFwd = pEmitter->pdf(emitterQueryRecord) * lightPdf;
+    }
+
+    return count;
+}
+
+Color3f BDPTIntegrator::connect(const PathContext & context, Sampler * pSampler, const std::vector<PathVertex> & lightPath,
+                                const std::vector<PathVertex> & cameraPath, int s, int t, Point2f & pixel) const
+{
+    /* Emitters are only connected as endpoints */
+    if (t > 1 && s != 0 && cameraPath[t - 1].type == EVertexType::ELight)
+    {
+        return Color3f(0.0f);
+    }
+
+    Color3f L(0.0f);
+    PathVertex sampled;
+
+    if (s == 0)
+    {
+        /* The camera subpath hit an emitter */
+        const PathVertex & pt = cameraPath[t - 1];
+        if (pt.isLight())
+        {
+            L = pt.le(context, cameraPath[t - 2]) * pt.beta;
+        }
+    }
+    else if (t == 1)
+    {
+        /* Connect the light subpath to the camera */
+        const PathVertex & qs = lightPath[s - 1];
+        if (!qs.isConnectible())
+        {
+            return Color3f(0.0f);
+        }
+
+        Point3f p;
+        Normal3f n;
+        float pdf;
+        Color3f importance = context.pCamera->sampleImportance(qs.p, pSampler->next2D(), p, n, pixel, pdf);
+        if (pdf == 0.0f || importance.isZero())
+        {
+            return Color3f(0.0f);
+        }
+
+        sampled.type = EVertexType::ECamera;
+        sampled.beta = importance;
+        sampled.p = p;
+        sampled.n = n;
+
+        L = qs.beta * qs.f(sampled) * sampled.beta;
+        if (qs.isOnSurface())
+        {
+            L *= std::abs((p - qs.p).normalized().dot(qs.getShadingNormal()));
+        }
+        if (!L.isZero() && context.pScene->rayIntersect(qs.its.generateShadowRay(p)))
+        {
+            L = Color3f(0.0f);
+        }
+    }
+    else if (s == 1)
+    {
+        /* Sample a new point on an emitter (next event estimation) */
+        const PathVertex & pt = cameraPath[t - 1];
+        if (!pt.isConnectible())
+        {
+            return Color3f(0.0f);
+        }
+
+        const std::vector<Emitter *> & emitters = context.pScene->getEmitters();
+        float sampleLight = pSampler->next1D();
+        const Emitter * pEmitter = emitters[std::min(size_t(sampleLight * emitters.size()), emitters.size() - 1)];
+
+        EmitterQueryRecord emitterQueryRecord(pt.p);
+        if (pEmitter->getEmitterType() == EEmitterType::EEnvironment || pEmitter->getEmitterType() == EEmitterType::EDirectional)
+        {
+            emitterQueryRecord.distance = context.sceneBounds.getRadius();
+        }
+        Point2f sample2D = pSampler->next2D();
+        Color3f ldirect = pEmitter->sample(emitterQueryRecord, sample2D, pSampler->next1D());
+        if (ldirect.isZero())
+        {
+            return Color3f(0.0f);
+        }
+
+        sampled.type = EVertexType::ELight;
+        sampled.mode = ETransportMode::EImportance;
+        sampled.beta = ldirect * context.emitterCount;
+        sampled.p = emitterQueryRecord.p;
+        sampled.n = emitterQueryRecord.n;
+        sampled.pEmitter = pEmitter;
+        sampled.pdfFwd = sampled.pdfLightOrigin(context, pt);
+
+        L = pt.beta * pt.f(sampled) * sampled.beta * std::abs(emitterQueryRecord.wi.dot(pt.getShadingNormal()));
+        if (!L.isZero() && context.pScene->rayIntersect(pt.its.generateShadowRay(emitterQueryRecord.p)))
+        {
+            L = Color3f(0.0f);
+        }
+    }
+    else
+    {
+        /* Connect the endpoints of both subpaths */
+        const PathVertex & qs = lightPath[s - 1];
+        const PathVertex & pt = cameraPath[t - 1];
+        if (!qs.isConnectible() || !pt.isConnectible())
+        {
+            return Color3f(0.0f);
+        }
+
+        L = qs.beta * qs.f(pt) * pt.f(qs) * pt.beta;
+        if (!L.isZero())
+        {
+            Vector3f d = qs.p - pt.p;
+            float G = 1.0f / d.squaredNorm();
+            d *= std::sqrt(G);
+            G *= std::abs(qs.getShadingNormal().dot(d)) * std::abs(pt.getShadingNormal().dot(d));
+            L *= G;
+            if (!L.isZero() && context.pScene->rayIntersect(pt.its.generateShadowRay(qs.p)))
+            {
+                L = Color3f(0.0f);
+            }
+        }
+    }
+
+    if (L.isZero() || !L.isValid())
+    {
+        return Color3f(0.0f);
+    }
+
+    return L * misWeight(context, lightPath, cameraPath, sampled, s, t);
+}
+
+float BDPTIntegrator::misWeight(const PathContext & context, const std::vector<PathVertex> & lightPath,
+                                const std::vector<PathVertex> & cameraPath, const PathVertex & sampled, int s, int t) const
+{
+    if (s + t == 2)
+    {
+        return 1.0f;
+    }
+
+    /* Endpoints sampled during the connection replace the first vertex of their subpath */
+    auto lightVertex = [&](int i) -> const PathVertex & { return s == 1 && i == 0 ? sampled : lightPath[i]; };
+    auto cameraVertex = [&](int i) -> const PathVertex & { return t == 1 && i == 0 ? sampled : cameraPath[i]; };
+
+    const PathVertex * pt = t > 0 ? &cameraVertex(t - 1) : nullptr;
+    const PathVertex * qs = s > 0 ? &lightVertex(s - 1) : nullptr;
+    const PathVertex * ptMinus = t > 1 ? &cameraVertex(t - 2) : nullptr;
+    const PathVertex * qsMinus = s > 1 ? &lightVertex(s - 2) : nullptr;
+
+    /* Densities of the vertices of this strategy, with the reverse densities at the connection updated */
+    thread_local std::vector<float> cameraFwd, cameraRev, lightFwd, lightRev;
+    thread_local std::vector<bool> cameraDelta, lightDelta;
+    cameraFwd.resize(t); cameraRev.resize(t); cameraDelta.resize(t);
+    lightFwd.resize(s); lightRev.resize(s); lightDelta.resize(s);
+    for (int i = 0; i < t; i++)
+    {
+        cameraFwd[i] = cameraVertex(i).pdfFwd;
+        cameraRev[i] = cameraVertex(i).pdfRev;
+        cameraDelta[i] = cameraVertex(i).bDelta;
+    }
+    for (int i = 0; i < s; i++)
+    {
+        lightFwd[i] = lightVertex(i).pdfFwd;
+        lightRev[i] = lightVertex(i).pdfRev;
+        lightDelta[i] = lightVertex(i).bDelta;
+    }
+
+    if (pt != nullptr)
+    {
+        cameraDelta[t - 1] = false;
+        cameraRev[t - 1] = s > 0 ? qs->pdf(context, qsMinus, *pt) : pt->pdfLightOrigin(context, *ptMinus);
+    }
+    if (ptMinus != nullptr)
+    {
+        cameraRev[t - 2] = s > 0 ? pt->pdf(context, qs, *ptMinus) : pt->pdfLight(context, *ptMinus);
+    }
+    if (qs != nullptr)
+    {
+        lightDelta[s - 1] = false;
+        lightRev[s - 1] = pt->pdf(context, ptMinus, *qs);
+    }
+    if (qsMinus != nullptr)
+    {
+        lightRev[s - 2] = qs->pdf(context, pt, *qsMinus);
+    }
+
+    /* Ratios of the densities of the other strategies to the density of this one,
+       the strategy with i camera vertices is skipped if it is not evaluated */
+    float sumRatios = 0.0f;
+    float ratio = 1.0f;
+    for (int i = t - 1; i > 0; i--)
+    {
+        ratio *= remapZero(cameraRev[i]) / remapZero(cameraFwd[i]);
+        if (!cameraDelta[i] && !cameraDelta[i - 1] && (i > 1 || m_bLightTracing))
+        {
+            sumRatios += ratio;
+        }
+    }
+
+    ratio = 1.0f;
+    for (int i = s - 1; i >= 0; i--)
+    {
+        ratio *= remapZero(lightRev[i]) / remapZero(lightFwd[i]);
+        bool bDeltaLight = i > 0 ? lightDelta[i - 1] : lightVertex(0).isDeltaLight();
+        if (!lightDelta[i] && !bDeltaLight)
+        {
+            sumRatios += ratio;
+        }
+    }
+
+    return 1.0f / (1.0f + sumRatios);
+}
+
+void BDPTIntegrator::splat(const Point2f & pixel, const Color3f & value) const
+{
+    int x = int(pixel.x()), y = int(pixel.y());
+    if (m_pSplats == nullptr || x < 0 || y < 0 || x >= m_outputSize.x() || y >= m_outputSize.y())
+    {
+        return;
+    }
+
+    std::atomic<float> * pPixel = &m_pSplats[3 * (size_t(y) * size_t(m_outputSize.x()) + size_t(x))];
+    for (int i = 0; i < 3; i++)
+    {
+        atomicAdd(pPixel[i], value[i]);
+    }
+}
+
+Color3f BDPTIntegrator::li(const Scene * pScene, Sampler * pSampler, const Ray3f & ray) const
+{
+    PathContext context;
+    context.pScene = pScene;
+    context.pCamera = pScene->getCamera();
+    context.pEnvironmentEmitter = pScene->getEnvironmentEmitter();
+    context.sceneBounds = pScene->getBoundingBox();
+    context.emitterCount = float(pScene->getEmitters().size());
+
+    thread_local std::vector<PathVertex> cameraPath, lightPath;
+    cameraPath.clear();
+    lightPath.clear();
+
+    int cameraCount = generateCameraSubpath(context, pSampler, ray, cameraPath);
+    int lightCount = generateLightSubpath(context, pSampler, lightPath);
+    m_lightPathCount.local()++;
+
+    /* The camera ray left the scene without an environment emitter, but the
+       light subpath is still connected to the camera to keep the splats unbiased */
+    Color3f L = cameraCount == 1 ? pScene->getBackground() : Color3f(0.0f);
+    for (int t = 1; t <= cameraCount; t++)
+    {
+        for (int s = 0; s <= lightCount; s++)
+        {
+            int depth = s + t - 2;
+            if ((s == 1 && t == 1) || depth < 0 || depth > int(m_depth))
+            {
+                continue;
+            }
+            if (t == 1 && !m_bLightTracing)
+            {
+                continue;
+            }
+
+            Point2f pixel;
+            Color3f contribution = connect(context, pSampler, lightPath, cameraPath, s, t, pixel);
+            if (t == 1)
+            {
+                if (!contribution.isZero())
+                {
+                    splat(pixel, contribution);
+                }
+            }
+            else
+            {
+                L += contribution;
+            }
+        }
+    }
+
+    return L;
+}
+
+void BDPTIntegrator::postprocess(const Scene * pScene, ImageBlock & result) const
+{
+    uint64_t lightPathCount = m_lightPathCount.combine(std::plus<uint64_t>());
+    if (m_pSplats == nullptr || lightPathCount == 0)
+    {
+        return;
+    }
+
+    /* The splats estimate the image with every light subpath, one per pixel on average */
+    float scale = float(double(m_outputSize.x()) * double(m_outputSize.y()) / double(lightPathCount));
+    int border = result.getBorderSize();
+    result.lock();
+    for (int y = 0; y < m_outputSize.y(); y++)
+    {
+        for (int x = 0; x < m_outputSize.x(); x++)
+        {
+            const std::atomic<float> * pPixel = &m_pSplats[3 * (size_t(y) * size_t(m_outputSize.x()) + size_t(x))];
+            Color3f value(pPixel[0].load() * scale, pPixel[1].load() * scale, pPixel[2].load() * scale);
+
+            /* The result stores weighted sums, scale the splats by the filter weight
+               and leave the weight itself untouched */
+            Color4f & pixel = result.coeffRef(y + border, x + border);
+            pixel += Color4f(value.r() * pixel.w(), value.g() * pixel.w(), value.b() * pixel.w(), 0.0f);
+        }
+    }
+    result.unlock();
+}
+
+std::string BDPTIntegrator::toString() const
+{
+    return tfm::format(
+            "BDPTIntegrator[\n"
+            "  depth = %u,\n"
+            "  lightTracing = %s\n"
+            "]",
+            m_depth,
+            m_bLightTracing ? "true" : "false"
+    );
+}
+
+NORI_REGISTER_CLASS(BDPTIntegrator, XML_INTEGRATOR_BDPT);
+NORI_NAMESPACE_END
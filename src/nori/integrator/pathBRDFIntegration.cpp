@@ -12,6 +12,8 @@
 #include <nori/core/bsdfQueryRecord.h>
 #include <nori/core/primitiveShape.h>
 #include <nori/core/bsdf.h>
+#include <nori/core/radianceCache.h>
+#include <nori/core/timer.h>
 
 NORI_NAMESPACE_BEGIN
 
@@ -19,11 +21,88 @@ PathBRDFIntegrator::PathBRDFIntegrator(const PropertyList & propList)
 {
     m_depth = propList.getInteger(XML_INTEGRATOR_PATH_MATS_DEPTH, DEFAULT_PATH_TRACING_DEPTH);
 
+    std::string russianRoulette = propList.getString(XML_INTEGRATOR_RUSSIAN_ROULETTE, DEFAULT_INTEGRATOR_RUSSIAN_ROULETTE);
+    if (russianRoulette == XML_INTEGRATOR_RUSSIAN_ROULETTE_FIXED)
+    {
+        m_bAdrrs = false;
+    }
+    else if (russianRoulette == XML_INTEGRATOR_RUSSIAN_ROULETTE_ADRRS)
+    {
+        m_bAdrrs = true;
+    }
+    else
+    {
+        throw NoriException("PathBRDFIntegrator: unknown Russian roulette strategy \"%s\"!", russianRoulette);
+    }
+    m_adrrsSampleCount = uint32_t(std::max(propList.getInteger(XML_INTEGRATOR_ADRRS_SAMPLE_COUNT, DEFAULT_INTEGRATOR_ADRRS_SAMPLE_COUNT), 1));
+    m_adrrsMaxSplit = std::max(propList.getFloat(XML_INTEGRATOR_ADRRS_MAX_SPLIT, DEFAULT_INTEGRATOR_ADRRS_MAX_SPLIT), 1.0f);
+}
+
+void PathBRDFIntegrator::preprocess(const Scene * pScene)
+{
+    if (!m_bAdrrs)
+    {
+        return;
+    }
+
+    Timer timer;
+    m_pRadianceCache.reset(new RadianceCache(pScene->getBoundingBox(), 64));
+    traceCameraRays(pScene, m_adrrsSampleCount, 1, [&](Sampler * pSampler, const Ray3f & ray) {
+        trace(pScene, pSampler, ray, true);
+    });
+
+    LOG(INFO) << "Radiance cache pre-pass (" << m_adrrsSampleCount << " spp) took " << timer.elapsedString() << ".";
+}
+
+void PathBRDFIntegrator::postprocess(const Scene * pScene, ImageBlock & result) const
+{
+    AdrrsStatistics total;
+    for (const AdrrsStatistics & statistics : m_statistics)
+    {
+        total.pathCount += statistics.pathCount;
+        total.vertexCount += statistics.vertexCount;
+        total.splitCount += statistics.splitCount;
+    }
+    m_statistics.clear();
+    if (total.pathCount == 0)
+    {
+        return;
+    }
+    LOG(INFO) << tfm::format("Average path length: %.2f vertices, %llu splits (%.3f per path)",
+                             float(total.vertexCount) / float(total.pathCount), (unsigned long long) total.splitCount,
+                             float(total.splitCount) / float(total.pathCount));
 }
 
 Color3f PathBRDFIntegrator::li(const Scene * pScene, Sampler * pSampler, const Ray3f & ray) const
 {
+    return trace(pScene, pSampler, ray, false);
+}
+
+Color3f PathBRDFIntegrator::trace(const Scene * pScene, Sampler * pSampler, const Ray3f & ray, bool bRecord) const
+{
+    /* Vertices whose reflected radiance is recorded into the radiance cache */
+    struct RecordedVertex
+    {
+        Point3f p;
+        Color3f beta;
+        Color3f radiance;
+    };
+    thread_local std::vector<RecordedVertex> recordedVertices;
+    recordedVertices.clear();
+
+    /* Split paths which remain to be traced, starting at the intersection \c its */
+    struct SplitPath
+    {
+        Intersection its;
+        Ray3f ray;
+        Color3f beta;
+        uint32_t depth;
+    };
+    thread_local std::vector<SplitPath> splitPaths;
+    splitPaths.clear();
+
     Intersection its;
+    bool bIntersected = false; // its already holds the intersection of tracingRay
     Ray3f tracingRay(ray);
     Color3f li(0.0f);
     Color3f beta(1.0f);
@@ -31,59 +110,140 @@ Color3f PathBRDFIntegrator::li(const Scene * pScene, Sampler * pSampler, const R
     const Emitter * pEnvironmentEmitter = pScene->getEnvironmentEmitter();
     Color3f background = pScene->getBackground();
     bool bForceBackground = pScene->getForceBackground();
+    const RadianceCache * pRadianceCache = bRecord ? nullptr : m_pRadianceCache.get();
+    float pixelEstimate = 0.0f;
+    uint64_t vertexCount = 0, splitCount = 0;
+
+    /* Add a contribution to the estimate and to the radiance of the recorded vertices */
+    auto addRadiance = [&](const Color3f & contribution) {
+        li += contribution;
+        for (RecordedVertex & vertex : recordedVertices)
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                if (vertex.beta[i] > 0.0f)
+                {
+                    vertex.radiance[i] += contribution[i] / vertex.beta[i];
+                }
+            }
+        }
+    };
 
-    while (depth < m_depth)
+    for (;;)
     {
-        // miss hit, calculate the environment contribute
-        if (!pScene->rayIntersect(tracingRay, its))
+        while (depth < m_depth)
         {
-            if (pEnvironmentEmitter != nullptr && !bForceBackground)
+            // miss hit, calculate the environment contribute
+            if (!bIntersected && !pScene->rayIntersect(tracingRay, its))
+            {
+                if (pEnvironmentEmitter != nullptr && !bForceBackground)
+                {
+                    EmitterQueryRecord emitterQueryRecord;
+                    emitterQueryRecord.ref = tracingRay.o;
+                    emitterQueryRecord.wi = tracingRay.d;
+                    addRadiance(beta * pEnvironmentEmitter->eval(emitterQueryRecord) / 1.0f);
+                }
+                else if (depth == 0)
+                {
+                    return background;
+                }
+                break;
+            }
+            bIntersected = false;
+            vertexCount++;
+
+            /**     Close hit  process */
+            if (its.pShape->isEmitter())
             {
                 EmitterQueryRecord emitterQueryRecord;
                 emitterQueryRecord.ref = tracingRay.o;
+                emitterQueryRecord.p = its.p;
+                emitterQueryRecord.n = its.shFrame.n;
                 emitterQueryRecord.wi = tracingRay.d;
-                li += beta * pEnvironmentEmitter->eval(emitterQueryRecord) / 1.0f;
+                Color3f Le = its.pEmitter->eval(emitterQueryRecord);
+                addRadiance(Le * beta);
+                if (depth == 0)
+                {
+                    pixelEstimate += Le.getLuminance();
+                }
             }
-            else if (depth == 0)
+
+            if (depth == 0 && pRadianceCache != nullptr)
             {
-                return background;
+                /* The reflected radiance cached at the primary hit estimates the value of the pixel */
+                pixelEstimate += std::max(pRadianceCache->lookup(its.p), 0.0f);
             }
-            break;
-        }
-        /**     Close hit  process */
-        if (its.pShape->isEmitter())
-        {
-            EmitterQueryRecord emitterQueryRecord;
-            emitterQueryRecord.ref = tracingRay.o;
-            emitterQueryRecord.p = its.p;
-            emitterQueryRecord.n = its.shFrame.n;
-            emitterQueryRecord.wi = tracingRay.d;
-            Color3f Le = its.pEmitter->eval(emitterQueryRecord);
-            li += Le * beta;
-        }
 
-        const BSDF * pBSDF = its.pBSDF;
-        BSDFQueryRecord bsdfQueryRecord(its.toLocal(-1.0f * tracingRay.d), ETransportMode::ERadiance, pSampler, its);
-        beta *= pBSDF->sample(bsdfQueryRecord, pSampler->next2D());
+            if (bRecord)
+            {
+                recordedVertices.push_back({ its.p, beta, Color3f(0.0f) });
+            }
 
-        if (beta.isZero())
-        {
-            break;
-        }
+            const BSDF * pBSDF = its.pBSDF;
+            BSDFQueryRecord bsdfQueryRecord(its.toLocal(-1.0f * tracingRay.d), ETransportMode::ERadiance, pSampler, its);
+            beta *= pBSDF->sample(bsdfQueryRecord, pSampler->next2D());
 
-        // Russian roulette
-        if (pSampler->next1D() < 0.95f)
-        {
-            constexpr float inv = 1.0f / 0.95f;
-            beta *= inv;
+            if (beta.isZero())
+            {
+                break;
+            }
+
+            Ray3f scatteredRay(its.p, its.toWorld(bsdfQueryRecord.wo));
+            pBSDF->propagateDifferentials(bsdfQueryRecord, tracingRay, scatteredRay);
+            tracingRay = scatteredRay;
+
+            // Russian roulette and splitting, the path is continued q times on average
+            float q = 0.95f;
+            if (pRadianceCache != nullptr && depth + 1 < m_depth)
+            {
+                /* Look ahead at the next vertex, whose cached radiance drives the decision */
+                bIntersected = pScene->rayIntersect(tracingRay, its);
+                if (bIntersected)
+                {
+                    q = pRadianceCache->getSplittingFactor(its.p, beta, pixelEstimate, m_adrrsMaxSplit, q);
+                }
+            }
+            uint32_t continuationCount = uint32_t(q + pSampler->next1D());
+            if (continuationCount == 0)
+            {
+                break;
+            }
+            beta /= q;
+            for (uint32_t i = 1; i < continuationCount; i++)
+            {
+                splitPaths.push_back({ its, tracingRay, beta, depth + 1 });
+            }
+            splitCount += continuationCount - 1;
+
+            depth++;
         }
-        else
+
+        if (splitPaths.empty())
         {
             break;
         }
 
-        tracingRay = Ray3f(its.p, its.toWorld(bsdfQueryRecord.wo));
-        depth++;
+        /* Continue with the next split path */
+        const SplitPath & splitPath = splitPaths.back();
+        its = splitPath.its;
+        bIntersected = true;
+        tracingRay = splitPath.ray;
+        beta = splitPath.beta;
+        depth = splitPath.depth;
+        splitPaths.pop_back();
+    }
+
+    for (const RecordedVertex & vertex : recordedVertices)
+    {
+        m_pRadianceCache->record(vertex.p, vertex.radiance.getLuminance());
+    }
+
+    if (m_bAdrrs && !bRecord)
+    {
+        AdrrsStatistics & statistics = m_statistics.local();
+        statistics.pathCount++;
+        statistics.vertexCount += vertexCount;
+        statistics.splitCount += splitCount;
     }
 
     return li;
@@ -91,7 +251,9 @@ Color3f PathBRDFIntegrator::li(const Scene * pScene, Sampler * pSampler, const R
 
 std::string PathBRDFIntegrator::toString() const
 {
-    return tfm::format("PathBRDFIntegrator[depth = %u]", m_depth);
+    return tfm::format("PathBRDFIntegrator[depth = %u, russianRoulette = %s]",
+                       m_depth,
+                       m_bAdrrs ? XML_INTEGRATOR_RUSSIAN_ROULETTE_ADRRS : XML_INTEGRATOR_RUSSIAN_ROULETTE_FIXED);
 }
 
 NORI_REGISTER_CLASS(PathBRDFIntegrator, XML_INTEGRATOR_PATH_MATS);
@@ -11,6 +11,9 @@
 #include <nori/core/bsdfQueryRecord.h>
 #include <nori/core/primitiveShape.h>
 #include <nori/core/bsdf.h>
+#include <nori/core/lightBVH.h>
+#include <nori/core/shadowRayQueue.h>
+#include <nori/core/memoryHelper.h>
 
 NORI_NAMESPACE_BEGIN
 
@@ -18,6 +21,19 @@ PathEmitterIntegrator::PathEmitterIntegrator(const PropertyList & propList)
 {
     m_depth = propList.getInteger(XML_INTEGRATOR_PATH_MATS_DEPTH, DEFAULT_PATH_TRACING_DEPTH);
 
+    std::string emitterSampling = propList.getString(XML_INTEGRATOR_EMITTER_SAMPLING, DEFAULT_INTEGRATOR_EMITTER_SAMPLING);
+    if (emitterSampling == XML_INTEGRATOR_EMITTER_SAMPLING_ALL)
+    {
+        m_bLightBVH = false;
+    }
+    else if (emitterSampling == XML_INTEGRATOR_EMITTER_SAMPLING_LIGHT_BVH)
+    {
+        m_bLightBVH = true;
+    }
+    else
+    {
+        throw NoriException("PathEmitterIntegrator: unknown emitter sampling strategy \"%s\"!", emitterSampling);
+    }
 }
 
 Color3f PathEmitterIntegrator::li(const Scene * pScene, Sampler * pSampler, const Ray3f & ray) const
@@ -32,6 +48,13 @@ Color3f PathEmitterIntegrator::li(const Scene * pScene, Sampler * pSampler, cons
     const Emitter * pEnvironmentEmitter = pScene->getEnvironmentEmitter();
     Color3f Background = pScene->getBackground();
     bool bForceBackground = pScene->getForceBackground();
+    const LightBVH * pLightBVH = m_bLightBVH ? pScene->getLightBVH() : nullptr;
+    size_t nLightSamples = pLightBVH != nullptr ? 1 : pScene->getEmitters().size();
+    ShadowRayQueue * pShadowRays = ShadowRayQueue::getActive();
+
+    /* Texture values of the BSDFs along the path, evaluated once per vertex */
+    thread_local MemoryArena bsdfArena(16384);
+    bsdfArena.reset();
 
     while (Depth < m_depth)
     {
@@ -70,34 +93,57 @@ Color3f PathEmitterIntegrator::li(const Scene * pScene, Sampler * pSampler, cons
         }
 
         const BSDF * pBSDF = its.pBSDF;
+        pBSDF->prepare(its, bsdfArena);
 
         if (pBSDF->isDiffuse())
         {
             bLastPathSpecular = false;
-            // Direct light sampling
-            for (Emitter * pEmitter : pScene->getEmitters())
+            // Direct light sampling, the emitter of the shading point is accounted for by the hits above
+            for (size_t i = 0; i < nLightSamples; i++)
             {
-                if (pEmitter == its.pEmitter)
-                {
-                    continue;
-                }
-
                 EmitterQueryRecord emitterQueryRecord;
                 emitterQueryRecord.ref = its.p;
+                Color3f ldirect;
 
-                if (pEmitter->getEmitterType() == EEmitterType::EEnvironment || pEmitter->getEmitterType() == EEmitterType::EDirectional)
+                if (pLightBVH != nullptr)
                 {
-                    emitterQueryRecord.distance = pScene->getBoundingBox().getRadius();
+                    float sampleLight = pSampler->next1D();
+                    Point2f sample2D = pSampler->next2D();
+                    ldirect = pLightBVH->sample(emitterQueryRecord, its.shFrame.n, sampleLight, sample2D, pSampler->next1D());
+                    if (emitterQueryRecord.pEmitter == its.pEmitter)
+                    {
+                        continue;
+                    }
+                }
+                else
+                {
+                    const Emitter * pEmitter = pScene->getEmitters()[i];
+                    if (pEmitter == its.pEmitter)
+                    {
+                        continue;
+                    }
+
+                    if (pEmitter->getEmitterType() == EEmitterType::EEnvironment || pEmitter->getEmitterType() == EEmitterType::EDirectional)
+                    {
+                        emitterQueryRecord.distance = pScene->getBoundingBox().getRadius();
+                    }
+
+                    ldirect = pEmitter->sample(emitterQueryRecord, pSampler->next2D(), pSampler->next1D());
                 }
 
-                Color3f ldirect = pEmitter->sample(emitterQueryRecord, pSampler->next2D(), pSampler->next1D());
                 if (!ldirect.isZero())
                 {
+                    BSDFQueryRecord bsdfQueryRecord(its.toLocal(-1.0 * tracingRay.d), its.toLocal(emitterQueryRecord.wi), EMeasure::ESolidAngle, ETransportMode::ERadiance, pSampler, its);
+                    Color3f contribution = beta * pBSDF->eval(bsdfQueryRecord) * std::abs(Frame::cosTheta(bsdfQueryRecord.wo)) * ldirect;
+
                     Ray3f shadowRay = its.generateShadowRay(emitterQueryRecord.p);
-                    if (!pScene->rayIntersect(shadowRay))
+                    if (pShadowRays != nullptr)
+                    {
+                        pShadowRays->push(shadowRay, contribution);
+                    }
+                    else if (!pScene->rayIntersect(shadowRay))
                     {
-                        BSDFQueryRecord bsdfQueryRecord(its.toLocal(-1.0 * tracingRay.d), its.toLocal(emitterQueryRecord.wi), EMeasure::ESolidAngle, ETransportMode::ERadiance, pSampler, its);
-                        li += beta * pBSDF->eval(bsdfQueryRecord) * std::abs(Frame::cosTheta(bsdfQueryRecord.wo)) * ldirect;
+                        li += contribution;
                     }
                 }
             }
@@ -127,7 +173,9 @@ Color3f PathEmitterIntegrator::li(const Scene * pScene, Sampler * pSampler, cons
         }
 
         pLastEmitter = its.pEmitter;
-        tracingRay = Ray3f(its.p, its.toWorld(BSDFRecord.wo));
+        Ray3f scatteredRay(its.p, its.toWorld(BSDFRecord.wo));
+        pBSDF->propagateDifferentials(BSDFRecord, tracingRay, scatteredRay);
+        tracingRay = scatteredRay;
         Depth++;
     }
 
@@ -136,7 +184,8 @@ Color3f PathEmitterIntegrator::li(const Scene * pScene, Sampler * pSampler, cons
 
 std::string PathEmitterIntegrator::toString() const
 {
-    return tfm::format("PathEmitterIntegrator[depth = %u]", m_depth);
+    return tfm::format("PathEmitterIntegrator[depth = %u, emitterSampling = %s]", m_depth,
+                       m_bLightBVH ? XML_INTEGRATOR_EMITTER_SAMPLING_LIGHT_BVH : XML_INTEGRATOR_EMITTER_SAMPLING_ALL);
 }
 
 NORI_REGISTER_CLASS(PathEmitterIntegrator, XML_INTEGRATOR_PATH_EMS);
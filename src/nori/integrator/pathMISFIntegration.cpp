@@ -11,6 +11,12 @@
 #include <nori/core/bsdfQueryRecord.h>
 #include <nori/core/primitiveShape.h>
 #include <nori/core/bsdf.h>
+#include <nori/core/lightBVH.h>
+#include <nori/core/sdTree.h>
+#include <nori/core/radianceCache.h>
+#include <nori/core/shadowRayQueue.h>
+#include <nori/core/memoryHelper.h>
+#include <nori/core/timer.h>
 
 NORI_NAMESPACE_BEGIN
 
@@ -18,14 +24,187 @@ PathMISIntegrator::PathMISIntegrator(const PropertyList & propList)
 {
     m_depth = propList.getInteger(XML_INTEGRATOR_PATH_MATS_DEPTH, DEFAULT_PATH_TRACING_DEPTH);
 
+    std::string emitterSampling = propList.getString(XML_INTEGRATOR_EMITTER_SAMPLING, DEFAULT_INTEGRATOR_EMITTER_SAMPLING);
+    if (emitterSampling == XML_INTEGRATOR_EMITTER_SAMPLING_ALL)
+    {
+        m_bLightBVH = false;
+    }
+    else if (emitterSampling == XML_INTEGRATOR_EMITTER_SAMPLING_LIGHT_BVH)
+    {
+        m_bLightBVH = true;
+    }
+    else
+    {
+        throw NoriException("PathMISIntegrator: unknown emitter sampling strategy \"%s\"!", emitterSampling);
+    }
+
+    m_bGuiding = propList.getBoolean(XML_INTEGRATOR_PATH_MIS_GUIDING, DEFAULT_INTEGRATOR_PATH_MIS_GUIDING);
+    m_guidingPasses = uint32_t(propList.getInteger(XML_INTEGRATOR_PATH_MIS_GUIDING_PASSES, DEFAULT_INTEGRATOR_PATH_MIS_GUIDING_PASSES));
+    m_guidingBsdfFraction = clamp(propList.getFloat(XML_INTEGRATOR_PATH_MIS_GUIDING_BSDF_FRACTION, DEFAULT_INTEGRATOR_PATH_MIS_GUIDING_BSDF_FRACTION), 0.0f, 1.0f);
+    m_guidingSpatialThreshold = uint32_t(propList.getInteger(XML_INTEGRATOR_PATH_MIS_GUIDING_SPATIAL_THRESHOLD, DEFAULT_INTEGRATOR_PATH_MIS_GUIDING_SPATIAL_THRESHOLD));
+    m_guidingDirectionalThreshold = propList.getFloat(XML_INTEGRATOR_PATH_MIS_GUIDING_DIRECTIONAL_THRESHOLD, DEFAULT_INTEGRATOR_PATH_MIS_GUIDING_DIRECTIONAL_THRESHOLD);
+
+    std::string russianRoulette = propList.getString(XML_INTEGRATOR_RUSSIAN_ROULETTE, DEFAULT_INTEGRATOR_RUSSIAN_ROULETTE);
+    if (russianRoulette == XML_INTEGRATOR_RUSSIAN_ROULETTE_FIXED)
+    {
+        m_bAdrrs = false;
+    }
+    else if (russianRoulette == XML_INTEGRATOR_RUSSIAN_ROULETTE_ADRRS)
+    {
+        m_bAdrrs = true;
+    }
+    else
+    {
+        throw NoriException("PathMISIntegrator: unknown Russian roulette strategy \"%s\"!", russianRoulette);
+    }
+    m_adrrsSampleCount = uint32_t(std::max(propList.getInteger(XML_INTEGRATOR_ADRRS_SAMPLE_COUNT, DEFAULT_INTEGRATOR_ADRRS_SAMPLE_COUNT), 1));
+    m_adrrsMaxSplit = std::max(propList.getFloat(XML_INTEGRATOR_ADRRS_MAX_SPLIT, DEFAULT_INTEGRATOR_ADRRS_MAX_SPLIT), 1.0f);
+}
+
+PathMISIntegrator::~PathMISIntegrator()
+{
+
+}
+
+void PathMISIntegrator::preprocess(const Scene * pScene)
+{
+    if (m_bGuiding)
+    {
+        m_pSDTree.reset(new SDTree(pScene->getBoundingBox()));
+
+        /* Progressive training: every pass doubles the sample count and refines the guiding distribution */
+        for (uint32_t pass = 0; pass < m_guidingPasses; pass++)
+        {
+            Timer timer;
+            uint32_t sampleCount = 1u << pass;
+            traceCameraRays(pScene, sampleCount, uint64_t(pass) + 1, [&](Sampler * pSampler, const Ray3f & ray) {
+                trace(pScene, pSampler, ray, ETraceMode::ETrainGuiding);
+            });
+
+            m_pSDTree->refine(uint64_t(m_guidingSpatialThreshold * std::sqrt(float(sampleCount))),
+                              m_guidingDirectionalThreshold, 20);
+
+            LOG(INFO) << "Path guiding pass " << pass + 1 << "/" << m_guidingPasses << " (" << sampleCount << " spp, "
+                      << m_pSDTree->getLeafCount() << " spatial leaves) took " << timer.elapsedString() << ".";
+        }
+    }
+
+    if (m_bAdrrs)
+    {
+        Timer timer;
+        m_pRadianceCache.reset(new RadianceCache(pScene->getBoundingBox(), 64));
+        traceCameraRays(pScene, m_adrrsSampleCount, uint64_t(m_guidingPasses) + 1, [&](Sampler * pSampler, const Ray3f & ray) {
+            trace(pScene, pSampler, ray, ETraceMode::ETrainRadianceCache);
+        });
+
+        LOG(INFO) << "Radiance cache pre-pass (" << m_adrrsSampleCount << " spp) took " << timer.elapsedString() << ".";
+    }
+}
+
+void PathMISIntegrator::postprocess(const Scene * pScene, ImageBlock & result) const
+{
+    AdrrsStatistics total;
+    for (const AdrrsStatistics & statistics : m_statistics)
+    {
+        total.pathCount += statistics.pathCount;
+        total.vertexCount += statistics.vertexCount;
+        total.splitCount += statistics.splitCount;
+    }
+    m_statistics.clear();
+    if (total.pathCount == 0)
+    {
+        return;
+    }
+    LOG(INFO) << tfm::format("Average path length: %.2f vertices, %llu splits (%.3f per path)",
+                             float(total.vertexCount) / float(total.pathCount), (unsigned long long) total.splitCount,
+                             float(total.splitCount) / float(total.pathCount));
+}
+
+Color3f PathMISIntegrator::sampleDirection(const BSDF * pBSDF, const DTreeWrapper * pDTree, const Intersection & its,
+                                           BSDFQueryRecord & bsdfQueryRecord, Sampler * pSampler, float & pdf) const
+{
+    Point2f sample = pSampler->next2D();
+    if (pDTree == nullptr)
+    {
+        Color3f F = pBSDF->sample(bsdfQueryRecord, sample);
+        pdf = pBSDF->pdf(bsdfQueryRecord);
+        return F;
+    }
+
+    float alpha = m_guidingBsdfFraction;
+    if (sample.x() < alpha)
+    {
+        sample.x() = sample.x() / alpha;
+        Color3f F = pBSDF->sample(bsdfQueryRecord, sample);
+        if (bsdfQueryRecord.measure == EMeasure::EDiscrete)
+        {
+            /* Discrete lobes are only reached through the BSDF part of the mixture */
+            pdf = pBSDF->pdf(bsdfQueryRecord);
+            return F / alpha;
+        }
+        if (F.isZero())
+        {
+            pdf = 0.0f;
+            return F;
+        }
+    }
+    else
+    {
+        sample.x() = std::min((sample.x() - alpha) / (1.0f - alpha), 0x1.fffffep-1f);
+        bsdfQueryRecord.wo = its.toLocal(pDTree->sampling.sample(sample));
+        bsdfQueryRecord.measure = EMeasure::ESolidAngle;
+        bsdfQueryRecord.eta = 1.0f;
+    }
+
+    pdf = alpha * pBSDF->pdf(bsdfQueryRecord) + (1.0f - alpha) * pDTree->sampling.pdf(its.toWorld(bsdfQueryRecord.wo));
+    if (pdf == 0.0f)
+    {
+        return Color3f(0.0f);
+    }
+    return pBSDF->eval(bsdfQueryRecord) * std::abs(Frame::cosTheta(bsdfQueryRecord.wo)) / pdf;
 }
 
 Color3f PathMISIntegrator::li(const Scene * pScene, Sampler * pSampler, const Ray3f & ray) const
 {
-    Intersection itsNext;
+    return trace(pScene, pSampler, ray, ETraceMode::ERender);
+}
+
+Color3f PathMISIntegrator::trace(const Scene * pScene, Sampler * pSampler, const Ray3f & ray, ETraceMode mode) const
+{
+    /* Vertices whose incident (guiding) or reflected (radiance cache) radiance is recorded */
+    struct RecordedVertex
+    {
+        DTreeWrapper * pDTree; ///< Null for radiance cache records
+        Point3f p;
+        Vector3f wo;
+        Color3f beta;
+        Color3f radiance;
+        float pdf;
+    };
+    thread_local std::vector<RecordedVertex> recordedVertices;
+    recordedVertices.clear();
+
+    /* Split paths which remain to be traced, starting at the intersection \c its */
+    struct SplitPath
+    {
+        Intersection its;
+        Ray3f ray;
+        Color3f beta;
+        uint32_t depth;
+        float weightEms, weightMats;
+    };
+    thread_local std::vector<SplitPath> splitPaths;
+    splitPaths.clear();
+
+    /* Texture values of the BSDFs along the path, evaluated once per vertex */
+    thread_local MemoryArena bsdfArena(16384);
+    bsdfArena.reset();
+
+    /* The current and the next hit swap their storage at every bounce instead of being copied */
+    Intersection intersections[2];
+    Intersection * pIts = &intersections[0], * pItsNext = &intersections[1];
     bool bFoundIntersectionNext = false;
 
-    Intersection its;
     Ray3f tracingRay(ray);
     Color3f li(0.0f);
     Color3f beta(1.0f);
@@ -34,135 +213,262 @@ Color3f PathMISIntegrator::li(const Scene * pScene, Sampler * pSampler, const Ra
     const Emitter * pEnvironmentEmitter = pScene->getEnvironmentEmitter();
     Color3f background = pScene->getBackground();
     bool bForceBackground = pScene->getForceBackground();
+    const LightBVH * pLightBVH = m_bLightBVH ? pScene->getLightBVH() : nullptr;
+    size_t nLightSamples = pLightBVH != nullptr ? 1 : pScene->getEmitters().size();
+    float guidingFraction = 1.0f - m_guidingBsdfFraction;
+    const RadianceCache * pRadianceCache = mode == ETraceMode::ERender ? m_pRadianceCache.get() : nullptr;
+    // Training passes need the direct light at the recorded vertices, so only rendering defers the shadow rays
+    ShadowRayQueue * pShadowRays = mode == ETraceMode::ERender ? ShadowRayQueue::getActive() : nullptr;
+    float pixelEstimate = 0.0f;
+    uint64_t vertexCount = 0, splitCount = 0;
 
-    while (depth < m_depth)
-    {
-        if (depth == 0)
+    /* Add a contribution to the estimate and to the radiance of the recorded vertices */
+    auto addRadiance = [&](const Color3f & contribution) {
+        li += contribution;
+        for (RecordedVertex & vertex : recordedVertices)
         {
-            // miss hit, calculate the environment contribute
-            if (!pScene->rayIntersect(tracingRay, its))
+            for (int i = 0; i < 3; i++)
             {
-                if (pEnvironmentEmitter != nullptr && !bForceBackground)
+                if (vertex.beta[i] > 0.0f)
                 {
-                    EmitterQueryRecord EmitterRecord;
-                    EmitterRecord.ref = tracingRay.o;
-                    EmitterRecord.wi = tracingRay.d;
-                    li += beta * pEnvironmentEmitter->eval(EmitterRecord) / 1.0f;
-                    break;
-                }
-                else
-                {
-                    return background;
+                    vertex.radiance[i] += contribution[i] / vertex.beta[i];
                 }
             }
         }
-        else // Start from depth > 0
+    };
+
+    for (;;)
+    {
+        while (depth < m_depth)
         {
-            if (bFoundIntersectionNext)
+            if (depth == 0)
             {
-                its = itsNext;
+                // miss hit, calculate the environment contribute
+                if (!pScene->rayIntersect(tracingRay, *pIts))
+                {
+                    if (pEnvironmentEmitter != nullptr && !bForceBackground)
+                    {
+                        EmitterQueryRecord EmitterRecord;
+                        EmitterRecord.ref = tracingRay.o;
+                        EmitterRecord.wi = tracingRay.d;
+                        addRadiance(beta * pEnvironmentEmitter->eval(EmitterRecord) / 1.0f);
+                        break;
+                    }
+                    else
+                    {
+                        return background;
+                    }
+                }
             }
-            else
+            else // Start from depth > 0
             {
-                if (pEnvironmentEmitter != nullptr)
+                if (bFoundIntersectionNext)
                 {
-                    EmitterQueryRecord emitterRecord;
-                    emitterRecord.ref = tracingRay.o;
-                    emitterRecord.wi = tracingRay.d;
-                    li += beta * pEnvironmentEmitter->eval(emitterRecord) / 1.0f;
+                    std::swap(pIts, pItsNext);
+                }
+                else
+                {
+                    if (pEnvironmentEmitter != nullptr)
+                    {
+                        EmitterQueryRecord emitterRecord;
+                        emitterRecord.ref = tracingRay.o;
+                        emitterRecord.wi = tracingRay.d;
+                        addRadiance(beta * pEnvironmentEmitter->eval(emitterRecord) / 1.0f);
+                    }
+                    break;
                 }
-                break;
             }
-        }
 
-        /* Process the closest hit */
-        float pdfLightEms = 0.0f, pdfBsdfEms = 0.0f;
-        float pdfLightMats = 0.0f, pdfBsdfmats = 0.0f;
+            /* Process the closest hit */
+            Intersection & its = *pIts;
+            Intersection & itsNext = *pItsNext;
+            vertexCount++;
+            float pdfLightEms = 0.0f, pdfBsdfEms = 0.0f;
+            float pdfLightMats = 0.0f, pdfBsdfmats = 0.0f;
 
-        const BSDF * pBSDF = its.pBSDF;
+            const BSDF * pBSDF = its.pBSDF;
+            pBSDF->prepare(its, bsdfArena);
+            DTreeWrapper * pDTree = m_pSDTree != nullptr && pBSDF->isDiffuse() ? m_pSDTree->lookup(its.p) : nullptr;
 
-        if (its.pShape->isEmitter())
-        {
-            EmitterQueryRecord emitterQueryRecord(its.pEmitter, tracingRay.o, its.p, its.shFrame.n);
-
-            Color3f Le = its.pEmitter->eval(emitterQueryRecord);
-            li += beta * weightMats * Le;
-        }
+            if (its.pShape->isEmitter())
+            {
+                EmitterQueryRecord emitterQueryRecord(its.pEmitter, tracingRay.o, its.p, its.shFrame.n);
 
-        // Sampling direct light
-        for (Emitter * pEmitter : pScene->getEmitters())
-        {
-            EmitterQueryRecord emitterQueryRecord(its.p);
+                Color3f Le = its.pEmitter->eval(emitterQueryRecord);
+                addRadiance(beta * weightMats * Le);
+                if (depth == 0)
+                {
+                    pixelEstimate += Le.getLuminance();
+                }
+            }
 
-            if (pEmitter->getEmitterType() == EEmitterType::EEnvironment || pEmitter->getEmitterType() == EEmitterType::EDirectional)
+            if (depth == 0 && pRadianceCache != nullptr)
             {
-                emitterQueryRecord.distance = pScene->getBoundingBox().getRadius();
+                /* The reflected radiance cached at the primary hit estimates the value of the pixel */
+                pixelEstimate += std::max(pRadianceCache->lookup(its.p), 0.0f);
             }
 
-            Color3f ldirect = pEmitter->sample(emitterQueryRecord, pSampler->next2D(), pSampler->next1D());
-            pdfLightEms = emitterQueryRecord.pdf;
+            if (mode == ETraceMode::ETrainRadianceCache)
+            {
+                recordedVertices.push_back({ nullptr, its.p, Vector3f(0.0f), beta, Color3f(0.0f), 0.0f });
+            }
 
-            if (!ldirect.isZero())
+            // Sampling direct light, either every emitter or a single light selected by the light BVH
+            for (size_t i = 0; i < nLightSamples; i++)
             {
-                Ray3f shadowRay = its.generateShadowRay(emitterQueryRecord.p);
-                if (!pScene->rayIntersect(shadowRay))
+                EmitterQueryRecord emitterQueryRecord(its.p);
+                Color3f ldirect;
+
+                if (pLightBVH != nullptr)
+                {
+                    float sampleLight = pSampler->next1D();
+                    Point2f sample2D = pSampler->next2D();
+                    ldirect = pLightBVH->sample(emitterQueryRecord, its.shFrame.n, sampleLight, sample2D, pSampler->next1D());
+                }
+                else
+                {
+                    const Emitter * pEmitter = pScene->getEmitters()[i];
+                    if (pEmitter->getEmitterType() == EEmitterType::EEnvironment || pEmitter->getEmitterType() == EEmitterType::EDirectional)
+                    {
+                        emitterQueryRecord.distance = pScene->getBoundingBox().getRadius();
+                    }
+
+                    ldirect = pEmitter->sample(emitterQueryRecord, pSampler->next2D(), pSampler->next1D());
+                }
+                pdfLightEms = emitterQueryRecord.pdf;
+
+                if (!ldirect.isZero())
                 {
                     // For some virtual light which are not in BVH, we can set BSDF to EMeasure::EDiscrete, so that the value of pdfBsdfEms will be 0
                     BSDFQueryRecord bsdfQueryRecord(its.toLocal(-1.0f * tracingRay.d), its.toLocal(emitterQueryRecord.wi), EMeasure::ESolidAngle, ETransportMode::ERadiance, pSampler, its);
                     pdfBsdfEms = pBSDF->pdf(bsdfQueryRecord);
+                    if (pDTree != nullptr)
+                    {
+                        pdfBsdfEms = m_guidingBsdfFraction * pdfBsdfEms + guidingFraction * pDTree->sampling.pdf(emitterQueryRecord.wi);
+                    }
                     if (pdfLightEms + pdfBsdfEms != 0.0f)
                     {
                         weightEms = pdfLightEms / (pdfLightEms + pdfBsdfEms);
                     }
-                    li += beta * pBSDF->eval(bsdfQueryRecord) * std::abs(Frame::cosTheta(bsdfQueryRecord.wo)) * ldirect * weightEms;
+                    Color3f contribution = beta * pBSDF->eval(bsdfQueryRecord) * std::abs(Frame::cosTheta(bsdfQueryRecord.wo)) * ldirect * weightEms;
+
+                    Ray3f shadowRay = its.generateShadowRay(emitterQueryRecord.p);
+                    if (pShadowRays != nullptr)
+                    {
+                        pShadowRays->push(shadowRay, contribution);
+                    }
+                    else if (!pScene->rayIntersect(shadowRay))
+                    {
+                        addRadiance(contribution);
+                    }
                 }
             }
-        }
 
-        BSDFQueryRecord bsdfQueryRecord(its.toLocal(-1.0f * tracingRay.d), ETransportMode::ERadiance, pSampler, its);
-        Color3f F = pBSDF->sample(bsdfQueryRecord, pSampler->next2D());
+            BSDFQueryRecord bsdfQueryRecord(its.toLocal(-1.0f * tracingRay.d), ETransportMode::ERadiance, pSampler, its);
+            float pdfDirection = 0.0f;
+            Color3f F = sampleDirection(pBSDF, pDTree, its, bsdfQueryRecord, pSampler, pdfDirection);
 
-        tracingRay = Ray3f(its.p, its.toWorld(bsdfQueryRecord.wo));
-        beta *= F;
+            Ray3f scatteredRay(its.p, its.toWorld(bsdfQueryRecord.wo));
+            pBSDF->propagateDifferentials(bsdfQueryRecord, tracingRay, scatteredRay);
+            tracingRay = scatteredRay;
+            beta *= F;
 
-        if (beta.isZero())
-        {
-            break;
-        }
+            if (beta.isZero())
+            {
+                break;
+            }
 
-        // Intersection test for nest bounce
-        bFoundIntersectionNext = pScene->rayIntersect(tracingRay, itsNext);
-        if (bFoundIntersectionNext && itsNext.pEmitter != nullptr) // update the mis weight of indirect light
-        {
-            EmitterQueryRecord EmitterRecord(itsNext.pEmitter, its.p, itsNext.p, itsNext.shFrame.n);
+            // Intersection test for nest bounce
+            bFoundIntersectionNext = pScene->rayIntersect(tracingRay, itsNext);
+            if (bFoundIntersectionNext && itsNext.pEmitter != nullptr) // update the mis weight of indirect light
+            {
+                EmitterQueryRecord EmitterRecord(itsNext.pEmitter, its.p, itsNext.p, itsNext.shFrame.n);
+                EmitterRecord.primitive = itsNext.pShape->getFacetIndex();
 
-            pdfLightMats = itsNext.pEmitter->pdf(EmitterRecord);
-            pdfBsdfmats = pBSDF->pdf(bsdfQueryRecord);
+                if (pLightBVH != nullptr)
+                {
+                    pdfLightMats = pLightBVH->pdf(EmitterRecord, its.shFrame.n);
+                }
+                else
+                {
+                    pdfLightMats = itsNext.pEmitter->pdf(EmitterRecord);
+                }
+                pdfBsdfmats = pdfDirection;
 
-            if (pdfBsdfmats + pdfLightMats != 0.0f)
+                if (pdfBsdfmats + pdfLightMats != 0.0f)
+                {
+                    weightMats = pdfBsdfmats / (pdfBsdfmats + pdfLightMats);
+                }
+            }
+
+            if (bsdfQueryRecord.measure == EMeasure::EDiscrete)
             {
-                weightMats = pdfBsdfmats / (pdfBsdfmats + pdfLightMats);
+                weightEms = 0.0f;
+                weightMats = 1.0f;
             }
+
+            // Russian roulette and splitting, the path is continued q times on average
+            float q = 0.95f;
+            if (pRadianceCache != nullptr && bFoundIntersectionNext)
+            {
+                q = pRadianceCache->getSplittingFactor(itsNext.p, beta, pixelEstimate, m_adrrsMaxSplit, q);
+            }
+            uint32_t continuationCount = uint32_t(q + pSampler->next1D());
+            if (continuationCount == 0)
+            {
+                break;
+            }
+            beta /= q;
+            for (uint32_t i = 1; i < continuationCount; i++)
+            {
+                splitPaths.push_back({ itsNext, tracingRay, beta, depth + 1, weightEms, weightMats });
+            }
+            splitCount += continuationCount - 1;
+
+            if (mode == ETraceMode::ETrainGuiding && pDTree != nullptr && bsdfQueryRecord.measure != EMeasure::EDiscrete && pdfDirection > 0.0f)
+            {
+                recordedVertices.push_back({ pDTree, its.p, tracingRay.d, beta, Color3f(0.0f), pdfDirection });
+            }
+
+            depth++;
         }
 
-        if (bsdfQueryRecord.measure == EMeasure::EDiscrete)
+        if (splitPaths.empty())
         {
-            weightEms = 0.0f;
-            weightMats = 1.0f;
+            break;
         }
 
-        // Russian roulette
-        if (pSampler->next1D() < 0.95f)
+        /* Continue with the next split path */
+        const SplitPath & splitPath = splitPaths.back();
+        *pItsNext = splitPath.its;
+        bFoundIntersectionNext = true;
+        tracingRay = splitPath.ray;
+        beta = splitPath.beta;
+        depth = splitPath.depth;
+        weightEms = splitPath.weightEms;
+        weightMats = splitPath.weightMats;
+        splitPaths.pop_back();
+    }
+
+    for (const RecordedVertex & vertex : recordedVertices)
+    {
+        if (vertex.pDTree != nullptr)
         {
-            constexpr float inv = 1.0f / 0.95f;
-            beta *= inv;
+            vertex.pDTree->building.record(vertex.wo, vertex.radiance.getLuminance() / vertex.pdf);
+            vertex.pDTree->count++;
         }
         else
         {
-            break;
+            m_pRadianceCache->record(vertex.p, vertex.radiance.getLuminance());
         }
+    }
 
-        depth++;
+    if (m_bAdrrs && mode == ETraceMode::ERender)
+    {
+        AdrrsStatistics & statistics = m_statistics.local();
+        statistics.pathCount++;
+        statistics.vertexCount += vertexCount;
+        statistics.splitCount += splitCount;
     }
 
     return li;
@@ -170,7 +476,13 @@ Color3f PathMISIntegrator::li(const Scene * pScene, Sampler * pSampler, const Ra
 
 std::string PathMISIntegrator::toString() const
 {
-    return tfm::format("PathMISIntegrator[depth = %u]", m_depth);
+    return tfm::format("PathMISIntegrator[depth = %u, emitterSampling = %s, guiding = %s, guidingPasses = %u, guidingBsdfFraction = %.2f, russianRoulette = %s]",
+                       m_depth,
+                       m_bLightBVH ? XML_INTEGRATOR_EMITTER_SAMPLING_LIGHT_BVH : XML_INTEGRATOR_EMITTER_SAMPLING_ALL,
+                       m_bGuiding ? "true" : "false",
+                       m_guidingPasses,
+                       m_guidingBsdfFraction,
+                       m_bAdrrs ? XML_INTEGRATOR_RUSSIAN_ROULETTE_ADRRS : XML_INTEGRATOR_RUSSIAN_ROULETTE_FIXED);
 }
 
 NORI_REGISTER_CLASS(PathMISIntegrator, XML_INTEGRATOR_PATH_MIS);
@@ -0,0 +1,368 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#include <nori/integrator/restirIntegration.h>
+#include <nori/core/intersection.h>
+#include <nori/core/scene.h>
+#include <nori/core/sampler.h>
+#include <nori/core/emitterQueryRecord.h>
+#include <nori/core/emitter.h>
+#include <nori/core/bsdfQueryRecord.h>
+#include <nori/core/primitiveShape.h>
+#include <nori/core/bsdf.h>
+#include <nori/core/lightBVH.h>
+#include <nori/core/block.h>
+#include <atomic>
+
+NORI_NAMESPACE_BEGIN
+
+RestirIntegrator::RestirIntegrator(const PropertyList & propList)
+{
+    m_depth = uint32_t(propList.getInteger(XML_INTEGRATOR_RESTIR_DEPTH, DEFAULT_PATH_TRACING_DEPTH));
+    m_candidates = uint32_t(propList.getInteger(XML_INTEGRATOR_RESTIR_CANDIDATES, DEFAULT_INTEGRATOR_RESTIR_CANDIDATES));
+    m_bTemporalReuse = propList.getBoolean(XML_INTEGRATOR_RESTIR_TEMPORAL_REUSE, DEFAULT_INTEGRATOR_RESTIR_TEMPORAL_REUSE);
+    m_bSpatialReuse = propList.getBoolean(XML_INTEGRATOR_RESTIR_SPATIAL_REUSE, DEFAULT_INTEGRATOR_RESTIR_SPATIAL_REUSE);
+    m_spatialNeighbors = uint32_t(propList.getInteger(XML_INTEGRATOR_RESTIR_SPATIAL_NEIGHBORS, DEFAULT_INTEGRATOR_RESTIR_SPATIAL_NEIGHBORS));
+    m_spatialRadius = propList.getInteger(XML_INTEGRATOR_RESTIR_SPATIAL_RADIUS, DEFAULT_INTEGRATOR_RESTIR_SPATIAL_RADIUS);
+    m_historyLimit = float(propList.getInteger(XML_INTEGRATOR_RESTIR_HISTORY_LIMIT, DEFAULT_INTEGRATOR_RESTIR_HISTORY_LIMIT));
+
+    if (m_candidates == 0)
+    {
+        throw NoriException("RestirIntegrator: the number of candidates must be positive!");
+    }
+
+    std::string emitterSampling = propList.getString(XML_INTEGRATOR_EMITTER_SAMPLING, DEFAULT_INTEGRATOR_EMITTER_SAMPLING);
+    if (emitterSampling == XML_INTEGRATOR_EMITTER_SAMPLING_ALL)
+    {
+        m_bLightBVH = false;
+    }
+    else if (emitterSampling == XML_INTEGRATOR_EMITTER_SAMPLING_LIGHT_BVH)
+    {
+        m_bLightBVH = true;
+    }
+    else
+    {
+        throw NoriException("RestirIntegrator: unknown emitter sampling strategy \"%s\"!", emitterSampling);
+    }
+}
+
+void RestirIntegrator::preprocess(const Scene * pScene)
+{
+    /* The reservoirs cached by the render threads belong to the previous rendering
+       (e.g. of a server session with another sampler seed), or to another integrator
+       which may have been allocated at the same address */
+    static std::atomic<uint64_t> generationCounter(0);
+    m_generation = ++generationCounter;
+}
+
+float RestirIntegrator::sampleCandidate(const Scene * pScene, Sampler * pSampler, const Point3f & ref, const Normal3f & n,
+                                        LightSample & sample) const
+{
+    EmitterQueryRecord record(ref);
+    float sampleLight = pSampler->next1D();
+    Point2f sample2D = pSampler->next2D();
+    float sample1D = pSampler->next1D();
+
+    const LightBVH * pLightBVH = m_bLightBVH ? pScene->getLightBVH() : nullptr;
+    if (pLightBVH != nullptr)
+    {
+        if (pLightBVH->sample(record, n, sampleLight, sample2D, sample1D).isZero())
+        {
+            return 0.0f;
+        }
+    }
+    else
+    {
+        /* The candidates are drawn from a uniformly selected emitter */
+        const std::vector<Emitter *> & emitters = pScene->getEmitters();
+        if (emitters.empty())
+        {
+            return 0.0f;
+        }
+
+        const Emitter * pEmitter = emitters[std::min(size_t(sampleLight * emitters.size()), emitters.size() - 1)];
+        if (pEmitter->getEmitterType() == EEmitterType::EEnvironment || pEmitter->getEmitterType() == EEmitterType::EDirectional)
+        {
+            record.distance = pScene->getBoundingBox().getRadius();
+        }
+
+        if (pEmitter->sample(record, sample2D, sample1D).isZero())
+        {
+            return 0.0f;
+        }
+        record.pdf /= float(emitters.size());
+    }
+
+    sample.pEmitter = record.pEmitter;
+    sample.primitive = record.primitive;
+    sample.p = record.p;
+    sample.n = record.n;
+    sample.wi = record.wi;
+    sample.bInfinite = record.pEmitter->getEmitterType() == EEmitterType::EEnvironment ||
+                       record.pEmitter->getEmitterType() == EEmitterType::EDirectional;
+
+    if (sample.bInfinite)
+    {
+        return record.pdf;
+    }
+
+    /* Convert the density from solid angle to area, which is shared by all shading points */
+    float cosLight = std::abs(record.n.dot(record.wi));
+    if (cosLight == 0.0f || record.distance == 0.0f)
+    {
+        return 0.0f;
+    }
+    return record.pdf * cosLight / (record.distance * record.distance);
+}
+
+Color3f RestirIntegrator::evalContribution(const Intersection & its, const Vector3f & woLocal, Sampler * pSampler,
+                                           const Scene * pScene, const LightSample & sample, EmitterQueryRecord & record) const
+{
+    float geometry = 1.0f;
+    if (sample.bInfinite)
+    {
+        float radius = pScene->getBoundingBox().getRadius();
+        record = EmitterQueryRecord(its.p);
+        record.pEmitter = sample.pEmitter;
+        record.wi = sample.wi;
+        record.distance = radius;
+        record.p = its.p + sample.wi * radius;
+    }
+    else
+    {
+        record = EmitterQueryRecord(sample.pEmitter, its.p, sample.p, sample.n);
+        record.primitive = sample.primitive;
+        if (record.distance == 0.0f)
+        {
+            return Color3f(0.0f);
+        }
+        geometry = std::abs(sample.n.dot(record.wi)) / (record.distance * record.distance);
+    }
+
+    Color3f le = sample.pEmitter->eval(record);
+    if (le.isZero())
+    {
+        return Color3f(0.0f);
+    }
+
+    BSDFQueryRecord bsdfQueryRecord(woLocal, its.toLocal(record.wi), EMeasure::ESolidAngle, ETransportMode::ERadiance, pSampler, its);
+    return its.pBSDF->eval(bsdfQueryRecord) * std::abs(Frame::cosTheta(bsdfQueryRecord.wo)) * le * geometry;
+}
+
+void RestirIntegrator::combine(Reservoir & target, const Reservoir & source, const Intersection & its, const Vector3f & woLocal,
+                               Sampler * pSampler, const Scene * pScene) const
+{
+    /* The history is clamped so that old samples cannot dominate the reservoir */
+    float M = std::min(source.M, m_historyLimit * float(m_candidates));
+    float targetPdf = 0.0f;
+    if (source.W > 0.0f)
+    {
+        EmitterQueryRecord record;
+        targetPdf = evalContribution(its, woLocal, pSampler, pScene, source.y, record).getLuminance();
+    }
+
+    if (target.update(source.y, targetPdf * source.W * M, M, pSampler->next1D()))
+    {
+        target.targetPdf = targetPdf;
+    }
+}
+
+Color3f RestirIntegrator::estimateDirect(const Scene * pScene, Sampler * pSampler, const Intersection & its,
+                                         const Vector3f & woLocal, bool bReuse) const
+{
+    /* Reservoirs of the block rendered by the current thread */
+    thread_local std::vector<Reservoir> reservoirs(NORI_BLOCK_SIZE * NORI_BLOCK_SIZE);
+    thread_local Point2i currentBlock(-1, -1);
+    thread_local uint64_t currentGeneration = 0;
+
+    Reservoir reservoir;
+    reservoir.n = its.shFrame.n;
+    reservoir.t = its.t;
+    reservoir.bValid = true;
+
+    /* Stream the candidates through the reservoir, weighted by their unshadowed contribution */
+    for (uint32_t i = 0; i < m_candidates; i++)
+    {
+        LightSample sample;
+        float pdf = sampleCandidate(pScene, pSampler, its.p, its.shFrame.n, sample);
+        float targetPdf = 0.0f;
+        if (pdf > 0.0f)
+        {
+            EmitterQueryRecord record;
+            targetPdf = evalContribution(its, woLocal, pSampler, pScene, sample, record).getLuminance();
+        }
+
+        if (reservoir.update(sample, pdf > 0.0f ? targetPdf / pdf : 0.0f, 1.0f, pSampler->next1D()))
+        {
+            reservoir.targetPdf = targetPdf;
+        }
+    }
+    reservoir.W = reservoir.targetPdf > 0.0f ? reservoir.wSum / (reservoir.M * reservoir.targetPdf) : 0.0f;
+
+    Reservoir * pStored = nullptr;
+    if (bReuse)
+    {
+        Point2i pixel = pSampler->getPixel();
+        Point2i block(pixel.x() / NORI_BLOCK_SIZE, pixel.y() / NORI_BLOCK_SIZE);
+        if (block != currentBlock || currentGeneration != m_generation)
+        {
+            for (Reservoir & stored : reservoirs)
+            {
+                stored.bValid = false;
+            }
+            currentBlock = block;
+            currentGeneration = m_generation;
+        }
+
+        Point2i local(pixel.x() - block.x() * NORI_BLOCK_SIZE, pixel.y() - block.y() * NORI_BLOCK_SIZE);
+        pStored = &reservoirs[local.y() * NORI_BLOCK_SIZE + local.x()];
+
+        /* Reservoirs are only reused between similar surfaces */
+        auto isSimilar = [&](const Reservoir & other) {
+            return other.bValid && other.n.dot(its.shFrame.n) > 0.9f && std::abs(other.t - its.t) < 0.1f * its.t;
+        };
+
+        Reservoir combined;
+        combined.n = reservoir.n;
+        combined.t = reservoir.t;
+        combined.bValid = true;
+        combined.update(reservoir.y, reservoir.wSum, reservoir.M, 0.0f);
+        combined.targetPdf = reservoir.targetPdf;
+
+        /* Temporal reuse: the previous sample of this pixel */
+        if (m_bTemporalReuse && pSampler->getSampleIndex() > pSampler->getFirstSample() && isSimilar(*pStored))
+        {
+            combine(combined, *pStored, its, woLocal, pSampler, pScene);
+        }
+
+        /* Spatial reuse: pixels of the block that were shaded before */
+        if (m_bSpatialReuse)
+        {
+            for (uint32_t i = 0; i < m_spatialNeighbors; i++)
+            {
+                Point2f offset = pSampler->next2D();
+                int x = local.x() + int(std::floor((offset.x() * 2.0f - 1.0f) * m_spatialRadius + 0.5f));
+                int y = local.y() + int(std::floor((offset.y() * 2.0f - 1.0f) * m_spatialRadius + 0.5f));
+                if (x < 0 || y < 0 || x >= NORI_BLOCK_SIZE || y >= NORI_BLOCK_SIZE || (x == local.x() && y == local.y()))
+                {
+                    continue;
+                }
+
+                const Reservoir & neighbor = reservoirs[y * NORI_BLOCK_SIZE + x];
+                if (isSimilar(neighbor))
+                {
+                    combine(combined, neighbor, its, woLocal, pSampler, pScene);
+                }
+            }
+        }
+
+        combined.W = combined.targetPdf > 0.0f ? combined.wSum / (combined.M * combined.targetPdf) : 0.0f;
+        reservoir = combined;
+    }
+
+    /* Trace a single shadow ray towards the selected sample */
+    Color3f result(0.0f);
+    if (reservoir.W > 0.0f)
+    {
+        EmitterQueryRecord record;
+        Color3f contribution = evalContribution(its, woLocal, pSampler, pScene, reservoir.y, record);
+        if (!pScene->rayIntersect(its.generateShadowRay(record.p)))
+        {
+            result = contribution * reservoir.W;
+        }
+        else
+        {
+            reservoir.W = 0.0f;
+        }
+    }
+
+    if (pStored != nullptr)
+    {
+        *pStored = reservoir;
+    }
+
+    return result;
+}
+
+Color3f RestirIntegrator::li(const Scene * pScene, Sampler * pSampler, const Ray3f & ray) const
+{
+    const Emitter * pEnvironmentEmitter = pScene->getEnvironmentEmitter();
+    bool bReuse = m_bTemporalReuse || m_bSpatialReuse;
+
+    Intersection its;
+    Ray3f tracingRay(ray);
+    Color3f li(0.0f);
+    Color3f beta(1.0f);
+
+    for (uint32_t depth = 0; depth < m_depth; depth++)
+    {
+        if (!pScene->rayIntersect(tracingRay, its))
+        {
+            if (pEnvironmentEmitter != nullptr && !(depth == 0 && pScene->getForceBackground()))
+            {
+                EmitterQueryRecord emitterQueryRecord;
+                emitterQueryRecord.ref = tracingRay.o;
+                emitterQueryRecord.wi = tracingRay.d;
+                li += beta * pEnvironmentEmitter->eval(emitterQueryRecord);
+            }
+            else if (depth == 0)
+            {
+                return pScene->getBackground();
+            }
+            break;
+        }
+
+        /* Every vertex is either seen from the camera or through specular surfaces */
+        if (its.pShape->isEmitter())
+        {
+            EmitterQueryRecord emitterQueryRecord(its.pEmitter, tracingRay.o, its.p, its.shFrame.n);
+            li += beta * its.pEmitter->eval(emitterQueryRecord);
+        }
+
+        const BSDF * pBSDF = its.pBSDF;
+        Vector3f woLocal = its.toLocal(-1.0f * tracingRay.d);
+        if (pBSDF->isDiffuse())
+        {
+            li += beta * estimateDirect(pScene, pSampler, its, woLocal, bReuse && depth == 0);
+            break;
+        }
+
+        BSDFQueryRecord bsdfQueryRecord(woLocal, ETransportMode::ERadiance, pSampler, its);
+        beta *= pBSDF->sample(bsdfQueryRecord, pSampler->next2D());
+        if (beta.isZero())
+        {
+            break;
+        }
+        tracingRay = Ray3f(its.p, its.toWorld(bsdfQueryRecord.wo));
+    }
+
+    return li;
+}
+
+std::string RestirIntegrator::toString() const
+{
+    return tfm::format(
+            "RestirIntegrator[\n"
+            "  depth = %u,\n"
+            "  candidates = %u,\n"
+            "  emitterSampling = %s,\n"
+            "  temporalReuse = %s,\n"
+            "  spatialReuse = %s,\n"
+            "  spatialNeighbors = %u,\n"
+            "  spatialRadius = %i,\n"
+            "  historyLimit = %f\n"
+            "]",
+            m_depth,
+            m_candidates,
+            m_bLightBVH ? XML_INTEGRATOR_EMITTER_SAMPLING_LIGHT_BVH : XML_INTEGRATOR_EMITTER_SAMPLING_ALL,
+            m_bTemporalReuse ? "true" : "false",
+            m_bSpatialReuse ? "true" : "false",
+            m_spatialNeighbors,
+            m_spatialRadius,
+            m_historyLimit
+    );
+}
+
+NORI_REGISTER_CLASS(RestirIntegrator, XML_INTEGRATOR_RESTIR);
+NORI_NAMESPACE_END
@@ -0,0 +1,447 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#include <nori/integrator/sppmIntegration.h>
+#include <nori/core/scene.h>
+#include <nori/core/camera.h>
+#include <nori/core/sampler.h>
+#include <nori/core/emitterQueryRecord.h>
+#include <nori/core/emitter.h>
+#include <nori/core/bsdfQueryRecord.h>
+#include <nori/core/primitiveShape.h>
+#include <nori/core/bsdf.h>
+#include <nori/core/block.h>
+#include <nori/core/timer.h>
+#include <tbb/tbb.h>
+#include <pcg32.h>
+
+NORI_NAMESPACE_BEGIN
+
+namespace
+{
+    /// Entry of the visible point grid, linked into the list of its hash bucket
+    struct GridNode
+    {
+        int pixel;
+        int next;
+    };
+
+    inline uint32_t hashCell(const Point3i & p, uint32_t hashSize)
+    {
+        return (uint32_t(p.x() * 73856093) ^ uint32_t(p.y() * 19349663) ^ uint32_t(p.z() * 83492791)) % hashSize;
+    }
+
+    inline void atomicAdd(std::atomic<float> & target, float value)
+    {
+        float current = target.load(std::memory_order_relaxed);
+        while (!target.compare_exchange_weak(current, current + value, std::memory_order_relaxed))
+        {
+        }
+    }
+}
+
+SPPMIntegrator::SPPMIntegrator(const PropertyList & propList)
+{
+    m_depth = uint32_t(propList.getInteger(XML_INTEGRATOR_SPPM_DEPTH, DEFAULT_PATH_TRACING_DEPTH));
+    m_iterations = uint32_t(propList.getInteger(XML_INTEGRATOR_SPPM_ITERATIONS, DEFAULT_INTEGRATOR_SPPM_ITERATIONS));
+    m_photonCount = uint32_t(propList.getInteger(XML_INTEGRATOR_SPPM_PHOTON_COUNT, DEFAULT_INTEGRATOR_SPPM_PHOTON_COUNT));
+    m_initialRadius = propList.getFloat(XML_INTEGRATOR_SPPM_INITIAL_RADIUS, DEFAULT_INTEGRATOR_SPPM_INITIAL_RADIUS);
+    m_alpha = propList.getFloat(XML_INTEGRATOR_SPPM_ALPHA, DEFAULT_INTEGRATOR_SPPM_ALPHA);
+
+    if (m_alpha <= 0.0f || m_alpha >= 1.0f)
+    {
+        throw NoriException("SPPMIntegrator: alpha must be in (0, 1)!");
+    }
+}
+
+Color3f SPPMIntegrator::li(const Scene * pScene, Sampler * pSampler, const Ray3f & ray) const
+{
+    throw NoriException("SPPMIntegrator::li(): photon mapping renders the entire image with render()!");
+}
+
+Color3f SPPMIntegrator::estimateDirect(const Scene * pScene, Sampler * pSampler, const Intersection & its, const Vector3f & wi) const
+{
+    const std::vector<Emitter *> & emitters = pScene->getEmitters();
+    if (emitters.empty())
+    {
+        return Color3f(0.0f);
+    }
+
+    /* One sample of a uniformly selected emitter */
+    float sampleLight = pSampler->next1D();
+    const Emitter * pEmitter = emitters[std::min(size_t(sampleLight * emitters.size()), emitters.size() - 1)];
+
+    EmitterQueryRecord emitterQueryRecord(its.p);
+    if (pEmitter->getEmitterType() == EEmitterType::EEnvironment || pEmitter->getEmitterType() == EEmitterType::EDirectional)
+    {
+        emitterQueryRecord.distance = pScene->getBoundingBox().getRadius();
+    }
+
+    Point2f sample2D = pSampler->next2D();
+    Color3f ldirect = pEmitter->sample(emitterQueryRecord, sample2D, pSampler->next1D());
+    if (ldirect.isZero() || pScene->rayIntersect(its.generateShadowRay(emitterQueryRecord.p)))
+    {
+        return Color3f(0.0f);
+    }
+
+    BSDFQueryRecord bsdfQueryRecord(its.toLocal(wi), its.toLocal(emitterQueryRecord.wi), EMeasure::ESolidAngle, ETransportMode::ERadiance, pSampler, its);
+    return its.pBSDF->eval(bsdfQueryRecord) * std::abs(Frame::cosTheta(bsdfQueryRecord.wo)) * ldirect * float(emitters.size());
+}
+
+void SPPMIntegrator::traceCameraPath(const Scene * pScene, Sampler * pSampler, const Point2i & pixel, SPPMPixel & sppmPixel) const
+{
+    const Camera * pCamera = pScene->getCamera();
+    const Emitter * pEnvironmentEmitter = pScene->getEnvironmentEmitter();
+    VisiblePoint & visiblePoint = sppmPixel.visiblePoint;
+    visiblePoint.bValid = false;
+
+    Point2f pixelSample = Point2f(float(pixel.x()), float(pixel.y())) + pSampler->next2D();
+    Point2f apertureSample = pSampler->next2D();
+    Ray3f ray;
+    Color3f beta = pCamera->sampleRay(ray, pixelSample, apertureSample);
+
+    for (uint32_t depth = 0; depth < m_depth; depth++)
+    {
+        Intersection its;
+        if (!pScene->rayIntersect(ray, its))
+        {
+            if (pEnvironmentEmitter != nullptr && !(depth == 0 && pScene->getForceBackground()))
+            {
+                EmitterQueryRecord emitterQueryRecord;
+                emitterQueryRecord.ref = ray.o;
+                emitterQueryRecord.wi = ray.d;
+                sppmPixel.ld += beta * pEnvironmentEmitter->eval(emitterQueryRecord);
+            }
+            else if (depth == 0)
+            {
+                sppmPixel.ld += beta * pScene->getBackground();
+            }
+            return;
+        }
+
+        /* The vertices before the visible point are seen from the camera or through specular surfaces */
+        if (its.pShape->isEmitter())
+        {
+            EmitterQueryRecord emitterQueryRecord(its.pEmitter, ray.o, its.p, its.shFrame.n);
+            sppmPixel.ld += beta * its.pEmitter->eval(emitterQueryRecord);
+        }
+
+        const BSDF * pBSDF = its.pBSDF;
+        if (pBSDF->isDiffuse())
+        {
+            sppmPixel.ld += beta * estimateDirect(pScene, pSampler, its, -ray.d);
+
+            visiblePoint.its = its;
+            visiblePoint.wi = -ray.d;
+            visiblePoint.beta = beta;
+            visiblePoint.bValid = true;
+            return;
+        }
+
+        BSDFQueryRecord bsdfQueryRecord(its.toLocal(-ray.d), ETransportMode::ERadiance, pSampler, its);
+        beta *= pBSDF->sample(bsdfQueryRecord, pSampler->next2D());
+        if (beta.isZero())
+        {
+            return;
+        }
+        ray = Ray3f(its.p, its.toWorld(bsdfQueryRecord.wo));
+    }
+}
+
+bool SPPMIntegrator::render(const Scene * pScene, ImageBlock & result) const
+{
+    const Camera * pCamera = pScene->getCamera();
+    const std::vector<Emitter *> & emitters = pScene->getEmitters();
+    if (emitters.empty())
+    {
+        throw NoriException("SPPMIntegrator: the scene does not contain any emitter!");
+    }
+
+    Vector2i outputSize = pCamera->getOutputSize();
+    int pixelCount = outputSize.x() * outputSize.y();
+    BoundingBox3f sceneBounds = pScene->getBoundingBox();
+    float initialRadius = m_initialRadius > 0.0f ? m_initialRadius : sceneBounds.getRadius() * 0.01f;
+
+    std::unique_ptr<SPPMPixel[]> pixels(new SPPMPixel[pixelCount]);
+    for (int i = 0; i < pixelCount; i++)
+    {
+        pixels[i].radius = initialRadius;
+        pixels[i].M.store(0);
+        for (int c = 0; c < 3; c++)
+        {
+            pixels[i].phi[c].store(0.0f);
+        }
+    }
+
+    /* The camera paths use independent samples, since every iteration only takes one sample per pixel */
+    std::unique_ptr<Sampler> pSampler(static_cast<Sampler *>(NoriObjectFactory::createInstance("independent", PropertyList())));
+
+    uint32_t hashSize = uint32_t(pixelCount);
+    std::unique_ptr<std::atomic<int>[]> gridHeads(new std::atomic<int>[hashSize]);
+    std::vector<GridNode> gridNodes;
+    std::vector<uint32_t> gridOffsets(pixelCount + 1);
+
+    for (uint32_t iteration = 0; iteration < m_iterations; iteration++)
+    {
+        Timer timer;
+
+        /* 1. Trace the camera paths */
+        BlockGenerator blockGenerator(outputSize, NORI_BLOCK_SIZE);
+        tbb::parallel_for(tbb::blocked_range<int>(0, blockGenerator.getBlockCount()),
+            [&](const tbb::blocked_range<int> & range) {
+                ImageBlock block(Vector2i(NORI_BLOCK_SIZE), pCamera->getReconstructionFilter());
+                std::unique_ptr<Sampler> pLocalSampler(pSampler->clone());
+                pLocalSampler->setSeed(iteration);
+
+                for (int i = range.begin(); i < range.end(); i++)
+                {
+                    blockGenerator.next(block);
+                    pLocalSampler->prepare(block);
+
+                    Point2i offset = block.getOffset();
+                    Vector2i size = block.getSize();
+                    for (int y = offset.y(); y < offset.y() + size.y(); y++)
+                    {
+                        for (int x = offset.x(); x < offset.x() + size.x(); x++)
+                        {
+                            pLocalSampler->generate(Point2i(x, y));
+                            traceCameraPath(pScene, pLocalSampler.get(), Point2i(x, y), pixels[y * outputSize.x() + x]);
+                        }
+                    }
+                }
+            });
+
+        /* 2. Insert the visible points into the hash grid, every point overlaps the cells within its radius */
+        BoundingBox3f gridBounds;
+        float maxRadius = 0.0f;
+        for (int i = 0; i < pixelCount; i++)
+        {
+            const SPPMPixel & pixel = pixels[i];
+            if (pixel.visiblePoint.bValid && !pixel.visiblePoint.beta.isZero())
+            {
+                gridBounds.expandBy(pixel.visiblePoint.its.p - Vector3f(pixel.radius));
+                gridBounds.expandBy(pixel.visiblePoint.its.p + Vector3f(pixel.radius));
+                maxRadius = std::max(maxRadius, pixel.radius);
+            }
+        }
+
+        Vector3f gridExtents = gridBounds.isValid() ? Vector3f(gridBounds.getExtents()) : Vector3f(0.0f);
+        float maxExtent = gridExtents.maxCoeff();
+        Vector3i gridResolution;
+        for (int i = 0; i < 3; i++)
+        {
+            gridResolution[i] = maxRadius > 0.0f ? std::max(int(maxExtent / maxRadius * gridExtents[i] / maxExtent), 1) : 1;
+        }
+
+        auto toGrid = [&](const Point3f & p, Point3i & cell) {
+            bool bInside = gridBounds.contains(p);
+            for (int i = 0; i < 3; i++)
+            {
+                float offset = gridExtents[i] > 0.0f ? (p[i] - gridBounds.min[i]) / gridExtents[i] : 0.0f;
+                cell[i] = clamp(int(offset * gridResolution[i]), 0, gridResolution[i] - 1);
+            }
+            return bInside;
+        };
+
+        tbb::parallel_for(tbb::blocked_range<int>(0, pixelCount), [&](const tbb::blocked_range<int> & range) {
+            for (int i = range.begin(); i < range.end(); i++)
+            {
+                const SPPMPixel & pixel = pixels[i];
+                gridOffsets[i + 1] = 0;
+                if (pixel.visiblePoint.bValid && !pixel.visiblePoint.beta.isZero())
+                {
+                    Point3i cellMin, cellMax;
+                    toGrid(pixel.visiblePoint.its.p - Vector3f(pixel.radius), cellMin);
+                    toGrid(pixel.visiblePoint.its.p + Vector3f(pixel.radius), cellMax);
+                    gridOffsets[i + 1] = uint32_t((cellMax - cellMin + Vector3i(1)).prod());
+                }
+            }
+        });
+
+        gridOffsets[0] = 0;
+        for (int i = 0; i < pixelCount; i++)
+        {
+            gridOffsets[i + 1] += gridOffsets[i];
+        }
+        gridNodes.resize(gridOffsets[pixelCount]);
+        for (uint32_t i = 0; i < hashSize; i++)
+        {
+            gridHeads[i].store(-1, std::memory_order_relaxed);
+        }
+
+        tbb::parallel_for(tbb::blocked_range<int>(0, pixelCount), [&](const tbb::blocked_range<int> & range) {
+            for (int i = range.begin(); i < range.end(); i++)
+            {
+                if (gridOffsets[i + 1] == gridOffsets[i])
+                {
+                    continue;
+                }
+
+                const SPPMPixel & pixel = pixels[i];
+                Point3i cellMin, cellMax;
+                toGrid(pixel.visiblePoint.its.p - Vector3f(pixel.radius), cellMin);
+                toGrid(pixel.visiblePoint.its.p + Vector3f(pixel.radius), cellMax);
+
+                int nodeIndex = int(gridOffsets[i]);
+                for (int z = cellMin.z(); z <= cellMax.z(); z++)
+                {
+                    for (int y = cellMin.y(); y <= cellMax.y(); y++)
+                    {
+                        for (int x = cellMin.x(); x <= cellMax.x(); x++, nodeIndex++)
+                        {
+                            /* Lock-free push to the front of the bucket list */
+                            std::atomic<int> & head = gridHeads[hashCell(Point3i(x, y, z), hashSize)];
+                            gridNodes[nodeIndex].pixel = i;
+                            int next = head.load(std::memory_order_relaxed);
+                            do
+                            {
+                                gridNodes[nodeIndex].next = next;
+                            } while (!head.compare_exchange_weak(next, nodeIndex, std::memory_order_release, std::memory_order_relaxed));
+                        }
+                    }
+                }
+            }
+        });
+
+        /* 3. Trace the photons and splat their flux onto the visible points */
+        tbb::parallel_for(tbb::blocked_range<uint32_t>(0, m_photonCount, 4096), [&](const tbb::blocked_range<uint32_t> & range) {
+            pcg32 random;
+            random.seed(uint64_t(range.begin()), uint64_t(iteration));
+
+            for (uint32_t i = range.begin(); i < range.end(); i++)
+            {
+                float sampleLight = random.nextFloat();
+                const Emitter * pEmitter = emitters[std::min(size_t(sampleLight * emitters.size()), emitters.size() - 1)];
+
+                Ray3f ray;
+                Normal3f n;
+                Point2f positionSample(random.nextFloat(), random.nextFloat());
+                Point2f directionSample(random.nextFloat(), random.nextFloat());
+                Color3f beta = pEmitter->sampleRay(ray, n, positionSample, directionSample, random.nextFloat(), sceneBounds) *
+                               float(emitters.size());
+                if (beta.isZero())
+                {
+                    continue;
+                }
+
+                for (uint32_t depth = 0; depth < m_depth; depth++)
+                {
+                    Intersection its;
+                    if (!pScene->rayIntersect(ray, its))
+                    {
+                        break;
+                    }
+
+                    /* Direct illumination is estimated at the visible points */
+                    Point3i cell;
+                    if (depth > 0 && its.pBSDF->isDiffuse() && toGrid(its.p, cell))
+                    {
+                        std::atomic<int> & head = gridHeads[hashCell(cell, hashSize)];
+                        for (int node = head.load(std::memory_order_acquire); node != -1; node = gridNodes[node].next)
+                        {
+                            SPPMPixel & pixel = pixels[gridNodes[node].pixel];
+                            const VisiblePoint & visiblePoint = pixel.visiblePoint;
+                            if ((visiblePoint.its.p - its.p).squaredNorm() > pixel.radius * pixel.radius)
+                            {
+                                continue;
+                            }
+
+                            BSDFQueryRecord bsdfQueryRecord(visiblePoint.its.toLocal(visiblePoint.wi), visiblePoint.its.toLocal(-ray.d),
+                                                            EMeasure::ESolidAngle, ETransportMode::ERadiance, nullptr, visiblePoint.its);
+                            Color3f phi = beta * visiblePoint.its.pBSDF->eval(bsdfQueryRecord);
+                            for (int c = 0; c < 3; c++)
+                            {
+                                atomicAdd(pixel.phi[c], phi[c]);
+                            }
+                            pixel.M++;
+                        }
+                    }
+
+                    /* Photon paths draw their random numbers from a dedicated generator */
+                    BSDFQueryRecord bsdfQueryRecord(its.toLocal(-ray.d), ETransportMode::EImportance, nullptr, its);
+                    Point2f sample(random.nextFloat(), random.nextFloat());
+                    Color3f betaNext = beta * its.pBSDF->sample(bsdfQueryRecord, sample);
+                    if (betaNext.isZero())
+                    {
+                        break;
+                    }
+
+                    /* Russian roulette on the change of the throughput */
+                    float q = std::max(0.0f, 1.0f - betaNext.getLuminance() / beta.getLuminance());
+                    if (random.nextFloat() < q)
+                    {
+                        break;
+                    }
+                    beta = betaNext / (1.0f - q);
+                    ray = Ray3f(its.p, its.toWorld(bsdfQueryRecord.wo));
+                }
+            }
+        });
+
+        /* 4. Shrink the radii and accumulate the flux */
+        tbb::parallel_for(tbb::blocked_range<int>(0, pixelCount), [&](const tbb::blocked_range<int> & range) {
+            for (int i = range.begin(); i < range.end(); i++)
+            {
+                SPPMPixel & pixel = pixels[i];
+                int M = pixel.M.load();
+                if (M > 0)
+                {
+                    float N = pixel.N + m_alpha * float(M);
+                    float radius = pixel.radius * std::sqrt(N / (pixel.N + float(M)));
+                    Color3f phi(pixel.phi[0].load(), pixel.phi[1].load(), pixel.phi[2].load());
+                    pixel.tau = (pixel.tau + pixel.visiblePoint.beta * phi) * (radius * radius) / (pixel.radius * pixel.radius);
+                    pixel.N = N;
+                    pixel.radius = radius;
+                    pixel.M.store(0);
+                    for (int c = 0; c < 3; c++)
+                    {
+                        pixel.phi[c].store(0.0f);
+                    }
+                }
+            }
+        });
+
+        /* 5. Write the current estimate into the result */
+        float photonTotal = float(iteration + 1) * float(m_photonCount);
+        int border = result.getBorderSize();
+        result.lock();
+        for (int y = 0; y < outputSize.y(); y++)
+        {
+            for (int x = 0; x < outputSize.x(); x++)
+            {
+                const SPPMPixel & pixel = pixels[y * outputSize.x() + x];
+                Color3f value = pixel.ld / float(iteration + 1) +
+                                pixel.tau / (photonTotal * float(M_PI) * pixel.radius * pixel.radius);
+                result.coeffRef(y + border, x + border) = Color4f(value);
+            }
+        }
+        result.unlock();
+
+        LOG(INFO) << "SPPM iteration " << iteration + 1 << "/" << m_iterations << " (" << gridNodes.size()
+                  << " grid entries) took " << timer.elapsedString() << ".";
+    }
+
+    return true;
+}
+
+std::string SPPMIntegrator::toString() const
+{
+    return tfm::format(
+            "SPPMIntegrator[\n"
+            "  depth = %u,\n"
+            "  iterations = %u,\n"
+            "  photonCount = %u,\n"
+            "  initialRadius = %f,\n"
+            "  alpha = %f\n"
+            "]",
+            m_depth,
+            m_iterations,
+            m_photonCount,
+            m_initialRadius,
+            m_alpha
+    );
+}
+
+NORI_REGISTER_CLASS(SPPMIntegrator, XML_INTEGRATOR_SPPM);
+NORI_NAMESPACE_END
@@ -11,12 +11,27 @@
 #include <nori/core/emitter.h>
 #include <nori/core/primitiveShape.h>
 #include <nori/core/bsdfQueryRecord.h>
+#include <nori/core/lightBVH.h>
 
 NORI_NAMESPACE_BEGIN
 
 WhittedIntegrator::WhittedIntegrator(const PropertyList & propList)
 {
     m_depth = uint32_t(propList.getInteger(XML_INTEGRATOR_WHITTED_DEPTH, DEFAULT_INTEGRATOR_WHITTED_DEPTH));
+
+    std::string emitterSampling = propList.getString(XML_INTEGRATOR_EMITTER_SAMPLING, DEFAULT_INTEGRATOR_EMITTER_SAMPLING);
+    if (emitterSampling == XML_INTEGRATOR_EMITTER_SAMPLING_ALL)
+    {
+        m_bLightBVH = false;
+    }
+    else if (emitterSampling == XML_INTEGRATOR_EMITTER_SAMPLING_LIGHT_BVH)
+    {
+        m_bLightBVH = true;
+    }
+    else
+    {
+        throw NoriException("WhittedIntegrator: unknown emitter sampling strategy \"%s\"!", emitterSampling);
+    }
 }
 
 Color3f WhittedIntegrator::li(const Scene * pScene, Sampler * pSampler, const Ray3f & ray) const
@@ -26,7 +41,8 @@ Color3f WhittedIntegrator::li(const Scene * pScene, Sampler * pSampler, const Ra
 
 std::string WhittedIntegrator::toString() const
 {
-    return tfm::format("WhittedIntegrator[depth = %d]", m_depth);
+    return tfm::format("WhittedIntegrator[depth = %d, emitterSampling = %s]", m_depth,
+                       m_bLightBVH ? XML_INTEGRATOR_EMITTER_SAMPLING_LIGHT_BVH : XML_INTEGRATOR_EMITTER_SAMPLING_ALL);
 }
 
 Color3f WhittedIntegrator::liRecursive(const Scene * pScene, Sampler * pSampler, const Ray3f & ray, uint32_t depth) const
@@ -73,28 +89,55 @@ Color3f WhittedIntegrator::liRecursive(const Scene * pScene, Sampler * pSampler,
 
     Color3f lr(0.0f);
     const BSDF * pBSDF = its.pBSDF;
+    const LightBVH * pLightBVH = m_bLightBVH ? pScene->getLightBVH() : nullptr;
     // Diffuse material
     if (pBSDF->isDiffuse())
     {
-        for (Emitter * pEmitter : pScene->getEmitters())
+        if (its.pEmitter != nullptr)
+        {
+            BSDFQueryRecord bsdfQueryRecord(its.toLocal(-1.0f * ray.d),
+                                            its.toLocal(its.shFrame.n),
+                                            EMeasure::ESolidAngle
+                                            , ETransportMode::ERadiance,
+                                            pSampler,
+                                            its);
+            float pdf = pBSDF->pdf(bsdfQueryRecord);
+            if (pdf > Epsilon)
+            {
+                lr += pBSDF->eval(bsdfQueryRecord) / pdf * std::abs(Frame::cosTheta(bsdfQueryRecord.wo)) * le;
+            }
+        }
+
+        // One light selected by the light BVH
+        if (pLightBVH != nullptr)
         {
-            if (pEmitter == its.pEmitter)
+            EmitterQueryRecord emitterQueryRecord;
+            emitterQueryRecord.ref = its.p;
+
+            float sampleLight = pSampler->next1D();
+            Point2f sample2D = pSampler->next2D();
+            Color3f li = pLightBVH->sample(emitterQueryRecord, its.shFrame.n, sampleLight, sample2D, pSampler->next1D());
+
+            // The emitter of the shading point is accounted for above
+            if (!li.isZero() && emitterQueryRecord.pEmitter != its.pEmitter)
             {
-                BSDFQueryRecord bsdfQueryRecord(its.toLocal(-1.0f * ray.d),
-                                                its.toLocal(its.shFrame.n),
-                                                EMeasure::ESolidAngle
-                                                , ETransportMode::ERadiance,
-                                                pSampler,
-                                                its);
-                float pdf = pBSDF->pdf(bsdfQueryRecord);
-                if (pdf > Epsilon)
+                Ray3f shadowRay = its.generateShadowRay(emitterQueryRecord.p);
+                if (!pScene->rayIntersect(shadowRay))
                 {
-                    lr += pBSDF->eval(bsdfQueryRecord) / pdf * std::abs(Frame::cosTheta(bsdfQueryRecord.wo)) * le;
+                    BSDFQueryRecord bsdfQueryRecord(its.toLocal(-1.0f * ray.d), its.toLocal(emitterQueryRecord.wi), EMeasure::ESolidAngle, ETransportMode::ERadiance, pSampler, its);
+                    lr += pBSDF->eval(bsdfQueryRecord) * std::abs(Frame::cosTheta(bsdfQueryRecord.wo)) * li;
                 }
-                continue;
             }
-            else
+        }
+        else
+        {
+            for (Emitter * pEmitter : pScene->getEmitters())
             {
+                if (pEmitter == its.pEmitter)
+                {
+                    continue;
+                }
+
                 EmitterQueryRecord emitterQueryRecord;
                 emitterQueryRecord.ref = its.p;
 
@@ -123,7 +166,9 @@ Color3f WhittedIntegrator::liRecursive(const Scene * pScene, Sampler * pSampler,
             constexpr float inv = 1.0f / 0.95f;
             BSDFQueryRecord bsdfQueryRecord(its.toLocal(-1.0f * ray.d), ETransportMode::ERadiance, pSampler, its);
             Color3f color = pBSDF->sample(bsdfQueryRecord, pSampler->next2D());
-            lr += color * liRecursive(pScene, pSampler, Ray3f(its.p, its.toWorld(bsdfQueryRecord.wo)), depth + 1) * inv;
+            Ray3f scatteredRay(its.p, its.toWorld(bsdfQueryRecord.wo));
+            pBSDF->propagateDifferentials(bsdfQueryRecord, ray, scatteredRay);
+            lr += color * liRecursive(pScene, pSampler, scatteredRay, depth + 1) * inv;
         }
     }
 
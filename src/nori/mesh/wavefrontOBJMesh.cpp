@@ -23,6 +23,9 @@ WavefrontOBJ::WavefrontOBJ(const PropertyList &propList)
         throw NoriException("Unable to open OBJ file \"%s\"!", filename);
     Transform trafo = propList.getTransform("toWorld", Transform());
 
+    /* Triangle selection of area lights: CDF inversion unless an alias table is requested */
+    m_bAliasTable = propList.getBoolean(XML_MESH_WAVEFRONG_OBJ_ALIAS_TABLE, DEFAULT_MESH_ALIAS_TABLE);
+
     LOG(INFO) << "Loading \"" << filename << "\" .. ";
     Timer timer;
     std::vector<Vector3f>   positions;
@@ -0,0 +1,92 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#include <nori/sampler/cmjSampler.h>
+#include <nori/core/lowDiscrepancy.h>
+
+NORI_NAMESPACE_BEGIN
+
+CMJSampler::CMJSampler(const PropertyList & propList)
+{
+    m_sampleCount = (size_t) propList.getInteger(XML_SAMPLER_CMJ_SAMPLE_COUNT, DEFAULT_SAMPLER_CMJ_SAMPLE_COUNT);
+    m_seed = (uint64_t) propList.getInteger(XML_SAMPLER_CMJ_SEED, DEFAULT_SAMPLER_CMJ_SEED);
+
+    if (m_sampleCount == 0)
+    {
+        throw NoriException("CMJSampler: the sample count must be positive!");
+    }
+
+    setSampleCount(m_sampleCount);
+}
+
+std::unique_ptr<Sampler> CMJSampler::clone() const
+{
+    std::unique_ptr<CMJSampler> cloned(new CMJSampler());
+    cloned->m_sampleCount = m_sampleCount;
+    cloned->m_seed = m_seed;
+    cloned->m_pixel = m_pixel;
+    cloned->m_sampleIndex = m_sampleIndex;
+    cloned->m_dimension = m_dimension;
+    cloned->m_firstSample = m_firstSample;
+    cloned->m_rangeSampleCount = m_rangeSampleCount;
+    cloned->m_bSampleRange = m_bSampleRange;
+    cloned->m_gridX = m_gridX;
+    cloned->m_gridY = m_gridY;
+    return std::move(cloned);
+}
+
+void CMJSampler::setSampleCount(size_t sampleCount)
+{
+    Sampler::setSampleCount(sampleCount);
+    m_gridX = std::max(uint32_t(std::sqrt(float(m_sampleCount))), 1u);
+    m_gridY = (uint32_t(m_sampleCount) + m_gridX - 1) / m_gridX;
+}
+
+void CMJSampler::prepare(const ImageBlock & block)
+{
+    /* No-op, the samples only depend on the pixel */
+}
+
+float CMJSampler::next1D()
+{
+    uint32_t pattern = uint32_t(LowDiscrepancy::hash(m_pixel, m_dimension, m_seed));
+    m_dimension++;
+
+    uint32_t sampleCount = uint32_t(m_sampleCount);
+    uint32_t index = m_sampleIndex % sampleCount;
+    uint32_t stratum = LowDiscrepancy::permutationElement(index, sampleCount, pattern * 0x68bc21ebu);
+    float jitter = LowDiscrepancy::randomFloat(index, pattern * 0x967a889bu);
+    return std::min((float(stratum) + jitter) / float(sampleCount), LowDiscrepancy::OneMinusEpsilon);
+}
+
+Point2f CMJSampler::next2D()
+{
+    uint32_t pattern = uint32_t(LowDiscrepancy::hash(m_pixel, m_dimension, m_seed));
+    m_dimension += 2;
+
+    /* Kensler's formulation for arbitrary N: the grid has m * n >= N cells, so y is
+       stratified over the N samples rather than over the rows, which keeps the
+       pattern uniform when the last row is only partially filled */
+    uint32_t sampleCount = uint32_t(m_sampleCount);
+    uint32_t s = LowDiscrepancy::permutationElement(m_sampleIndex % sampleCount, sampleCount, pattern * 0x51633e2du);
+    uint32_t sx = LowDiscrepancy::permutationElement(s % m_gridX, m_gridX, pattern * 0xa511e9b3u);
+    uint32_t sy = LowDiscrepancy::permutationElement(s / m_gridX, m_gridY, pattern * 0x63d83595u);
+    float jx = LowDiscrepancy::randomFloat(s, pattern * 0xa399d265u);
+    float jy = LowDiscrepancy::randomFloat(s, pattern * 0x711ad6a5u);
+
+    float x = (float(sx) + (float(sy) + jx) / float(m_gridY)) / float(m_gridX);
+    float y = (float(s) + jy) / float(sampleCount);
+    return Point2f(
+            std::min(x, LowDiscrepancy::OneMinusEpsilon),
+            std::min(y, LowDiscrepancy::OneMinusEpsilon)
+    );
+}
+
+std::string CMJSampler::toString() const
+{
+    return tfm::format("CMJ[sampleCount=%i, grid=%ix%i, seed=%i]", m_sampleCount, m_gridX, m_gridY, m_seed);
+}
+
+NORI_REGISTER_CLASS(CMJSampler, XML_SAMPLER_CMJ);
+NORI_NAMESPACE_END
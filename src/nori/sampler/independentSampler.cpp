@@ -6,12 +6,14 @@
 
 #include <nori/sampler/independentSampler.h>
 #include <nori/core/block.h>
+#include <nori/core/pcg32x8.h>
 
 NORI_NAMESPACE_BEGIN
 
 IndependentSampler::IndependentSampler(const PropertyList &propList)
 {
     m_sampleCount = (size_t) propList.getInteger("sampleCount", 1);
+    m_seed = (uint64_t) propList.getInteger(XML_SAMPLER_INDEPENDENT_SEED, DEFAULT_SAMPLER_INDEPENDENT_SEED);
 }
 
 IndependentSampler::~IndependentSampler()
@@ -23,37 +25,75 @@ std::unique_ptr<Sampler> IndependentSampler::clone() const
 {
     std::unique_ptr<IndependentSampler> cloned(new IndependentSampler());
     cloned->m_sampleCount = m_sampleCount;
+    cloned->m_seed = m_seed;
+    cloned->m_firstSample = m_firstSample;
+    cloned->m_rangeSampleCount = m_rangeSampleCount;
+    cloned->m_bSampleRange = m_bSampleRange;
     cloned->m_random = m_random;
     return std::move(cloned);
 }
 
 void IndependentSampler::prepare(const ImageBlock &block)
 {
+    /* The seed and the sample range select the stream, a seed of zero keeps the original sequences */
     m_random.seed(
-            block.getOffset().x(),
-            block.getOffset().y()
+            uint64_t(block.getOffset().x()) + (uint64_t(m_firstSample) << 32),
+            uint64_t(block.getOffset().y()) + (m_seed << 32)
     );
 }
 
-void IndependentSampler::generate() { /* No-op for this sampler */ }
-void IndependentSampler::advance()  { /* No-op for this sampler */ }
-
 float IndependentSampler::next1D()
 {
+    m_dimension++;
     return m_random.nextFloat();
 }
 
 Point2f IndependentSampler::next2D()
 {
-    return Point2f(
-            m_random.nextFloat(),
-            m_random.nextFloat()
-    );
+    m_dimension += 2;
+
+    /* The order of evaluation of function arguments is unspecified */
+    float x = m_random.nextFloat();
+    float y = m_random.nextFloat();
+    return Point2f(x, y);
+}
+
+void IndependentSampler::next1DArray(float * pValues, size_t count)
+{
+    m_dimension += uint32_t(count);
+    nextFloats(pValues, count);
+}
+
+void IndependentSampler::next2DArray(Point2f * pValues, size_t count)
+{
+    static_assert(sizeof(Point2f) == 2 * sizeof(float), "Point2f must be two packed floats");
+    m_dimension += uint32_t(2 * count);
+    nextFloats(reinterpret_cast<float *>(pValues), 2 * count);
+}
+
+void IndependentSampler::nextFloats(float * pValues, size_t count)
+{
+    /* The lanes continue the scalar stream, so the result equals repeated next1D() calls */
+    size_t i = 0;
+    if (count >= 8)
+    {
+        PCG32x8 random(m_random);
+        for (; i + 8 <= count; i += 8)
+        {
+            random.nextFloat(pValues + i);
+        }
+        m_random.state = random.getScalarState();
+    }
+
+    for (; i < count; i++)
+    {
+        pValues[i] = m_random.nextFloat();
+    }
 }
 
 std::string IndependentSampler::toString() const
 {
-    return tfm::format("Independent[sampleCount=%i]", m_sampleCount);
+    return tfm::format("Independent[sampleCount=%i, seed=%i]", m_sampleCount, m_seed);
 }
 
 IndependentSampler::IndependentSampler() { }
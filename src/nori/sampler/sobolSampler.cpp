@@ -0,0 +1,71 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#include <nori/sampler/sobolSampler.h>
+#include <nori/core/lowDiscrepancy.h>
+
+NORI_NAMESPACE_BEGIN
+
+SobolSampler::SobolSampler(const PropertyList & propList)
+{
+    m_sampleCount = (size_t) propList.getInteger(XML_SAMPLER_SOBOL_SAMPLE_COUNT, DEFAULT_SAMPLER_SOBOL_SAMPLE_COUNT);
+    m_seed = (uint64_t) propList.getInteger(XML_SAMPLER_SOBOL_SEED, DEFAULT_SAMPLER_SOBOL_SEED);
+
+    if (m_sampleCount == 0)
+    {
+        throw NoriException("SobolSampler: the sample count must be positive!");
+    }
+
+    if ((m_sampleCount & (m_sampleCount - 1)) != 0)
+    {
+        LOG(WARNING) << "SobolSampler: the sample count " << m_sampleCount
+                     << " is not a power of two, the samples are not fully stratified.";
+    }
+}
+
+std::unique_ptr<Sampler> SobolSampler::clone() const
+{
+    std::unique_ptr<SobolSampler> cloned(new SobolSampler());
+    cloned->m_sampleCount = m_sampleCount;
+    cloned->m_seed = m_seed;
+    cloned->m_pixel = m_pixel;
+    cloned->m_sampleIndex = m_sampleIndex;
+    cloned->m_dimension = m_dimension;
+    cloned->m_firstSample = m_firstSample;
+    cloned->m_rangeSampleCount = m_rangeSampleCount;
+    cloned->m_bSampleRange = m_bSampleRange;
+    return std::move(cloned);
+}
+
+void SobolSampler::prepare(const ImageBlock & block)
+{
+    /* No-op, the samples only depend on the pixel */
+}
+
+float SobolSampler::next1D()
+{
+    uint64_t hash = LowDiscrepancy::hash(m_pixel, m_dimension, m_seed);
+    m_dimension++;
+    return LowDiscrepancy::scrambledSobol(m_sampleIndex, 0, uint32_t(hash), uint32_t(hash >> 32));
+}
+
+Point2f SobolSampler::next2D()
+{
+    /* Both dimensions share the shuffled index, which keeps the pair a (0,2)-sequence */
+    uint64_t hash = LowDiscrepancy::hash(m_pixel, m_dimension, m_seed);
+    uint64_t scrambleHash = LowDiscrepancy::mixBits(hash);
+    m_dimension += 2;
+    return Point2f(
+            LowDiscrepancy::scrambledSobol(m_sampleIndex, 0, uint32_t(hash), uint32_t(scrambleHash)),
+            LowDiscrepancy::scrambledSobol(m_sampleIndex, 1, uint32_t(hash), uint32_t(scrambleHash >> 32))
+    );
+}
+
+std::string SobolSampler::toString() const
+{
+    return tfm::format("Sobol[sampleCount=%i, seed=%i]", m_sampleCount, m_seed);
+}
+
+NORI_REGISTER_CLASS(SobolSampler, XML_SAMPLER_SOBOL);
+NORI_NAMESPACE_END
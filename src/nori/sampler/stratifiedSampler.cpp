@@ -0,0 +1,90 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#include <nori/sampler/stratifiedSampler.h>
+#include <nori/core/lowDiscrepancy.h>
+
+NORI_NAMESPACE_BEGIN
+
+StratifiedSampler::StratifiedSampler(const PropertyList & propList)
+{
+    m_sampleCount = (size_t) propList.getInteger(XML_SAMPLER_STRATIFIED_SAMPLE_COUNT, DEFAULT_SAMPLER_STRATIFIED_SAMPLE_COUNT);
+    m_seed = (uint64_t) propList.getInteger(XML_SAMPLER_STRATIFIED_SEED, DEFAULT_SAMPLER_STRATIFIED_SEED);
+    m_bJitter = propList.getBoolean(XML_SAMPLER_STRATIFIED_JITTER, DEFAULT_SAMPLER_STRATIFIED_JITTER);
+
+    if (m_sampleCount == 0)
+    {
+        throw NoriException("StratifiedSampler: the sample count must be positive!");
+    }
+
+    setSampleCount(m_sampleCount);
+}
+
+std::unique_ptr<Sampler> StratifiedSampler::clone() const
+{
+    std::unique_ptr<StratifiedSampler> cloned(new StratifiedSampler());
+    cloned->m_sampleCount = m_sampleCount;
+    cloned->m_seed = m_seed;
+    cloned->m_pixel = m_pixel;
+    cloned->m_sampleIndex = m_sampleIndex;
+    cloned->m_dimension = m_dimension;
+    cloned->m_firstSample = m_firstSample;
+    cloned->m_rangeSampleCount = m_rangeSampleCount;
+    cloned->m_bSampleRange = m_bSampleRange;
+    cloned->m_gridX = m_gridX;
+    cloned->m_gridY = m_gridY;
+    cloned->m_bJitter = m_bJitter;
+    return std::move(cloned);
+}
+
+void StratifiedSampler::setSampleCount(size_t sampleCount)
+{
+    Sampler::setSampleCount(sampleCount);
+    m_gridX = std::max(uint32_t(std::sqrt(float(m_sampleCount))), 1u);
+    m_gridY = (uint32_t(m_sampleCount) + m_gridX - 1) / m_gridX;
+}
+
+void StratifiedSampler::prepare(const ImageBlock & block)
+{
+    /* No-op, the samples only depend on the pixel */
+}
+
+float StratifiedSampler::next1D()
+{
+    uint32_t pattern = uint32_t(LowDiscrepancy::hash(m_pixel, m_dimension, m_seed));
+    m_dimension++;
+
+    uint32_t sampleCount = uint32_t(m_sampleCount);
+    uint32_t index = m_sampleIndex % sampleCount;
+    uint32_t stratum = LowDiscrepancy::permutationElement(index, sampleCount, pattern);
+    float jitter = m_bJitter ? LowDiscrepancy::randomFloat(index, pattern * 0x967a889bu) : 0.5f;
+    return std::min((float(stratum) + jitter) / float(sampleCount), LowDiscrepancy::OneMinusEpsilon);
+}
+
+Point2f StratifiedSampler::next2D()
+{
+    uint32_t pattern = uint32_t(LowDiscrepancy::hash(m_pixel, m_dimension, m_seed));
+    m_dimension += 2;
+
+    /* When N is not a product of the grid size, a random subset of the strata is used */
+    uint32_t stratumCount = m_gridX * m_gridY;
+    uint32_t index = m_sampleIndex % stratumCount;
+    uint32_t stratum = LowDiscrepancy::permutationElement(index, stratumCount, pattern);
+    float jx = m_bJitter ? LowDiscrepancy::randomFloat(index, pattern * 0xa399d265u) : 0.5f;
+    float jy = m_bJitter ? LowDiscrepancy::randomFloat(index, pattern * 0x711ad6a5u) : 0.5f;
+
+    return Point2f(
+            std::min((float(stratum % m_gridX) + jx) / float(m_gridX), LowDiscrepancy::OneMinusEpsilon),
+            std::min((float(stratum / m_gridX) + jy) / float(m_gridY), LowDiscrepancy::OneMinusEpsilon)
+    );
+}
+
+std::string StratifiedSampler::toString() const
+{
+    return tfm::format("Stratified[sampleCount=%i, grid=%ix%i, jitter=%s, seed=%i]",
+                       m_sampleCount, m_gridX, m_gridY, m_bJitter ? "true" : "false", m_seed);
+}
+
+NORI_REGISTER_CLASS(StratifiedSampler, XML_SAMPLER_STRATIFIED);
+NORI_NAMESPACE_END
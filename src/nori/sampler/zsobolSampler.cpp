@@ -0,0 +1,146 @@
+//
+// Created by superqqli on 2026/10/18.
+//
+
+#include <nori/sampler/zsobolSampler.h>
+#include <nori/core/lowDiscrepancy.h>
+#include <nori/core/scene.h>
+#include <nori/core/camera.h>
+
+NORI_NAMESPACE_BEGIN
+
+namespace
+{
+    /// All permutations of the four base-4 digits
+    const uint8_t DIGIT_PERMUTATIONS[24][4] = {
+        {0, 1, 2, 3}, {0, 1, 3, 2}, {0, 2, 1, 3}, {0, 2, 3, 1}, {0, 3, 2, 1}, {0, 3, 1, 2},
+        {1, 0, 2, 3}, {1, 0, 3, 2}, {1, 2, 0, 3}, {1, 2, 3, 0}, {1, 3, 2, 0}, {1, 3, 0, 2},
+        {2, 1, 0, 3}, {2, 1, 3, 0}, {2, 0, 1, 3}, {2, 0, 3, 1}, {2, 3, 0, 1}, {2, 3, 1, 0},
+        {3, 1, 2, 0}, {3, 1, 0, 2}, {3, 2, 1, 0}, {3, 2, 0, 1}, {3, 0, 2, 1}, {3, 0, 1, 2}
+    };
+
+    int log2Ceil(uint64_t value)
+    {
+        int log2 = 0;
+        while ((uint64_t(1) << log2) < value)
+        {
+            log2++;
+        }
+        return log2;
+    }
+}
+
+ZSobolSampler::ZSobolSampler(const PropertyList & propList)
+{
+    m_sampleCount = (size_t) propList.getInteger(XML_SAMPLER_ZSOBOL_SAMPLE_COUNT, DEFAULT_SAMPLER_ZSOBOL_SAMPLE_COUNT);
+    m_seed = (uint64_t) propList.getInteger(XML_SAMPLER_ZSOBOL_SEED, DEFAULT_SAMPLER_ZSOBOL_SEED);
+
+    if (m_sampleCount == 0)
+    {
+        throw NoriException("ZSobolSampler: the sample count must be positive!");
+    }
+}
+
+std::unique_ptr<Sampler> ZSobolSampler::clone() const
+{
+    std::unique_ptr<ZSobolSampler> cloned(new ZSobolSampler());
+    cloned->m_sampleCount = m_sampleCount;
+    cloned->m_seed = m_seed;
+    cloned->m_pixel = m_pixel;
+    cloned->m_sampleIndex = m_sampleIndex;
+    cloned->m_dimension = m_dimension;
+    cloned->m_firstSample = m_firstSample;
+    cloned->m_rangeSampleCount = m_rangeSampleCount;
+    cloned->m_bSampleRange = m_bSampleRange;
+    cloned->m_log2SampleCount = m_log2SampleCount;
+    cloned->m_base4Digits = m_base4Digits;
+    return std::move(cloned);
+}
+
+void ZSobolSampler::preprocess(const Scene * pScene)
+{
+    if ((m_sampleCount & (m_sampleCount - 1)) != 0)
+    {
+        LOG(WARNING) << "ZSobolSampler: the sample count " << m_sampleCount
+                     << " is not a power of two, the error is not fully distributed as blue noise.";
+    }
+
+    const Vector2i & outputSize = pScene->getCamera()->getOutputSize();
+    int log2Resolution = log2Ceil(uint64_t(std::max(outputSize.x(), outputSize.y())));
+    m_log2SampleCount = log2Ceil(m_sampleCount);
+    m_base4Digits = log2Resolution + (m_log2SampleCount + 1) / 2;
+}
+
+void ZSobolSampler::prepare(const ImageBlock & block)
+{
+    /* No-op, the samples only depend on the pixel */
+}
+
+uint64_t ZSobolSampler::getSobolIndex() const
+{
+    uint64_t mortonIndex = (LowDiscrepancy::encodeMorton2(uint32_t(m_pixel.x()), uint32_t(m_pixel.y()))
+                            << m_log2SampleCount) | m_sampleIndex;
+
+    /* With an odd power of two, the least significant digit is binary */
+    bool bOddPower = (m_log2SampleCount & 1) != 0;
+    int lastDigit = bOddPower ? 1 : 0;
+
+    uint64_t sobolIndex = 0;
+    for (int i = m_base4Digits - 1; i >= lastDigit; i--)
+    {
+        int digitShift = 2 * i - (bOddPower ? 1 : 0);
+        int digit = int((mortonIndex >> digitShift) & 3);
+        uint64_t higherDigits = mortonIndex >> (digitShift + 2);
+        int permutation = int((LowDiscrepancy::mixBits(higherDigits ^ (0x55555555ull * m_dimension)) >> 24) % 24);
+        sobolIndex |= uint64_t(DIGIT_PERMUTATIONS[permutation][digit]) << digitShift;
+    }
+
+    if (bOddPower)
+    {
+        uint64_t digit = mortonIndex & 1;
+        sobolIndex |= digit ^ (LowDiscrepancy::mixBits((mortonIndex >> 1) ^ (0x55555555ull * m_dimension)) & 1);
+    }
+
+    return sobolIndex;
+}
+
+uint64_t ZSobolSampler::getScrambleHash(uint64_t sobolIndex) const
+{
+    /* The first dimension of the sequence only has 32 bits of precision, so the
+       points 2^32 indices apart share it. Every such run of the index (i.e.
+       every group of distant pixels) is therefore scrambled independently, the
+       first run keeps the plain per-dimension scramble */
+    return LowDiscrepancy::hash(m_dimension, m_seed) ^ LowDiscrepancy::mixBits(sobolIndex >> 32);
+}
+
+float ZSobolSampler::next1D()
+{
+    uint64_t sobolIndex = getSobolIndex();
+    uint64_t hash = getScrambleHash(sobolIndex);
+    m_dimension++;
+
+    uint32_t value = LowDiscrepancy::sobol(sobolIndex, 0);
+    return LowDiscrepancy::toFloat(LowDiscrepancy::nestedUniformScramble(value, uint32_t(hash)));
+}
+
+Point2f ZSobolSampler::next2D()
+{
+    uint64_t sobolIndex = getSobolIndex();
+    uint64_t hash = getScrambleHash(sobolIndex);
+    m_dimension += 2;
+
+    uint32_t x = LowDiscrepancy::sobol(sobolIndex, 0);
+    uint32_t y = LowDiscrepancy::sobol(sobolIndex, 1);
+    return Point2f(
+            LowDiscrepancy::toFloat(LowDiscrepancy::nestedUniformScramble(x, uint32_t(hash))),
+            LowDiscrepancy::toFloat(LowDiscrepancy::nestedUniformScramble(y, uint32_t(hash >> 32)))
+    );
+}
+
+std::string ZSobolSampler::toString() const
+{
+    return tfm::format("ZSobol[sampleCount=%i, seed=%i]", m_sampleCount, m_seed);
+}
+
+NORI_REGISTER_CLASS(ZSobolSampler, XML_SAMPLER_ZSOBOL);
+NORI_NAMESPACE_END
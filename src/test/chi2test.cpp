@@ -7,6 +7,7 @@
 #include <nori/test/chi2test.h>
 #include <nori/core/bsdf.h>
 #include <nori/core/bsdfQueryRecord.h>
+#include <nori/core/bsdfQueryBatch.h>
 #include <pcg32.h>
 #include <hypothesis.h>
 #include <fstream>
@@ -54,6 +55,10 @@ ChiSquareTest::ChiSquareTest(const PropertyList &propList)
        how many tests will be executed per BSDF */
     m_testCount = propList.getInteger("testCount", 5);
 
+    /* Number of lanes when sampling and evaluating the BSDFs through
+       their batch (SIMD) interface (0: use the scalar interface) */
+    m_batchSize = propList.getInteger("batchSize", 0);
+
     m_phiResolution = 2 * m_cosThetaResolution;
 
     if (m_sampleCount < 0) // ~5K samples per bin
@@ -112,24 +117,50 @@ void ChiSquareTest::activate()
 
             /* Generate many samples from the BSDF and create
                a histogram / contingency table */
-            BSDFQueryRecord bRec(wi);
-            for (int i=0; i<m_sampleCount; ++i) {
-                Point2f sample(random.nextFloat(), random.nextFloat());
-                Color3f result = bsdf->sample(bRec, sample);
-
-                if ((result.array() == 0).all())
-                    continue;
-
-                int cosThetaBin = std::min(std::max(0, (int) std::floor((bRec.wo.z()*0.5f+0.5f)
+            auto addSample = [&](const Vector3f &wo) {
+                int cosThetaBin = std::min(std::max(0, (int) std::floor((wo.z()*0.5f+0.5f)
                                                                         * m_cosThetaResolution)), m_cosThetaResolution-1);
 
-                float scaledPhi = std::atan2(bRec.wo.y(), bRec.wo.x()) * INV_TWOPI;
+                float scaledPhi = std::atan2(wo.y(), wo.x()) * INV_TWOPI;
                 if (scaledPhi < 0)
                     scaledPhi += 1;
 
                 int phiBin = std::min(std::max(0,
                                                (int) std::floor(scaledPhi * m_phiResolution)), m_phiResolution-1);
                 obsFrequencies[cosThetaBin * m_phiResolution + phiBin] += 1;
+            };
+
+            if (m_batchSize > 0) {
+                BSDFQueryBatch batch;
+                Point2fBatch samples;
+                Color3fBatch results;
+                for (int i=0; i<m_sampleCount; i += m_batchSize) {
+                    int size = std::min(m_batchSize, m_sampleCount - i);
+                    batch.resize(size);
+                    samples.resize(size, 2);
+                    for (int k=0; k<size; ++k) {
+                        batch.wi.row(k) << wi.x(), wi.y(), wi.z();
+                        samples(k, 0) = random.nextFloat();
+                        samples(k, 1) = random.nextFloat();
+                    }
+                    bsdf->sampleBatch(batch, samples, results);
+
+                    for (int k=0; k<size; ++k) {
+                        if ((results.row(k) == 0).all())
+                            continue;
+                        addSample(Vector3f(batch.wo(k, 0), batch.wo(k, 1), batch.wo(k, 2)));
+                    }
+                }
+            } else {
+                BSDFQueryRecord bRec(wi);
+                for (int i=0; i<m_sampleCount; ++i) {
+                    Point2f sample(random.nextFloat(), random.nextFloat());
+                    Color3f result = bsdf->sample(bRec, sample);
+
+                    if ((result.array() == 0).all())
+                        continue;
+                    addSample(bRec.wo);
+                }
             }
             cout << "done." << endl;
 
@@ -153,6 +184,16 @@ void ChiSquareTest::activate()
                                     (float) (sinTheta * sinPhi),
                                     (float) cosTheta);
 
+                        if (m_batchSize > 0) {
+                            /* Single-lane batch, validates pdfBatch() */
+                            BSDFQueryBatch batch(1);
+                            batch.wi.row(0) << wi.x(), wi.y(), wi.z();
+                            batch.wo.row(0) << wo.x(), wo.y(), wo.z();
+                            FloatBatch pdf;
+                            bsdf->pdfBatch(batch, pdf);
+                            return pdf(0);
+                        }
+
                         BSDFQueryRecord bRec(wi, wo, ESolidAngle);
                         return bsdf->pdf(bRec);
                     };
@@ -195,6 +236,7 @@ std::string ChiSquareTest::toString() const
                        "  minExpFrequency = %i,\n"
                        "  sampleCount = %i,\n"
                        "  testCount = %i,\n"
+                       "  batchSize = %i,\n"
                        "  significanceLevel = %f\n"
                        "]",
                        m_cosThetaResolution,
@@ -202,6 +244,7 @@ std::string ChiSquareTest::toString() const
                        m_minExpFrequency,
                        m_sampleCount,
                        m_testCount,
+                       m_batchSize,
                        m_significanceLevel
     );
 }